@@ -24,6 +24,8 @@ namespace UnrealBuildTool.Rules
 				{
 					"AIModule",
 					"HeadMountedDisplay",
+					"Json",
+					"NavigationSystem",
 					"PerfCounters",
 					"PhysicsCore",
 				}
@@ -0,0 +1,146 @@
+// "Ninja Character" plugin, by Javier 'Xaklse' Osset; Copyright 2020
+
+
+#include "NinjaAsyncQuerySubsystem.h"
+
+#include "Engine/World.h"
+
+
+UNinjaAsyncQuerySubsystem::UNinjaAsyncQuerySubsystem()
+	: Super()
+{
+	LastPruneFrame = 0;
+}
+
+void UNinjaAsyncQuerySubsystem::Deinitialize()
+{
+	Sweeps.Empty();
+
+	Super::Deinitialize();
+}
+
+void UNinjaAsyncQuerySubsystem::RequestSweep(const UObject* Requester, ENinjaAsyncQuery Query, const FVector& Start,
+	const FVector& End, const FQuat& Rotation, ECollisionChannel TraceChannel, const FCollisionShape& CollisionShape,
+	const FCollisionQueryParams& Params, const FCollisionResponseParams& ResponseParam)
+{
+	UWorld* World = GetWorld();
+	if (Requester == nullptr || World == nullptr)
+	{
+		return;
+	}
+
+	PruneSweeps();
+
+	FNinjaAsyncSweep& Sweep = Sweeps.FindOrAdd(MakeKey(Requester, Query));
+	Sweep.Handle = World->AsyncSweepByChannel(EAsyncTraceType::Single, Start, End, Rotation, TraceChannel,
+		CollisionShape, Params, ResponseParam);
+	Sweep.Start = Start;
+	Sweep.End = End;
+	Sweep.AxisZ = Rotation.GetAxisZ();
+	Sweep.Shape = CollisionShape;
+	Sweep.Frame = GFrameCounter;
+}
+
+bool UNinjaAsyncQuerySubsystem::ConsumeSweep(const UObject* Requester, ENinjaAsyncQuery Query, const FVector& Start,
+	const FVector& End, const FQuat& Rotation, const FCollisionShape& CollisionShape, float MaxDistance,
+	float MaxAngleCosine, FHitResult& OutHit, bool& bOutBlockingHit)
+{
+	FNinjaAsyncSweep Sweep;
+	if (Requester == nullptr || !Sweeps.RemoveAndCopyValue(MakeKey(Requester, Query), Sweep))
+	{
+		return false;
+	}
+
+	// Results are only meaningful for queries requested on previous frame
+	if (Sweep.Frame + 1 != GFrameCounter || Sweep.Shape.ShapeType != CollisionShape.ShapeType ||
+		!Sweep.Shape.GetExtent().Equals(CollisionShape.GetExtent(), KINDA_SMALL_NUMBER))
+	{
+		return false;
+	}
+
+	const FVector Delta = Start - Sweep.Start;
+	const FVector TraceVector = End - Start;
+	const float TraceLength = TraceVector.Size();
+	if (Delta.SizeSquared() > FMath::Square(MaxDistance) || TraceLength <= KINDA_SMALL_NUMBER ||
+		!FMath::IsNearlyEqual(TraceLength, (Sweep.End - Sweep.Start).Size(), KINDA_SMALL_NUMBER) ||
+		(TraceVector / TraceLength | (Sweep.End - Sweep.Start).GetSafeNormal()) < MaxAngleCosine ||
+		(Rotation.GetAxisZ() | Sweep.AxisZ) < MaxAngleCosine)
+	{
+		return false;
+	}
+
+	FTraceDatum TraceDatum;
+	if (!GetWorld()->QueryTraceData(Sweep.Handle, TraceDatum))
+	{
+		return false;
+	}
+
+	const FHitResult* TraceHit = TraceDatum.OutHits.Num() > 0 ? &TraceDatum.OutHits[0] : nullptr;
+	bOutBlockingHit = (TraceHit != nullptr && TraceHit->bBlockingHit);
+
+	if (!bOutBlockingHit)
+	{
+		OutHit.Reset(1.0f, false);
+		OutHit.TraceStart = Start;
+		OutHit.TraceEnd = End;
+		return true;
+	}
+
+	// Initial overlaps depend on exact start location
+	if (TraceHit->bStartPenetrating)
+	{
+		return false;
+	}
+
+	OutHit = *TraceHit;
+
+	if (!Delta.IsZero())
+	{
+		// Assume impacted surface is locally planar to move the hit along with the shape
+		const FVector TraceDirection = TraceVector / TraceLength;
+		const float Approach = (TraceDirection | OutHit.Normal) * -1.0f;
+		if (Approach <= KINDA_SMALL_NUMBER)
+		{
+			return false;
+		}
+
+		const float HitDistance = OutHit.Time * TraceLength + (Delta | OutHit.Normal) / Approach;
+		if (HitDistance < 0.0f || HitDistance > TraceLength)
+		{
+			return false;
+		}
+
+		OutHit.Time = HitDistance / TraceLength;
+		OutHit.Distance = HitDistance;
+		OutHit.Location = Start + TraceDirection * HitDistance;
+		OutHit.ImpactPoint += FVector::VectorPlaneProject(Delta, OutHit.ImpactNormal);
+		OutHit.TraceStart = Start;
+		OutHit.TraceEnd = End;
+	}
+
+	return true;
+}
+
+uint64 UNinjaAsyncQuerySubsystem::MakeKey(const UObject* Requester, ENinjaAsyncQuery Query)
+{
+	return ((uint64)Requester->GetUniqueID() << 8) | (uint64)Query;
+}
+
+void UNinjaAsyncQuerySubsystem::PruneSweeps()
+{
+	// Requesters that stopped requesting would leave stale entries behind
+	if (GFrameCounter < LastPruneFrame + 300)
+	{
+		return;
+	}
+
+	LastPruneFrame = GFrameCounter;
+
+	for (auto It = Sweeps.CreateIterator(); It; ++It)
+	{
+		if (It.Value().Frame + 1 < GFrameCounter)
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
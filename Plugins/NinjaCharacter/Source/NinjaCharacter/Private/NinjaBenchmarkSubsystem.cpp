@@ -0,0 +1,589 @@
+// "Ninja Character" plugin, by Javier 'Xaklse' Osset; Copyright 2020
+
+
+#include "NinjaBenchmarkSubsystem.h"
+
+#include "NinjaCharacter.h"
+#include "NinjaCharacterMovementComponent.h"
+#include "NinjaCharacterStats.h"
+#include "NinjaPhysicsVolume.h"
+#include "NinjaProjectileManager.h"
+
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/Controller.h"
+#include "Dom/JsonObject.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+
+
+DEFINE_LOG_CATEGORY_STATIC(LogNinjaBenchmark, Log, All);
+
+namespace NinjaBenchmark
+{
+	/**
+	 * Checks if a gravity mode can be benchmarked without Actors or assets.
+	 * @param Mode - mode that determines direction of gravity
+	 * @return true if the mode is supported
+	 */
+	static bool IsModeSupported(ENinjaGravityDirectionMode Mode)
+	{
+		return Mode == ENinjaGravityDirectionMode::Fixed || Mode == ENinjaGravityDirectionMode::Point ||
+			Mode == ENinjaGravityDirectionMode::Line || Mode == ENinjaGravityDirectionMode::Segment ||
+			Mode == ENinjaGravityDirectionMode::Plane || Mode == ENinjaGravityDirectionMode::Box;
+	}
+
+	/**
+	 * Obtains the display name of a gravity mode.
+	 * @param Mode - mode that determines direction of gravity
+	 * @return name of the mode
+	 */
+	static FString GetModeName(ENinjaGravityDirectionMode Mode)
+	{
+		return StaticEnum<ENinjaGravityDirectionMode>()->GetNameStringByValue((int64)Mode);
+	}
+
+	/**
+	 * Serializes a JSON object to a string; strings are escaped by the writer.
+	 * @param Object - object to serialize
+	 * @param bPrettyPrint - if true, output is indented and split in lines
+	 * @return serialized object, empty string if serialization failed
+	 */
+	static FString SerializeJson(const TSharedRef<FJsonObject>& Object, bool bPrettyPrint)
+	{
+		FString Output;
+		bool bSerialized;
+
+		if (bPrettyPrint)
+		{
+			TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Output);
+			bSerialized = FJsonSerializer::Serialize(Object, Writer);
+		}
+		else
+		{
+			TSharedRef<TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>> Writer =
+				TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&Output);
+			bSerialized = FJsonSerializer::Serialize(Object, Writer);
+		}
+
+		return bSerialized ? Output : FString();
+	}
+
+	/**
+	 * Resets benchmark counters and enables or disables them.
+	 * @param bTrack - if true, counters are updated
+	 */
+	static void ResetCounters(bool bTrack)
+	{
+#if !UE_BUILD_SHIPPING
+		NinjaCharacterStats::bTrackBenchmarkCounters = bTrack;
+		NinjaCharacterStats::GravityEvaluations = 0;
+		NinjaCharacterStats::FloorSweeps = 0;
+		NinjaCharacterStats::GravityRPCs = 0;
+#endif // !UE_BUILD_SHIPPING
+	}
+
+#if !UE_BUILD_SHIPPING
+	/**
+	 * Handles the Ninja.Benchmark console command.
+	 * @param Args - arguments of the command
+	 * @param World - world where the command runs
+	 */
+	static void ExecBenchmarkCommand(const TArray<FString>& Args, UWorld* World)
+	{
+		UNinjaBenchmarkSubsystem* Subsystem = (World != nullptr) ? World->GetSubsystem<UNinjaBenchmarkSubsystem>() : nullptr;
+		if (Subsystem == nullptr)
+		{
+			return;
+		}
+
+		const FString Params = FString::Join(Args, TEXT(" "));
+		if (FParse::Param(*Params, TEXT("Stop")))
+		{
+			Subsystem->StopBenchmark();
+			return;
+		}
+
+		FNinjaBenchmarkSettings Settings;
+		FParse::Value(*Params, TEXT("Projectiles="), Settings.NumProjectiles);
+		FParse::Value(*Params, TEXT("Warmup="), Settings.WarmupFrames);
+		FParse::Value(*Params, TEXT("Frames="), Settings.MeasuredFrames);
+		FParse::Value(*Params, TEXT("Seed="), Settings.RandomSeed);
+		FParse::Value(*Params, TEXT("Radius="), Settings.SpawnRadius);
+		Settings.bQuitWhenFinished = FParse::Param(*Params, TEXT("Quit"));
+
+		FString Counts;
+		if (FParse::Value(*Params, TEXT("Counts="), Counts, false))
+		{
+			TArray<FString> CountStrings;
+			Counts.ParseIntoArray(CountStrings, TEXT(","));
+
+			Settings.CharacterCounts.Reset();
+			for (const FString& CountString : CountStrings)
+			{
+				Settings.CharacterCounts.Add(FCString::Atoi(*CountString));
+			}
+		}
+
+		FString Modes;
+		if (FParse::Value(*Params, TEXT("Modes="), Modes, false))
+		{
+			TArray<FString> ModeStrings;
+			Modes.ParseIntoArray(ModeStrings, TEXT(","));
+
+			Settings.GravityModes.Reset();
+			for (const FString& ModeString : ModeStrings)
+			{
+				const int64 ModeValue = StaticEnum<ENinjaGravityDirectionMode>()->GetValueByNameString(ModeString);
+				if (ModeValue != INDEX_NONE)
+				{
+					Settings.GravityModes.Add((ENinjaGravityDirectionMode)ModeValue);
+				}
+			}
+		}
+
+		Subsystem->StartBenchmark(Settings);
+	}
+
+	FAutoConsoleCommandWithWorldAndArgs CmdBenchmark(TEXT("Ninja.Benchmark"),
+		TEXT("Measures scaling of Ninja movement and saves results to the profiling directory.\n")
+		TEXT("Arguments: Counts=1,10,100,500 Modes=Fixed,Point Projectiles=500 Warmup=30 Frames=300 Seed=1234 Radius=2000 Quit, or Stop"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&ExecBenchmarkCommand));
+#endif // !UE_BUILD_SHIPPING
+}
+
+FNinjaBenchmarkSettings::FNinjaBenchmarkSettings()
+	: CharacterClass(ANinjaCharacter::StaticClass())
+	, NumProjectiles(500)
+	, WarmupFrames(30)
+	, MeasuredFrames(300)
+	, RandomSeed(1234)
+	, SpawnRadius(2000.0f)
+	, bQuitWhenFinished(false)
+{
+	CharacterCounts = {1, 10, 100, 500};
+	GravityModes = {ENinjaGravityDirectionMode::Fixed, ENinjaGravityDirectionMode::Point,
+		ENinjaGravityDirectionMode::Line, ENinjaGravityDirectionMode::Segment,
+		ENinjaGravityDirectionMode::Plane, ENinjaGravityDirectionMode::Box};
+}
+
+FNinjaBenchmarkTickFunction::FNinjaBenchmarkTickFunction()
+	: Subsystem(nullptr)
+{
+	TickGroup = TG_PrePhysics;
+	bCanEverTick = true;
+	bStartWithTickEnabled = true;
+}
+
+void FNinjaBenchmarkTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread,
+	const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Subsystem != nullptr && TickType != LEVELTICK_ViewportsOnly)
+	{
+		Subsystem->TickBenchmark(DeltaTime);
+	}
+}
+
+FString FNinjaBenchmarkTickFunction::DiagnosticMessage()
+{
+	return TEXT("FNinjaBenchmarkTickFunction");
+}
+
+FName FNinjaBenchmarkTickFunction::DiagnosticContext(bool bDetailed)
+{
+	return FName(TEXT("NinjaBenchmark"));
+}
+
+UNinjaBenchmarkSubsystem::UNinjaBenchmarkSubsystem()
+	: Super()
+{
+	CaseIndex = INDEX_NONE;
+	CaseFrame = 0;
+	Center = FVector::ZeroVector;
+	LastTickTime = 0.0;
+	FrameTimeSum = 0.0;
+	FrameTimeMax = 0.0;
+	GameThreadTimeSum = 0.0;
+	StartNetOutBytes = 0;
+}
+
+void UNinjaBenchmarkSubsystem::Deinitialize()
+{
+	StopBenchmark();
+
+	if (TickFunction.IsTickFunctionRegistered())
+	{
+		TickFunction.UnRegisterTickFunction();
+	}
+
+	Super::Deinitialize();
+}
+
+bool UNinjaBenchmarkSubsystem::StartBenchmark(const FNinjaBenchmarkSettings& NewSettings)
+{
+	StopBenchmark();
+
+	UWorld* World = GetWorld();
+	if (World == nullptr || World->PersistentLevel == nullptr || World->GetNetMode() == NM_Client ||
+		*NewSettings.CharacterClass == nullptr || NewSettings.CharacterCounts.Num() == 0 ||
+		NewSettings.GravityModes.Num() == 0)
+	{
+		UE_LOG(LogNinjaBenchmark, Warning, TEXT("Benchmark can't start: it needs an authoritative world, a character class, counts and modes"));
+		return false;
+	}
+
+	if (!TickFunction.IsTickFunctionRegistered())
+	{
+		TickFunction.Subsystem = this;
+		TickFunction.RegisterTickFunction(World->PersistentLevel);
+	}
+
+	Settings = NewSettings;
+	Settings.WarmupFrames = FMath::Max(0, Settings.WarmupFrames);
+	Settings.MeasuredFrames = FMath::Max(1, Settings.MeasuredFrames);
+	Results.Reset();
+
+	// Benchmark center is the first Ninja physics volume, or the world origin
+	Volume.Reset();
+	Center = FVector::ZeroVector;
+	for (TActorIterator<ANinjaPhysicsVolume> It(World); It; ++It)
+	{
+		Volume = *It;
+		Center = It->GetActorLocation();
+		break;
+	}
+
+	CaseIndex = 0;
+	while (IsBenchmarkRunning() && !StartCase())
+	{
+		CaseIndex = (CaseIndex + 1 < Settings.GravityModes.Num() * Settings.CharacterCounts.Num()) ?
+			CaseIndex + 1 : INDEX_NONE;
+	}
+
+	return IsBenchmarkRunning();
+}
+
+void UNinjaBenchmarkSubsystem::StopBenchmark()
+{
+	if (IsBenchmarkRunning())
+	{
+		DestroyCharacters();
+		NinjaBenchmark::ResetCounters(false);
+
+		CaseIndex = INDEX_NONE;
+	}
+}
+
+void UNinjaBenchmarkSubsystem::TickBenchmark(float DeltaTime)
+{
+	if (!IsBenchmarkRunning())
+	{
+		return;
+	}
+
+	const double TickTime = FPlatformTime::Seconds();
+
+	CaseFrame++;
+	if (CaseFrame == Settings.WarmupFrames + 1)
+	{
+		// Measuring starts now
+		NinjaBenchmark::ResetCounters(true);
+
+		FrameTimeSum = 0.0;
+		FrameTimeMax = 0.0;
+		GameThreadTimeSum = 0.0;
+		StartNetOutBytes = GetNetOutBytes();
+	}
+	else if (CaseFrame > Settings.WarmupFrames + 1)
+	{
+		const double FrameTime = (TickTime - LastTickTime) * 1000.0;
+		FrameTimeSum += FrameTime;
+		FrameTimeMax = FMath::Max(FrameTimeMax, FrameTime);
+		GameThreadTimeSum += FPlatformTime::ToMilliseconds(GGameThreadTime);
+
+		if (CaseFrame > Settings.WarmupFrames + Settings.MeasuredFrames)
+		{
+			FinishCase();
+
+			const int32 NumCases = Settings.GravityModes.Num() * Settings.CharacterCounts.Num();
+			do
+			{
+				CaseIndex = (CaseIndex + 1 < NumCases) ? CaseIndex + 1 : INDEX_NONE;
+			}
+			while (IsBenchmarkRunning() && !StartCase());
+
+			if (!IsBenchmarkRunning())
+			{
+				SaveResults();
+
+				if (Settings.bQuitWhenFinished)
+				{
+					FPlatformMisc::RequestExit(false);
+				}
+			}
+
+			LastTickTime = FPlatformTime::Seconds();
+			return;
+		}
+	}
+
+	LastTickTime = TickTime;
+
+	DriveCharacters();
+	RefillProjectiles();
+}
+
+bool UNinjaBenchmarkSubsystem::StartCase()
+{
+	const ENinjaGravityDirectionMode Mode = Settings.GravityModes[CaseIndex / Settings.CharacterCounts.Num()];
+	const int32 NumCharacters = Settings.CharacterCounts[CaseIndex % Settings.CharacterCounts.Num()];
+
+	if (!NinjaBenchmark::IsModeSupported(Mode) || NumCharacters < 0)
+	{
+		UE_LOG(LogNinjaBenchmark, Warning, TEXT("Skipping gravity mode %s with %d characters"),
+			*NinjaBenchmark::GetModeName(Mode), NumCharacters);
+		return false;
+	}
+
+	UWorld* World = GetWorld();
+
+	// Every case replays the same scenario
+	RandomStream.Initialize(Settings.RandomSeed);
+	FMath::RandInit(Settings.RandomSeed);
+	FMath::SRandInit(Settings.RandomSeed);
+
+	if (Volume.IsValid())
+	{
+		ApplyGravityMode(nullptr, Mode);
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+	Characters.Reserve(NumCharacters);
+	Waypoints.Reserve(NumCharacters);
+	for (int32 i = 0; i < NumCharacters; ++i)
+	{
+		const FVector2D Offset = FVector2D(RandomStream.VRand()).GetSafeNormal() *
+			RandomStream.FRandRange(0.0f, Settings.SpawnRadius);
+		const FVector SpawnLocation = Center + FVector(Offset, 0.0f);
+
+		ANinjaCharacter* Character = World->SpawnActor<ANinjaCharacter>(Settings.CharacterClass, SpawnLocation,
+			FRotator(0.0f, RandomStream.FRandRange(-180.0f, 180.0f), 0.0f), SpawnParams);
+		if (Character == nullptr)
+		{
+			continue;
+		}
+
+		Character->SpawnDefaultController();
+		ApplyGravityMode(Character, Mode);
+
+		const FVector2D WaypointOffset = FVector2D(RandomStream.VRand()).GetSafeNormal() *
+			RandomStream.FRandRange(0.0f, Settings.SpawnRadius);
+
+		Characters.Add(Character);
+		Waypoints.Add(Center + FVector(WaypointOffset, 0.0f));
+	}
+
+	CaseFrame = 0;
+	LastTickTime = FPlatformTime::Seconds();
+
+	UE_LOG(LogNinjaBenchmark, Log, TEXT("Measuring gravity mode %s with %d characters and %d projectiles"),
+		*NinjaBenchmark::GetModeName(Mode), Characters.Num(), Settings.NumProjectiles);
+
+	return true;
+}
+
+void UNinjaBenchmarkSubsystem::FinishCase()
+{
+	const ENinjaGravityDirectionMode Mode = Settings.GravityModes[CaseIndex / Settings.CharacterCounts.Num()];
+	const double NumFrames = (double)Settings.MeasuredFrames;
+
+	int64 GravityEvaluations = 0;
+	int64 FloorSweeps = 0;
+	int64 GravityRPCs = 0;
+#if !UE_BUILD_SHIPPING
+	GravityEvaluations = NinjaCharacterStats::GravityEvaluations;
+	FloorSweeps = NinjaCharacterStats::FloorSweeps;
+	GravityRPCs = NinjaCharacterStats::GravityRPCs;
+#endif // !UE_BUILD_SHIPPING
+
+	const int64 NetOutBytes = GetNetOutBytes() - StartNetOutBytes;
+
+	TSharedRef<FJsonObject> Result = MakeShared<FJsonObject>();
+	Result->SetStringField(TEXT("mode"), NinjaBenchmark::GetModeName(Mode));
+	Result->SetNumberField(TEXT("characters"), Characters.Num());
+	Result->SetNumberField(TEXT("projectiles"), Settings.NumProjectiles);
+	Result->SetNumberField(TEXT("frames"), Settings.MeasuredFrames);
+	Result->SetNumberField(TEXT("msPerFrame"), FrameTimeSum / NumFrames);
+	Result->SetNumberField(TEXT("msPerFrameMax"), FrameTimeMax);
+	Result->SetNumberField(TEXT("gameThreadMsPerFrame"), GameThreadTimeSum / NumFrames);
+	Result->SetNumberField(TEXT("gravityEvaluationsPerFrame"), GravityEvaluations / NumFrames);
+	Result->SetNumberField(TEXT("floorSweepsPerFrame"), FloorSweeps / NumFrames);
+	Result->SetNumberField(TEXT("gravityRPCsPerFrame"), GravityRPCs / NumFrames);
+	Result->SetNumberField(TEXT("netBytesPerFrame"), NetOutBytes / NumFrames);
+
+	Results.Add(MakeShared<FJsonValueObject>(Result));
+
+	UE_LOG(LogNinjaBenchmark, Log, TEXT("%s"), *NinjaBenchmark::SerializeJson(Result, false));
+
+	NinjaBenchmark::ResetCounters(false);
+	DestroyCharacters();
+}
+
+void UNinjaBenchmarkSubsystem::ApplyGravityMode(ANinjaCharacter* Character, ENinjaGravityDirectionMode Mode) const
+{
+	// Gravity targets are placed below the center so characters keep walking on the floor
+	const float Radius = FMath::Max(Settings.SpawnRadius, 100.0f);
+	const FVector Below = Center - FVector::UpVector * Radius * 10.0f;
+	const FVector BoxExtent(Radius * 2.0f, Radius * 2.0f, Radius * 5.0f);
+
+	// Movement components and physics volumes share the same setters
+	auto SetGravity = [&](auto* Target)
+	{
+		switch (Mode)
+		{
+			case ENinjaGravityDirectionMode::Point:
+				Target->SetPointGravityDirection(Below);
+				break;
+			case ENinjaGravityDirectionMode::Line:
+				Target->SetLineGravityDirection(Below, Below + FVector::ForwardVector);
+				break;
+			case ENinjaGravityDirectionMode::Segment:
+				Target->SetSegmentGravityDirection(Below - FVector::ForwardVector * Radius,
+					Below + FVector::ForwardVector * Radius);
+				break;
+			case ENinjaGravityDirectionMode::Plane:
+				Target->SetPlaneGravityDirection(Center, FVector::UpVector);
+				break;
+			case ENinjaGravityDirectionMode::Box:
+				Target->SetBoxGravityDirection(Below, BoxExtent);
+				break;
+			default:
+				Target->SetFixedGravityDirection(FVector::DownVector);
+				break;
+		}
+	};
+
+	if (Character != nullptr)
+	{
+		UNinjaCharacterMovementComponent* CharacterMovement = Character->GetNinjaCharacterMovement();
+		if (CharacterMovement != nullptr)
+		{
+			SetGravity(CharacterMovement);
+		}
+	}
+	else if (Volume.IsValid())
+	{
+		SetGravity(Volume.Get());
+	}
+}
+
+void UNinjaBenchmarkSubsystem::DriveCharacters()
+{
+	const float AcceptanceRadiusSquared = FMath::Square(100.0f);
+
+	for (int32 i = 0; i < Characters.Num(); ++i)
+	{
+		ANinjaCharacter* Character = Characters[i];
+		if (Character == nullptr || Character->IsPendingKill())
+		{
+			continue;
+		}
+
+		Character->StopJumping();
+
+		const FVector Location = Character->GetActorLocation();
+		const FVector Up = Character->GetActorQuat().GetAxisZ();
+		FVector Direction = FVector::VectorPlaneProject(Waypoints[i] - Location, Up);
+
+		if (Direction.SizeSquared() < AcceptanceRadiusSquared)
+		{
+			const FVector2D WaypointOffset = FVector2D(RandomStream.VRand()).GetSafeNormal() *
+				RandomStream.FRandRange(0.0f, Settings.SpawnRadius);
+			Waypoints[i] = Center + FVector(WaypointOffset, 0.0f);
+
+			Direction = FVector::VectorPlaneProject(Waypoints[i] - Location, Up);
+		}
+
+		Character->AddMovementInput(Direction.GetSafeNormal());
+
+		if (RandomStream.FRand() < 0.01f)
+		{
+			Character->Jump();
+		}
+	}
+}
+
+void UNinjaBenchmarkSubsystem::RefillProjectiles()
+{
+	UNinjaProjectileManager* ProjectileManager = (Settings.NumProjectiles > 0) ?
+		GetWorld()->GetSubsystem<UNinjaProjectileManager>() : nullptr;
+	if (ProjectileManager == nullptr)
+	{
+		return;
+	}
+
+	FNinjaPooledProjectileParams Params;
+	Params.Radius = 5.0f;
+	Params.LifeSpan = 3.0f;
+
+	const FVector LaunchLocation = Center + FVector::UpVector * Settings.SpawnRadius * 0.5f;
+	for (int32 i = ProjectileManager->GetNumProjectiles(); i < Settings.NumProjectiles; ++i)
+	{
+		ProjectileManager->FireProjectile(LaunchLocation, RandomStream.VRand() * RandomStream.FRandRange(500.0f, 2000.0f),
+			Params);
+	}
+}
+
+void UNinjaBenchmarkSubsystem::DestroyCharacters()
+{
+	for (ANinjaCharacter* Character : Characters)
+	{
+		if (Character != nullptr && !Character->IsPendingKill())
+		{
+			AController* Controller = Character->GetController();
+			if (Controller != nullptr)
+			{
+				Controller->Destroy();
+			}
+
+			Character->Destroy();
+		}
+	}
+
+	Characters.Reset();
+	Waypoints.Reset();
+}
+
+void UNinjaBenchmarkSubsystem::SaveResults() const
+{
+	TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+	Root->SetStringField(TEXT("map"), GetWorld()->GetMapName());
+	Root->SetNumberField(TEXT("seed"), Settings.RandomSeed);
+	Root->SetArrayField(TEXT("results"), Results);
+
+	const FString Json = NinjaBenchmark::SerializeJson(Root, true);
+
+	const FString FileName = FPaths::ProfilingDir() / TEXT("NinjaBenchmark") /
+		FString::Printf(TEXT("NinjaBenchmark-%s.json"), *FDateTime::Now().ToString());
+
+	if (FFileHelper::SaveStringToFile(Json, *FileName))
+	{
+		UE_LOG(LogNinjaBenchmark, Log, TEXT("Benchmark results saved to %s"), *FileName);
+	}
+	else
+	{
+		UE_LOG(LogNinjaBenchmark, Warning, TEXT("Benchmark results couldn't be saved to %s"), *FileName);
+	}
+}
+
+int64 UNinjaBenchmarkSubsystem::GetNetOutBytes() const
+{
+	const UNetDriver* NetDriver = GetWorld()->GetNetDriver();
+	return (NetDriver != nullptr) ? (int64)NetDriver->OutTotalBytes : 0;
+}
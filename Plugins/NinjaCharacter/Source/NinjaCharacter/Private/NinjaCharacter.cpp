@@ -5,9 +5,11 @@
 
 #include "NinjaCharacterMovementComponent.h"
 #include "NinjaMath.h"
+#include "NinjaPlayerCameraManager.h"
 
 #include "GameFramework/DamageType.h"
 #include "GameFramework/Controller.h"
+#include "GameFramework/PlayerController.h"
 #include "Components/SkeletalMeshComponent.h"
 #include "Engine/World.h"
 
@@ -267,6 +269,13 @@ void ANinjaCharacter::LaunchCharacterRotated(FVector LaunchVelocity, bool bHoriz
 
 void ANinjaCharacter::TransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
 {
+	// Don't interpolate fixed time steps across teleports
+	UNinjaCharacterMovementComponent* NinjaMovement = GetNinjaCharacterMovement();
+	if (Teleport != ETeleportType::None && NinjaMovement != nullptr)
+	{
+		NinjaMovement->ResetFixedTimeStepInterpolation();
+	}
+
 	// Abort if rotation didn't change
 	const FQuat NewRotation = GetActorQuat();
 	if (NewRotation == LastRotation)
@@ -316,6 +325,15 @@ void ANinjaCharacter::OnCharMovementAxisChanged(const FVector& OldAxisZ, const F
 {
 	if (bCapsuleRotatesControlRotation && Controller != nullptr)
 	{
+		const APlayerController* PlayerController = Cast<APlayerController>(Controller);
+		const ANinjaPlayerCameraManager* CameraManager = (PlayerController != nullptr) ?
+			Cast<ANinjaPlayerCameraManager>(PlayerController->PlayerCameraManager) : nullptr;
+		if (CameraManager != nullptr && CameraManager->IsGravityAwareViewOf(this))
+		{
+			// Camera manager follows 'up' axis of the capsule by itself
+			return;
+		}
+
 		const FQuat ControlRotation = Controller->GetControlRotation().Quaternion();
 		FQuat QuatRotation;
 
@@ -401,6 +419,28 @@ FVector ANinjaCharacter::GetActorAxisZ() const
 	return GetActorQuat().GetAxisZ();
 }
 
+FVector ANinjaCharacter::GetInterpolatedActorLocation() const
+{
+	const UNinjaCharacterMovementComponent* MovementComponent = GetNinjaCharacterMovement();
+	if (MovementComponent != nullptr && MovementComponent->UpdatedComponent == RootComponent)
+	{
+		return MovementComponent->GetInterpolatedComponentLocation();
+	}
+
+	return GetActorLocation();
+}
+
+FQuat ANinjaCharacter::GetInterpolatedActorQuat() const
+{
+	const UNinjaCharacterMovementComponent* MovementComponent = GetNinjaCharacterMovement();
+	if (MovementComponent != nullptr && MovementComponent->UpdatedComponent == RootComponent)
+	{
+		return MovementComponent->GetInterpolatedComponentQuat();
+	}
+
+	return GetActorQuat();
+}
+
 void ANinjaCharacter::SmoothComponentLocationAndRotation(class USceneComponent* SceneComponent, float DeltaTime, float LocationSpeed, float RotationSpeed, const FVector& RelativeLocation, const FRotator& RelativeRotation)
 {
 	if (DeltaTime <= 0.0f || SceneComponent == nullptr)
@@ -426,7 +466,7 @@ void ANinjaCharacter::SmoothComponentLocationAndRotation(class USceneComponent*
 	SceneComponent->SetUsingAbsoluteLocation(true);
 	SceneComponent->SetUsingAbsoluteRotation(true);
 
-	FQuat NewRotation = GetActorQuat() * (RelativeRotation.IsNearlyZero() ?
+	FQuat NewRotation = GetInterpolatedActorQuat() * (RelativeRotation.IsNearlyZero() ?
 		FQuat::Identity : RelativeRotation.Quaternion());
 
 	if (RotationSpeed > 0.0f)
@@ -435,7 +475,7 @@ void ANinjaCharacter::SmoothComponentLocationAndRotation(class USceneComponent*
 			NewRotation, DeltaTime, RotationSpeed);
 	}
 
-	FVector NewLocation = GetActorLocation() + (RelativeLocation.IsNearlyZero() ?
+	FVector NewLocation = GetInterpolatedActorLocation() + (RelativeLocation.IsNearlyZero() ?
 		FVector::ZeroVector : NewRotation.RotateVector(RelativeLocation));
 
 	if (LocationSpeed > 0.0f)
@@ -471,8 +511,8 @@ void ANinjaCharacter::SmoothComponentLocation(class USceneComponent* SceneCompon
 
 	SceneComponent->SetUsingAbsoluteLocation(true);
 
-	FVector NewLocation = GetActorLocation() + (RelativeLocation.IsNearlyZero() ?
-		FVector::ZeroVector : GetActorQuat().RotateVector(RelativeLocation));
+	FVector NewLocation = GetInterpolatedActorLocation() + (RelativeLocation.IsNearlyZero() ?
+		FVector::ZeroVector : GetInterpolatedActorQuat().RotateVector(RelativeLocation));
 
 	if (LocationSpeed > 0.0f)
 	{
@@ -507,7 +547,7 @@ void ANinjaCharacter::SmoothComponentRotation(class USceneComponent* SceneCompon
 
 	SceneComponent->SetUsingAbsoluteRotation(true);
 
-	FQuat NewRotation = GetActorQuat() * (RelativeRotation.IsNearlyZero() ?
+	FQuat NewRotation = GetInterpolatedActorQuat() * (RelativeRotation.IsNearlyZero() ?
 		FQuat::Identity : RelativeRotation.Quaternion());
 
 	if (RotationSpeed > 0.0f)
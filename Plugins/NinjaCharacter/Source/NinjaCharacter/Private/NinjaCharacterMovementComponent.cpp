@@ -7,7 +7,12 @@
 #include "NinjaCharacterMovementComponent.h"
 
 #include "NinjaCharacter.h"
+#include "NinjaCharacterStats.h"
+#include "NinjaGravityField.h"
+#include "NinjaGravityRegistrySubsystem.h"
 #include "NinjaMath.h"
+#include "NinjaMovementTickManager.h"
+#include "NinjaPhysicsVolume.h"
 
 #include "UObject/Package.h"
 #include "GameFramework/PlayerController.h"
@@ -22,18 +27,19 @@
 #include "Components/BrushComponent.h"
 #include "Net/PerfCountersHelpers.h"
 #include "Components/SplineComponent.h"
+#include "Net/UnrealNetwork.h"
 
 
 // Log categories
 DEFINE_LOG_CATEGORY_STATIC(LogCharacterMovement, Log, All);
 
 // Character stats
-DECLARE_CYCLE_STAT(TEXT("Char RootMotionSource Apply"), STAT_CharacterMovementRootMotionSourceApply, STATGROUP_Character);
-DECLARE_CYCLE_STAT(TEXT("Char StepUp"), STAT_CharStepUp, STATGROUP_Character);
-DECLARE_CYCLE_STAT(TEXT("Char AdjustFloorHeight"), STAT_CharAdjustFloorHeight, STATGROUP_Character);
-DECLARE_CYCLE_STAT(TEXT("Char PhysWalking"), STAT_CharPhysWalking, STATGROUP_Character);
-DECLARE_CYCLE_STAT(TEXT("Char PhysFalling"), STAT_CharPhysFalling, STATGROUP_Character);
-DECLARE_CYCLE_STAT(TEXT("Char HandleImpact"), STAT_CharHandleImpact, STATGROUP_Character);
+DECLARE_CYCLE_STAT(TEXT("Ninja RootMotionSource Apply"), STAT_CharacterMovementRootMotionSourceApply, STATGROUP_NinjaCharacter);
+DECLARE_CYCLE_STAT(TEXT("Ninja StepUp"), STAT_CharStepUp, STATGROUP_NinjaCharacter);
+DECLARE_CYCLE_STAT(TEXT("Ninja AdjustFloorHeight"), STAT_CharAdjustFloorHeight, STATGROUP_NinjaCharacter);
+DECLARE_CYCLE_STAT(TEXT("Ninja PhysWalking"), STAT_CharPhysWalking, STATGROUP_NinjaCharacter);
+DECLARE_CYCLE_STAT(TEXT("Ninja PhysFalling"), STAT_CharPhysFalling, STATGROUP_NinjaCharacter);
+DECLARE_CYCLE_STAT(TEXT("Ninja HandleImpact"), STAT_CharHandleImpact, STATGROUP_NinjaCharacter);
 
 // Magic numbers
 const float MAX_STEP_SIDE_Z = 0.08f; // Maximum Z value for the normal on the vertical side of steps
@@ -103,6 +109,41 @@ namespace NinjaCharacterMovementCVars
 		TEXT("0: Disable, 1: Enable"),
 		EConsoleVariableFlags::ECVF_Cheat);
 #endif // !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
+
+	static int32 SimulatedMovementLOD = 1;
+	FAutoConsoleVariableRef CVarSimulatedMovementLOD(
+		TEXT("p.SimulatedMovementLOD"),
+		SimulatedMovementLOD,
+		TEXT("Whether simulated proxies use levels of detail of simulated movement.\n")
+		TEXT("0: Disable, 1: Enable"),
+		ECVF_Default);
+
+	static int32 FloorCache = 1;
+	FAutoConsoleVariableRef CVarFloorCache(
+		TEXT("p.FloorCache"),
+		FloorCache,
+		TEXT("Whether floor queries can reuse the result of the last floor sweep.\n")
+		TEXT("0: Disable, 1: Enable"),
+		ECVF_Default);
+
+	static int32 AsyncSceneQueries = 1;
+	FAutoConsoleVariableRef CVarAsyncSceneQueries(
+		TEXT("p.AsyncSceneQueries"),
+		AsyncSceneQueries,
+		TEXT("Whether speculative floor and rotation sweeps can be requested as asynchronous scene queries.\n")
+		TEXT("0: Disable, 1: Enable"),
+		ECVF_Default);
+}
+
+
+FNinjaSimulatedMovementLOD::FNinjaSimulatedMovementLOD()
+	: MinDistance(0.0f)
+	, TickInterval(0.0f)
+	, bSkipFloorChecks(false)
+	, bFreezeGravity(false)
+	, bExtrapolateOnly(false)
+	, MaxExtrapolationTime(0.5f)
+{
 }
 
 
@@ -113,27 +154,65 @@ UNinjaCharacterMovementComponent::UNinjaCharacterMovementComponent(const FObject
 	RotationRate = FRotator(360.0f, 360.0f, 360.0f);
 
 	SetMoveResponseDataContainer(NinjaMoveResponseDataContainer);
+	SetNetworkMoveDataContainer(NinjaNetworkMoveDataContainer);
 
 	bAlignComponentToFloor = false;
 	bAlignComponentToGravity = false;
 	bAlignGravityToBase = false;
 	bAlwaysRotateAroundCenter = false;
 	bApplyingNetworkMovementMode = false;
-	bDirtyGravityDirection = false;
 	bDisableGravityReplication = false;
+	bFixedTimeStep = false;
+	bFixedTimeStepInterpolation = false;
+	bFloorCacheValid = false;
 	bForceSimulateMovement = false;
+	bIncrementalRotation = false;
+	bInterpolateFixedTimeStepMesh = true;
 	bLandOnAnySurface = false;
+	bPublishGravitySnapshot = false;
 	bRevertToDefaultGravity = false;
 	bRotateVelocityOnGround = false;
+	bSimulatingFixedTimeSteps = false;
 	bTriggerUnwalkableHits = false;
+	bUseAsyncSceneQueries = false;
+	bUseMovementTickManager = false;
+	bUseNetworkGravityDirection = false;
+	AsyncQueryDistanceTolerance = 1.0f;
+	FixedTimeStepAccumulator = 0.0f;
+	FixedTimeStepCurrentLocation = FVector::ZeroVector;
+	FixedTimeStepCurrentRotation = FQuat::Identity;
+	FixedTimeStepPendingInput = FVector::ZeroVector;
+	FixedTimeStepPreviousLocation = FVector::ZeroVector;
+	FixedTimeStepPreviousRotation = FQuat::Identity;
+	FixedTimeStepRate = 60.0f;
+	FloorCacheAngleTolerance = 2.0f;
+	FloorCacheAxisZ = FVector::UpVector;
+	FloorCacheBaseTransform = FTransform::Identity;
+	FloorCacheDistanceTolerance = 1.0f;
+	FloorCacheLocation = FVector::ZeroVector;
+	FloorCacheSweepRadius = 0.0f;
 	GravityActor = nullptr;
 	GravityDirectionMode = ENinjaGravityDirectionMode::Fixed;
+	GravityField = nullptr;
+	GravityReplicationAngleThreshold = 1.0f;
+	GravityReplicationDistanceThreshold = 1.0f;
+	GravityReplicationSettleTime = 0.5f;
+	GravitySpline = nullptr;
 	GravityVectorA = FVector::DownVector;
 	GravityVectorB = FVector::ZeroVector;
+	LastGravityReplicationTime = -1.0f;
 	LastUnwalkableHitTime = -1.0f;
-	OldGravityScale = GravityScale;
+	MaxFixedTimeSteps = 4;
+	NetworkGravityAngleTolerance = 5.0f;
+	NetworkGravityDirection = FVector::DownVector;
+	NotRenderedLODDistanceScale = 2.0f;
+	HotState.OldGravityScale = GravityScale;
+	SimulatedMovementExtrapolationTime = 0.0f;
+	SimulatedMovementLODBaseTickInterval = 0.0f;
+	SimulatedMovementLODIndex = INDEX_NONE;
 
 	SetThresholdParallelAngle(1.0f);
+	SetIncrementalRotationAngles(2.0f, 0.5f);
 }
 
 #if WITH_EDITOR
@@ -147,9 +226,32 @@ void UNinjaCharacterMovementComponent::PostEditChangeProperty(FPropertyChangedEv
 		// Compute new threshold values
 		SetThresholdParallelAngle(ThresholdParallelAngle);
 	}
+	else if (PropertyName == GET_MEMBER_NAME_CHECKED(ThisClass, IncrementalRotationBudget) ||
+		PropertyName == GET_MEMBER_NAME_CHECKED(ThisClass, IncrementalRotationRelease))
+	{
+		// Compute new cosine values
+		SetIncrementalRotationAngles(IncrementalRotationBudget, IncrementalRotationRelease);
+	}
 }
 #endif // WITH_EDITOR
 
+void UNinjaCharacterMovementComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(UNinjaCharacterMovementComponent, GravityState);
+}
+
+void UNinjaCharacterMovementComponent::InitializeComponent()
+{
+	Super::InitializeComponent();
+
+	// Derived values aren't serialized, compute them from loaded settings
+	SetThresholdParallelAngle(ThresholdParallelAngle);
+	SetIncrementalRotationAngles(IncrementalRotationBudget, IncrementalRotationRelease);
+	HotState.GravityDirectionFunc = FNinjaGravityEvaluator::Find(GravityDirectionMode);
+}
+
 bool UNinjaCharacterMovementComponent::DoJump(bool bReplayingMoves)
 {
 	if (CharacterOwner && CharacterOwner->CanJump())
@@ -422,10 +524,68 @@ void UNinjaCharacterMovementComponent::PerformAirControlForPathFollowingEx(const
 	}
 }
 
+void UNinjaCharacterMovementComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (ShouldUseMovementTickManager())
+	{
+		UNinjaMovementTickManager* MovementTickManager = GetWorld()->GetSubsystem<UNinjaMovementTickManager>();
+		if (MovementTickManager != nullptr)
+		{
+			MovementTickManager->RegisterComponent(this);
+		}
+	}
+}
+
+void UNinjaCharacterMovementComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (bUseMovementTickManager && GetWorld() != nullptr)
+	{
+		UNinjaMovementTickManager* MovementTickManager = GetWorld()->GetSubsystem<UNinjaMovementTickManager>();
+		if (MovementTickManager != nullptr)
+		{
+			MovementTickManager->UnregisterComponent(this, false);
+		}
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+bool UNinjaCharacterMovementComponent::ShouldUseMovementTickManager() const
+{
+	// Batched tick runs every frame and stops while paused, own tick settings have to match
+	return (bUseMovementTickManager && CharacterOwner != nullptr && GetWorld() != nullptr && GetWorld()->IsGameWorld() &&
+		CharacterOwner->GetLocalRole() == ROLE_Authority && !CharacterOwner->IsPlayerControlled() &&
+		PrimaryComponentTick.TickInterval <= 0.0f && !PrimaryComponentTick.bTickEvenWhenPaused);
+}
+
 void UNinjaCharacterMovementComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
 {
+	if (CharacterOwner != nullptr && CharacterOwner->GetLocalRole() == ROLE_SimulatedProxy)
+	{
+		UpdateSimulatedMovementLOD();
+	}
+	else if (SimulatedMovementLODIndex != INDEX_NONE)
+	{
+		// Role changed, i.e. possession; level of detail only applies to simulated proxies
+		ResetSimulatedMovementLOD();
+	}
+
 	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
 
+	// Only characters that move during their own tick can consume speculative queries
+	if (CanUseAsyncSceneQueries() && (CharacterOwner->IsLocallyControlled() ||
+		(CharacterOwner->GetLocalRole() == ROLE_Authority && CharacterOwner->GetRemoteRole() != ROLE_AutonomousProxy)))
+	{
+		RequestAsyncSceneQueries(DeltaTime);
+	}
+
+	if (bPublishGravitySnapshot && HasValidData())
+	{
+		PublishGravitySnapshot();
+	}
+
 #if !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
 	if (NinjaCharacterMovementCVars::ShowGravity > 0)
 	{
@@ -498,6 +658,145 @@ void UNinjaCharacterMovementComponent::TickComponent(float DeltaTime, ELevelTick
 #endif // !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
 }
 
+FVector UNinjaCharacterMovementComponent::GetInterpolatedComponentLocation() const
+{
+	if (UpdatedComponent == nullptr)
+	{
+		return FVector::ZeroVector;
+	}
+
+	if (!bFixedTimeStepInterpolation)
+	{
+		return UpdatedComponent->GetComponentLocation();
+	}
+
+	return FMath::Lerp(FixedTimeStepPreviousLocation, FixedTimeStepCurrentLocation,
+		FMath::Clamp(FixedTimeStepAccumulator * FixedTimeStepRate, 0.0f, 1.0f));
+}
+
+FQuat UNinjaCharacterMovementComponent::GetInterpolatedComponentQuat() const
+{
+	if (UpdatedComponent == nullptr)
+	{
+		return FQuat::Identity;
+	}
+
+	if (!bFixedTimeStepInterpolation)
+	{
+		return UpdatedComponent->GetComponentQuat();
+	}
+
+	return FQuat::Slerp(FixedTimeStepPreviousRotation, FixedTimeStepCurrentRotation,
+		FMath::Clamp(FixedTimeStepAccumulator * FixedTimeStepRate, 0.0f, 1.0f));
+}
+
+void UNinjaCharacterMovementComponent::ControlledCharacterMove(const FVector& InputVector, float DeltaSeconds)
+{
+	if (!bFixedTimeStep || FixedTimeStepRate <= 0.0f || !HasValidData())
+	{
+		if (bFixedTimeStepInterpolation)
+		{
+			// Put Mesh back in place
+			bFixedTimeStepInterpolation = false;
+			FixedTimeStepAccumulator = 0.0f;
+			InterpolateFixedTimeStepMesh();
+		}
+
+		FixedTimeStepPendingInput = FVector::ZeroVector;
+
+		Super::ControlledCharacterMove(InputVector, DeltaSeconds);
+		return;
+	}
+
+	const FVector Location = UpdatedComponent->GetComponentLocation();
+	const FQuat Rotation = UpdatedComponent->GetComponentQuat();
+
+	if (!bFixedTimeStepInterpolation)
+	{
+		// Started, teleported or corrected; don't interpolate from the old transform
+		FixedTimeStepPreviousLocation = FixedTimeStepCurrentLocation = Location;
+		FixedTimeStepPreviousRotation = FixedTimeStepCurrentRotation = Rotation;
+		bFixedTimeStepInterpolation = true;
+	}
+	else if (Location != FixedTimeStepCurrentLocation || Rotation != FixedTimeStepCurrentRotation)
+	{
+		// Moved between fixed time steps without teleporting (i.e. by a moving base); interpolation follows
+		FixedTimeStepPreviousLocation += Location - FixedTimeStepCurrentLocation;
+		FixedTimeStepPreviousRotation = (Rotation * FixedTimeStepCurrentRotation.Inverse()) * FixedTimeStepPreviousRotation;
+		FixedTimeStepPreviousRotation.Normalize();
+		FixedTimeStepCurrentLocation = Location;
+		FixedTimeStepCurrentRotation = Rotation;
+	}
+
+	const float TimeStep = 1.0f / FixedTimeStepRate;
+	FixedTimeStepAccumulator += DeltaSeconds;
+
+	// Under load catch-up is capped; time that can't be simulated is discarded
+	const int32 NumSteps = FMath::Min(FMath::FloorToInt(FixedTimeStepAccumulator / TimeStep),
+		FMath::Max(1, MaxFixedTimeSteps));
+	FixedTimeStepAccumulator = FMath::Min(FixedTimeStepAccumulator - NumSteps * TimeStep, TimeStep);
+
+	// Input of frames without fixed time steps is kept for the next step
+	FixedTimeStepPendingInput += InputVector;
+	if (NumSteps > 0)
+	{
+		const FVector StepInputVector = FixedTimeStepPendingInput;
+		FixedTimeStepPendingInput = FVector::ZeroVector;
+
+		// Teleports flagged by the simulation itself don't reset interpolation
+		TGuardValue<bool> SimulatingGuard(bSimulatingFixedTimeSteps, true);
+
+		for (int32 Step = 0; Step < NumSteps; ++Step)
+		{
+			FixedTimeStepPreviousLocation = UpdatedComponent->GetComponentLocation();
+			FixedTimeStepPreviousRotation = UpdatedComponent->GetComponentQuat();
+
+			Super::ControlledCharacterMove(StepInputVector, TimeStep);
+
+			if (!HasValidData())
+			{
+				bFixedTimeStepInterpolation = false;
+				return;
+			}
+		}
+	}
+
+	FixedTimeStepCurrentLocation = UpdatedComponent->GetComponentLocation();
+	FixedTimeStepCurrentRotation = UpdatedComponent->GetComponentQuat();
+
+	if (bInterpolateFixedTimeStepMesh)
+	{
+		InterpolateFixedTimeStepMesh();
+	}
+}
+
+void UNinjaCharacterMovementComponent::ResetFixedTimeStepInterpolation()
+{
+	if (!bSimulatingFixedTimeSteps)
+	{
+		bFixedTimeStepInterpolation = false;
+	}
+}
+
+void UNinjaCharacterMovementComponent::InterpolateFixedTimeStepMesh()
+{
+	USkeletalMeshComponent* Mesh = (CharacterOwner != nullptr) ? CharacterOwner->GetMesh() : nullptr;
+	if (Mesh == nullptr || UpdatedComponent == nullptr || Mesh->GetAttachParent() != UpdatedComponent ||
+		IsNetMode(NM_DedicatedServer))
+	{
+		return;
+	}
+
+	// Mesh keeps its base offsets relative to the interpolated transform
+	const FTransform BaseTransform(CharacterOwner->GetBaseRotationOffset(), CharacterOwner->GetBaseTranslationOffset());
+	const FTransform InterpolatedTransform(GetInterpolatedComponentQuat(), GetInterpolatedComponentLocation(),
+		UpdatedComponent->GetComponentScale());
+	const FTransform RelativeTransform = (BaseTransform * InterpolatedTransform).GetRelativeTransform(
+		UpdatedComponent->GetComponentTransform());
+
+	Mesh->SetRelativeLocationAndRotation(RelativeTransform.GetLocation(), RelativeTransform.GetRotation());
+}
+
 FVector UNinjaCharacterMovementComponent::ConstrainAnimRootMotionVelocity(const FVector& RootMotionVelocity, const FVector& CurrentVelocity) const
 {
 	FVector Result = RootMotionVelocity;
@@ -538,6 +837,13 @@ void UNinjaCharacterMovementComponent::SimulateMovement(float DeltaSeconds)
 		return;
 	}
 
+	const FNinjaSimulatedMovementLOD* SimulatedLOD = bIsSimulatedProxy ? GetSimulatedMovementLOD() : nullptr;
+	if (SimulatedLOD != nullptr && SimulatedLOD->bExtrapolateOnly)
+	{
+		ExtrapolateSimulatedMovement(DeltaSeconds);
+		return;
+	}
+
 	FVector OldVelocity;
 	FVector OldLocation;
 
@@ -621,7 +927,15 @@ void UNinjaCharacterMovementComponent::SimulateMovement(float DeltaSeconds)
 			MoveSmooth(Velocity, DeltaSeconds, &StepDownResult);
 
 			// Find floor and check if falling
-			if (IsMovingOnGround() || MovementMode == MOVE_Falling)
+			if (SimulatedLOD != nullptr && SimulatedLOD->bSkipFloorChecks)
+			{
+				// Current floor is kept; network updates will fix the movement mode
+				if (MovementMode == MOVE_Falling && !bSimGravityDisabled)
+				{
+					Velocity = NewFallVelocity(Velocity, GetGravity(), DeltaSeconds);
+				}
+			}
+			else if (IsMovingOnGround() || MovementMode == MOVE_Falling)
 			{
 				const FVector Gravity = GetGravity();
 
@@ -705,13 +1019,141 @@ void UNinjaCharacterMovementComponent::SimulateMovement(float DeltaSeconds)
 	LastUpdateVelocity = Velocity;
 }
 
+const FNinjaSimulatedMovementLOD* UNinjaCharacterMovementComponent::GetSimulatedMovementLOD() const
+{
+	return SimulatedMovementLODs.IsValidIndex(SimulatedMovementLODIndex) ?
+		&SimulatedMovementLODs[SimulatedMovementLODIndex] : nullptr;
+}
+
+void UNinjaCharacterMovementComponent::UpdateSimulatedMovementLOD()
+{
+	int32 NewLODIndex = INDEX_NONE;
+
+	if (NinjaCharacterMovementCVars::SimulatedMovementLOD > 0 && SimulatedMovementLODs.Num() > 0 && HasValidData())
+	{
+		const FVector Location = UpdatedComponent->GetComponentLocation();
+		float MinDistanceSquared = -1.0f;
+
+		// Find closest local view target
+		for (FConstPlayerControllerIterator Iterator = GetWorld()->GetPlayerControllerIterator(); Iterator; ++Iterator)
+		{
+			const APlayerController* PlayerController = Iterator->Get();
+			if (PlayerController != nullptr && PlayerController->IsLocalController())
+			{
+				FVector ViewLocation;
+				FRotator ViewRotation;
+				PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+
+				const float DistanceSquared = FVector::DistSquared(ViewLocation, Location);
+				if (MinDistanceSquared < 0.0f || DistanceSquared < MinDistanceSquared)
+				{
+					MinDistanceSquared = DistanceSquared;
+				}
+			}
+		}
+
+		if (MinDistanceSquared >= 0.0f)
+		{
+			float Distance = FMath::Sqrt(MinDistanceSquared);
+			if (!CharacterOwner->WasRecentlyRendered())
+			{
+				Distance *= NotRenderedLODDistanceScale;
+			}
+
+			for (int32 Index = SimulatedMovementLODs.Num() - 1; Index >= 0; --Index)
+			{
+				if (Distance >= SimulatedMovementLODs[Index].MinDistance)
+				{
+					NewLODIndex = Index;
+					break;
+				}
+			}
+		}
+	}
+
+	if (NewLODIndex == SimulatedMovementLODIndex)
+	{
+		return;
+	}
+
+	if (SimulatedMovementLODIndex == INDEX_NONE)
+	{
+		SimulatedMovementLODBaseTickInterval = GetComponentTickInterval();
+	}
+
+	SimulatedMovementLODIndex = NewLODIndex;
+	SimulatedMovementExtrapolationTime = 0.0f;
+
+	SetComponentTickInterval(NewLODIndex != INDEX_NONE ?
+		SimulatedMovementLODs[NewLODIndex].TickInterval : SimulatedMovementLODBaseTickInterval);
+
+	// Previous level of detail might have frozen gravity or skipped floor checks
+	InvalidateGravityCache();
+	bForceNextFloorCheck = true;
+}
+
+void UNinjaCharacterMovementComponent::ResetSimulatedMovementLOD()
+{
+	if (SimulatedMovementLODIndex == INDEX_NONE)
+	{
+		return;
+	}
+
+	SimulatedMovementLODIndex = INDEX_NONE;
+	SimulatedMovementExtrapolationTime = 0.0f;
+
+	SetComponentTickInterval(SimulatedMovementLODBaseTickInterval);
+
+	// Previous level of detail might have frozen gravity or skipped floor checks
+	InvalidateGravityCache();
+	bForceNextFloorCheck = true;
+}
+
+void UNinjaCharacterMovementComponent::ExtrapolateSimulatedMovement(float DeltaSeconds)
+{
+	// Location and rotation were already applied when replicated movement was received
+	if (bNetworkUpdateReceived)
+	{
+		bNetworkUpdateReceived = false;
+		SimulatedMovementExtrapolationTime = 0.0f;
+
+		if (bNetworkMovementModeChanged)
+		{
+			ApplyNetworkMovementMode(CharacterOwner->GetReplicatedMovementMode());
+			bNetworkMovementModeChanged = false;
+		}
+	}
+
+	const FNinjaSimulatedMovementLOD* SimulatedLOD = GetSimulatedMovementLOD();
+	const bool bExtrapolate = (MovementMode != MOVE_None && !CharacterOwner->bSimGravityDisabled &&
+		(SimulatedLOD == nullptr || SimulatedMovementExtrapolationTime < SimulatedLOD->MaxExtrapolationTime));
+
+	if (bExtrapolate && !Velocity.IsZero())
+	{
+		SimulatedMovementExtrapolationTime += DeltaSeconds;
+		UpdatedComponent->SetWorldLocation(UpdatedComponent->GetComponentLocation() + Velocity * DeltaSeconds,
+			false, nullptr, ETeleportType::None);
+	}
+
+	UpdateComponentVelocity();
+	bJustTeleported = false;
+
+	LastUpdateLocation = UpdatedComponent->GetComponentLocation();
+	LastUpdateRotation = UpdatedComponent->GetComponentQuat();
+	LastUpdateVelocity = Velocity;
+}
+
 void UNinjaCharacterMovementComponent::MaybeUpdateBasedMovement(float DeltaSeconds)
 {
 	UpdateGravity();
 
 	const bool bMovingOnGround = IsMovingOnGround();
-	UpdateComponentRotation(GetComponentDesiredAxisZ(), bAlwaysRotateAroundCenter || !bMovingOnGround,
-		bRotateVelocityOnGround && bMovingOnGround);
+	const FVector DesiredAxisZ = GetComponentDesiredAxisZ();
+	if (ShouldUpdateComponentRotation(DesiredAxisZ))
+	{
+		UpdateComponentRotation(DesiredAxisZ, bAlwaysRotateAroundCenter || !bMovingOnGround,
+			bRotateVelocityOnGround && bMovingOnGround);
+	}
 
 	Super::MaybeUpdateBasedMovement(DeltaSeconds);
 }
@@ -2176,7 +2618,7 @@ FVector UNinjaCharacterMovementComponent::ComputeGroundMovementDeltaEx(const FVe
 			return DeltaNormal;
 		}
 
-		if (!FNinjaMath::Orthogonal(DeltaNormal, FloorNormal, ThresholdOrthogonalCosine))
+		if (!FNinjaMath::Orthogonal(DeltaNormal, FloorNormal, HotState.ThresholdOrthogonalCosine))
 		{
 			// Compute a vector that moves parallel to the surface, by projecting the horizontal movement direction onto the ramp
 			// We can't just project Delta onto the plane defined by FloorNormal because the direction changes on spherical geometry
@@ -2625,6 +3067,7 @@ void UNinjaCharacterMovementComponent::OnTeleported()
 	UPawnMovementComponent::OnTeleported();
 
 	bJustTeleported = true;
+	InvalidateFloorCache();
 
 	// Find floor at current location
 	UpdateFloorFromAdjustment();
@@ -2764,6 +3207,9 @@ void UNinjaCharacterMovementComponent::PhysicsVolumeChanged(class APhysicsVolume
 		return;
 	}
 
+	// Magnitude of gravity might be different now
+	InvalidateGravityCache();
+
 	if (bRevertToDefaultGravity && NewVolume != nullptr &&
 		NewVolume == GetWorld()->GetDefaultPhysicsVolume())
 	{
@@ -2956,6 +3402,22 @@ void UNinjaCharacterMovementComponent::MoveSmooth(const FVector& InVelocity, con
 }
 
 bool UNinjaCharacterMovementComponent::IsWalkable(const FHitResult& Hit) const
+{
+	if (!IsWalkableEx(Hit, GetComponentAxisZ()))
+	{
+		return false;
+	}
+
+	// Can't start walking on this surface if gravity direction disallows that
+	if (!bLandOnAnySurface && IsFalling() && !IsWalkableEx(Hit, GetGravityDirection() * -1.0f))
+	{
+		return false;
+	}
+
+	return true;
+}
+
+bool UNinjaCharacterMovementComponent::IsWalkableEx(const FHitResult& Hit, const FVector& UpDirection) const
 {
 	if (!Hit.IsValidBlockingHit())
 	{
@@ -2963,10 +3425,8 @@ bool UNinjaCharacterMovementComponent::IsWalkable(const FHitResult& Hit) const
 		return false;
 	}
 
-	const FVector CapsuleUp = GetComponentAxisZ();
-
 	// Never walk up vertical surfaces
-	if ((Hit.ImpactNormal | CapsuleUp) < KINDA_SMALL_NUMBER)
+	if ((Hit.ImpactNormal | UpDirection) < KINDA_SMALL_NUMBER)
 	{
 		return false;
 	}
@@ -2982,14 +3442,7 @@ bool UNinjaCharacterMovementComponent::IsWalkable(const FHitResult& Hit) const
 	}
 
 	// Can't walk on this surface if it is too steep
-	if ((Hit.ImpactNormal | CapsuleUp) < TestWalkableZ)
-	{
-		return false;
-	}
-
-	// Can't start walking on this surface if gravity direction disallows that
-	if (!bLandOnAnySurface && IsFalling() &&
-		(Hit.ImpactNormal | (GetGravityDirection() * -1.0f)) < TestWalkableZ)
+	if ((Hit.ImpactNormal | UpDirection) < TestWalkableZ)
 	{
 		return false;
 	}
@@ -3012,6 +3465,8 @@ bool UNinjaCharacterMovementComponent::IsWithinEdgeToleranceEx(const FVector& Ca
 
 void UNinjaCharacterMovementComponent::ComputeFloorDist(const FVector& CapsuleLocation, float LineDistance, float SweepDistance, FFindFloorResult& OutFloorResult, float SweepRadius, const FHitResult* DownwardSweepResult) const
 {
+	SCOPE_CYCLE_COUNTER(STAT_NinjaComputeFloorDist);
+
 	UE_LOG(LogCharacterMovement, VeryVerbose, TEXT("[Role:%d] ComputeFloorDist: %s at location %s"), (int32)CharacterOwner->GetLocalRole(), *GetNameSafe(CharacterOwner), *CapsuleLocation.ToString());
 	OutFloorResult.Clear();
 
@@ -3025,7 +3480,7 @@ void UNinjaCharacterMovementComponent::ComputeFloorDist(const FVector& CapsuleLo
 	{
 		// Only if the supplied sweep was vertical and downward
 		if (FNinjaMath::Coincident((DownwardSweepResult->TraceEnd - DownwardSweepResult->TraceStart).GetSafeNormal(),
-			CapsuleDown, ThresholdParallelCosine))
+			CapsuleDown, HotState.ThresholdParallelCosine))
 		{
 			// Reject hits that are barely on the cusp of the radius of the capsule
 			if (IsWithinEdgeToleranceEx(DownwardSweepResult->Location, CapsuleDown, PawnRadius, DownwardSweepResult->ImpactPoint))
@@ -3046,6 +3501,12 @@ void UNinjaCharacterMovementComponent::ComputeFloorDist(const FVector& CapsuleLo
 		}
 	}
 
+	// Reuse last floor sweep if the capsule barely moved or rotated since then
+	if (!bSkipSweep && ReuseFloorCache(CapsuleLocation, SweepDistance, SweepRadius, OutFloorResult))
+	{
+		return;
+	}
+
 	// We require the sweep distance to be >= the line distance, otherwise the HitResult can't be interpreted as the sweep result
 	if (SweepDistance < LineDistance)
 	{
@@ -3071,7 +3532,8 @@ void UNinjaCharacterMovementComponent::ComputeFloorDist(const FVector& CapsuleLo
 		FCollisionShape CapsuleShape = FCollisionShape::MakeCapsule(SweepRadius, PawnHalfHeight - ShrinkHeight);
 
 		FHitResult Hit(1.0f);
-		bBlockingHit = FloorSweepTest(Hit, CapsuleLocation, CapsuleLocation + CapsuleDown * TraceDist, CollisionChannel, CapsuleShape, QueryParams, ResponseParam);
+		bBlockingHit = AsyncFloorSweepTest(ENinjaAsyncQuery::Floor, Hit, CapsuleLocation, CapsuleLocation + CapsuleDown * TraceDist,
+			CollisionChannel, CapsuleShape, QueryParams, ResponseParam);
 
 		if (bBlockingHit)
 		{
@@ -3105,6 +3567,13 @@ void UNinjaCharacterMovementComponent::ComputeFloorDist(const FVector& CapsuleLo
 				{
 					// Hit within test distance
 					OutFloorResult.bWalkableFloor = true;
+
+					// Perch queries use a smaller radius, only regular floor sweeps are cached
+					if (FMath::IsNearlyEqual(SweepRadius, PawnRadius))
+					{
+						StoreFloorCache(CapsuleLocation, SweepRadius, OutFloorResult);
+					}
+
 					return;
 				}
 			}
@@ -3154,31 +3623,113 @@ void UNinjaCharacterMovementComponent::ComputeFloorDist(const FVector& CapsuleLo
 	OutFloorResult.bWalkableFloor = false;
 }
 
-bool UNinjaCharacterMovementComponent::FloorSweepTest(FHitResult& OutHit, const FVector& Start, const FVector& End, ECollisionChannel TraceChannel,
-	const FCollisionShape& CollisionShape, const FCollisionQueryParams& Params, const FCollisionResponseParams& ResponseParam) const
+void UNinjaCharacterMovementComponent::InvalidateFloorCache()
 {
-	bool bBlockingHit = false;
+	bFloorCacheValid = false;
+}
 
-	if (!bUseFlatBaseForFloorChecks)
+bool UNinjaCharacterMovementComponent::ReuseFloorCache(const FVector& CapsuleLocation, float SweepDistance, float SweepRadius, FFindFloorResult& OutFloorResult) const
+{
+	if (!bFloorCacheValid || NinjaCharacterMovementCVars::FloorCache == 0 || bJustTeleported || bForceNextFloorCheck ||
+		!FMath::IsNearlyEqual(SweepRadius, FloorCacheSweepRadius))
 	{
-		bBlockingHit = GetWorld()->SweepSingleByChannel(OutHit, Start, End, UpdatedComponent->GetComponentQuat(), TraceChannel, CollisionShape, Params, ResponseParam);
+		return false;
 	}
-	else
+
+	const FVector Delta = CapsuleLocation - FloorCacheLocation;
+	if (Delta.SizeSquared() > FMath::Square(FloorCacheDistanceTolerance))
 	{
-		// Test with a box that is enclosed by the capsule
-		const float CapsuleRadius = CollisionShape.GetCapsuleRadius();
-		const float CapsuleHeight = CollisionShape.GetCapsuleHalfHeight();
-		const FCollisionShape BoxShape = FCollisionShape::MakeBox(FVector(CapsuleRadius * 0.707f, CapsuleRadius * 0.707f, CapsuleHeight));
+		return false;
+	}
 
-		// Use a box rotation that ignores the capsule forward orientation
-		const FVector BoxUp = GetComponentAxisZ();
-		const FQuat BoxRotation = FRotationMatrix::MakeFromZ(BoxUp).ToQuat();
+	const FVector CapsuleUp = GetComponentAxisZ();
+	if ((CapsuleUp | FloorCacheAxisZ) < FMath::Cos(FMath::DegreesToRadians(FloorCacheAngleTolerance)))
+	{
+		return false;
+	}
 
-		// First test with the box rotated so the corners are along the major axes (ie rotated 45 degrees)
-		bBlockingHit = GetWorld()->SweepSingleByChannel(OutHit, Start, End, FQuat(BoxUp, PI * 0.25f) * BoxRotation, TraceChannel, BoxShape, Params, ResponseParam);
+	// Floor must not have moved since it was swept
+	const UPrimitiveComponent* FloorComponent = FloorCacheResult.HitResult.Component.Get();
+	if (FloorComponent == nullptr || (FloorComponent->Mobility != EComponentMobility::Static &&
+		!FloorComponent->GetComponentTransform().Equals(FloorCacheBaseTransform, KINDA_SMALL_NUMBER)))
+	{
+		return false;
+	}
 
-		if (!bBlockingHit)
-		{
+	const FHitResult& CachedHit = FloorCacheResult.HitResult;
+	const float NormalDotUp = CachedHit.Normal | CapsuleUp;
+	if (NormalDotUp <= KINDA_SMALL_NUMBER)
+	{
+		return false;
+	}
+
+	// Assume floor is locally planar around the cached impact point
+	const float FloorDist = FloorCacheResult.FloorDist + (Delta | CachedHit.Normal) / NormalDotUp;
+	if (FloorDist > SweepDistance)
+	{
+		return false;
+	}
+
+	FHitResult Hit = CachedHit;
+	Hit.TraceStart += Delta;
+	Hit.TraceEnd += Delta;
+	Hit.Location += Delta - CapsuleUp * (FloorDist - FloorCacheResult.FloorDist);
+	Hit.ImpactPoint += FVector::VectorPlaneProject(Delta, CachedHit.ImpactNormal);
+
+	if (!IsWithinEdgeToleranceEx(CapsuleLocation, CapsuleUp * -1.0f, SweepRadius, Hit.ImpactPoint) || !IsWalkable(Hit))
+	{
+		return false;
+	}
+
+	OutFloorResult.SetFromSweep(Hit, FloorDist, true);
+
+	return true;
+}
+
+void UNinjaCharacterMovementComponent::StoreFloorCache(const FVector& CapsuleLocation, float SweepRadius, const FFindFloorResult& FloorResult) const
+{
+	const UPrimitiveComponent* FloorComponent = FloorResult.HitResult.Component.Get();
+	if (FloorComponent == nullptr || NinjaCharacterMovementCVars::FloorCache == 0)
+	{
+		bFloorCacheValid = false;
+		return;
+	}
+
+	bFloorCacheValid = true;
+	FloorCacheResult = FloorResult;
+	FloorCacheLocation = CapsuleLocation;
+	FloorCacheAxisZ = GetComponentAxisZ();
+	FloorCacheSweepRadius = SweepRadius;
+	FloorCacheBaseTransform = FloorComponent->GetComponentTransform();
+}
+
+bool UNinjaCharacterMovementComponent::FloorSweepTest(FHitResult& OutHit, const FVector& Start, const FVector& End, ECollisionChannel TraceChannel,
+	const FCollisionShape& CollisionShape, const FCollisionQueryParams& Params, const FCollisionResponseParams& ResponseParam) const
+{
+	NINJA_COUNT_FLOOR_SWEEPS(1);
+
+	bool bBlockingHit = false;
+
+	if (!bUseFlatBaseForFloorChecks)
+	{
+		bBlockingHit = GetWorld()->SweepSingleByChannel(OutHit, Start, End, UpdatedComponent->GetComponentQuat(), TraceChannel, CollisionShape, Params, ResponseParam);
+	}
+	else
+	{
+		// Test with a box that is enclosed by the capsule
+		const float CapsuleRadius = CollisionShape.GetCapsuleRadius();
+		const float CapsuleHeight = CollisionShape.GetCapsuleHalfHeight();
+		const FCollisionShape BoxShape = FCollisionShape::MakeBox(FVector(CapsuleRadius * 0.707f, CapsuleRadius * 0.707f, CapsuleHeight));
+
+		// Use a box rotation that ignores the capsule forward orientation
+		const FVector BoxUp = GetComponentAxisZ();
+		const FQuat BoxRotation = FRotationMatrix::MakeFromZ(BoxUp).ToQuat();
+
+		// First test with the box rotated so the corners are along the major axes (ie rotated 45 degrees)
+		bBlockingHit = GetWorld()->SweepSingleByChannel(OutHit, Start, End, FQuat(BoxUp, PI * 0.25f) * BoxRotation, TraceChannel, BoxShape, Params, ResponseParam);
+
+		if (!bBlockingHit)
+		{
 			// Test again with the same box, not rotated
 			OutHit.Reset(1.0f, false);
 			bBlockingHit = GetWorld()->SweepSingleByChannel(OutHit, Start, End, BoxRotation, TraceChannel, BoxShape, Params, ResponseParam);
@@ -3188,6 +3739,75 @@ bool UNinjaCharacterMovementComponent::FloorSweepTest(FHitResult& OutHit, const
 	return bBlockingHit;
 }
 
+bool UNinjaCharacterMovementComponent::CanUseAsyncSceneQueries() const
+{
+	return (bUseAsyncSceneQueries && NinjaCharacterMovementCVars::AsyncSceneQueries > 0 &&
+		!bUseFlatBaseForFloorChecks && HasValidData());
+}
+
+bool UNinjaCharacterMovementComponent::AsyncFloorSweepTest(ENinjaAsyncQuery Query, FHitResult& OutHit, const FVector& Start, const FVector& End,
+	ECollisionChannel TraceChannel, const FCollisionShape& CollisionShape, const FCollisionQueryParams& Params, const FCollisionResponseParams& ResponseParam) const
+{
+	if (CanUseAsyncSceneQueries())
+	{
+		UNinjaAsyncQuerySubsystem* AsyncQuerySubsystem = GetWorld()->GetSubsystem<UNinjaAsyncQuerySubsystem>();
+
+		bool bBlockingHit = false;
+		if (AsyncQuerySubsystem != nullptr && AsyncQuerySubsystem->ConsumeSweep(this, Query, Start, End,
+			UpdatedComponent->GetComponentQuat(), CollisionShape, AsyncQueryDistanceTolerance, HotState.ThresholdParallelCosine,
+			OutHit, bBlockingHit))
+		{
+			return bBlockingHit;
+		}
+	}
+
+	return FloorSweepTest(OutHit, Start, End, TraceChannel, CollisionShape, Params, ResponseParam);
+}
+
+void UNinjaCharacterMovementComponent::RequestAsyncSceneQueries(float DeltaTime)
+{
+	UNinjaAsyncQuerySubsystem* AsyncQuerySubsystem = GetWorld()->GetSubsystem<UNinjaAsyncQuerySubsystem>();
+	if (AsyncQuerySubsystem == nullptr)
+	{
+		return;
+	}
+
+	float PawnRadius, PawnHalfHeight;
+	CharacterOwner->GetCapsuleComponent()->GetScaledCapsuleSize(PawnRadius, PawnHalfHeight);
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(RequestAsyncSceneQueries), false, CharacterOwner);
+	FCollisionResponseParams ResponseParam;
+	InitCollisionParams(QueryParams, ResponseParam);
+	const ECollisionChannel CollisionChannel = UpdatedComponent->GetCollisionObjectType();
+
+	const FVector PawnLocation = UpdatedComponent->GetComponentLocation();
+	const FQuat PawnRotation = UpdatedComponent->GetComponentQuat();
+	const FVector DesiredAxisZ = GetComponentDesiredAxisZ();
+	const bool bMovingOnGround = IsMovingOnGround();
+
+	// Penetration check of next capsule rotation around its center, done before moving
+	if (PawnHalfHeight > PawnRadius && (bAlwaysRotateAroundCenter || !bMovingOnGround) &&
+		!FNinjaMath::Coincident(DesiredAxisZ, FNinjaMath::GetAxisZ(PawnRotation), HotState.ThresholdParallelCosine))
+	{
+		AsyncQuerySubsystem->RequestSweep(this, ENinjaAsyncQuery::Rotation, PawnLocation,
+			PawnLocation - DesiredAxisZ * (PawnHalfHeight - PawnRadius), PawnRotation, CollisionChannel,
+			FCollisionShape::MakeSphere(PawnRadius), QueryParams, ResponseParam);
+	}
+
+	// Floor probe of next walking move along predicted capsule 'down' axis; same shape as ComputeFloorDist
+	if (bMovingOnGround)
+	{
+		const float ShrinkHeight = (PawnHalfHeight - PawnRadius) * (1.0f - 0.9f);
+		const float SweepDistance = FMath::Max(MAX_FLOOR_DIST, MaxStepHeight + MAX_FLOOR_DIST + KINDA_SMALL_NUMBER);
+		const FVector PredictedLocation = PawnLocation + Velocity * DeltaTime;
+
+		AsyncQuerySubsystem->RequestSweep(this, ENinjaAsyncQuery::Floor, PredictedLocation,
+			PredictedLocation - DesiredAxisZ * (SweepDistance + ShrinkHeight),
+			FNinjaMath::MakeFromZQuat(DesiredAxisZ, PawnRotation, HotState.ThresholdParallelCosine), CollisionChannel,
+			FCollisionShape::MakeCapsule(PawnRadius, PawnHalfHeight - ShrinkHeight), QueryParams, ResponseParam);
+	}
+}
+
 bool UNinjaCharacterMovementComponent::IsValidLandingSpot(const FVector& CapsuleLocation, const FHitResult& Hit) const
 {
 	if (!Hit.bBlockingHit)
@@ -3336,8 +3956,12 @@ void UNinjaCharacterMovementComponent::OnMovementUpdated(float DeltaSeconds, con
 	UpdateGravity();
 
 	const bool bMovingOnGround = IsMovingOnGround();
-	UpdateComponentRotation(GetComponentDesiredAxisZ(), bAlwaysRotateAroundCenter || !bMovingOnGround,
-		bRotateVelocityOnGround && bMovingOnGround);
+	const FVector DesiredAxisZ = GetComponentDesiredAxisZ();
+	if (ShouldUpdateComponentRotation(DesiredAxisZ))
+	{
+		UpdateComponentRotation(DesiredAxisZ, bAlwaysRotateAroundCenter || !bMovingOnGround,
+			bRotateVelocityOnGround && bMovingOnGround);
+	}
 
 	if (ShouldReplicateGravity())
 	{
@@ -3875,7 +4499,8 @@ void UNinjaCharacterMovementComponent::ServerMoveHandleClientError(float ClientT
 	// Compute the client error from the server's position
 	// If client has accumulated a noticeable positional error, correct them
 	bNetworkLargeClientCorrection = ServerData->bForceClientUpdate;
-	if (ServerData->bForceClientUpdate || ServerCheckClientError(ClientTimeStamp, DeltaTime, Accel, ClientLoc, RelativeClientLoc, ClientMovementBase, ClientBaseBoneName, ClientMovementMode))
+	if (ServerData->bForceClientUpdate || ServerCheckClientError(ClientTimeStamp, DeltaTime, Accel, ClientLoc, RelativeClientLoc, ClientMovementBase, ClientBaseBoneName, ClientMovementMode) ||
+		ServerCheckClientGravityError())
 	{
 		UPrimitiveComponent* MovementBase = CharacterOwner->GetMovementBase();
 		ServerData->PendingAdjustment.NewVel = Velocity;
@@ -3907,6 +4532,11 @@ void UNinjaCharacterMovementComponent::ServerMoveHandleClientError(float ClientT
 		}
 #endif
 
+		if (MovementRecording.IsValid())
+		{
+			RecordCorrection(ClientTimeStamp, ClientLoc, UpdatedComponent->GetComponentLocation());
+		}
+
 		ServerData->LastUpdateTime = GetWorld()->TimeSeconds;
 		ServerData->PendingAdjustment.DeltaTime = DeltaTime;
 		ServerData->PendingAdjustment.TimeStamp = ClientTimeStamp;
@@ -3955,6 +4585,100 @@ void UNinjaCharacterMovementComponent::ServerMoveHandleClientError(float ClientT
 	ServerData->bForceClientUpdate = false;
 }
 
+bool UNinjaCharacterMovementComponent::ServerCheckClientGravityError() const
+{
+	const FNinjaCharacterNetworkMoveData* MoveData = static_cast<const FNinjaCharacterNetworkMoveData*>(GetCurrentNetworkMoveData());
+	if (MoveData == nullptr)
+	{
+		// Move wasn't sent through packed RPCs
+		return false;
+	}
+
+	// Position is validated elsewhere; a capsule that ended the move with a different orientation needs a correction
+	return (MoveData->ComponentAxisZ | GetComponentAxisZ()) < FMath::Cos(FMath::DegreesToRadians(NetworkGravityAngleTolerance));
+}
+
+void UNinjaCharacterMovementComponent::MoveAutonomous(float ClientTimeStamp, float DeltaTime, uint8 CompressedFlags, const FVector& NewAccel)
+{
+	FVector MoveGravityDirection = FVector::ZeroVector;
+
+	const FNinjaCharacterNetworkMoveData* MoveData = static_cast<const FNinjaCharacterNetworkMoveData*>(GetCurrentNetworkMoveData());
+	if (MoveData != nullptr && IsNetworkGravityDirectionAcceptable(MoveData->GravityDirection))
+	{
+		// Gravity settings reach the client later than they are applied on the server; if both gravity directions
+		// are close enough, simulate the move with the client one to avoid a needless correction
+		SetNetworkGravityDirection(MoveData->GravityDirection);
+		MoveGravityDirection = MoveData->GravityDirection;
+	}
+
+	if (MovementRecording.IsValid())
+	{
+		RecordGravityState();
+	}
+
+	Super::MoveAutonomous(ClientTimeStamp, DeltaTime, CompressedFlags, NewAccel);
+
+	ClearNetworkGravityDirection();
+
+	if (MovementRecording.IsValid())
+	{
+		RecordMove(ClientTimeStamp, DeltaTime, CompressedFlags, NewAccel, MoveGravityDirection);
+	}
+}
+
+void UNinjaCharacterMovementComponent::SetNetworkGravityDirection(const FVector& NewGravityDirection)
+{
+	if (GravityScale == 0.0f)
+	{
+		return;
+	}
+
+	bUseNetworkGravityDirection = true;
+	NetworkGravityDirection = NewGravityDirection * ((GravityScale > 0.0f) ? 1.0f : -1.0f);
+	InvalidateGravityCache();
+}
+
+void UNinjaCharacterMovementComponent::ClearNetworkGravityDirection()
+{
+	if (bUseNetworkGravityDirection)
+	{
+		bUseNetworkGravityDirection = false;
+		InvalidateGravityCache();
+	}
+}
+
+bool UNinjaCharacterMovementComponent::IsNetworkGravityDirectionAcceptable(const FVector& MoveGravityDirection) const
+{
+	if (GravityScale == 0.0f || !HasValidData())
+	{
+		return false;
+	}
+
+	return (MoveGravityDirection | GetGravityDirection(true)) >=
+		FMath::Cos(FMath::DegreesToRadians(NetworkGravityAngleTolerance));
+}
+
+bool UNinjaCharacterMovementComponent::ClientUpdatePositionAfterServerUpdate()
+{
+	const bool bResult = Super::ClientUpdatePositionAfterServerUpdate();
+
+	// Replayed moves may have forced their gravity direction
+	ClearNetworkGravityDirection();
+
+	return bResult;
+}
+
+FNetworkPredictionData_Client* UNinjaCharacterMovementComponent::GetPredictionData_Client() const
+{
+	if (ClientPredictionData == nullptr)
+	{
+		UNinjaCharacterMovementComponent* MutableThis = const_cast<UNinjaCharacterMovementComponent*>(this);
+		MutableThis->ClientPredictionData = new FNetworkPredictionData_Client_Ninja(*this);
+	}
+
+	return ClientPredictionData;
+}
+
 void UNinjaCharacterMovementComponent::ClientAdjustPosition_Implementation(float TimeStamp, FVector NewLocation, FVector NewVelocity, UPrimitiveComponent* NewBase, FName NewBaseBoneName, bool bHasBase, bool bBaseRelativePosition, uint8 ServerMovementMode)
 {
 	if (!HasValidData() || !IsActive())
@@ -4019,9 +4743,9 @@ void UNinjaCharacterMovementComponent::ClientAdjustPosition_Implementation(float
 		const FQuat PawnRotation = UpdatedComponent->GetComponentQuat();
 
 		// Don't rotate if angle between new and old capsule 'up' axes almost equals to 0 degrees
-		if (!FNinjaMath::Coincident(DesiredAxisZ, FNinjaMath::GetAxisZ(PawnRotation), ThresholdParallelCosine))
+		if (!FNinjaMath::Coincident(DesiredAxisZ, FNinjaMath::GetAxisZ(PawnRotation), HotState.ThresholdParallelCosine))
 		{
-			const FQuat NewRotation = FNinjaMath::MakeFromZQuat(DesiredAxisZ, PawnRotation, ThresholdParallelCosine);
+			const FQuat NewRotation = FNinjaMath::MakeFromZQuat(DesiredAxisZ, PawnRotation, HotState.ThresholdParallelCosine);
 			UpdatedComponent->SetWorldLocationAndRotation(WorldShiftedNewLocation, NewRotation, false, nullptr, ETeleportType::TeleportPhysics);
 		}
 		else
@@ -4222,6 +4946,15 @@ void UNinjaCharacterMovementComponent::ClientAdjustRootMotionSourcePosition_Impl
 
 void UNinjaCharacterMovementComponent::OnClientCorrectionReceived(FNetworkPredictionData_Client_Character& ClientData, float TimeStamp, FVector NewLocation, FVector NewVelocity, UPrimitiveComponent* NewBase, FName NewBaseBoneName, bool bHasBase, bool bBaseRelativePosition, uint8 ServerMovementMode)
 {
+	// Corrected location isn't a result of fixed time steps
+	ResetFixedTimeStepInterpolation();
+
+	if (MovementRecording.IsValid())
+	{
+		RecordCorrection(TimeStamp, ClientData.LastAckedMove.IsValid() ? ClientData.LastAckedMove->SavedLocation :
+			UpdatedComponent->GetComponentLocation(), NewLocation);
+	}
+
 #if !UE_BUILD_SHIPPING
 	if (NinjaCharacterMovementCVars::NetShowCorrections != 0)
 	{
@@ -4258,6 +4991,215 @@ void UNinjaCharacterMovementComponent::OnClientCorrectionReceived(FNetworkPredic
 #endif
 }
 
+void UNinjaCharacterMovementComponent::StartMovementRecording()
+{
+	if (!HasValidData())
+	{
+		return;
+	}
+
+	MovementRecording = MakeShared<FNinjaMovementRecording>();
+	MovementRecording->CharacterClass = FSoftClassPath(CharacterOwner->GetClass());
+	MovementRecording->NetMode = (uint8)GetNetMode();
+	MovementRecording->StartLocation = UpdatedComponent->GetComponentLocation();
+	MovementRecording->StartRotation = UpdatedComponent->GetComponentRotation();
+	MovementRecording->StartVelocity = Velocity;
+	MovementRecording->StartMovementMode = PackNetworkMovementMode();
+
+	RecordGravityState();
+}
+
+TSharedPtr<FNinjaMovementRecording> UNinjaCharacterMovementComponent::StopMovementRecording()
+{
+	TSharedPtr<FNinjaMovementRecording> Recording = MovementRecording;
+	MovementRecording.Reset();
+
+	return Recording;
+}
+
+void UNinjaCharacterMovementComponent::ReplayMovementRecording(const FNinjaMovementRecording& Recording,
+	float Tolerance, FNinjaMovementReplayReport& OutReport)
+{
+	SCOPE_CYCLE_COUNTER(STAT_NinjaMovementReplay);
+
+	OutReport = FNinjaMovementReplayReport();
+
+	if (!HasValidData() || MovementRecording.IsValid())
+	{
+		return;
+	}
+
+	UpdatedComponent->SetWorldLocationAndRotation(Recording.StartLocation, Recording.StartRotation, false, nullptr,
+		ETeleportType::TeleportPhysics);
+	Velocity = Recording.StartVelocity;
+	ApplyNetworkMovementMode(Recording.StartMovementMode);
+	UpdateFloorFromAdjustment();
+
+	const float ToleranceSquared = FMath::Square(Tolerance);
+	int32 GravityStateIndex = 0;
+
+	for (int32 MoveIndex = 0; MoveIndex < Recording.Moves.Num(); ++MoveIndex)
+	{
+		const FNinjaRecordedMove& Move = Recording.Moves[MoveIndex];
+
+		while (GravityStateIndex < Recording.GravityStates.Num() &&
+			Recording.GravityStates[GravityStateIndex].MoveIndex <= MoveIndex)
+		{
+			FNinjaGravityState NewGravityState;
+			if (!Recording.GravityStates[GravityStateIndex].Resolve(GetWorld(), NewGravityState))
+			{
+				OutReport.NumUnresolvedGravityStates++;
+			}
+
+			ApplyGravityState(NewGravityState);
+			GravityStateIndex++;
+		}
+
+		const double StartTime = FPlatformTime::Seconds();
+
+		if (!Move.GravityDirection.IsZero() && IsNetworkGravityDirectionAcceptable(Move.GravityDirection))
+		{
+			SetNetworkGravityDirection(Move.GravityDirection);
+		}
+
+		MoveAutonomous(Move.TimeStamp, Move.DeltaTime, Move.CompressedFlags, Move.Acceleration);
+
+		OutReport.SimulationTime += (FPlatformTime::Seconds() - StartTime) * 1000.0;
+		OutReport.NumMoves++;
+
+		// Compare with the recorded result
+		const float LocationErrorSquared = (UpdatedComponent->GetComponentLocation() - Move.EndLocation).SizeSquared();
+		const float VelocityErrorSquared = (Velocity - Move.EndVelocity).SizeSquared();
+		OutReport.MaxLocationError = FMath::Max(OutReport.MaxLocationError, FMath::Sqrt(LocationErrorSquared));
+		OutReport.MaxVelocityError = FMath::Max(OutReport.MaxVelocityError, FMath::Sqrt(VelocityErrorSquared));
+
+		if (CurrentFloor.bBlockingHit != Move.bFloorBlockingHit || CurrentFloor.bWalkableFloor != Move.bFloorWalkable)
+		{
+			OutReport.NumFloorMismatches++;
+		}
+
+		if (LocationErrorSquared > ToleranceSquared || VelocityErrorSquared > ToleranceSquared ||
+			!FNinjaMath::Coincident(GetComponentAxisZ(), FNinjaMath::GetAxisZ(Move.EndRotation), HotState.ThresholdParallelCosine))
+		{
+			if (OutReport.NumDivergedMoves == 0)
+			{
+				OutReport.FirstDivergedMove = MoveIndex;
+			}
+
+			OutReport.NumDivergedMoves++;
+
+			// Snap to the recorded result so the next move is compared on its own
+			UpdatedComponent->SetWorldLocationAndRotation(Move.EndLocation, Move.EndRotation, false, nullptr,
+				ETeleportType::TeleportPhysics);
+			Velocity = Move.EndVelocity;
+			ApplyNetworkMovementMode(Move.EndMovementMode);
+			UpdateFloorFromAdjustment();
+		}
+	}
+}
+
+void UNinjaCharacterMovementComponent::RecordSavedMove(const FSavedMove_Ninja& SavedMove) const
+{
+	if (!MovementRecording.IsValid() || !HasValidData())
+	{
+		return;
+	}
+
+	RecordMove(SavedMove.TimeStamp, SavedMove.DeltaTime, SavedMove.GetCompressedFlags(), SavedMove.Acceleration,
+		SavedMove.SavedGravityDirection);
+}
+
+void UNinjaCharacterMovementComponent::DiscardRecordedSavedMove(const FSavedMove_Ninja& SavedMove) const
+{
+	if (!MovementRecording.IsValid())
+	{
+		return;
+	}
+
+	// Combined move is simulated again from the start of the pending move, which is the last recorded one
+	TArray<FNinjaRecordedMove>& Moves = MovementRecording->Moves;
+	if (Moves.Num() > 0 && Moves.Last().TimeStamp == SavedMove.TimeStamp)
+	{
+		Moves.Pop(false);
+
+		for (FNinjaRecordedGravityState& RecordedGravityState : MovementRecording->GravityStates)
+		{
+			RecordedGravityState.MoveIndex = FMath::Min(RecordedGravityState.MoveIndex, Moves.Num());
+		}
+	}
+}
+
+void UNinjaCharacterMovementComponent::RecordGravityState() const
+{
+	if (!MovementRecording.IsValid())
+	{
+		return;
+	}
+
+	FNinjaRecordedGravityState NewGravityState;
+	NewGravityState.MoveIndex = MovementRecording->Moves.Num();
+	NewGravityState.Set(MakeGravityState());
+
+	TArray<FNinjaRecordedGravityState>& GravityStates = MovementRecording->GravityStates;
+	if (GravityStates.Num() > 0)
+	{
+		const FNinjaRecordedGravityState& LastGravityState = GravityStates.Last();
+		if (LastGravityState.Mode == NewGravityState.Mode && LastGravityState.VectorA == NewGravityState.VectorA &&
+			LastGravityState.VectorB == NewGravityState.VectorB && LastGravityState.Scale == NewGravityState.Scale &&
+			LastGravityState.ActorName == NewGravityState.ActorName &&
+			LastGravityState.FieldPath == NewGravityState.FieldPath)
+		{
+			return;
+		}
+
+		if (LastGravityState.MoveIndex == NewGravityState.MoveIndex)
+		{
+			GravityStates.Last() = NewGravityState;
+			return;
+		}
+	}
+
+	GravityStates.Add(NewGravityState);
+}
+
+void UNinjaCharacterMovementComponent::RecordMove(float TimeStamp, float DeltaTime, uint8 CompressedFlags,
+	const FVector& NewAccel, const FVector& MoveGravityDirection) const
+{
+	if (!HasValidData())
+	{
+		return;
+	}
+
+	FNinjaRecordedMove& Move = MovementRecording->Moves.AddDefaulted_GetRef();
+	Move.TimeStamp = TimeStamp;
+	Move.DeltaTime = DeltaTime;
+	Move.CompressedFlags = CompressedFlags;
+	Move.Acceleration = NewAccel;
+	Move.GravityDirection = MoveGravityDirection;
+	Move.EndLocation = UpdatedComponent->GetComponentLocation();
+	Move.EndRotation = UpdatedComponent->GetComponentRotation();
+	Move.EndVelocity = Velocity;
+	Move.EndMovementMode = PackNetworkMovementMode();
+	Move.bFloorBlockingHit = CurrentFloor.bBlockingHit;
+	Move.bFloorWalkable = CurrentFloor.bWalkableFloor;
+
+	if (CurrentFloor.bBlockingHit)
+	{
+		Move.FloorDist = CurrentFloor.FloorDist;
+		Move.FloorNormal = CurrentFloor.HitResult.ImpactNormal;
+	}
+}
+
+void UNinjaCharacterMovementComponent::RecordCorrection(float TimeStamp, const FVector& ClientLocation,
+	const FVector& ServerLocation) const
+{
+	FNinjaRecordedCorrection& Correction = MovementRecording->Corrections.AddDefaulted_GetRef();
+	Correction.TimeStamp = TimeStamp;
+	Correction.MoveIndex = MovementRecording->Moves.Num() - 1;
+	Correction.ClientLocation = ClientLocation;
+	Correction.ServerLocation = ServerLocation;
+}
+
 void UNinjaCharacterMovementComponent::CapsuleTouched(UPrimitiveComponent* OverlappedComp, AActor* Other, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
 {
 	if (!bEnablePhysicsInteraction)
@@ -4500,572 +5442,367 @@ FVector UNinjaCharacterMovementComponent::GetGravity() const
 		return FVector::ZeroVector;
 	}
 
-	FVector Gravity = FVector::ZeroVector;
+	RefreshGravityCache();
 
-	switch (GravityDirectionMode)
-	{
-		case ENinjaGravityDirectionMode::Fixed:
-		{
-			Gravity = GravityVectorA * (FMath::Abs(UPawnMovementComponent::GetGravityZ()) * GravityScale);
-			break;
-		}
+	return HotState.GravityCacheDirection * (HotState.GravityCacheMagnitude * GravityScale);
+}
 
-		case ENinjaGravityDirectionMode::SplineTangent:
-		{
-			if (GravityActor != nullptr && !GravityActor->IsPendingKill())
-			{
-				const USplineComponent* Spline = Cast<USplineComponent>(
-					GravityActor->GetComponentByClass(USplineComponent::StaticClass()));
-				if (Spline != nullptr)
-				{
-					UNinjaCharacterMovementComponent* MutableThis = const_cast<UNinjaCharacterMovementComponent*>(this);
-					MutableThis->GravityVectorA = Spline->FindDirectionClosestToWorldLocation(
-						UpdatedComponent->GetComponentLocation(), ESplineCoordinateSpace::Type::World);
-				}
-			}
-
-			Gravity = GravityVectorA * (FMath::Abs(UPawnMovementComponent::GetGravityZ()) * GravityScale);
-			break;
-		}
-
-		case ENinjaGravityDirectionMode::Point:
-		{
-			if (GravityActor != nullptr && !GravityActor->IsPendingKill())
-			{
-				UNinjaCharacterMovementComponent* MutableThis = const_cast<UNinjaCharacterMovementComponent*>(this);
-				MutableThis->GravityVectorA = GravityActor->GetActorLocation();
-			}
-
-			const FVector GravityDir = GravityVectorA - UpdatedComponent->GetComponentLocation();
-			if (!GravityDir.IsZero())
-			{
-				Gravity = GravityDir.GetSafeNormal() * (FMath::Abs(UPawnMovementComponent::GetGravityZ()) * GravityScale);
-			}
+FVector UNinjaCharacterMovementComponent::GetGravityDirection(bool bAvoidZeroGravity) const
+{
+	if (!HasValidData())
+	{
+		return FVector::DownVector;
+	}
 
-			break;
-		}
+	FVector GravityDir = FVector::ZeroVector;
 
-		case ENinjaGravityDirectionMode::Line:
-		{
-			const FVector GravityDir = FMath::ClosestPointOnInfiniteLine(GravityVectorA,
-				GravityVectorB, UpdatedComponent->GetComponentLocation()) - UpdatedComponent->GetComponentLocation();
-			if (!GravityDir.IsZero())
-			{
-				Gravity = GravityDir.GetSafeNormal() * (FMath::Abs(UPawnMovementComponent::GetGravityZ()) * GravityScale);
-			}
+	// Gravity direction can be influenced by the custom gravity scale value
+	if (GravityScale != 0.0f)
+	{
+		RefreshGravityCache();
 
-			break;
-		}
+		GravityDir = HotState.GravityCacheDirection * ((GravityScale > 0.0f) ? 1.0f : -1.0f);
 
-		case ENinjaGravityDirectionMode::Segment:
+		if (bAvoidZeroGravity && GravityDir.IsZero())
 		{
-			const FVector GravityDir = FMath::ClosestPointOnLine(GravityVectorA,
-				GravityVectorB, UpdatedComponent->GetComponentLocation()) - UpdatedComponent->GetComponentLocation();
-			if (!GravityDir.IsZero())
-			{
-				Gravity = GravityDir.GetSafeNormal() * (FMath::Abs(UPawnMovementComponent::GetGravityZ()) * GravityScale);
-			}
-
-			break;
+			GravityDir = FVector(0.0f, 0.0f,
+				((UPawnMovementComponent::GetGravityZ() > 0.0f) ? 1.0f : -1.0f) * ((GravityScale > 0.0f) ? 1.0f : -1.0f));
 		}
-
-		case ENinjaGravityDirectionMode::Spline:
+	}
+	else
+	{
+		if (bAvoidZeroGravity)
 		{
-			if (GravityActor != nullptr && !GravityActor->IsPendingKill())
-			{
-				const USplineComponent* Spline = Cast<USplineComponent>(
-					GravityActor->GetComponentByClass(USplineComponent::StaticClass()));
-				if (Spline != nullptr)
-				{
-					UNinjaCharacterMovementComponent* MutableThis = const_cast<UNinjaCharacterMovementComponent*>(this);
-					MutableThis->GravityVectorA = Spline->FindLocationClosestToWorldLocation(
-						UpdatedComponent->GetComponentLocation(), ESplineCoordinateSpace::Type::World);
-				}
-			}
-
-			const FVector GravityDir = GravityVectorA - UpdatedComponent->GetComponentLocation();
-			if (!GravityDir.IsZero())
-			{
-				Gravity = GravityDir.GetSafeNormal() * (FMath::Abs(UPawnMovementComponent::GetGravityZ()) * GravityScale);
-			}
+			RefreshGravityCache();
 
-			break;
-		}
+			GravityDir = HotState.GravityCacheDirection;
 
-		case ENinjaGravityDirectionMode::Plane:
-		{
-			const FVector GravityDir = FVector::PointPlaneProject(UpdatedComponent->GetComponentLocation(),
-				GravityVectorA, GravityVectorB) - UpdatedComponent->GetComponentLocation();
-			if (!GravityDir.IsZero())
+			if (GravityDir.IsZero())
 			{
-				Gravity = GravityDir.GetSafeNormal() * (FMath::Abs(UPawnMovementComponent::GetGravityZ()) * GravityScale);
+				GravityDir = FVector(0.0f, 0.0f,
+					((UPawnMovementComponent::GetGravityZ() > 0.0f) ? 1.0f : -1.0f));
 			}
-
-			break;
 		}
+	}
 
-		case ENinjaGravityDirectionMode::SplinePlane:
-		{
-			if (GravityActor != nullptr && !GravityActor->IsPendingKill())
-			{
-				const USplineComponent* Spline = Cast<USplineComponent>(
-					GravityActor->GetComponentByClass(USplineComponent::StaticClass()));
-				if (Spline != nullptr)
-				{
-					const float InputKey = Spline->FindInputKeyClosestToWorldLocation(
-						UpdatedComponent->GetComponentLocation());
-					const FVector ClosestLocation = Spline->GetLocationAtSplineInputKey(
-						InputKey, ESplineCoordinateSpace::Type::World);
-					const FVector ClosestUpVector = Spline->GetUpVectorAtSplineInputKey(
-						InputKey, ESplineCoordinateSpace::Type::World);
+	return GravityDir;
+}
 
-					UNinjaCharacterMovementComponent* MutableThis = const_cast<UNinjaCharacterMovementComponent*>(this);
-					MutableThis->GravityVectorA = FVector::PointPlaneProject(UpdatedComponent->GetComponentLocation(),
-						ClosestLocation, ClosestUpVector);
-					MutableThis->GravityVectorB = ClosestUpVector;
-				}
-			}
+float UNinjaCharacterMovementComponent::GetGravityMagnitude() const
+{
+	return FMath::Abs(GetGravityZ());
+}
 
-			const FVector GravityDir = GravityVectorA - UpdatedComponent->GetComponentLocation();
-			if (!GravityDir.IsZero())
-			{
-				Gravity = GravityDir.GetSafeNormal() * (FMath::Abs(UPawnMovementComponent::GetGravityZ()) * GravityScale);
-			}
+void UNinjaCharacterMovementComponent::UpdateGravityCache()
+{
+	FScopeCycleCounter GravityCycleCounter(NinjaCharacterStats::GetGravityStatId(GravityDirectionMode));
+	NINJA_COUNT_GRAVITY_EVALUATIONS(1);
 
-			break;
-		}
+	const FVector Location = UpdatedComponent->GetComponentLocation();
+	FVector GravityDir = FVector::ZeroVector;
+	float GravityStrength = 1.0f;
 
-		case ENinjaGravityDirectionMode::Box:
+	if (HotState.GravityDirectionFunc != nullptr)
+	{
+		// Geometric modes only need their Actor driven vectors refreshed; cached
+		// ones are used while the Actor is streamed out
+		if ((GravityDirectionMode == ENinjaGravityDirectionMode::Point ||
+			GravityDirectionMode == ENinjaGravityDirectionMode::Box) && GravityActorProxy.IsSet())
 		{
-			if (GravityActor != nullptr && !GravityActor->IsPendingKill())
-			{
-				UNinjaCharacterMovementComponent* MutableThis = const_cast<UNinjaCharacterMovementComponent*>(this);
-				GravityActor->GetActorBounds(true, MutableThis->GravityVectorA, MutableThis->GravityVectorB);
-			}
-
-			const FVector GravityDir = FBox(GravityVectorA - GravityVectorB,
-				GravityVectorA + GravityVectorB).GetClosestPointTo(UpdatedComponent->GetComponentLocation()) -
-				UpdatedComponent->GetComponentLocation();
-			if (!GravityDir.IsZero())
-			{
-				Gravity = GravityDir.GetSafeNormal() * (FMath::Abs(UPawnMovementComponent::GetGravityZ()) * GravityScale);
-			}
+			ResolveGravityActor();
 
-			break;
-		}
-
-		case ENinjaGravityDirectionMode::Collision:
-		{
-			if (GravityActor != nullptr && !GravityActor->IsPendingKill())
+			if (GravityActorProxy.HasCache())
 			{
-				FVector ClosestPoint;
-				if (Cast<UPrimitiveComponent>(GravityActor->GetRootComponent())->GetClosestPointOnCollision(
-					UpdatedComponent->GetComponentLocation(), ClosestPoint) > 0.0f)
+				if (GravityDirectionMode == ENinjaGravityDirectionMode::Point)
 				{
-					UNinjaCharacterMovementComponent* MutableThis = const_cast<UNinjaCharacterMovementComponent*>(this);
-					MutableThis->GravityVectorA = ClosestPoint;
+					GravityVectorA = GravityActorProxy.GetCachedLocation();
+				}
+				else
+				{
+					GravityActorProxy.GetCachedBounds(GravityVectorA, GravityVectorB);
 				}
 			}
-
-			const FVector GravityDir = GravityVectorA - UpdatedComponent->GetComponentLocation();
-			if (!GravityDir.IsZero())
-			{
-				Gravity = GravityDir.GetSafeNormal() * (FMath::Abs(UPawnMovementComponent::GetGravityZ()) * GravityScale);
-			}
-
-			break;
 		}
-	}
-
-	return Gravity;
-}
 
-FVector UNinjaCharacterMovementComponent::GetGravityDirection(bool bAvoidZeroGravity) const
-{
-	if (!HasValidData())
-	{
-		return FVector::DownVector;
+		GravityDir = HotState.GravityDirectionFunc(GravityVectorA, GravityVectorB, Location);
 	}
-
-	FVector GravityDir = FVector::ZeroVector;
-
-	// Gravity direction can be influenced by the custom gravity scale value
-	if (GravityScale != 0.0f)
+	else
 	{
 		switch (GravityDirectionMode)
 		{
-			case ENinjaGravityDirectionMode::Fixed:
-			{
-				GravityDir = GravityVectorA * ((GravityScale > 0.0f) ? 1.0f : -1.0f);
-				break;
-			}
-
 			case ENinjaGravityDirectionMode::SplineTangent:
 			{
-				if (GravityActor != nullptr && !GravityActor->IsPendingKill())
-				{
-					const USplineComponent* Spline = Cast<USplineComponent>(
-						GravityActor->GetComponentByClass(USplineComponent::StaticClass()));
-					if (Spline != nullptr)
-					{
-						UNinjaCharacterMovementComponent* MutableThis = const_cast<UNinjaCharacterMovementComponent*>(this);
-						MutableThis->GravityVectorA = Spline->FindDirectionClosestToWorldLocation(
-							UpdatedComponent->GetComponentLocation(), ESplineCoordinateSpace::Type::World);
-					}
-				}
+				ResolveGravityActor();
 
-				GravityDir = GravityVectorA * ((GravityScale > 0.0f) ? 1.0f : -1.0f);
-				break;
-			}
+				const USplineComponent* Spline = ResolveGravitySpline();
+				const FNinjaGravitySplineSamples* CachedSpline = GravityActorProxy.GetCachedSpline();
+				FVector ClosestLocation, ClosestUpVector;
 
-			case ENinjaGravityDirectionMode::Point:
-			{
-				if (GravityActor != nullptr && !GravityActor->IsPendingKill())
+				if (Spline != nullptr)
 				{
-					UNinjaCharacterMovementComponent* MutableThis = const_cast<UNinjaCharacterMovementComponent*>(this);
-					MutableThis->GravityVectorA = GravityActor->GetActorLocation();
+					GravityVectorA = Spline->GetDirectionAtSplineInputKey(
+						GravitySplineTree.FindInputKeyClosestToWorldLocation(Spline, Location),
+						ESplineCoordinateSpace::Type::World);
 				}
-
-				GravityDir = GravityVectorA - UpdatedComponent->GetComponentLocation();
-				if (!GravityDir.IsZero())
+				else if (CachedSpline != nullptr)
 				{
-					GravityDir = GravityDir.GetSafeNormal() * ((GravityScale > 0.0f) ? 1.0f : -1.0f);
+					CachedSpline->FindClosest(Location, ClosestLocation, GravityVectorA, ClosestUpVector);
 				}
 
+				GravityDir = GravityVectorA;
 				break;
 			}
 
-			case ENinjaGravityDirectionMode::Line:
+			case ENinjaGravityDirectionMode::Spline:
 			{
-				GravityDir = FMath::ClosestPointOnInfiniteLine(GravityVectorA,
-					GravityVectorB, UpdatedComponent->GetComponentLocation()) - UpdatedComponent->GetComponentLocation();
-				if (!GravityDir.IsZero())
-				{
-					GravityDir = GravityDir.GetSafeNormal() * ((GravityScale > 0.0f) ? 1.0f : -1.0f);
-				}
+				ResolveGravityActor();
 
-				break;
-			}
+				const USplineComponent* Spline = ResolveGravitySpline();
+				const FNinjaGravitySplineSamples* CachedSpline = GravityActorProxy.GetCachedSpline();
+				FVector ClosestDirection, ClosestUpVector;
 
-			case ENinjaGravityDirectionMode::Segment:
-			{
-				GravityDir = FMath::ClosestPointOnLine(GravityVectorA,
-					GravityVectorB, UpdatedComponent->GetComponentLocation()) - UpdatedComponent->GetComponentLocation();
-				if (!GravityDir.IsZero())
+				if (Spline != nullptr)
 				{
-					GravityDir = GravityDir.GetSafeNormal() * ((GravityScale > 0.0f) ? 1.0f : -1.0f);
+					GravityVectorA = Spline->GetLocationAtSplineInputKey(
+						GravitySplineTree.FindInputKeyClosestToWorldLocation(Spline, Location),
+						ESplineCoordinateSpace::Type::World);
+				}
+				else if (CachedSpline != nullptr)
+				{
+					CachedSpline->FindClosest(Location, GravityVectorA, ClosestDirection, ClosestUpVector);
 				}
 
+				GravityDir = (GravityVectorA - Location).GetSafeNormal();
 				break;
 			}
 
-			case ENinjaGravityDirectionMode::Spline:
+			case ENinjaGravityDirectionMode::SplinePlane:
 			{
-				if (GravityActor != nullptr && !GravityActor->IsPendingKill())
-				{
-					const USplineComponent* Spline = Cast<USplineComponent>(
-						GravityActor->GetComponentByClass(USplineComponent::StaticClass()));
-					if (Spline != nullptr)
-					{
-						UNinjaCharacterMovementComponent* MutableThis = const_cast<UNinjaCharacterMovementComponent*>(this);
-						MutableThis->GravityVectorA = Spline->FindLocationClosestToWorldLocation(
-							UpdatedComponent->GetComponentLocation(), ESplineCoordinateSpace::Type::World);
-					}
-				}
+				ResolveGravityActor();
 
-				GravityDir = GravityVectorA - UpdatedComponent->GetComponentLocation();
-				if (!GravityDir.IsZero())
-				{
-					GravityDir = GravityDir.GetSafeNormal() * ((GravityScale > 0.0f) ? 1.0f : -1.0f);
-				}
+				const USplineComponent* Spline = ResolveGravitySpline();
+				const FNinjaGravitySplineSamples* CachedSpline = GravityActorProxy.GetCachedSpline();
+				FVector ClosestLocation, ClosestDirection, ClosestUpVector;
 
-				break;
-			}
+				if (Spline != nullptr)
+				{
+					const float InputKey = GravitySplineTree.FindInputKeyClosestToWorldLocation(Spline, Location);
+					ClosestLocation = Spline->GetLocationAtSplineInputKey(
+						InputKey, ESplineCoordinateSpace::Type::World);
+					ClosestUpVector = Spline->GetUpVectorAtSplineInputKey(
+						InputKey, ESplineCoordinateSpace::Type::World);
 
-			case ENinjaGravityDirectionMode::Plane:
-			{
-				GravityDir = FVector::PointPlaneProject(UpdatedComponent->GetComponentLocation(),
-					GravityVectorA, GravityVectorB) - UpdatedComponent->GetComponentLocation();
-				if (!GravityDir.IsZero())
+					GravityVectorA = FVector::PointPlaneProject(Location, ClosestLocation, ClosestUpVector);
+					GravityVectorB = ClosestUpVector;
+				}
+				else if (CachedSpline != nullptr &&
+					CachedSpline->FindClosest(Location, ClosestLocation, ClosestDirection, ClosestUpVector))
 				{
-					GravityDir = GravityDir.GetSafeNormal() * ((GravityScale > 0.0f) ? 1.0f : -1.0f);
+					GravityVectorA = FVector::PointPlaneProject(Location, ClosestLocation, ClosestUpVector);
+					GravityVectorB = ClosestUpVector;
 				}
 
+				GravityDir = (GravityVectorA - Location).GetSafeNormal();
 				break;
 			}
 
-			case ENinjaGravityDirectionMode::SplinePlane:
+			case ENinjaGravityDirectionMode::Collision:
 			{
-				if (GravityActor != nullptr && !GravityActor->IsPendingKill())
+				const AActor* SourceActor = ResolveGravityActor();
+				if (SourceActor != nullptr)
 				{
-					const USplineComponent* Spline = Cast<USplineComponent>(
-						GravityActor->GetComponentByClass(USplineComponent::StaticClass()));
-					if (Spline != nullptr)
+					FVector ClosestPoint;
+					if (Cast<UPrimitiveComponent>(SourceActor->GetRootComponent())->GetClosestPointOnCollision(
+						Location, ClosestPoint) > 0.0f)
 					{
-						const float InputKey = Spline->FindInputKeyClosestToWorldLocation(
-							UpdatedComponent->GetComponentLocation());
-						const FVector ClosestLocation = Spline->GetLocationAtSplineInputKey(
-							InputKey, ESplineCoordinateSpace::Type::World);
-						const FVector ClosestUpVector = Spline->GetUpVectorAtSplineInputKey(
-							InputKey, ESplineCoordinateSpace::Type::World);
-
-						UNinjaCharacterMovementComponent* MutableThis = const_cast<UNinjaCharacterMovementComponent*>(this);
-						MutableThis->GravityVectorA = FVector::PointPlaneProject(UpdatedComponent->GetComponentLocation(),
-							ClosestLocation, ClosestUpVector);
-						MutableThis->GravityVectorB = ClosestUpVector;
+						GravityVectorA = ClosestPoint;
 					}
 				}
-
-				GravityDir = GravityVectorA - UpdatedComponent->GetComponentLocation();
-				if (!GravityDir.IsZero())
+				else if (GravityActorProxy.HasCache())
 				{
-					GravityDir = GravityDir.GetSafeNormal() * ((GravityScale > 0.0f) ? 1.0f : -1.0f);
+					// Collision geometry is streamed out, approximate it with its last bounds
+					FVector BoundsOrigin, BoundsExtent;
+					GravityActorProxy.GetCachedBounds(BoundsOrigin, BoundsExtent);
+					GravityVectorA = FBox(BoundsOrigin - BoundsExtent, BoundsOrigin + BoundsExtent).GetClosestPointTo(Location);
 				}
 
+				GravityDir = (GravityVectorA - Location).GetSafeNormal();
 				break;
 			}
 
-			case ENinjaGravityDirectionMode::Box:
+			case ENinjaGravityDirectionMode::Baked:
 			{
-				if (GravityActor != nullptr && !GravityActor->IsPendingKill())
-				{
-					UNinjaCharacterMovementComponent* MutableThis = const_cast<UNinjaCharacterMovementComponent*>(this);
-					GravityActor->GetActorBounds(true, MutableThis->GravityVectorA, MutableThis->GravityVectorB);
-				}
-
-				GravityDir = FBox(GravityVectorA - GravityVectorB, GravityVectorA + GravityVectorB).GetClosestPointTo(
-					UpdatedComponent->GetComponentLocation()) - UpdatedComponent->GetComponentLocation();
-				if (!GravityDir.IsZero())
+				if (GravityField != nullptr)
 				{
-					GravityDir = GravityDir.GetSafeNormal() * ((GravityScale > 0.0f) ? 1.0f : -1.0f);
+					// Baked samples also store relative strength of gravity
+					const FVector BakedGravity = GravityField->SampleGravity(Location);
+					GravityStrength = BakedGravity.Size();
+					GravityDir = (GravityStrength > KINDA_SMALL_NUMBER) ? BakedGravity / GravityStrength : FVector::ZeroVector;
 				}
 
 				break;
 			}
 
-			case ENinjaGravityDirectionMode::Collision:
+			case ENinjaGravityDirectionMode::Field:
 			{
-				if (GravityActor != nullptr && !GravityActor->IsPendingKill())
-				{
-					FVector ClosestPoint;
-					if (Cast<UPrimitiveComponent>(GravityActor->GetRootComponent())->GetClosestPointOnCollision(
-						UpdatedComponent->GetComponentLocation(), ClosestPoint) > 0.0f)
-					{
-						UNinjaCharacterMovementComponent* MutableThis = const_cast<UNinjaCharacterMovementComponent*>(this);
-						MutableThis->GravityVectorA = ClosestPoint;
-					}
-				}
-
-				GravityDir = GravityVectorA - UpdatedComponent->GetComponentLocation();
-				if (!GravityDir.IsZero())
+				const UNinjaGravityRegistrySubsystem* GravityRegistry = GetWorld()->GetSubsystem<UNinjaGravityRegistrySubsystem>();
+				if (GravityRegistry != nullptr)
 				{
-					GravityDir = GravityDir.GetSafeNormal() * ((GravityScale > 0.0f) ? 1.0f : -1.0f);
+					// Blended sources also provide relative strength of gravity
+					const FVector FieldGravity = GravityRegistry->GetFieldGravity(Location);
+					GravityStrength = FieldGravity.Size();
+					GravityDir = (GravityStrength > KINDA_SMALL_NUMBER) ? FieldGravity / GravityStrength : FVector::ZeroVector;
 				}
 
 				break;
 			}
 		}
-
-		if (bAvoidZeroGravity && GravityDir.IsZero())
-		{
-			GravityDir = FVector(0.0f, 0.0f,
-				((UPawnMovementComponent::GetGravityZ() > 0.0f) ? 1.0f : -1.0f) * ((GravityScale > 0.0f) ? 1.0f : -1.0f));
-		}
 	}
-	else
-	{
-		if (bAvoidZeroGravity)
-		{
-			switch (GravityDirectionMode)
-			{
-				case ENinjaGravityDirectionMode::Fixed:
-				{
-					GravityDir = GravityVectorA;
-					break;
-				}
 
-				case ENinjaGravityDirectionMode::SplineTangent:
-				{
-					if (GravityActor != nullptr && !GravityActor->IsPendingKill())
-					{
-						const USplineComponent* Spline = Cast<USplineComponent>(
-							GravityActor->GetComponentByClass(USplineComponent::StaticClass()));
-						if (Spline != nullptr)
-						{
-							UNinjaCharacterMovementComponent* MutableThis = const_cast<UNinjaCharacterMovementComponent*>(this);
-							MutableThis->GravityVectorA = Spline->FindDirectionClosestToWorldLocation(
-								UpdatedComponent->GetComponentLocation(), ESplineCoordinateSpace::Type::World);
-						}
-					}
-
-					GravityDir = GravityVectorA;
-					break;
-				}
+	if (bUseNetworkGravityDirection)
+	{
+		// Server is processing a client move that was made with this gravity direction
+		GravityDir = NetworkGravityDirection;
+	}
 
-				case ENinjaGravityDirectionMode::Point:
-				{
-					if (GravityActor != nullptr && !GravityActor->IsPendingKill())
-					{
-						UNinjaCharacterMovementComponent* MutableThis = const_cast<UNinjaCharacterMovementComponent*>(this);
-						MutableThis->GravityVectorA = GravityActor->GetActorLocation();
-					}
+	HotState.bGravityCacheValid = true;
+	HotState.GravityCacheFrame = GFrameCounter;
+	HotState.GravityCacheLocation = Location;
+	HotState.GravityCacheDirection = GravityDir;
+	HotState.GravityCacheMagnitude = FMath::Abs(GetVolumeGravityZ()) * GravityStrength;
+}
 
-					GravityDir = GravityVectorA - UpdatedComponent->GetComponentLocation();
-					if (!GravityDir.IsZero())
-					{
-						GravityDir = GravityDir.GetSafeNormal();
-					}
+float UNinjaCharacterMovementComponent::GetVolumeGravityZ() const
+{
+	return (HotState.GroupVolumeGravityFrame == GFrameCounter) ? HotState.GroupVolumeGravityZ : UPawnMovementComponent::GetGravityZ();
+}
 
-					break;
-				}
+void UNinjaCharacterMovementComponent::SetGroupVolumeGravityZ(float NewVolumeGravityZ)
+{
+	HotState.GroupVolumeGravityZ = NewVolumeGravityZ;
+	HotState.GroupVolumeGravityFrame = GFrameCounter;
+}
 
-				case ENinjaGravityDirectionMode::Line:
-				{
-					GravityDir = FMath::ClosestPointOnInfiniteLine(GravityVectorA,
-						GravityVectorB, UpdatedComponent->GetComponentLocation()) -
-						UpdatedComponent->GetComponentLocation();
-					if (!GravityDir.IsZero())
-					{
-						GravityDir = GravityDir.GetSafeNormal();
-					}
+void UNinjaCharacterMovementComponent::PublishGravitySnapshot()
+{
+	// Evaluation updates GravityVectorA and GravityVectorB of Actor driven modes
+	const FVector GravityDir = GetGravityDirection();
 
-					break;
-				}
+	FNinjaGravitySnapshot* NewSnapshot = GravitySnapshotBuffer.BeginWrite();
+	if (NewSnapshot == nullptr)
+	{
+		// Every other slot is being read, readers keep the previous snapshot
+		return;
+	}
 
-				case ENinjaGravityDirectionMode::Segment:
-				{
-					GravityDir = FMath::ClosestPointOnLine(GravityVectorA,
-						GravityVectorB, UpdatedComponent->GetComponentLocation()) -
-						UpdatedComponent->GetComponentLocation();
-					if (!GravityDir.IsZero())
-					{
-						GravityDir = GravityDir.GetSafeNormal();
-					}
+	const FNinjaGravitySnapshotPtr PreviousSnapshot = GravitySnapshotBuffer.Read();
+	FNinjaGravitySnapshot& Snapshot = *NewSnapshot;
 
-					break;
-				}
+	Snapshot.Mode = GravityDirectionMode;
+	Snapshot.DirectionFunc = HotState.GravityDirectionFunc;
+	Snapshot.VectorA = GravityVectorA;
+	Snapshot.VectorB = GravityVectorB;
+	Snapshot.Scale = GravityScale;
+	Snapshot.Magnitude = FMath::Abs(GetVolumeGravityZ());
+	Snapshot.EngineGravityZ = GetVolumeGravityZ();
+	Snapshot.Direction = GravityDir;
+	Snapshot.Transform = UpdatedComponent->GetComponentTransform();
+	Snapshot.Frame = GFrameCounter;
 
-				case ENinjaGravityDirectionMode::Spline:
-				{
-					if (GravityActor != nullptr && !GravityActor->IsPendingKill())
-					{
-						const USplineComponent* Spline = Cast<USplineComponent>(
-							GravityActor->GetComponentByClass(USplineComponent::StaticClass()));
-						if (Spline != nullptr)
-						{
-							UNinjaCharacterMovementComponent* MutableThis = const_cast<UNinjaCharacterMovementComponent*>(this);
-							MutableThis->GravityVectorA = Spline->FindLocationClosestToWorldLocation(
-								UpdatedComponent->GetComponentLocation(), ESplineCoordinateSpace::Type::World);
-						}
-					}
+	const bool bSplineMode = (GravityDirectionMode == ENinjaGravityDirectionMode::SplineTangent ||
+		GravityDirectionMode == ENinjaGravityDirectionMode::Spline ||
+		GravityDirectionMode == ENinjaGravityDirectionMode::SplinePlane);
+	Snapshot.Spline = FNinjaGravitySplineSamples::Sample(bSplineMode ? ResolveGravitySpline() : nullptr,
+		PreviousSnapshot.IsValid() ? PreviousSnapshot->Spline : nullptr);
 
-					GravityDir = GravityVectorA - UpdatedComponent->GetComponentLocation();
-					if (!GravityDir.IsZero())
-					{
-						GravityDir = GravityDir.GetSafeNormal();
-					}
+	if (GravityDirectionMode == ENinjaGravityDirectionMode::Baked && GravityField != nullptr)
+	{
+		Snapshot.FieldBounds = GravityField->GetBounds();
+		Snapshot.FieldDimensions = GravityField->GetDimensions();
+		Snapshot.FieldSamples = GravityField->GetSharedSamples();
+	}
+	else
+	{
+		Snapshot.FieldSamples.Reset();
+	}
 
-					break;
-				}
+	GravitySnapshotBuffer.Publish();
+}
 
-				case ENinjaGravityDirectionMode::Plane:
-				{
-					GravityDir = FVector::PointPlaneProject(UpdatedComponent->GetComponentLocation(),
-						GravityVectorA, GravityVectorB) - UpdatedComponent->GetComponentLocation();
-					if (!GravityDir.IsZero())
-					{
-						GravityDir = GravityDir.GetSafeNormal();
-					}
+bool UNinjaCharacterMovementComponent::IsGravityCacheValid() const
+{
+	if (!HotState.bGravityCacheValid)
+	{
+		return false;
+	}
 
-					break;
-				}
+	// Far simulated proxies might reuse last gravity evaluation
+	const FNinjaSimulatedMovementLOD* SimulatedLOD = GetSimulatedMovementLOD();
+	if (SimulatedLOD != nullptr && SimulatedLOD->bFreezeGravity)
+	{
+		return true;
+	}
 
-				case ENinjaGravityDirectionMode::SplinePlane:
-				{
-					if (GravityActor != nullptr && !GravityActor->IsPendingKill())
-					{
-						const USplineComponent* Spline = Cast<USplineComponent>(
-							GravityActor->GetComponentByClass(USplineComponent::StaticClass()));
-						if (Spline != nullptr)
-						{
-							const float InputKey = Spline->FindInputKeyClosestToWorldLocation(
-								UpdatedComponent->GetComponentLocation());
-							const FVector ClosestLocation = Spline->GetLocationAtSplineInputKey(
-								InputKey, ESplineCoordinateSpace::Type::World);
-							const FVector ClosestUpVector = Spline->GetUpVectorAtSplineInputKey(
-								InputKey, ESplineCoordinateSpace::Type::World);
-
-							UNinjaCharacterMovementComponent* MutableThis = const_cast<UNinjaCharacterMovementComponent*>(this);
-							MutableThis->GravityVectorA = FVector::PointPlaneProject(UpdatedComponent->GetComponentLocation(),
-								ClosestLocation, ClosestUpVector);
-							MutableThis->GravityVectorB = ClosestUpVector;
-						}
-					}
+	return (HotState.GravityCacheFrame == GFrameCounter && HotState.GravityCacheLocation == UpdatedComponent->GetComponentLocation());
+}
 
-					GravityDir = GravityVectorA - UpdatedComponent->GetComponentLocation();
-					if (!GravityDir.IsZero())
-					{
-						GravityDir = GravityDir.GetSafeNormal();
-					}
+void UNinjaCharacterMovementComponent::RefreshGravityCache() const
+{
+	if (!IsGravityCacheValid())
+	{
+		// Gravity evaluation is the only place that stores intermediate data in GravityVectorA/B
+		UNinjaCharacterMovementComponent* MutableThis = const_cast<UNinjaCharacterMovementComponent*>(this);
+		MutableThis->UpdateGravityCache();
+	}
+}
 
-					break;
-				}
+void UNinjaCharacterMovementComponent::InvalidateGravityCache()
+{
+	HotState.bGravityCacheValid = false;
+}
 
-				case ENinjaGravityDirectionMode::Box:
-				{
-					if (GravityActor != nullptr && !GravityActor->IsPendingKill())
-					{
-						UNinjaCharacterMovementComponent* MutableThis = const_cast<UNinjaCharacterMovementComponent*>(this);
-						GravityActor->GetActorBounds(true, MutableThis->GravityVectorA, MutableThis->GravityVectorB);
-					}
+const USplineComponent* UNinjaCharacterMovementComponent::ResolveGravitySpline()
+{
+	if (GravityActor == nullptr || GravityActor->IsPendingKill())
+	{
+		return nullptr;
+	}
 
-					GravityDir = FBox(GravityVectorA - GravityVectorB, GravityVectorA + GravityVectorB).GetClosestPointTo(
-						UpdatedComponent->GetComponentLocation()) - UpdatedComponent->GetComponentLocation();
-					if (!GravityDir.IsZero())
-					{
-						GravityDir = GravityDir.GetSafeNormal();
-					}
+	if (GravitySpline == nullptr || GravitySpline->IsPendingKill() || GravitySpline->GetOwner() != GravityActor)
+	{
+		GravitySpline = Cast<USplineComponent>(GravityActor->GetComponentByClass(USplineComponent::StaticClass()));
+	}
 
-					break;
-				}
+	if (GravitySpline != nullptr && !GravitySplineTree.IsBuiltFor(GravitySpline))
+	{
+		// Spline changed, rebuild its acceleration structure
+		GravitySplineTree.Build(GravitySpline);
+	}
 
-				case ENinjaGravityDirectionMode::Collision:
-				{
-					if (GravityActor != nullptr && !GravityActor->IsPendingKill())
-					{
-						FVector ClosestPoint;
-						if (Cast<UPrimitiveComponent>(GravityActor->GetRootComponent())->GetClosestPointOnCollision(
-							UpdatedComponent->GetComponentLocation(), ClosestPoint) > 0.0f)
-						{
-							UNinjaCharacterMovementComponent* MutableThis = const_cast<UNinjaCharacterMovementComponent*>(this);
-							MutableThis->GravityVectorA = ClosestPoint;
-						}
-					}
+	// Keep sampled spline ready in case the Actor streams out
+	GravityActorProxy.RefreshSpline(GravitySpline);
 
-					GravityDir = GravityVectorA - UpdatedComponent->GetComponentLocation();
-					if (!GravityDir.IsZero())
-					{
-						GravityDir = GravityDir.GetSafeNormal();
-					}
+	return GravitySpline;
+}
 
-					break;
-				}
-			}
+AActor* UNinjaCharacterMovementComponent::ResolveGravityActor()
+{
+	AActor* SourceActor = GravityActorProxy.Get();
+	if (SourceActor == nullptr)
+	{
+		return nullptr;
+	}
 
-			if (GravityDir.IsZero())
-			{
-				GravityDir = FVector(0.0f, 0.0f,
-					((UPawnMovementComponent::GetGravityZ() > 0.0f) ? 1.0f : -1.0f));
-			}
-		}
+	if (SourceActor != GravityActor)
+	{
+		// Level of the Actor was streamed back in
+		GravityActor = SourceActor;
+		GravitySpline = nullptr;
 	}
 
-	return GravityDir;
-}
+	GravityActorProxy.Refresh(GravityDirectionMode);
 
-float UNinjaCharacterMovementComponent::GetGravityMagnitude() const
-{
-	return FMath::Abs(GetGravityZ());
+	return SourceActor;
 }
 
 void UNinjaCharacterMovementComponent::K2_SetFixedGravityDirection(const FVector& NewGravityDirection)
@@ -5084,23 +5821,7 @@ void UNinjaCharacterMovementComponent::SetFixedGravityDirection(const FVector& N
 
 	const ENinjaGravityDirectionMode OldGravityDirectionMode = GravityDirectionMode;
 
-	bDirtyGravityDirection = true;
-	GravityDirectionMode = ENinjaGravityDirectionMode::Fixed;
-	GravityVectorA = NewFixedGravityDirection;
-
-	GravityDirectionChanged(OldGravityDirectionMode);
-}
-
-void UNinjaCharacterMovementComponent::MulticastSetFixedGravityDirection_Implementation(const FVector& NewFixedGravityDirection)
-{
-	if (GravityDirectionMode == ENinjaGravityDirectionMode::Fixed &&
-		GravityVectorA == NewFixedGravityDirection)
-	{
-		return;
-	}
-
-	const ENinjaGravityDirectionMode OldGravityDirectionMode = GravityDirectionMode;
-
+	HotState.bDirtyGravityDirection = true;
 	GravityDirectionMode = ENinjaGravityDirectionMode::Fixed;
 	GravityVectorA = NewFixedGravityDirection;
 
@@ -5116,36 +5837,22 @@ void UNinjaCharacterMovementComponent::SetSplineTangentGravityDirection(AActor*
 		return;
 	}
 
-	const USplineComponent* Spline = Cast<USplineComponent>(
+	USplineComponent* Spline = Cast<USplineComponent>(
 		NewGravityActor->GetComponentByClass(USplineComponent::StaticClass()));
 	if (Spline != nullptr)
 	{
 		const ENinjaGravityDirectionMode OldGravityDirectionMode = GravityDirectionMode;
 
-		bDirtyGravityDirection = true;
+		HotState.bDirtyGravityDirection = true;
 		GravityDirectionMode = ENinjaGravityDirectionMode::SplineTangent;
 		GravityActor = NewGravityActor;
+		GravityActorProxy.Set(NewGravityActor, GravityDirectionMode);
+		GravitySpline = Spline;
 
 		GravityDirectionChanged(OldGravityDirectionMode);
 	}
 }
 
-void UNinjaCharacterMovementComponent::MulticastSetSplineTangentGravityDirection_Implementation(AActor* NewGravityActor)
-{
-	if (GravityDirectionMode == ENinjaGravityDirectionMode::SplineTangent &&
-		GravityActor == NewGravityActor)
-	{
-		return;
-	}
-
-	const ENinjaGravityDirectionMode OldGravityDirectionMode = GravityDirectionMode;
-
-	GravityDirectionMode = ENinjaGravityDirectionMode::SplineTangent;
-	GravityActor = NewGravityActor;
-
-	GravityDirectionChanged(OldGravityDirectionMode);
-}
-
 void UNinjaCharacterMovementComponent::SetPointGravityDirection(const FVector& NewGravityPoint)
 {
 	if (GravityDirectionMode == ENinjaGravityDirectionMode::Point &&
@@ -5156,93 +5863,45 @@ void UNinjaCharacterMovementComponent::SetPointGravityDirection(const FVector& N
 
 	const ENinjaGravityDirectionMode OldGravityDirectionMode = GravityDirectionMode;
 
-	bDirtyGravityDirection = true;
+	HotState.bDirtyGravityDirection = true;
 	GravityDirectionMode = ENinjaGravityDirectionMode::Point;
 	GravityVectorA = NewGravityPoint;
 	GravityActor = nullptr;
+	GravityActorProxy.Reset();
 
 	GravityDirectionChanged(OldGravityDirectionMode);
 }
 
 void UNinjaCharacterMovementComponent::SetPointGravityDirectionFromActor(AActor* NewGravityActor)
 {
-	if (GravityDirectionMode == ENinjaGravityDirectionMode::Point &&
-		GravityActor == NewGravityActor)
-	{
-		return;
-	}
-
-	const ENinjaGravityDirectionMode OldGravityDirectionMode = GravityDirectionMode;
-
-	bDirtyGravityDirection = true;
-	GravityDirectionMode = ENinjaGravityDirectionMode::Point;
-	GravityActor = NewGravityActor;
-
-	GravityDirectionChanged(OldGravityDirectionMode);
-}
-
-void UNinjaCharacterMovementComponent::MulticastSetPointGravityDirection_Implementation(const FVector& NewGravityPoint)
-{
-	if (GravityDirectionMode == ENinjaGravityDirectionMode::Point &&
-		GravityVectorA == NewGravityPoint)
-	{
-		return;
-	}
-
-	const ENinjaGravityDirectionMode OldGravityDirectionMode = GravityDirectionMode;
-
-	GravityDirectionMode = ENinjaGravityDirectionMode::Point;
-	GravityVectorA = NewGravityPoint;
-	GravityActor = nullptr;
-
-	GravityDirectionChanged(OldGravityDirectionMode);
-}
-
-void UNinjaCharacterMovementComponent::MulticastSetPointGravityDirectionFromActor_Implementation(AActor* NewGravityActor)
-{
-	if (GravityDirectionMode == ENinjaGravityDirectionMode::Point &&
-		GravityActor == NewGravityActor)
-	{
-		return;
-	}
-
-	const ENinjaGravityDirectionMode OldGravityDirectionMode = GravityDirectionMode;
-
-	GravityDirectionMode = ENinjaGravityDirectionMode::Point;
-	GravityActor = NewGravityActor;
-
-	GravityDirectionChanged(OldGravityDirectionMode);
-}
-
-void UNinjaCharacterMovementComponent::SetLineGravityDirection(const FVector& NewGravityLineStart, const FVector& NewGravityLineEnd)
-{
-	if (NewGravityLineStart == NewGravityLineEnd ||
-		(GravityDirectionMode == ENinjaGravityDirectionMode::Line &&
-		GravityVectorA == NewGravityLineStart && GravityVectorB == NewGravityLineEnd))
+	if (GravityDirectionMode == ENinjaGravityDirectionMode::Point &&
+		GravityActor == NewGravityActor)
 	{
 		return;
 	}
 
 	const ENinjaGravityDirectionMode OldGravityDirectionMode = GravityDirectionMode;
 
-	bDirtyGravityDirection = true;
-	GravityDirectionMode = ENinjaGravityDirectionMode::Line;
-	GravityVectorA = NewGravityLineStart;
-	GravityVectorB = NewGravityLineEnd;
+	HotState.bDirtyGravityDirection = true;
+	GravityDirectionMode = ENinjaGravityDirectionMode::Point;
+	GravityActor = NewGravityActor;
+	GravityActorProxy.Set(NewGravityActor, GravityDirectionMode);
 
 	GravityDirectionChanged(OldGravityDirectionMode);
 }
 
-void UNinjaCharacterMovementComponent::MulticastSetLineGravityDirection_Implementation(const FVector& NewGravityLineStart, const FVector& NewGravityLineEnd)
+void UNinjaCharacterMovementComponent::SetLineGravityDirection(const FVector& NewGravityLineStart, const FVector& NewGravityLineEnd)
 {
-	if (GravityDirectionMode == ENinjaGravityDirectionMode::Line &&
-		GravityVectorA == NewGravityLineStart && GravityVectorB == NewGravityLineEnd)
+	if (NewGravityLineStart == NewGravityLineEnd ||
+		(GravityDirectionMode == ENinjaGravityDirectionMode::Line &&
+		GravityVectorA == NewGravityLineStart && GravityVectorB == NewGravityLineEnd))
 	{
 		return;
 	}
 
 	const ENinjaGravityDirectionMode OldGravityDirectionMode = GravityDirectionMode;
 
+	HotState.bDirtyGravityDirection = true;
 	GravityDirectionMode = ENinjaGravityDirectionMode::Line;
 	GravityVectorA = NewGravityLineStart;
 	GravityVectorB = NewGravityLineEnd;
@@ -5261,24 +5920,7 @@ void UNinjaCharacterMovementComponent::SetSegmentGravityDirection(const FVector&
 
 	const ENinjaGravityDirectionMode OldGravityDirectionMode = GravityDirectionMode;
 
-	bDirtyGravityDirection = true;
-	GravityDirectionMode = ENinjaGravityDirectionMode::Segment;
-	GravityVectorA = NewGravitySegmentStart;
-	GravityVectorB = NewGravitySegmentEnd;
-
-	GravityDirectionChanged(OldGravityDirectionMode);
-}
-
-void UNinjaCharacterMovementComponent::MulticastSetSegmentGravityDirection_Implementation(const FVector& NewGravitySegmentStart, const FVector& NewGravitySegmentEnd)
-{
-	if (GravityDirectionMode == ENinjaGravityDirectionMode::Segment &&
-		GravityVectorA == NewGravitySegmentStart && GravityVectorB == NewGravitySegmentEnd)
-	{
-		return;
-	}
-
-	const ENinjaGravityDirectionMode OldGravityDirectionMode = GravityDirectionMode;
-
+	HotState.bDirtyGravityDirection = true;
 	GravityDirectionMode = ENinjaGravityDirectionMode::Segment;
 	GravityVectorA = NewGravitySegmentStart;
 	GravityVectorB = NewGravitySegmentEnd;
@@ -5295,36 +5937,22 @@ void UNinjaCharacterMovementComponent::SetSplineGravityDirection(AActor* NewGrav
 		return;
 	}
 
-	const USplineComponent* Spline = Cast<USplineComponent>(
+	USplineComponent* Spline = Cast<USplineComponent>(
 		NewGravityActor->GetComponentByClass(USplineComponent::StaticClass()));
 	if (Spline != nullptr)
 	{
 		const ENinjaGravityDirectionMode OldGravityDirectionMode = GravityDirectionMode;
 
-		bDirtyGravityDirection = true;
+		HotState.bDirtyGravityDirection = true;
 		GravityDirectionMode = ENinjaGravityDirectionMode::Spline;
 		GravityActor = NewGravityActor;
+		GravityActorProxy.Set(NewGravityActor, GravityDirectionMode);
+		GravitySpline = Spline;
 
 		GravityDirectionChanged(OldGravityDirectionMode);
 	}
 }
 
-void UNinjaCharacterMovementComponent::MulticastSetSplineGravityDirection_Implementation(AActor* NewGravityActor)
-{
-	if (GravityDirectionMode == ENinjaGravityDirectionMode::Spline &&
-		GravityActor == NewGravityActor)
-	{
-		return;
-	}
-
-	const ENinjaGravityDirectionMode OldGravityDirectionMode = GravityDirectionMode;
-
-	GravityDirectionMode = ENinjaGravityDirectionMode::Spline;
-	GravityActor = NewGravityActor;
-
-	GravityDirectionChanged(OldGravityDirectionMode);
-}
-
 void UNinjaCharacterMovementComponent::K2_SetPlaneGravityDirection(const FVector& NewGravityPlaneBase, const FVector& NewGravityPlaneNormal)
 {
 	SetPlaneGravityDirection(NewGravityPlaneBase, NewGravityPlaneNormal.GetSafeNormal());
@@ -5341,24 +5969,7 @@ void UNinjaCharacterMovementComponent::SetPlaneGravityDirection(const FVector& N
 
 	const ENinjaGravityDirectionMode OldGravityDirectionMode = GravityDirectionMode;
 
-	bDirtyGravityDirection = true;
-	GravityDirectionMode = ENinjaGravityDirectionMode::Plane;
-	GravityVectorA = NewGravityPlaneBase;
-	GravityVectorB = NewGravityPlaneNormal;
-
-	GravityDirectionChanged(OldGravityDirectionMode);
-}
-
-void UNinjaCharacterMovementComponent::MulticastSetPlaneGravityDirection_Implementation(const FVector& NewGravityPlaneBase, const FVector& NewGravityPlaneNormal)
-{
-	if (GravityDirectionMode == ENinjaGravityDirectionMode::Plane &&
-		GravityVectorA == NewGravityPlaneBase && GravityVectorB == NewGravityPlaneNormal)
-	{
-		return;
-	}
-
-	const ENinjaGravityDirectionMode OldGravityDirectionMode = GravityDirectionMode;
-
+	HotState.bDirtyGravityDirection = true;
 	GravityDirectionMode = ENinjaGravityDirectionMode::Plane;
 	GravityVectorA = NewGravityPlaneBase;
 	GravityVectorB = NewGravityPlaneNormal;
@@ -5375,36 +5986,22 @@ void UNinjaCharacterMovementComponent::SetSplinePlaneGravityDirection(AActor* Ne
 		return;
 	}
 
-	const USplineComponent* Spline = Cast<USplineComponent>(
+	USplineComponent* Spline = Cast<USplineComponent>(
 		NewGravityActor->GetComponentByClass(USplineComponent::StaticClass()));
 	if (Spline != nullptr)
 	{
 		const ENinjaGravityDirectionMode OldGravityDirectionMode = GravityDirectionMode;
 
-		bDirtyGravityDirection = true;
+		HotState.bDirtyGravityDirection = true;
 		GravityDirectionMode = ENinjaGravityDirectionMode::SplinePlane;
 		GravityActor = NewGravityActor;
+		GravityActorProxy.Set(NewGravityActor, GravityDirectionMode);
+		GravitySpline = Spline;
 
 		GravityDirectionChanged(OldGravityDirectionMode);
 	}
 }
 
-void UNinjaCharacterMovementComponent::MulticastSetSplinePlaneGravityDirection_Implementation(AActor* NewGravityActor)
-{
-	if (GravityDirectionMode == ENinjaGravityDirectionMode::SplinePlane &&
-		GravityActor == NewGravityActor)
-	{
-		return;
-	}
-
-	const ENinjaGravityDirectionMode OldGravityDirectionMode = GravityDirectionMode;
-
-	GravityDirectionMode = ENinjaGravityDirectionMode::SplinePlane;
-	GravityActor = NewGravityActor;
-
-	GravityDirectionChanged(OldGravityDirectionMode);
-}
-
 void UNinjaCharacterMovementComponent::SetBoxGravityDirection(const FVector& NewGravityBoxOrigin, const FVector& NewGravityBoxExtent)
 {
 	if (GravityDirectionMode == ENinjaGravityDirectionMode::Box &&
@@ -5415,11 +6012,12 @@ void UNinjaCharacterMovementComponent::SetBoxGravityDirection(const FVector& New
 
 	const ENinjaGravityDirectionMode OldGravityDirectionMode = GravityDirectionMode;
 
-	bDirtyGravityDirection = true;
+	HotState.bDirtyGravityDirection = true;
 	GravityDirectionMode = ENinjaGravityDirectionMode::Box;
 	GravityVectorA = NewGravityBoxOrigin;
 	GravityVectorB = NewGravityBoxExtent;
 	GravityActor = nullptr;
+	GravityActorProxy.Reset();
 
 	GravityDirectionChanged(OldGravityDirectionMode);
 }
@@ -5433,42 +6031,10 @@ void UNinjaCharacterMovementComponent::SetBoxGravityDirectionFromActor(AActor* N
 
 	const ENinjaGravityDirectionMode OldGravityDirectionMode = GravityDirectionMode;
 
-	bDirtyGravityDirection = true;
-	GravityDirectionMode = ENinjaGravityDirectionMode::Box;
-	GravityActor = NewGravityActor;
-
-	GravityDirectionChanged(OldGravityDirectionMode);
-}
-
-void UNinjaCharacterMovementComponent::MulticastSetBoxGravityDirection_Implementation(const FVector& NewGravityBoxOrigin, const FVector& NewGravityBoxExtent)
-{
-	if (GravityDirectionMode == ENinjaGravityDirectionMode::Box &&
-		GravityVectorA == NewGravityBoxOrigin && GravityVectorB == NewGravityBoxExtent)
-	{
-		return;
-	}
-
-	const ENinjaGravityDirectionMode OldGravityDirectionMode = GravityDirectionMode;
-
-	GravityDirectionMode = ENinjaGravityDirectionMode::Box;
-	GravityVectorA = NewGravityBoxOrigin;
-	GravityVectorB = NewGravityBoxExtent;
-	GravityActor = nullptr;
-
-	GravityDirectionChanged(OldGravityDirectionMode);
-}
-
-void UNinjaCharacterMovementComponent::MulticastSetBoxGravityDirectionFromActor_Implementation(AActor* NewGravityActor)
-{
-	if (GravityDirectionMode == ENinjaGravityDirectionMode::Box && GravityActor == NewGravityActor)
-	{
-		return;
-	}
-
-	const ENinjaGravityDirectionMode OldGravityDirectionMode = GravityDirectionMode;
-
+	HotState.bDirtyGravityDirection = true;
 	GravityDirectionMode = ENinjaGravityDirectionMode::Box;
 	GravityActor = NewGravityActor;
+	GravityActorProxy.Set(NewGravityActor, GravityDirectionMode);
 
 	GravityDirectionChanged(OldGravityDirectionMode);
 }
@@ -5487,31 +6053,57 @@ void UNinjaCharacterMovementComponent::SetCollisionGravityDirection(AActor* NewG
 	{
 		const ENinjaGravityDirectionMode OldGravityDirectionMode = GravityDirectionMode;
 
-		bDirtyGravityDirection = true;
+		HotState.bDirtyGravityDirection = true;
 		GravityDirectionMode = ENinjaGravityDirectionMode::Collision;
 		GravityActor = NewGravityActor;
+		GravityActorProxy.Set(NewGravityActor, GravityDirectionMode);
 
 		GravityDirectionChanged(OldGravityDirectionMode);
 	}
 }
 
-void UNinjaCharacterMovementComponent::MulticastSetCollisionGravityDirection_Implementation(AActor* NewGravityActor)
+void UNinjaCharacterMovementComponent::SetBakedGravityDirection(UNinjaGravityField* NewGravityField)
 {
-	if (GravityDirectionMode == ENinjaGravityDirectionMode::Collision && GravityActor == NewGravityActor)
+	if (NewGravityField == nullptr || !NewGravityField->IsValidField() ||
+		(GravityDirectionMode == ENinjaGravityDirectionMode::Baked &&
+		GravityField == NewGravityField))
 	{
 		return;
 	}
 
 	const ENinjaGravityDirectionMode OldGravityDirectionMode = GravityDirectionMode;
 
-	GravityDirectionMode = ENinjaGravityDirectionMode::Collision;
-	GravityActor = NewGravityActor;
+	HotState.bDirtyGravityDirection = true;
+	GravityDirectionMode = ENinjaGravityDirectionMode::Baked;
+	GravityField = NewGravityField;
+
+	GravityDirectionChanged(OldGravityDirectionMode);
+}
+
+void UNinjaCharacterMovementComponent::SetFieldGravityDirection()
+{
+	if (GravityDirectionMode == ENinjaGravityDirectionMode::Field)
+	{
+		return;
+	}
+
+	const ENinjaGravityDirectionMode OldGravityDirectionMode = GravityDirectionMode;
+
+	HotState.bDirtyGravityDirection = true;
+	GravityDirectionMode = ENinjaGravityDirectionMode::Field;
 
 	GravityDirectionChanged(OldGravityDirectionMode);
 }
 
 void UNinjaCharacterMovementComponent::GravityDirectionChanged(ENinjaGravityDirectionMode OldGravityDirectionMode)
 {
+	// Evaluator is only looked up when mode changes
+	HotState.GravityDirectionFunc = FNinjaGravityEvaluator::Find(GravityDirectionMode);
+
+	// Gravity direction of a client move doesn't apply to new gravity settings
+	bUseNetworkGravityDirection = false;
+	InvalidateGravityCache();
+
 	OnGravityDirectionChanged(OldGravityDirectionMode, GravityDirectionMode);
 
 	// Call owner delegate
@@ -5526,11 +6118,6 @@ void UNinjaCharacterMovementComponent::OnGravityDirectionChanged(ENinjaGravityDi
 {
 }
 
-void UNinjaCharacterMovementComponent::MulticastSetGravityScale_Implementation(float NewGravityScale)
-{
-	GravityScale = NewGravityScale;
-}
-
 void UNinjaCharacterMovementComponent::SetAlignGravityToBase(bool bNewAlignGravityToBase)
 {
 	if (bAlignGravityToBase == bNewAlignGravityToBase)
@@ -5542,6 +6129,8 @@ void UNinjaCharacterMovementComponent::SetAlignGravityToBase(bool bNewAlignGravi
 
 	if (ShouldReplicateGravity())
 	{
+		NINJA_COUNT_GRAVITY_RPCS(1);
+
 		if (!bAlignGravityToBase)
 		{
 			MulticastDisableAlignGravityToBase();
@@ -5565,6 +6154,8 @@ void UNinjaCharacterMovementComponent::MulticastDisableAlignGravityToBase_Implem
 
 void UNinjaCharacterMovementComponent::UpdateGravity()
 {
+	SCOPE_CYCLE_COUNTER(STAT_NinjaUpdateGravity);
+
 	if (!bAlignGravityToBase || !IsMovingOnGround())
 	{
 		return;
@@ -5620,81 +6211,155 @@ void UNinjaCharacterMovementComponent::UpdateGravity()
 
 void UNinjaCharacterMovementComponent::ReplicateGravityToClients()
 {
-	if (bDirtyGravityDirection)
+	SCOPE_CYCLE_COUNTER(STAT_NinjaReplicateGravityToClients);
+
+	if (!HotState.bDirtyGravityDirection && HotState.OldGravityScale == GravityScale)
 	{
-		// Replicate gravity direction to clients
-		switch (GravityDirectionMode)
+		return;
+	}
+
+	FNinjaGravityState NewGravityState = MakeGravityState();
+
+	// Gravity settings that follow a replicating physics volume are sent by the volume just once
+	const ANinjaPhysicsVolume* NinjaPhysicsVolume = Cast<ANinjaPhysicsVolume>(GetPhysicsVolume());
+	if (NinjaPhysicsVolume != nullptr && NinjaPhysicsVolume->bReplicateGravity &&
+		NewGravityState == NinjaPhysicsVolume->MakeGravityState())
+	{
+		NewGravityState = FNinjaGravityState();
+		NewGravityState.bFromVolume = true;
+	}
+
+	// Replicate meaningful changes at once; small deviations are replicated after settling for a while
+	const float WorldTime = GetWorld()->GetTimeSeconds();
+	if (NewGravityState != GravityState && (!NewGravityState.IsNearlyEqual(GravityState,
+		FMath::Cos(FMath::DegreesToRadians(GravityReplicationAngleThreshold)), GravityReplicationDistanceThreshold) ||
+		WorldTime - LastGravityReplicationTime >= GravityReplicationSettleTime))
+	{
+		GravityState = NewGravityState;
+		LastGravityReplicationTime = WorldTime;
+		NINJA_COUNT_GRAVITY_RPCS(1);
+	}
+
+	// Stay dirty until clients receive exactly the current gravity settings
+	HotState.bDirtyGravityDirection = (NewGravityState != GravityState);
+	HotState.OldGravityScale = GravityScale;
+}
+
+FNinjaGravityState UNinjaCharacterMovementComponent::MakeGravityState() const
+{
+	FNinjaGravityState NewGravityState;
+	NewGravityState.Mode = GravityDirectionMode;
+	NewGravityState.VectorA = FVector::ZeroVector;
+	NewGravityState.Scale = GravityScale;
+
+	switch (GravityDirectionMode)
+	{
+		case ENinjaGravityDirectionMode::Fixed:
 		{
-			case ENinjaGravityDirectionMode::Fixed:
-			{
-				MulticastSetFixedGravityDirection(GravityVectorA);
-				break;
-			}
+			NewGravityState.VectorA = GravityVectorA;
+			break;
+		}
 
-			case ENinjaGravityDirectionMode::SplineTangent:
-			{
-				MulticastSetSplineTangentGravityDirection(GravityActor);
-				break;
-			}
+		case ENinjaGravityDirectionMode::SplineTangent:
+		case ENinjaGravityDirectionMode::Spline:
+		case ENinjaGravityDirectionMode::SplinePlane:
+		case ENinjaGravityDirectionMode::Collision:
+		{
+			NewGravityState.Actor = GravityActor;
+			break;
+		}
 
-			case ENinjaGravityDirectionMode::Point:
+		case ENinjaGravityDirectionMode::Point:
+		{
+			if (GravityActor != nullptr && !GravityActor->IsPendingKill())
 			{
-				MulticastSetPointGravityDirection(GravityVectorA);
-				break;
+				NewGravityState.Actor = GravityActor;
 			}
-
-			case ENinjaGravityDirectionMode::Line:
+			else
 			{
-				MulticastSetLineGravityDirection(GravityVectorA, GravityVectorB);
-				break;
+				NewGravityState.VectorA = GravityVectorA;
 			}
 
-			case ENinjaGravityDirectionMode::Segment:
-			{
-				MulticastSetSegmentGravityDirection(GravityVectorA, GravityVectorB);
-				break;
-			}
+			break;
+		}
 
-			case ENinjaGravityDirectionMode::Spline:
+		case ENinjaGravityDirectionMode::Box:
+		{
+			if (GravityActor != nullptr && !GravityActor->IsPendingKill())
 			{
-				MulticastSetSplineGravityDirection(GravityActor);
-				break;
+				NewGravityState.Actor = GravityActor;
 			}
-
-			case ENinjaGravityDirectionMode::Plane:
+			else
 			{
-				MulticastSetPlaneGravityDirection(GravityVectorA, GravityVectorB);
-				break;
+				NewGravityState.VectorA = GravityVectorA;
+				NewGravityState.VectorB = GravityVectorB;
 			}
 
-			case ENinjaGravityDirectionMode::SplinePlane:
-			{
-				MulticastSetSplinePlaneGravityDirection(GravityActor);
-				break;
-			}
+			break;
+		}
 
-			case ENinjaGravityDirectionMode::Box:
-			{
-				MulticastSetBoxGravityDirection(GravityVectorA, GravityVectorB);
-				break;
-			}
+		case ENinjaGravityDirectionMode::Line:
+		case ENinjaGravityDirectionMode::Segment:
+		case ENinjaGravityDirectionMode::Plane:
+		{
+			NewGravityState.VectorA = GravityVectorA;
+			NewGravityState.VectorB = GravityVectorB;
+			break;
+		}
 
-			case ENinjaGravityDirectionMode::Collision:
-			{
-				MulticastSetCollisionGravityDirection(GravityActor);
-				break;
-			}
+		case ENinjaGravityDirectionMode::Baked:
+		{
+			NewGravityState.Field = GravityField;
+			break;
 		}
+	}
+
+	return NewGravityState;
+}
+
+void UNinjaCharacterMovementComponent::OnRep_GravityState()
+{
+	if (!GravityState.bFromVolume)
+	{
+		ApplyGravityState(GravityState);
+		return;
+	}
+
+	// Follow gravity settings replicated by the physics volume; if it isn't
+	// known yet, they are applied when the volume is entered
+	const ANinjaPhysicsVolume* NinjaPhysicsVolume = Cast<ANinjaPhysicsVolume>(GetPhysicsVolume());
+	if (NinjaPhysicsVolume != nullptr)
+	{
+		ApplyGravityState(NinjaPhysicsVolume->MakeGravityState());
+	}
+}
 
-		bDirtyGravityDirection = false;
+void UNinjaCharacterMovementComponent::ApplyGravityState(const FNinjaGravityState& NewGravityState)
+{
+	GravityScale = NewGravityState.Scale;
+	HotState.OldGravityScale = GravityScale;
+
+	const FNinjaGravityState CurrentGravityState = MakeGravityState();
+	if (CurrentGravityState == NewGravityState)
+	{
+		// Only gravity scale changed
+		return;
 	}
 
-	if (OldGravityScale != GravityScale)
+	const ENinjaGravityDirectionMode OldGravityDirectionMode = GravityDirectionMode;
+
+	GravityDirectionMode = NewGravityState.Mode;
+	GravityActor = NewGravityState.Actor;
+	GravityActorProxy.Set(NewGravityState.Actor, GravityDirectionMode);
+	GravityField = NewGravityState.Field;
+
+	if (NewGravityState.Actor == nullptr)
 	{
-		// Replicate gravity scale to clients
-		MulticastSetGravityScale(GravityScale);
-		OldGravityScale = GravityScale;
+		GravityVectorA = NewGravityState.VectorA;
+		GravityVectorB = NewGravityState.VectorB;
 	}
+
+	GravityDirectionChanged(OldGravityDirectionMode);
 }
 
 FRotator UNinjaCharacterMovementComponent::ConstrainComponentRotation(const FRotator& Rotation) const
@@ -5720,7 +6385,7 @@ FRotator UNinjaCharacterMovementComponent::ConstrainComponentRotation(const FRot
 
 	// Keep current Z rotation axis of capsule, try to keep X axis of rotation
 	return FNinjaMath::MakeFromZQuat(CapsuleUp, Rotation.Quaternion(),
-		ThresholdParallelCosine).Rotator();
+		HotState.ThresholdParallelCosine).Rotator();
 }
 
 void UNinjaCharacterMovementComponent::SetAlignComponentToFloor(bool bNewAlignComponentToFloor)
@@ -5734,6 +6399,8 @@ void UNinjaCharacterMovementComponent::SetAlignComponentToFloor(bool bNewAlignCo
 
 	if (ShouldReplicateGravity())
 	{
+		NINJA_COUNT_GRAVITY_RPCS(1);
+
 		if (!bAlignComponentToFloor)
 		{
 			MulticastDisableAlignComponentToFloor();
@@ -5766,6 +6433,8 @@ void UNinjaCharacterMovementComponent::SetAlignComponentToGravity(bool bNewAlign
 
 	if (ShouldReplicateGravity())
 	{
+		NINJA_COUNT_GRAVITY_RPCS(1);
+
 		if (!bAlignComponentToGravity)
 		{
 			MulticastDisableAlignComponentToGravity();
@@ -5805,7 +6474,7 @@ FVector UNinjaCharacterMovementComponent::GetComponentDesiredAxisZ() const
 	}
 
 	if (DesiredAxisZ.Z == 1.0f ||
-		FNinjaMath::Coincident(DesiredAxisZ, FVector::UpVector, ThresholdParallelCosine))
+		FNinjaMath::Coincident(DesiredAxisZ, FVector::UpVector, HotState.ThresholdParallelCosine))
 	{
 		// Optimization; avoids usage of several complex calculations in other places
 		DesiredAxisZ = FVector::UpVector;
@@ -5865,6 +6534,8 @@ bool UNinjaCharacterMovementComponent::SetComponentAxisZ(const FVector& NewCompo
 
 bool UNinjaCharacterMovementComponent::UpdateComponentRotation(const FVector& DesiredAxisZ, bool bRotateAroundCenter, bool bRotateVelocity)
 {
+	SCOPE_CYCLE_COUNTER(STAT_NinjaUpdateComponentRotation);
+
 	if (!HasValidData())
 	{
 		return false;
@@ -5874,7 +6545,7 @@ bool UNinjaCharacterMovementComponent::UpdateComponentRotation(const FVector& De
 	const FVector CurrentAxisZ = FNinjaMath::GetAxisZ(PawnRotation);
 
 	// Abort if angle between new and old capsule 'up' axes almost equals to 0 degrees
-	if (FNinjaMath::Coincident(DesiredAxisZ, CurrentAxisZ, ThresholdParallelCosine))
+	if (FNinjaMath::Coincident(DesiredAxisZ, CurrentAxisZ, HotState.ThresholdParallelCosine))
 	{
 		return false;
 	}
@@ -5898,22 +6569,41 @@ bool UNinjaCharacterMovementComponent::UpdateComponentRotation(const FVector& De
 			const FVector TraceStart = UpdatedComponent->GetComponentLocation();
 			const float TraceDistance = PawnHalfHeight - PawnRadius;
 
-			FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(UpdateComponentRotation), false, CharacterOwner);
-			FCollisionResponseParams ResponseParam;
-			InitCollisionParams(QueryParams, ResponseParam);
-
-			FHitResult Hit(1.0f);
-			const bool bBlockingHit = FloorSweepTest(Hit, TraceStart, TraceStart - DesiredAxisZ * TraceDistance,
-				UpdatedComponent->GetCollisionObjectType(), FCollisionShape::MakeSphere(PawnRadius), QueryParams, ResponseParam);
-			if (bBlockingHit)
+			if (bIncrementalRotation && IsMovingOnGround() && CurrentFloor.bBlockingHit &&
+				!CurrentFloor.HitResult.bStartPenetrating)
+			{
+				// Reuse the floor found this tick; small rotations allow treating it as a plane
+				const FVector& FloorNormal = CurrentFloor.HitResult.ImpactNormal;
+				const float NormalDot = DesiredAxisZ | FloorNormal;
+				if (NormalDot > KINDA_SMALL_NUMBER)
+				{
+					const float HitTime = FMath::Max(0.0f, (((TraceStart - CurrentFloor.HitResult.ImpactPoint) | FloorNormal) -
+						PawnRadius) / (TraceDistance * NormalDot));
+					if (HitTime < 1.0f)
+					{
+						Delta = DesiredAxisZ * (TraceDistance * (1.0f - HitTime));
+					}
+				}
+			}
+			else
 			{
-				Delta = DesiredAxisZ * (TraceDistance * (1.0f - Hit.Time));
+				FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(UpdateComponentRotation), false, CharacterOwner);
+				FCollisionResponseParams ResponseParam;
+				InitCollisionParams(QueryParams, ResponseParam);
+
+				FHitResult Hit(1.0f);
+				const bool bBlockingHit = AsyncFloorSweepTest(ENinjaAsyncQuery::Rotation, Hit, TraceStart, TraceStart - DesiredAxisZ * TraceDistance,
+					UpdatedComponent->GetCollisionObjectType(), FCollisionShape::MakeSphere(PawnRadius), QueryParams, ResponseParam);
+				if (bBlockingHit)
+				{
+					Delta = DesiredAxisZ * (TraceDistance * (1.0f - Hit.Time));
+				}
 			}
 		}
 	}
 
 	// Take desired Z rotation axis of capsule, try to keep current X rotation axis of capsule
-	const FQuat NewRotation = FNinjaMath::MakeFromZQuat(DesiredAxisZ, PawnRotation, ThresholdParallelCosine);
+	const FQuat NewRotation = FNinjaMath::MakeFromZQuat(DesiredAxisZ, PawnRotation, HotState.ThresholdParallelCosine);
 
 	// Try to rotate the capsule now, but don't sweep because penetrations are handled properly
 	FHitResult Hit(1.0f);
@@ -5928,10 +6618,51 @@ bool UNinjaCharacterMovementComponent::UpdateComponentRotation(const FVector& De
 	return bMoveResult;
 }
 
+void UNinjaCharacterMovementComponent::SetIncrementalRotationAngles(float NewBudget, float NewRelease)
+{
+	IncrementalRotationBudget = FMath::Clamp(NewBudget, 0.0f, 45.0f);
+	IncrementalRotationRelease = FMath::Clamp(NewRelease, 0.0f, IncrementalRotationBudget);
+
+	HotState.IncrementalRotationBudgetCosine = FMath::Cos(FMath::DegreesToRadians(IncrementalRotationBudget));
+	HotState.IncrementalRotationReleaseCosine = FMath::Cos(FMath::DegreesToRadians(IncrementalRotationRelease));
+}
+
+bool UNinjaCharacterMovementComponent::ShouldUpdateComponentRotation(const FVector& DesiredAxisZ)
+{
+	if (!bIncrementalRotation || !HasValidData())
+	{
+		return true;
+	}
+
+	const float DriftCosine = DesiredAxisZ | FNinjaMath::GetAxisZ(UpdatedComponent->GetComponentQuat());
+
+	if (HotState.bIncrementalRotationActive)
+	{
+		// Keep following the desired axis while it moves faster than the release angle per tick
+		if (HotState.IncrementalRotationFrame == GFrameCounter || DriftCosine < HotState.IncrementalRotationReleaseCosine)
+		{
+			HotState.IncrementalRotationFrame = GFrameCounter;
+			return true;
+		}
+
+		HotState.bIncrementalRotationActive = false;
+	}
+
+	// Drift accumulates as misalignment until it exceeds the budget
+	if (DriftCosine < HotState.IncrementalRotationBudgetCosine)
+	{
+		HotState.bIncrementalRotationActive = true;
+		HotState.IncrementalRotationFrame = GFrameCounter;
+		return true;
+	}
+
+	return false;
+}
+
 void UNinjaCharacterMovementComponent::SetThresholdParallelAngle(float NewThresholdParallelAngle)
 {
 	ThresholdParallelAngle = FMath::Clamp(NewThresholdParallelAngle, 0.25f, 1.0f);
 
-	ThresholdOrthogonalCosine = FMath::Cos(FMath::DegreesToRadians(90.0f - ThresholdParallelAngle));
-	ThresholdParallelCosine = FMath::Cos(FMath::DegreesToRadians(ThresholdParallelAngle));
+	HotState.ThresholdOrthogonalCosine = FMath::Cos(FMath::DegreesToRadians(90.0f - ThresholdParallelAngle));
+	HotState.ThresholdParallelCosine = FMath::Cos(FMath::DegreesToRadians(ThresholdParallelAngle));
 }
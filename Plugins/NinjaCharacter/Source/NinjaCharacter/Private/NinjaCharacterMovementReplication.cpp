@@ -0,0 +1,166 @@
+// "Ninja Character" plugin, by Javier 'Xaklse' Osset; Copyright 2020
+
+
+#include "NinjaCharacterMovementReplication.h"
+
+#include "NinjaCharacterMovementComponent.h"
+
+#include "GameFramework/Character.h"
+
+
+FNinjaCharacterNetworkMoveData::FNinjaCharacterNetworkMoveData()
+	: GravityDirection(FVector::DownVector)
+	, ComponentAxisZ(FVector::UpVector)
+{
+}
+
+void FNinjaCharacterNetworkMoveData::ClientFillNetworkMoveData(const FSavedMove_Character& ClientMove, ENetworkMoveType MoveType)
+{
+	Super::ClientFillNetworkMoveData(ClientMove, MoveType);
+
+	// Prediction data only allocates Ninja moves
+	const FSavedMove_Ninja& NinjaMove = static_cast<const FSavedMove_Ninja&>(ClientMove);
+	GravityDirection = NinjaMove.SavedGravityDirection;
+	ComponentAxisZ = NinjaMove.SavedComponentAxisZ;
+}
+
+bool FNinjaCharacterNetworkMoveData::Serialize(UCharacterMovementComponent& CharacterMovement, FArchive& Ar, UPackageMap* PackageMap, ENetworkMoveType MoveType)
+{
+	Super::Serialize(CharacterMovement, Ar, PackageMap, MoveType);
+
+	bool bLocalSuccess = true;
+	GravityDirection.NetSerialize(Ar, PackageMap, bLocalSuccess);
+
+	// The capsule is usually aligned to gravity, avoid sending the same direction twice
+	uint8 bAlignedToGravity = (Ar.IsSaving() && (ComponentAxisZ | GravityDirection) <= -0.99999f) ? 1 : 0;
+	Ar.SerializeBits(&bAlignedToGravity, 1);
+
+	if (bAlignedToGravity != 0)
+	{
+		if (Ar.IsLoading())
+		{
+			ComponentAxisZ = GravityDirection * -1.0f;
+		}
+	}
+	else
+	{
+		ComponentAxisZ.NetSerialize(Ar, PackageMap, bLocalSuccess);
+	}
+
+	return !Ar.IsError();
+}
+
+FNinjaCharacterNetworkMoveDataContainer::FNinjaCharacterNetworkMoveDataContainer()
+{
+	NewMoveData = &NinjaMoveData[0];
+	PendingMoveData = &NinjaMoveData[1];
+	OldMoveData = &NinjaMoveData[2];
+}
+
+FSavedMove_Ninja::FSavedMove_Ninja()
+	: SavedGravityDirection(FVector::DownVector)
+	, StartComponentAxisZ(FVector::UpVector)
+	, SavedComponentAxisZ(FVector::UpVector)
+	, SavedGravityDirectionMode(ENinjaGravityDirectionMode::Fixed)
+{
+}
+
+void FSavedMove_Ninja::Clear()
+{
+	Super::Clear();
+
+	SavedGravityDirection = FVector::DownVector;
+	StartComponentAxisZ = FVector::UpVector;
+	SavedComponentAxisZ = FVector::UpVector;
+	SavedGravityDirectionMode = ENinjaGravityDirectionMode::Fixed;
+}
+
+void FSavedMove_Ninja::SetMoveFor(ACharacter* C, float InDeltaTime, FVector const& NewAccel, FNetworkPredictionData_Client_Character& ClientData)
+{
+	Super::SetMoveFor(C, InDeltaTime, NewAccel, ClientData);
+
+	const UNinjaCharacterMovementComponent* NinjaMovement = Cast<UNinjaCharacterMovementComponent>(C->GetCharacterMovement());
+	if (NinjaMovement != nullptr)
+	{
+		SavedGravityDirection = NinjaMovement->GetGravityDirection(true);
+		StartComponentAxisZ = NinjaMovement->GetComponentAxisZ();
+		SavedGravityDirectionMode = NinjaMovement->GetGravityDirectionMode();
+
+		NinjaMovement->RecordGravityState();
+	}
+}
+
+bool FSavedMove_Ninja::CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const
+{
+	const UNinjaCharacterMovementComponent* NinjaMovement = Cast<UNinjaCharacterMovementComponent>(InCharacter->GetCharacterMovement());
+	if (NinjaMovement != nullptr)
+	{
+		const FSavedMove_Ninja* NewNinjaMove = static_cast<const FSavedMove_Ninja*>(NewMove.Get());
+		const float ThresholdParallelCosine = NinjaMovement->GetThresholdParallelCosine();
+
+		// Combined move is simulated with starting gravity and orientation of this move
+		if (SavedGravityDirectionMode != NewNinjaMove->SavedGravityDirectionMode ||
+			(SavedGravityDirection | NewNinjaMove->SavedGravityDirection) < ThresholdParallelCosine ||
+			(StartComponentAxisZ | NewNinjaMove->StartComponentAxisZ) < ThresholdParallelCosine)
+		{
+			return false;
+		}
+	}
+
+	return Super::CanCombineWith(NewMove, InCharacter, MaxDelta);
+}
+
+void FSavedMove_Ninja::CombineWith(const FSavedMove_Character* OldMove, ACharacter* InCharacter, APlayerController* PC, const FVector& OldStartLocation)
+{
+	Super::CombineWith(OldMove, InCharacter, PC, OldStartLocation);
+
+	const UNinjaCharacterMovementComponent* NinjaMovement = Cast<UNinjaCharacterMovementComponent>(InCharacter->GetCharacterMovement());
+	if (NinjaMovement != nullptr)
+	{
+		NinjaMovement->DiscardRecordedSavedMove(*static_cast<const FSavedMove_Ninja*>(OldMove));
+	}
+}
+
+void FSavedMove_Ninja::PrepMoveFor(ACharacter* C)
+{
+	Super::PrepMoveFor(C);
+
+	UNinjaCharacterMovementComponent* NinjaMovement = Cast<UNinjaCharacterMovementComponent>(C->GetCharacterMovement());
+	if (NinjaMovement != nullptr)
+	{
+		// Server simulates the move with its gravity direction only if it is close enough to current one
+		NinjaMovement->ClearNetworkGravityDirection();
+
+		if (SavedGravityDirectionMode == NinjaMovement->GetGravityDirectionMode() &&
+			NinjaMovement->IsNetworkGravityDirectionAcceptable(SavedGravityDirection))
+		{
+			NinjaMovement->SetNetworkGravityDirection(SavedGravityDirection);
+		}
+	}
+}
+
+void FSavedMove_Ninja::PostUpdate(ACharacter* C, EPostUpdateMode PostUpdateMode)
+{
+	Super::PostUpdate(C, PostUpdateMode);
+
+	const UNinjaCharacterMovementComponent* NinjaMovement = Cast<UNinjaCharacterMovementComponent>(C->GetCharacterMovement());
+	if (NinjaMovement != nullptr && NinjaMovement->UpdatedComponent != nullptr)
+	{
+		SavedComponentAxisZ = NinjaMovement->GetComponentAxisZ();
+
+		if (PostUpdateMode == PostUpdate_Record)
+		{
+			NinjaMovement->RecordSavedMove(*this);
+		}
+	}
+}
+
+FNetworkPredictionData_Client_Ninja::FNetworkPredictionData_Client_Ninja(const UCharacterMovementComponent& ClientMovement)
+	: Super(ClientMovement)
+{
+}
+
+FSavedMovePtr FNetworkPredictionData_Client_Ninja::AllocateNewMove()
+{
+	return FSavedMovePtr(new FSavedMove_Ninja());
+}
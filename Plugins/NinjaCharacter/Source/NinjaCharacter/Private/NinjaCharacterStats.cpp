@@ -0,0 +1,47 @@
+// "Ninja Character" plugin, by Javier 'Xaklse' Osset; Copyright 2020
+
+
+#include "NinjaCharacterStats.h"
+
+
+DEFINE_STAT(STAT_NinjaGravityFixed);
+DEFINE_STAT(STAT_NinjaGravitySplineTangent);
+DEFINE_STAT(STAT_NinjaGravityPoint);
+DEFINE_STAT(STAT_NinjaGravityLine);
+DEFINE_STAT(STAT_NinjaGravitySegment);
+DEFINE_STAT(STAT_NinjaGravitySpline);
+DEFINE_STAT(STAT_NinjaGravityPlane);
+DEFINE_STAT(STAT_NinjaGravitySplinePlane);
+DEFINE_STAT(STAT_NinjaGravityBox);
+DEFINE_STAT(STAT_NinjaGravityCollision);
+DEFINE_STAT(STAT_NinjaGravityBaked);
+DEFINE_STAT(STAT_NinjaGravityField);
+DEFINE_STAT(STAT_NinjaGravityBatch);
+
+DEFINE_STAT(STAT_NinjaComputeFloorDist);
+DEFINE_STAT(STAT_NinjaUpdateComponentRotation);
+DEFINE_STAT(STAT_NinjaUpdateGravity);
+DEFINE_STAT(STAT_NinjaReplicateGravityToClients);
+DEFINE_STAT(STAT_NinjaMovementReplay);
+
+DEFINE_STAT(STAT_NinjaPhysicsVolumeTick);
+DEFINE_STAT(STAT_NinjaPhysicsVolumeActorEntered);
+DEFINE_STAT(STAT_NinjaPhysicsVolumeActorLeaving);
+
+DEFINE_STAT(STAT_NinjaMovementTickManager);
+DEFINE_STAT(STAT_NinjaProjectileManager);
+DEFINE_STAT(STAT_NinjaSurfaceNavigationRebuild);
+DEFINE_STAT(STAT_NinjaSurfaceNavigationFindPath);
+
+DEFINE_STAT(STAT_NinjaGravityEvaluations);
+DEFINE_STAT(STAT_NinjaFloorSweeps);
+DEFINE_STAT(STAT_NinjaGravityRPCs);
+
+CSV_DEFINE_CATEGORY_MODULE(NINJACHARACTER_API, NinjaCharacter, true);
+
+#if !UE_BUILD_SHIPPING
+TAtomic<bool> NinjaCharacterStats::bTrackBenchmarkCounters(false);
+TAtomic<int64> NinjaCharacterStats::GravityEvaluations(0);
+TAtomic<int64> NinjaCharacterStats::FloorSweeps(0);
+TAtomic<int64> NinjaCharacterStats::GravityRPCs(0);
+#endif // !UE_BUILD_SHIPPING
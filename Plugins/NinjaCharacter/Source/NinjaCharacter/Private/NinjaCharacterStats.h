@@ -0,0 +1,151 @@
+// "Ninja Character" plugin, by Javier 'Xaklse' Osset; Copyright 2020
+
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "Stats/Stats.h"
+#include "Templates/Atomic.h"
+#include "NinjaTypes.h"
+
+
+DECLARE_STATS_GROUP(TEXT("NinjaCharacter"), STATGROUP_NinjaCharacter, STATCAT_Advanced);
+
+// Gravity evaluation by mode
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Ninja Gravity Fixed"), STAT_NinjaGravityFixed, STATGROUP_NinjaCharacter, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Ninja Gravity SplineTangent"), STAT_NinjaGravitySplineTangent, STATGROUP_NinjaCharacter, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Ninja Gravity Point"), STAT_NinjaGravityPoint, STATGROUP_NinjaCharacter, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Ninja Gravity Line"), STAT_NinjaGravityLine, STATGROUP_NinjaCharacter, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Ninja Gravity Segment"), STAT_NinjaGravitySegment, STATGROUP_NinjaCharacter, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Ninja Gravity Spline"), STAT_NinjaGravitySpline, STATGROUP_NinjaCharacter, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Ninja Gravity Plane"), STAT_NinjaGravityPlane, STATGROUP_NinjaCharacter, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Ninja Gravity SplinePlane"), STAT_NinjaGravitySplinePlane, STATGROUP_NinjaCharacter, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Ninja Gravity Box"), STAT_NinjaGravityBox, STATGROUP_NinjaCharacter, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Ninja Gravity Collision"), STAT_NinjaGravityCollision, STATGROUP_NinjaCharacter, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Ninja Gravity Baked"), STAT_NinjaGravityBaked, STATGROUP_NinjaCharacter, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Ninja Gravity Field"), STAT_NinjaGravityField, STATGROUP_NinjaCharacter, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Ninja Gravity Batch"), STAT_NinjaGravityBatch, STATGROUP_NinjaCharacter, );
+
+// Movement component
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Ninja ComputeFloorDist"), STAT_NinjaComputeFloorDist, STATGROUP_NinjaCharacter, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Ninja UpdateComponentRotation"), STAT_NinjaUpdateComponentRotation, STATGROUP_NinjaCharacter, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Ninja UpdateGravity"), STAT_NinjaUpdateGravity, STATGROUP_NinjaCharacter, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Ninja ReplicateGravityToClients"), STAT_NinjaReplicateGravityToClients, STATGROUP_NinjaCharacter, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Ninja MovementReplay"), STAT_NinjaMovementReplay, STATGROUP_NinjaCharacter, );
+
+// Physics volume
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Ninja PhysicsVolume Tick"), STAT_NinjaPhysicsVolumeTick, STATGROUP_NinjaCharacter, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Ninja PhysicsVolume ActorEntered"), STAT_NinjaPhysicsVolumeActorEntered, STATGROUP_NinjaCharacter, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Ninja PhysicsVolume ActorLeaving"), STAT_NinjaPhysicsVolumeActorLeaving, STATGROUP_NinjaCharacter, );
+
+// Subsystems
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Ninja MovementTickManager"), STAT_NinjaMovementTickManager, STATGROUP_NinjaCharacter, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Ninja ProjectileManager"), STAT_NinjaProjectileManager, STATGROUP_NinjaCharacter, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Ninja SurfaceNavigation Rebuild"), STAT_NinjaSurfaceNavigationRebuild, STATGROUP_NinjaCharacter, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Ninja SurfaceNavigation FindPath"), STAT_NinjaSurfaceNavigationFindPath, STATGROUP_NinjaCharacter, );
+
+// Counters, reset every frame
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Ninja Gravity Evaluations"), STAT_NinjaGravityEvaluations, STATGROUP_NinjaCharacter, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Ninja Floor Sweeps"), STAT_NinjaFloorSweeps, STATGROUP_NinjaCharacter, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Ninja Gravity RPCs"), STAT_NinjaGravityRPCs, STATGROUP_NinjaCharacter, );
+
+CSV_DECLARE_CATEGORY_MODULE_EXTERN(NINJACHARACTER_API, NinjaCharacter);
+
+// Counters are shared by stats, CSV profiler captures and benchmarks
+#define NINJA_COUNT_GRAVITY_EVALUATIONS(Amount) \
+	do \
+	{ \
+		INC_DWORD_STAT_BY(STAT_NinjaGravityEvaluations, Amount); \
+		CSV_CUSTOM_STAT(NinjaCharacter, GravityEvaluations, (int32)(Amount), ECsvCustomStatOp::Accumulate); \
+		NINJA_COUNT_BENCHMARK(GravityEvaluations, Amount); \
+	} \
+	while (0)
+
+#define NINJA_COUNT_FLOOR_SWEEPS(Amount) \
+	do \
+	{ \
+		INC_DWORD_STAT_BY(STAT_NinjaFloorSweeps, Amount); \
+		CSV_CUSTOM_STAT(NinjaCharacter, FloorSweeps, (int32)(Amount), ECsvCustomStatOp::Accumulate); \
+		NINJA_COUNT_BENCHMARK(FloorSweeps, Amount); \
+	} \
+	while (0)
+
+#define NINJA_COUNT_GRAVITY_RPCS(Amount) \
+	do \
+	{ \
+		INC_DWORD_STAT_BY(STAT_NinjaGravityRPCs, Amount); \
+		CSV_CUSTOM_STAT(NinjaCharacter, GravityRPCs, (int32)(Amount), ECsvCustomStatOp::Accumulate); \
+		NINJA_COUNT_BENCHMARK(GravityRPCs, Amount); \
+	} \
+	while (0)
+
+#if !UE_BUILD_SHIPPING
+#define NINJA_COUNT_BENCHMARK(Counter, Amount) \
+	do \
+	{ \
+		if (NinjaCharacterStats::bTrackBenchmarkCounters.Load(EMemoryOrder::Relaxed)) \
+		{ \
+			NinjaCharacterStats::Counter += (Amount); \
+		} \
+	} \
+	while (0)
+#else
+#define NINJA_COUNT_BENCHMARK(Counter, Amount) do { } while (0)
+#endif // !UE_BUILD_SHIPPING
+
+/**
+ * Helpers for Ninja stats.
+ */
+namespace NinjaCharacterStats
+{
+#if !UE_BUILD_SHIPPING
+	/** If true, counters below are updated; only enabled while a benchmark runs. */
+	extern TAtomic<bool> bTrackBenchmarkCounters;
+
+	/** Amount of gravity evaluations since the benchmark counters were reset. */
+	extern TAtomic<int64> GravityEvaluations;
+
+	/** Amount of floor sweeps since the benchmark counters were reset. */
+	extern TAtomic<int64> FloorSweeps;
+
+	/** Amount of gravity replication sends since the benchmark counters were reset. */
+	extern TAtomic<int64> GravityRPCs;
+#endif // !UE_BUILD_SHIPPING
+
+	/**
+	 * Obtains the cycle stat that measures gravity evaluation of a mode.
+	 * @param Mode - mode that determines direction of gravity
+	 * @return identifier of the cycle stat
+	 */
+	FORCEINLINE TStatId GetGravityStatId(ENinjaGravityDirectionMode Mode)
+	{
+		switch (Mode)
+		{
+			case ENinjaGravityDirectionMode::SplineTangent:
+				return GET_STATID(STAT_NinjaGravitySplineTangent);
+			case ENinjaGravityDirectionMode::Point:
+				return GET_STATID(STAT_NinjaGravityPoint);
+			case ENinjaGravityDirectionMode::Line:
+				return GET_STATID(STAT_NinjaGravityLine);
+			case ENinjaGravityDirectionMode::Segment:
+				return GET_STATID(STAT_NinjaGravitySegment);
+			case ENinjaGravityDirectionMode::Spline:
+				return GET_STATID(STAT_NinjaGravitySpline);
+			case ENinjaGravityDirectionMode::Plane:
+				return GET_STATID(STAT_NinjaGravityPlane);
+			case ENinjaGravityDirectionMode::SplinePlane:
+				return GET_STATID(STAT_NinjaGravitySplinePlane);
+			case ENinjaGravityDirectionMode::Box:
+				return GET_STATID(STAT_NinjaGravityBox);
+			case ENinjaGravityDirectionMode::Collision:
+				return GET_STATID(STAT_NinjaGravityCollision);
+			case ENinjaGravityDirectionMode::Baked:
+				return GET_STATID(STAT_NinjaGravityBaked);
+			case ENinjaGravityDirectionMode::Field:
+				return GET_STATID(STAT_NinjaGravityField);
+		}
+
+		return GET_STATID(STAT_NinjaGravityFixed);
+	}
+}
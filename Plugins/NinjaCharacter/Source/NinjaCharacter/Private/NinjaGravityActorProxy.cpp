@@ -0,0 +1,121 @@
+// "Ninja Character" plugin, by Javier 'Xaklse' Osset; Copyright 2020
+
+
+#include "NinjaGravityActorProxy.h"
+
+#include "Components/SplineComponent.h"
+#include "GameFramework/Actor.h"
+
+
+FNinjaGravityActorProxy::FNinjaGravityActorProxy()
+	: CachedLocation(FVector::ZeroVector)
+	, CachedBoundsOrigin(FVector::ZeroVector)
+	, CachedBoundsExtent(FVector::ZeroVector)
+	, CachedSplineFrame(0)
+	, bHasCache(false)
+{
+}
+
+void FNinjaGravityActorProxy::Set(AActor* NewActor, ENinjaGravityDirectionMode Mode)
+{
+	if (NewActor == nullptr || NewActor->IsPendingKill())
+	{
+		Reset();
+		return;
+	}
+
+	if (NewActor != ResolvedActor.Get())
+	{
+		Reset();
+
+		SoftActor = NewActor;
+		ResolvedActor = NewActor;
+	}
+
+	Refresh(Mode);
+
+	if (Mode == ENinjaGravityDirectionMode::SplineTangent || Mode == ENinjaGravityDirectionMode::Spline ||
+		Mode == ENinjaGravityDirectionMode::SplinePlane)
+	{
+		RefreshSpline(NewActor->FindComponentByClass<USplineComponent>());
+	}
+}
+
+void FNinjaGravityActorProxy::Reset()
+{
+	SoftActor.Reset();
+	ResolvedActor.Reset();
+	CachedSpline.Reset();
+	bHasCache = false;
+}
+
+AActor* FNinjaGravityActorProxy::Get() const
+{
+	AActor* Actor = ResolvedActor.Get();
+	if (Actor != nullptr && !Actor->IsPendingKill())
+	{
+		return Actor;
+	}
+
+	if (SoftActor.IsNull())
+	{
+		return nullptr;
+	}
+
+	// Look for the Actor again, its level could have been streamed back in
+	Actor = SoftActor.Get();
+	if (Actor == nullptr || Actor->IsPendingKill())
+	{
+		return nullptr;
+	}
+
+	ResolvedActor = Actor;
+
+	return Actor;
+}
+
+void FNinjaGravityActorProxy::Refresh(ENinjaGravityDirectionMode Mode)
+{
+	const AActor* Actor = Get();
+	if (Actor == nullptr)
+	{
+		// Streamed out, keep last cached data
+		return;
+	}
+
+	switch (Mode)
+	{
+		case ENinjaGravityDirectionMode::Point:
+		{
+			CachedLocation = Actor->GetActorLocation();
+			bHasCache = true;
+			break;
+		}
+
+		case ENinjaGravityDirectionMode::Box:
+		case ENinjaGravityDirectionMode::Collision:
+		{
+			Actor->GetActorBounds(true, CachedBoundsOrigin, CachedBoundsExtent);
+			bHasCache = true;
+			break;
+		}
+	}
+}
+
+void FNinjaGravityActorProxy::RefreshSpline(const USplineComponent* Spline)
+{
+	if (Spline == nullptr)
+	{
+		return;
+	}
+
+	// Moving splines would be sampled again by every gravity evaluation
+	if (CachedSpline.IsValid() && CachedSpline->SplineId == Spline && CachedSplineFrame == GFrameCounter)
+	{
+		return;
+	}
+
+	CachedSpline = FNinjaGravitySplineSamples::Sample(Spline, CachedSpline);
+	CachedSplineFrame = GFrameCounter;
+	bHasCache = true;
+}
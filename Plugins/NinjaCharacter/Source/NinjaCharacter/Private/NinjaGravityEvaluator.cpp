@@ -0,0 +1,43 @@
+// "Ninja Character" plugin, by Javier 'Xaklse' Osset; Copyright 2020
+
+
+#include "NinjaGravityEvaluator.h"
+
+
+FNinjaGravityDirectionFunc FNinjaGravityEvaluator::Find(ENinjaGravityDirectionMode Mode)
+{
+	switch (Mode)
+	{
+		case ENinjaGravityDirectionMode::Fixed:
+		{
+			return &Evaluate<FNinjaFixedGravityPolicy>;
+		}
+
+		case ENinjaGravityDirectionMode::Point:
+		{
+			return &Evaluate<FNinjaPointGravityPolicy>;
+		}
+
+		case ENinjaGravityDirectionMode::Line:
+		{
+			return &Evaluate<FNinjaLineGravityPolicy>;
+		}
+
+		case ENinjaGravityDirectionMode::Segment:
+		{
+			return &Evaluate<FNinjaSegmentGravityPolicy>;
+		}
+
+		case ENinjaGravityDirectionMode::Plane:
+		{
+			return &Evaluate<FNinjaPlaneGravityPolicy>;
+		}
+
+		case ENinjaGravityDirectionMode::Box:
+		{
+			return &Evaluate<FNinjaBoxGravityPolicy>;
+		}
+	}
+
+	return nullptr;
+}
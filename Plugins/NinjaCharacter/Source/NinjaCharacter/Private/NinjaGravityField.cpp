@@ -0,0 +1,134 @@
+// "Ninja Character" plugin, by Javier 'Xaklse' Osset; Copyright 2020
+
+
+#include "NinjaGravityField.h"
+
+
+const int32 UNinjaGravityField::MaxDimension = 128;
+
+UNinjaGravityField::UNinjaGravityField(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	Bounds = FBox(ForceInit);
+	Dimensions = FIntVector::ZeroValue;
+}
+
+bool UNinjaGravityField::IsValidField() const
+{
+	return (Bounds.IsValid && Dimensions.X > 1 && Dimensions.Y > 1 && Dimensions.Z > 1 &&
+		Samples.Num() == Dimensions.X * Dimensions.Y * Dimensions.Z);
+}
+
+FVector UNinjaGravityField::SampleGravity(const FVector& Point) const
+{
+	return SampleGravity(Bounds, Dimensions, Samples, Point);
+}
+
+FVector UNinjaGravityField::SampleGravity(const FBox& GridBounds, const FIntVector& GridDimensions,
+	const TArray<uint32>& GridSamples, const FVector& Point)
+{
+	if (!GridBounds.IsValid || GridDimensions.X < 2 || GridDimensions.Y < 2 || GridDimensions.Z < 2 ||
+		GridSamples.Num() != GridDimensions.X * GridDimensions.Y * GridDimensions.Z)
+	{
+		return FVector::ZeroVector;
+	}
+
+	// Transform the point to grid space and clamp it to the grid
+	const FVector GridScale = FVector(GridDimensions - FIntVector(1)) / GridBounds.GetSize();
+	const FVector GridPoint = ((Point - GridBounds.Min) * GridScale).ComponentMax(FVector::ZeroVector).ComponentMin(
+		FVector(GridDimensions - FIntVector(1)));
+
+	const int32 X = FMath::Min(FMath::FloorToInt(GridPoint.X), GridDimensions.X - 2);
+	const int32 Y = FMath::Min(FMath::FloorToInt(GridPoint.Y), GridDimensions.Y - 2);
+	const int32 Z = FMath::Min(FMath::FloorToInt(GridPoint.Z), GridDimensions.Z - 2);
+	const FVector Alpha = GridPoint - FVector(X, Y, Z);
+
+	const int32 StrideY = GridDimensions.X;
+	const int32 StrideZ = GridDimensions.X * GridDimensions.Y;
+	const uint32* Sample = GridSamples.GetData() + (X + Y * StrideY + Z * StrideZ);
+
+	// Trilinear interpolation of the eight samples of the cell
+	const FVector G00 = FMath::Lerp(UnpackSample(Sample[0]), UnpackSample(Sample[1]), Alpha.X);
+	const FVector G10 = FMath::Lerp(UnpackSample(Sample[StrideY]), UnpackSample(Sample[StrideY + 1]), Alpha.X);
+	const FVector G01 = FMath::Lerp(UnpackSample(Sample[StrideZ]), UnpackSample(Sample[StrideZ + 1]), Alpha.X);
+	const FVector G11 = FMath::Lerp(UnpackSample(Sample[StrideZ + StrideY]),
+		UnpackSample(Sample[StrideZ + StrideY + 1]), Alpha.X);
+
+	return FMath::Lerp(FMath::Lerp(G00, G10, Alpha.Y), FMath::Lerp(G01, G11, Alpha.Y), Alpha.Z);
+}
+
+TSharedPtr<const TArray<uint32>, ESPMode::ThreadSafe> UNinjaGravityField::GetSharedSamples() const
+{
+	if (!SharedSamples.IsValid() || SharedSamples->Num() != Samples.Num())
+	{
+		SharedSamples = MakeShared<const TArray<uint32>, ESPMode::ThreadSafe>(Samples);
+	}
+
+	return SharedSamples;
+}
+
+bool UNinjaGravityField::Bake(const FBox& NewBounds, float CellSize, float MaxGravityMagnitude,
+	TFunctionRef<FVector(const FVector&)> GravityFunction)
+{
+	if (!NewBounds.IsValid || CellSize <= 0.0f || MaxGravityMagnitude <= 0.0f)
+	{
+		return false;
+	}
+
+	const FVector Size = NewBounds.GetSize();
+	if (Size.GetMin() <= KINDA_SMALL_NUMBER)
+	{
+		return false;
+	}
+
+	Modify();
+
+	Bounds = NewBounds;
+	SharedSamples.Reset();
+	Dimensions.X = FMath::Clamp(FMath::CeilToInt(Size.X / CellSize) + 1, 2, MaxDimension);
+	Dimensions.Y = FMath::Clamp(FMath::CeilToInt(Size.Y / CellSize) + 1, 2, MaxDimension);
+	Dimensions.Z = FMath::Clamp(FMath::CeilToInt(Size.Z / CellSize) + 1, 2, MaxDimension);
+
+	const FVector CellExtent = Size / FVector(Dimensions - FIntVector(1));
+	const float InvMaxGravityMagnitude = 1.0f / MaxGravityMagnitude;
+
+	Samples.Reset(Dimensions.X * Dimensions.Y * Dimensions.Z);
+	for (int32 Z = 0; Z < Dimensions.Z; ++Z)
+	{
+		for (int32 Y = 0; Y < Dimensions.Y; ++Y)
+		{
+			for (int32 X = 0; X < Dimensions.X; ++X)
+			{
+				const FVector Point = Bounds.Min + CellExtent * FVector(X, Y, Z);
+				Samples.Add(PackSample(GravityFunction(Point) * InvMaxGravityMagnitude));
+			}
+		}
+	}
+
+	return true;
+}
+
+uint32 UNinjaGravityField::PackSample(const FVector& Gravity)
+{
+	const float Strength = FMath::Min(Gravity.Size(), 1.0f);
+	if (Strength < (0.5f / 255.0f))
+	{
+		return 0;
+	}
+
+	const FVector Direction = Gravity.GetUnsafeNormal() * 127.0f;
+	const uint32 DirX = (uint8)(int8)FMath::Clamp(FMath::RoundToInt(Direction.X), -127, 127);
+	const uint32 DirY = (uint8)(int8)FMath::Clamp(FMath::RoundToInt(Direction.Y), -127, 127);
+	const uint32 DirZ = (uint8)(int8)FMath::Clamp(FMath::RoundToInt(Direction.Z), -127, 127);
+	const uint32 Magnitude = (uint8)FMath::Clamp(FMath::RoundToInt(Strength * 255.0f), 0, 255);
+
+	return DirX | (DirY << 8) | (DirZ << 16) | (Magnitude << 24);
+}
+
+FVector UNinjaGravityField::UnpackSample(uint32 Sample)
+{
+	const float Scale = (float)(Sample >> 24) / (255.0f * 127.0f);
+
+	return FVector((float)(int8)(Sample & 0xFF), (float)(int8)((Sample >> 8) & 0xFF),
+		(float)(int8)((Sample >> 16) & 0xFF)) * Scale;
+}
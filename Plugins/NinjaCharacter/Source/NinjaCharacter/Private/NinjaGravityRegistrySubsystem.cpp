@@ -0,0 +1,347 @@
+// "Ninja Character" plugin, by Javier 'Xaklse' Osset; Copyright 2020
+
+
+#include "NinjaGravityRegistrySubsystem.h"
+
+#include "NinjaGravitySourceComponent.h"
+#include "NinjaPhysicsVolume.h"
+
+#include "Components/BrushComponent.h"
+#include "Engine/World.h"
+
+
+/** Maximum number of boxes stored by a leaf node. */
+static const int32 NINJA_BOUNDS_TREE_LEAF_BOXES = 4;
+/** Number of candidate gravity sources stored without heap allocation. */
+static const int32 NINJA_GRAVITY_FIELD_INLINE_SOURCES = 8;
+
+
+void FNinjaBoundsTree::Build(const TArray<FBox>& Bounds)
+{
+	Reset();
+
+	const int32 NumBoxes = Bounds.Num();
+	if (NumBoxes == 0)
+	{
+		return;
+	}
+
+	Indices.Reserve(NumBoxes);
+	for (int32 Index = 0; Index < NumBoxes; ++Index)
+	{
+		Indices.Add(Index);
+	}
+
+	Nodes.Reserve((NumBoxes / NINJA_BOUNDS_TREE_LEAF_BOXES + 1) * 2);
+	Nodes.AddDefaulted();
+	BuildNode(0, 0, NumBoxes, Bounds);
+}
+
+void FNinjaBoundsTree::Reset()
+{
+	Nodes.Reset();
+	Indices.Reset();
+}
+
+void FNinjaBoundsTree::BuildNode(int32 NodeIndex, int32 Start, int32 Count, const TArray<FBox>& Bounds)
+{
+	FBox NodeBounds(ForceInit);
+	FBox CenterBounds(ForceInit);
+	for (int32 Index = Start; Index < Start + Count; ++Index)
+	{
+		NodeBounds += Bounds[Indices[Index]];
+		CenterBounds += Bounds[Indices[Index]].GetCenter();
+	}
+
+	Nodes[NodeIndex].Bounds = NodeBounds;
+
+	if (Count <= NINJA_BOUNDS_TREE_LEAF_BOXES)
+	{
+		Nodes[NodeIndex].FirstIndex = Start;
+		Nodes[NodeIndex].NumBoxes = Count;
+		return;
+	}
+
+	// Split along the longest axis of box centers
+	const FVector CenterExtent = CenterBounds.GetExtent();
+	const int32 Axis = (CenterExtent.X >= CenterExtent.Y && CenterExtent.X >= CenterExtent.Z) ? 0 :
+		((CenterExtent.Y >= CenterExtent.Z) ? 1 : 2);
+
+	TArrayView<int32>(Indices.GetData() + Start, Count).Sort([&Bounds, Axis](int32 A, int32 B)
+	{
+		return Bounds[A].GetCenter()[Axis] < Bounds[B].GetCenter()[Axis];
+	});
+
+	const int32 FirstChild = Nodes.AddDefaulted(2);
+	Nodes[NodeIndex].FirstIndex = FirstChild;
+	Nodes[NodeIndex].NumBoxes = 0;
+
+	const int32 HalfCount = Count / 2;
+	BuildNode(FirstChild, Start, HalfCount, Bounds);
+	BuildNode(FirstChild + 1, Start + HalfCount, Count - HalfCount, Bounds);
+}
+
+UNinjaGravityRegistrySubsystem::UNinjaGravityRegistrySubsystem()
+	: Super()
+{
+	bSourceTreeDirty = false;
+	bVolumeTreeDirty = false;
+	LastSourceRefreshFrame = 0;
+	LastVolumeRefreshFrame = 0;
+}
+
+void UNinjaGravityRegistrySubsystem::Deinitialize()
+{
+	Volumes.Empty();
+	VolumeBounds.Empty();
+	VolumeTree.Reset();
+
+	Sources.Empty();
+	SourceBounds.Empty();
+	SourceTree.Reset();
+
+	Super::Deinitialize();
+}
+
+void UNinjaGravityRegistrySubsystem::RegisterVolume(ANinjaPhysicsVolume* Volume)
+{
+	if (Volume != nullptr && !Volumes.Contains(Volume))
+	{
+		Volumes.Add(Volume);
+		bVolumeTreeDirty = true;
+	}
+}
+
+void UNinjaGravityRegistrySubsystem::UnregisterVolume(ANinjaPhysicsVolume* Volume)
+{
+	// Keep registration order; it breaks ties between equal priorities
+	if (Volume != nullptr && Volumes.Remove(Volume) > 0)
+	{
+		bVolumeTreeDirty = true;
+	}
+}
+
+void UNinjaGravityRegistrySubsystem::UpdateVolume(ANinjaPhysicsVolume* Volume)
+{
+	if (Volume != nullptr && Volumes.Contains(Volume))
+	{
+		bVolumeTreeDirty = true;
+	}
+}
+
+ANinjaPhysicsVolume* UNinjaGravityRegistrySubsystem::FindGravityVolume(const FVector& Point) const
+{
+	UNinjaGravityRegistrySubsystem* MutableThis = const_cast<UNinjaGravityRegistrySubsystem*>(this);
+	MutableThis->RefreshVolumeTree();
+
+	TArray<int32, TInlineAllocator<16>> Candidates;
+	VolumeTree.FindLeafIndices(Point, Candidates);
+
+	ANinjaPhysicsVolume* BestVolume = nullptr;
+	int32 BestVolumeIndex = INDEX_NONE;
+
+	for (const int32 VolumeIndex : Candidates)
+	{
+		ANinjaPhysicsVolume* Volume = Volumes[VolumeIndex];
+		if (Volume == nullptr || !VolumeBounds[VolumeIndex].IsInsideOrOn(Point))
+		{
+			continue;
+		}
+
+		// Only test brush geometry if this volume would win
+		if (BestVolume != nullptr && (Volume->Priority < BestVolume->Priority ||
+			(Volume->Priority == BestVolume->Priority && VolumeIndex > BestVolumeIndex)))
+		{
+			continue;
+		}
+
+		if (Volume->EncompassesPoint(Point))
+		{
+			BestVolume = Volume;
+			BestVolumeIndex = VolumeIndex;
+		}
+	}
+
+	return BestVolume;
+}
+
+FVector UNinjaGravityRegistrySubsystem::GetGravity(const FVector& Point) const
+{
+	const ANinjaPhysicsVolume* Volume = FindGravityVolume(Point);
+	if (Volume != nullptr)
+	{
+		return Volume->GetGravity(Point);
+	}
+
+	const UWorld* World = GetWorld();
+	return FVector(0.0f, 0.0f, (World != nullptr) ? World->GetGravityZ() : 0.0f);
+}
+
+void UNinjaGravityRegistrySubsystem::RegisterSource(UNinjaGravitySourceComponent* Source)
+{
+	if (Source != nullptr && !Sources.Contains(Source))
+	{
+		Sources.Add(Source);
+		bSourceTreeDirty = true;
+	}
+}
+
+void UNinjaGravityRegistrySubsystem::UnregisterSource(UNinjaGravitySourceComponent* Source)
+{
+	if (Source != nullptr && Sources.Remove(Source) > 0)
+	{
+		bSourceTreeDirty = true;
+	}
+}
+
+void UNinjaGravityRegistrySubsystem::UpdateSource(UNinjaGravitySourceComponent* Source)
+{
+	if (Source != nullptr && Sources.Contains(Source))
+	{
+		bSourceTreeDirty = true;
+	}
+}
+
+FVector UNinjaGravityRegistrySubsystem::GetFieldGravity(const FVector& Point) const
+{
+	UNinjaGravityRegistrySubsystem* MutableThis = const_cast<UNinjaGravityRegistrySubsystem*>(this);
+	MutableThis->RefreshSourceTree();
+
+	TArray<int32, TInlineAllocator<NINJA_GRAVITY_FIELD_INLINE_SOURCES>> Candidates;
+	SourceTree.FindLeafIndices(Point, Candidates);
+
+	FVector AccumulatedGravity = FVector::ZeroVector;
+	float AccumulatedWeight = 0.0f;
+
+	for (const int32 SourceIndex : Candidates)
+	{
+		const UNinjaGravitySourceComponent* Source = Sources[SourceIndex];
+		if (Source == nullptr || !SourceBounds[SourceIndex].IsInsideOrOn(Point))
+		{
+			continue;
+		}
+
+		FVector ClosestPoint;
+		if (!Source->GetClosestPoint(Point, ClosestPoint))
+		{
+			continue;
+		}
+
+		const FVector ToSource = ClosestPoint - Point;
+		const float Distance = ToSource.Size();
+		const float SourceWeight = Source->GetInfluenceWeight(Distance);
+		if (SourceWeight <= 0.0f || Distance <= KINDA_SMALL_NUMBER)
+		{
+			continue;
+		}
+
+		AccumulatedGravity += ToSource * (SourceWeight * Source->Strength / Distance);
+		AccumulatedWeight += SourceWeight;
+	}
+
+	// Average overlapping sources, but let a lone source fade out with its falloff
+	return AccumulatedGravity / FMath::Max(AccumulatedWeight, 1.0f);
+}
+
+void UNinjaGravityRegistrySubsystem::RefreshVolumeTree()
+{
+	if (LastVolumeRefreshFrame != GFrameCounter)
+	{
+		LastVolumeRefreshFrame = GFrameCounter;
+
+		// Volumes can be destroyed without unregistering, e.g. when garbage is collected
+		if (Volumes.Remove(nullptr) > 0)
+		{
+			bVolumeTreeDirty = true;
+		}
+
+		if (!bVolumeTreeDirty && Volumes.Num() == VolumeBounds.Num())
+		{
+			for (int32 Index = 0; Index < Volumes.Num(); ++Index)
+			{
+				const ANinjaPhysicsVolume* Volume = Volumes[Index];
+				if (!Volume->IsRootComponentMovable())
+				{
+					continue;
+				}
+
+				const FBox Bounds = GetVolumeBounds(Volume);
+				if (!Bounds.Min.Equals(VolumeBounds[Index].Min) || !Bounds.Max.Equals(VolumeBounds[Index].Max))
+				{
+					bVolumeTreeDirty = true;
+					break;
+				}
+			}
+		}
+	}
+
+	if (!bVolumeTreeDirty)
+	{
+		return;
+	}
+
+	bVolumeTreeDirty = false;
+
+	VolumeBounds.Reset(Volumes.Num());
+	for (const ANinjaPhysicsVolume* Volume : Volumes)
+	{
+		VolumeBounds.Add(GetVolumeBounds(Volume));
+	}
+
+	VolumeTree.Build(VolumeBounds);
+}
+
+FBox UNinjaGravityRegistrySubsystem::GetVolumeBounds(const ANinjaPhysicsVolume* Volume)
+{
+	const UBrushComponent* Brush = (Volume != nullptr) ? Volume->GetBrushComponent() : nullptr;
+
+	return (Brush != nullptr) ? Brush->Bounds.GetBox() : FBox(ForceInit);
+}
+
+void UNinjaGravityRegistrySubsystem::RefreshSourceTree()
+{
+	if (LastSourceRefreshFrame != GFrameCounter)
+	{
+		LastSourceRefreshFrame = GFrameCounter;
+
+		if (Sources.Remove(nullptr) > 0)
+		{
+			bSourceTreeDirty = true;
+		}
+
+		// Sources attached to orbiting or moving Actors change their bounds often
+		if (!bSourceTreeDirty && Sources.Num() == SourceBounds.Num())
+		{
+			for (int32 Index = 0; Index < Sources.Num(); ++Index)
+			{
+				const UNinjaGravitySourceComponent* Source = Sources[Index];
+				if (Source->Mobility != EComponentMobility::Movable)
+				{
+					continue;
+				}
+
+				const FBox Bounds = Source->GetInfluenceBounds();
+				if (!Bounds.Min.Equals(SourceBounds[Index].Min) || !Bounds.Max.Equals(SourceBounds[Index].Max))
+				{
+					bSourceTreeDirty = true;
+					break;
+				}
+			}
+		}
+	}
+
+	if (!bSourceTreeDirty)
+	{
+		return;
+	}
+
+	bSourceTreeDirty = false;
+
+	SourceBounds.Reset(Sources.Num());
+	for (const UNinjaGravitySourceComponent* Source : Sources)
+	{
+		SourceBounds.Add(Source->GetInfluenceBounds());
+	}
+
+	SourceTree.Build(SourceBounds);
+}
@@ -0,0 +1,336 @@
+// "Ninja Character" plugin, by Javier 'Xaklse' Osset; Copyright 2020
+
+
+#include "NinjaGravitySnapshot.h"
+
+#include "NinjaCharacterMovementComponent.h"
+#include "NinjaGravityField.h"
+#include "NinjaPhysicsVolume.h"
+
+#include "Components/SplineComponent.h"
+
+
+const int32 FNinjaGravitySplineSamples::SamplesPerSegment = 8;
+const int32 FNinjaGravitySplineSamples::MaxSamples = 2048;
+
+FNinjaGravitySplineSamples::FNinjaGravitySplineSamples()
+	: SplineId(nullptr)
+	, SplineVersion(0)
+	, SplineTransform(FTransform::Identity)
+{
+}
+
+TSharedPtr<const FNinjaGravitySplineSamples, ESPMode::ThreadSafe> FNinjaGravitySplineSamples::Sample(
+	const USplineComponent* Spline, const TSharedPtr<const FNinjaGravitySplineSamples, ESPMode::ThreadSafe>& PreviousSamples)
+{
+	if (Spline == nullptr)
+	{
+		return nullptr;
+	}
+
+	if (PreviousSamples.IsValid() && PreviousSamples->SplineId == Spline &&
+		PreviousSamples->SplineVersion == Spline->SplineCurves.Version &&
+		PreviousSamples->SplineTransform.Equals(Spline->GetComponentTransform(), KINDA_SMALL_NUMBER))
+	{
+		return PreviousSamples;
+	}
+
+	TSharedRef<FNinjaGravitySplineSamples, ESPMode::ThreadSafe> NewSamples =
+		MakeShared<FNinjaGravitySplineSamples, ESPMode::ThreadSafe>();
+	NewSamples->SplineId = Spline;
+	NewSamples->SplineVersion = Spline->SplineCurves.Version;
+	NewSamples->SplineTransform = Spline->GetComponentTransform();
+
+	const int32 NumSegments = Spline->GetNumberOfSplineSegments();
+	const int32 NumSamples = FMath::Clamp(NumSegments * SamplesPerSegment + 1, 1, MaxSamples);
+	const float InputKeyStep = (NumSamples > 1) ? (float)NumSegments / (float)(NumSamples - 1) : 0.0f;
+
+	NewSamples->Locations.Reserve(NumSamples);
+	NewSamples->Directions.Reserve(NumSamples);
+	NewSamples->UpVectors.Reserve(NumSamples);
+
+	for (int32 Index = 0; Index < NumSamples; ++Index)
+	{
+		const float InputKey = InputKeyStep * Index;
+		NewSamples->Locations.Add(Spline->GetLocationAtSplineInputKey(InputKey, ESplineCoordinateSpace::World));
+		NewSamples->Directions.Add(Spline->GetDirectionAtSplineInputKey(InputKey, ESplineCoordinateSpace::World));
+		NewSamples->UpVectors.Add(Spline->GetUpVectorAtSplineInputKey(InputKey, ESplineCoordinateSpace::World));
+	}
+
+	return NewSamples;
+}
+
+bool FNinjaGravitySplineSamples::FindClosest(const FVector& Point, FVector& OutLocation, FVector& OutDirection,
+	FVector& OutUpVector) const
+{
+	if (Locations.Num() == 0)
+	{
+		return false;
+	}
+
+	int32 ClosestIndex = 0;
+	float ClosestAlpha = 0.0f;
+	float ClosestDistanceSquared = FVector::DistSquared(Point, Locations[0]);
+
+	// Visit every sampled segment; samples are few and contiguous in memory
+	for (int32 Index = 1; Index < Locations.Num(); ++Index)
+	{
+		const FVector SegmentStart = Locations[Index - 1];
+		const FVector Segment = Locations[Index] - SegmentStart;
+		const float SegmentSizeSquared = Segment.SizeSquared();
+		const float Alpha = (SegmentSizeSquared > SMALL_NUMBER) ?
+			FMath::Clamp(((Point - SegmentStart) | Segment) / SegmentSizeSquared, 0.0f, 1.0f) : 0.0f;
+		const float DistanceSquared = FVector::DistSquared(Point, SegmentStart + Segment * Alpha);
+
+		if (DistanceSquared < ClosestDistanceSquared)
+		{
+			ClosestIndex = Index - 1;
+			ClosestAlpha = Alpha;
+			ClosestDistanceSquared = DistanceSquared;
+		}
+	}
+
+	const int32 NextIndex = FMath::Min(ClosestIndex + 1, Locations.Num() - 1);
+	OutLocation = FMath::Lerp(Locations[ClosestIndex], Locations[NextIndex], ClosestAlpha);
+	OutDirection = FMath::Lerp(Directions[ClosestIndex], Directions[NextIndex], ClosestAlpha).GetSafeNormal();
+	OutUpVector = FMath::Lerp(UpVectors[ClosestIndex], UpVectors[NextIndex], ClosestAlpha).GetSafeNormal();
+
+	return true;
+}
+
+FNinjaGravitySnapshot::FNinjaGravitySnapshot()
+	: Mode(ENinjaGravityDirectionMode::Fixed)
+	, DirectionFunc(nullptr)
+	, VectorA(FVector::DownVector)
+	, VectorB(FVector::ZeroVector)
+	, Scale(1.0f)
+	, Magnitude(0.0f)
+	, EngineGravityZ(0.0f)
+	, Direction(FVector::ZeroVector)
+	, Transform(FTransform::Identity)
+	, FieldBounds(ForceInit)
+	, FieldDimensions(FIntVector::ZeroValue)
+	, Frame(0)
+{
+}
+
+FVector FNinjaGravitySnapshot::GetGravity(const FVector& Point) const
+{
+	if (Scale == 0.0f)
+	{
+		return FVector::ZeroVector;
+	}
+
+	float Strength = 1.0f;
+	const FVector GravityDir = EvaluateDirection(Point, Strength);
+
+	return GravityDir * (Magnitude * Strength * Scale);
+}
+
+FVector FNinjaGravitySnapshot::GetGravityDirection(const FVector& Point) const
+{
+	if (Scale == 0.0f)
+	{
+		return FVector::ZeroVector;
+	}
+
+	float Strength = 1.0f;
+	return EvaluateDirection(Point, Strength) * ((Scale > 0.0f) ? 1.0f : -1.0f);
+}
+
+FNinjaGravitySnapshotPtr FNinjaGravitySnapshot::Read(const UNinjaCharacterMovementComponent* Component)
+{
+	return (Component != nullptr) ? Component->GetGravitySnapshotBuffer().Read() : FNinjaGravitySnapshotPtr();
+}
+
+FNinjaGravitySnapshotPtr FNinjaGravitySnapshot::Read(const ANinjaPhysicsVolume* Volume)
+{
+	return (Volume != nullptr) ? Volume->GetGravitySnapshotBuffer().Read() : FNinjaGravitySnapshotPtr();
+}
+
+FVector FNinjaGravitySnapshot::EvaluateDirection(const FVector& Point, float& OutStrength) const
+{
+	OutStrength = 1.0f;
+
+	if (DirectionFunc != nullptr)
+	{
+		return DirectionFunc(VectorA, VectorB, Point);
+	}
+
+	switch (Mode)
+	{
+		case ENinjaGravityDirectionMode::SplineTangent:
+		case ENinjaGravityDirectionMode::Spline:
+		case ENinjaGravityDirectionMode::SplinePlane:
+		{
+			FVector ClosestLocation, ClosestDirection, ClosestUpVector;
+			if (!Spline.IsValid() || !Spline->FindClosest(Point, ClosestLocation, ClosestDirection, ClosestUpVector))
+			{
+				return Direction;
+			}
+
+			if (Mode == ENinjaGravityDirectionMode::SplineTangent)
+			{
+				return ClosestDirection;
+			}
+
+			if (Mode == ENinjaGravityDirectionMode::SplinePlane)
+			{
+				ClosestLocation = FVector::PointPlaneProject(Point, ClosestLocation, ClosestUpVector);
+			}
+
+			return (ClosestLocation - Point).GetSafeNormal();
+		}
+
+		case ENinjaGravityDirectionMode::Collision:
+		{
+			// Last closest point of collision geometry is treated as a gravity point
+			return FNinjaPointGravityPolicy::GetDirection(VectorA, VectorB, Point);
+		}
+
+		case ENinjaGravityDirectionMode::Baked:
+		{
+			if (!FieldSamples.IsValid())
+			{
+				return Direction;
+			}
+
+			// Baked samples also store relative strength of gravity
+			const FVector BakedGravity = UNinjaGravityField::SampleGravity(FieldBounds, FieldDimensions,
+				*FieldSamples, Point);
+			OutStrength = BakedGravity.Size();
+
+			return (OutStrength > KINDA_SMALL_NUMBER) ? BakedGravity / OutStrength : FVector::ZeroVector;
+		}
+	}
+
+	return Direction;
+}
+
+FNinjaGravitySnapshotPtr::FNinjaGravitySnapshotPtr()
+	: Snapshot(nullptr)
+	, ReaderCount(nullptr)
+{
+}
+
+FNinjaGravitySnapshotPtr::FNinjaGravitySnapshotPtr(const FNinjaGravitySnapshot* InSnapshot, TAtomic<int32>* InReaderCount)
+	: Snapshot(InSnapshot)
+	, ReaderCount(InReaderCount)
+{
+}
+
+FNinjaGravitySnapshotPtr::FNinjaGravitySnapshotPtr(FNinjaGravitySnapshotPtr&& Other)
+	: Snapshot(Other.Snapshot)
+	, ReaderCount(Other.ReaderCount)
+{
+	Other.Snapshot = nullptr;
+	Other.ReaderCount = nullptr;
+}
+
+FNinjaGravitySnapshotPtr& FNinjaGravitySnapshotPtr::operator=(FNinjaGravitySnapshotPtr&& Other)
+{
+	if (this != &Other)
+	{
+		Reset();
+
+		Snapshot = Other.Snapshot;
+		ReaderCount = Other.ReaderCount;
+		Other.Snapshot = nullptr;
+		Other.ReaderCount = nullptr;
+	}
+
+	return *this;
+}
+
+FNinjaGravitySnapshotPtr::~FNinjaGravitySnapshotPtr()
+{
+	Reset();
+}
+
+void FNinjaGravitySnapshotPtr::Reset()
+{
+	if (ReaderCount != nullptr)
+	{
+		// Slot can be written again once every reader is gone
+		--(*ReaderCount);
+	}
+
+	Snapshot = nullptr;
+	ReaderCount = nullptr;
+}
+
+FNinjaGravitySnapshotBuffer::FNinjaGravitySnapshotBuffer()
+	: PublishedIndex(INDEX_NONE)
+	, WriteIndex(INDEX_NONE)
+{
+	for (TAtomic<int32>& ReaderCount : ReaderCounts)
+	{
+		ReaderCount = 0;
+	}
+}
+
+FNinjaGravitySnapshot* FNinjaGravitySnapshotBuffer::BeginWrite()
+{
+	const int32 CurrentIndex = PublishedIndex.Load();
+
+	// Never write memory that a reader could be copying
+	WriteIndex = INDEX_NONE;
+	for (int32 Index = 0; Index < NumSlots; ++Index)
+	{
+		if (Index != CurrentIndex && ReaderCounts[Index].Load() == 0)
+		{
+			WriteIndex = Index;
+			break;
+		}
+	}
+
+	return (WriteIndex != INDEX_NONE) ? &Slots[WriteIndex] : nullptr;
+}
+
+void FNinjaGravitySnapshotBuffer::Publish()
+{
+	if (WriteIndex == INDEX_NONE)
+	{
+		return;
+	}
+
+	// Sequentially consistent store, slot contents are visible before its index
+	PublishedIndex = WriteIndex;
+	WriteIndex = INDEX_NONE;
+}
+
+FNinjaGravitySnapshotPtr FNinjaGravitySnapshotBuffer::Read() const
+{
+	while (true)
+	{
+		const int32 Index = PublishedIndex.Load();
+		if (Index == INDEX_NONE)
+		{
+			return FNinjaGravitySnapshotPtr();
+		}
+
+		// Pin the slot, then make sure it wasn't unpublished before the pin was visible to the writer
+		++ReaderCounts[Index];
+		if (PublishedIndex.Load() == Index)
+		{
+			return FNinjaGravitySnapshotPtr(&Slots[Index], &ReaderCounts[Index]);
+		}
+
+		--ReaderCounts[Index];
+	}
+}
+
+void FNinjaGravitySnapshotBuffer::Reset()
+{
+	PublishedIndex = INDEX_NONE;
+	WriteIndex = INDEX_NONE;
+
+	// Release shared data of slots nobody reads; pinned ones are released when written again
+	for (int32 Index = 0; Index < NumSlots; ++Index)
+	{
+		if (ReaderCounts[Index].Load() == 0)
+		{
+			Slots[Index] = FNinjaGravitySnapshot();
+		}
+	}
+}
@@ -0,0 +1,192 @@
+// "Ninja Character" plugin, by Javier 'Xaklse' Osset; Copyright 2020
+
+
+#include "NinjaGravitySourceComponent.h"
+
+#include "NinjaGravityRegistrySubsystem.h"
+
+#include "Components/SplineComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+
+
+UNinjaGravitySourceComponent::UNinjaGravitySourceComponent(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	BoxExtent = FVector(500.0f);
+	FalloffDistance = 1000.0f;
+	GravitySpline = nullptr;
+	InfluenceRadius = 2000.0f;
+	LineLength = 1000.0f;
+	Shape = ENinjaGravitySourceShape::Point;
+	Strength = 1.0f;
+	Weight = 1.0f;
+}
+
+void UNinjaGravitySourceComponent::OnRegister()
+{
+	Super::OnRegister();
+
+	UpdateGravitySpline();
+
+	UWorld* World = GetWorld();
+	UNinjaGravityRegistrySubsystem* GravityRegistry = (World != nullptr) ?
+		World->GetSubsystem<UNinjaGravityRegistrySubsystem>() : nullptr;
+	if (GravityRegistry != nullptr)
+	{
+		GravityRegistry->RegisterSource(this);
+	}
+}
+
+void UNinjaGravitySourceComponent::OnUnregister()
+{
+	UWorld* World = GetWorld();
+	UNinjaGravityRegistrySubsystem* GravityRegistry = (World != nullptr) ?
+		World->GetSubsystem<UNinjaGravityRegistrySubsystem>() : nullptr;
+	if (GravityRegistry != nullptr)
+	{
+		GravityRegistry->UnregisterSource(this);
+	}
+
+	Super::OnUnregister();
+}
+
+#if WITH_EDITOR
+void UNinjaGravitySourceComponent::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	UpdateGravitySpline();
+	NotifyRegistry();
+}
+#endif // WITH_EDITOR
+
+FBox UNinjaGravitySourceComponent::GetInfluenceBounds() const
+{
+	FBox Bounds(ForceInit);
+
+	switch (Shape)
+	{
+		case ENinjaGravitySourceShape::Point:
+		{
+			Bounds += GetComponentLocation();
+			break;
+		}
+
+		case ENinjaGravitySourceShape::Line:
+		{
+			const FVector HalfLine = GetForwardVector() * (LineLength * 0.5f);
+			Bounds += GetComponentLocation() - HalfLine;
+			Bounds += GetComponentLocation() + HalfLine;
+			break;
+		}
+
+		case ENinjaGravitySourceShape::Spline:
+		{
+			if (GravitySpline != nullptr)
+			{
+				Bounds = GravitySpline->Bounds.GetBox();
+			}
+
+			break;
+		}
+
+		case ENinjaGravitySourceShape::Box:
+		{
+			Bounds = FBox(-BoxExtent, BoxExtent).TransformBy(GetComponentTransform());
+			break;
+		}
+	}
+
+	return Bounds.IsValid ? Bounds.ExpandBy(InfluenceRadius) : Bounds;
+}
+
+bool UNinjaGravitySourceComponent::GetClosestPoint(const FVector& Point, FVector& OutClosestPoint) const
+{
+	switch (Shape)
+	{
+		case ENinjaGravitySourceShape::Point:
+		{
+			OutClosestPoint = GetComponentLocation();
+			return true;
+		}
+
+		case ENinjaGravitySourceShape::Line:
+		{
+			const FVector HalfLine = GetForwardVector() * (LineLength * 0.5f);
+			OutClosestPoint = FMath::ClosestPointOnLine(GetComponentLocation() - HalfLine,
+				GetComponentLocation() + HalfLine, Point);
+			return true;
+		}
+
+		case ENinjaGravitySourceShape::Spline:
+		{
+			if (GravitySpline == nullptr)
+			{
+				return false;
+			}
+
+			if (!GravitySplineTree.IsBuiltFor(GravitySpline))
+			{
+				// Spline could be modified at runtime
+				UNinjaGravitySourceComponent* MutableThis = const_cast<UNinjaGravitySourceComponent*>(this);
+				MutableThis->GravitySplineTree.Build(GravitySpline);
+			}
+
+			OutClosestPoint = GravitySpline->GetLocationAtSplineInputKey(
+				GravitySplineTree.FindInputKeyClosestToWorldLocation(GravitySpline, Point),
+				ESplineCoordinateSpace::Type::World);
+			return true;
+		}
+
+		case ENinjaGravitySourceShape::Box:
+		{
+			const FTransform& Transform = GetComponentTransform();
+			OutClosestPoint = Transform.TransformPosition(FBox(-BoxExtent, BoxExtent).GetClosestPointTo(
+				Transform.InverseTransformPosition(Point)));
+			return true;
+		}
+	}
+
+	return false;
+}
+
+float UNinjaGravitySourceComponent::GetInfluenceWeight(float Distance) const
+{
+	if (Distance >= InfluenceRadius)
+	{
+		return 0.0f;
+	}
+
+	const float FalloffStart = InfluenceRadius - FalloffDistance;
+	if (Distance <= FalloffStart)
+	{
+		return Weight;
+	}
+
+	// Smooth fade avoids sudden changes of direction at the edge of influence
+	return Weight * (1.0f - FMath::SmoothStep(FalloffStart, InfluenceRadius, Distance));
+}
+
+void UNinjaGravitySourceComponent::UpdateGravitySpline()
+{
+	GravitySpline = Cast<USplineComponent>(GetAttachParent());
+
+	if (GravitySpline == nullptr && GetOwner() != nullptr)
+	{
+		GravitySpline = GetOwner()->FindComponentByClass<USplineComponent>();
+	}
+
+	GravitySplineTree.Reset();
+}
+
+void UNinjaGravitySourceComponent::NotifyRegistry()
+{
+	UWorld* World = GetWorld();
+	UNinjaGravityRegistrySubsystem* GravityRegistry = (World != nullptr) ?
+		World->GetSubsystem<UNinjaGravityRegistrySubsystem>() : nullptr;
+	if (GravityRegistry != nullptr)
+	{
+		GravityRegistry->UpdateSource(this);
+	}
+}
@@ -0,0 +1,215 @@
+// "Ninja Character" plugin, by Javier 'Xaklse' Osset; Copyright 2020
+
+
+#include "NinjaGravityState.h"
+
+#include "NinjaGravityField.h"
+
+#include "Engine/NetSerialization.h"
+#include "GameFramework/Actor.h"
+
+
+FNinjaGravityState::FNinjaGravityState()
+	: Mode(ENinjaGravityDirectionMode::Fixed)
+	, VectorA(FVector::DownVector)
+	, VectorB(FVector::ZeroVector)
+	, Actor(nullptr)
+	, Field(nullptr)
+	, Scale(1.0f)
+	, bFromVolume(false)
+{
+}
+
+bool FNinjaGravityState::IsNearlyEqual(const FNinjaGravityState& Other, float MaxAngleCosine, float MaxDistance) const
+{
+	if (bFromVolume || Other.bFromVolume)
+	{
+		return bFromVolume == Other.bFromVolume;
+	}
+
+	if (Mode != Other.Mode || Actor != Other.Actor || Field != Other.Field ||
+		!FMath::IsNearlyEqual(Scale, Other.Scale, KINDA_SMALL_NUMBER))
+	{
+		return false;
+	}
+
+	if (UsesActor())
+	{
+		return true;
+	}
+
+	const float MaxDistanceSquared = FMath::Square(MaxDistance);
+
+	switch (Mode)
+	{
+		case ENinjaGravityDirectionMode::Fixed:
+		{
+			return (VectorA | Other.VectorA) >= MaxAngleCosine;
+		}
+
+		case ENinjaGravityDirectionMode::Plane:
+		{
+			return (FVector::DistSquared(VectorA, Other.VectorA) <= MaxDistanceSquared &&
+				(VectorB | Other.VectorB) >= MaxAngleCosine);
+		}
+
+		case ENinjaGravityDirectionMode::Point:
+		case ENinjaGravityDirectionMode::Line:
+		case ENinjaGravityDirectionMode::Segment:
+		case ENinjaGravityDirectionMode::Box:
+		{
+			return (FVector::DistSquared(VectorA, Other.VectorA) <= MaxDistanceSquared &&
+				FVector::DistSquared(VectorB, Other.VectorB) <= MaxDistanceSquared);
+		}
+	}
+
+	return true;
+}
+
+bool FNinjaGravityState::UsesActor() const
+{
+	switch (Mode)
+	{
+		case ENinjaGravityDirectionMode::SplineTangent:
+		case ENinjaGravityDirectionMode::Spline:
+		case ENinjaGravityDirectionMode::SplinePlane:
+		case ENinjaGravityDirectionMode::Collision:
+		{
+			return true;
+		}
+
+		case ENinjaGravityDirectionMode::Point:
+		case ENinjaGravityDirectionMode::Box:
+		{
+			return Actor != nullptr;
+		}
+	}
+
+	return false;
+}
+
+bool FNinjaGravityState::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	bOutSuccess = true;
+
+	// Gravity settings provided by the physics volume don't need anything else
+	uint8 bVolumeBit = bFromVolume ? 1 : 0;
+	Ar.SerializeBits(&bVolumeBit, 1);
+
+	if (bVolumeBit != 0)
+	{
+		if (Ar.IsLoading())
+		{
+			*this = FNinjaGravityState();
+			bFromVolume = true;
+		}
+
+		return true;
+	}
+	else if (Ar.IsLoading())
+	{
+		bFromVolume = false;
+	}
+
+	// All gravity modes fit in 5 bits
+	uint8 ModeBits = (uint8)Mode;
+	Ar.SerializeBits(&ModeBits, 5);
+
+	// Default gravity scale is the most common one
+	uint8 bDefaultScale = (Scale == 1.0f) ? 1 : 0;
+	Ar.SerializeBits(&bDefaultScale, 1);
+
+	// Point and Box modes can use either an Actor or vectors
+	uint8 bHasActor = (Actor != nullptr) ? 1 : 0;
+
+	if (Ar.IsLoading())
+	{
+		Mode = (ENinjaGravityDirectionMode)ModeBits;
+		VectorA = FVector::ZeroVector;
+		VectorB = FVector::ZeroVector;
+		Actor = nullptr;
+		Field = nullptr;
+		Scale = 1.0f;
+	}
+
+	if (bDefaultScale == 0)
+	{
+		Ar << Scale;
+	}
+
+	switch (Mode)
+	{
+		case ENinjaGravityDirectionMode::Fixed:
+		{
+			bOutSuccess &= SerializeFixedVector<1, 16>(VectorA, Ar);
+			break;
+		}
+
+		case ENinjaGravityDirectionMode::SplineTangent:
+		case ENinjaGravityDirectionMode::Spline:
+		case ENinjaGravityDirectionMode::SplinePlane:
+		case ENinjaGravityDirectionMode::Collision:
+		{
+			UObject* Object = Actor;
+			bOutSuccess &= Map->SerializeObject(Ar, AActor::StaticClass(), Object);
+			Actor = Cast<AActor>(Object);
+			break;
+		}
+
+		case ENinjaGravityDirectionMode::Point:
+		case ENinjaGravityDirectionMode::Box:
+		{
+			Ar.SerializeBits(&bHasActor, 1);
+
+			if (bHasActor != 0)
+			{
+				UObject* Object = Actor;
+				bOutSuccess &= Map->SerializeObject(Ar, AActor::StaticClass(), Object);
+				Actor = Cast<AActor>(Object);
+			}
+			else
+			{
+				bOutSuccess &= SerializePackedVector<10, 24>(VectorA, Ar);
+
+				if (Mode == ENinjaGravityDirectionMode::Box)
+				{
+					bOutSuccess &= SerializePackedVector<10, 24>(VectorB, Ar);
+				}
+			}
+
+			break;
+		}
+
+		case ENinjaGravityDirectionMode::Line:
+		case ENinjaGravityDirectionMode::Segment:
+		{
+			bOutSuccess &= SerializePackedVector<10, 24>(VectorA, Ar);
+			bOutSuccess &= SerializePackedVector<10, 24>(VectorB, Ar);
+			break;
+		}
+
+		case ENinjaGravityDirectionMode::Plane:
+		{
+			bOutSuccess &= SerializePackedVector<10, 24>(VectorA, Ar);
+			bOutSuccess &= SerializeFixedVector<1, 16>(VectorB, Ar);
+			break;
+		}
+
+		case ENinjaGravityDirectionMode::Baked:
+		{
+			UObject* Object = Field;
+			bOutSuccess &= Map->SerializeObject(Ar, UNinjaGravityField::StaticClass(), Object);
+			Field = Cast<UNinjaGravityField>(Object);
+			break;
+		}
+	}
+
+	return true;
+}
+
+bool FNinjaGravityState::operator==(const FNinjaGravityState& Other) const
+{
+	return (Mode == Other.Mode && VectorA == Other.VectorA && VectorB == Other.VectorB &&
+		Actor == Other.Actor && Field == Other.Field && Scale == Other.Scale &&
+		bFromVolume == Other.bFromVolume);
+}
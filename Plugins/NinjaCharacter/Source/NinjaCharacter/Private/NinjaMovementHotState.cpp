@@ -0,0 +1,28 @@
+// "Ninja Character" plugin, by Javier 'Xaklse' Osset; Copyright 2020
+
+
+#include "NinjaMovementHotState.h"
+
+
+static_assert(sizeof(FNinjaMovementHotState) <= 2 * PLATFORM_CACHE_LINE_SIZE,
+	"FNinjaMovementHotState should fit in two cache lines.");
+
+FNinjaMovementHotState::FNinjaMovementHotState()
+	: GravityCacheFrame(0)
+	, GroupVolumeGravityFrame(0)
+	, IncrementalRotationFrame(0)
+	, GravityDirectionFunc(FNinjaGravityEvaluator::Find(ENinjaGravityDirectionMode::Fixed))
+	, GravityCacheLocation(FVector::ZeroVector)
+	, GravityCacheDirection(FVector::DownVector)
+	, GravityCacheMagnitude(0.0f)
+	, GroupVolumeGravityZ(0.0f)
+	, OldGravityScale(1.0f)
+	, ThresholdOrthogonalCosine(0.0f)
+	, ThresholdParallelCosine(1.0f)
+	, IncrementalRotationBudgetCosine(1.0f)
+	, IncrementalRotationReleaseCosine(1.0f)
+	, bGravityCacheValid(false)
+	, bDirtyGravityDirection(false)
+	, bIncrementalRotationActive(false)
+{
+}
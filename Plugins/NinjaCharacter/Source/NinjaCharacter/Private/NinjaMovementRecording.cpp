@@ -0,0 +1,419 @@
+// "Ninja Character" plugin, by Javier 'Xaklse' Osset; Copyright 2020
+
+
+#include "NinjaMovementRecording.h"
+
+#include "NinjaCharacter.h"
+#include "NinjaCharacterMovementComponent.h"
+#include "NinjaGravityField.h"
+#include "NinjaGravityState.h"
+
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/Compression.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "UObject/UObjectIterator.h"
+
+
+DEFINE_LOG_CATEGORY_STATIC(LogNinjaMovementRecording, Log, All);
+
+namespace NinjaMovementRecording
+{
+	/** Identifies files of movement recordings. */
+	static const uint32 FileMagic = 0x434D524E;
+
+	/** Version of the file format. */
+	static const int32 FileVersion = 1;
+
+#if !UE_BUILD_SHIPPING
+	/**
+	 * Handles the Ninja.Record.Start console command.
+	 * @param Args - arguments of the command
+	 * @param World - world where the command runs
+	 */
+	static void ExecStartCommand(const TArray<FString>& Args, UWorld* World)
+	{
+		if (World == nullptr)
+		{
+			return;
+		}
+
+		for (TObjectIterator<UNinjaCharacterMovementComponent> It; It; ++It)
+		{
+			if (It->GetWorld() == World && !It->IsPendingKill() && It->GetOwnerRole() != ROLE_SimulatedProxy)
+			{
+				It->StartMovementRecording();
+			}
+		}
+	}
+
+	/**
+	 * Handles the Ninja.Record.Stop console command.
+	 * @param Args - arguments of the command
+	 * @param World - world where the command runs
+	 */
+	static void ExecStopCommand(const TArray<FString>& Args, UWorld* World)
+	{
+		if (World == nullptr)
+		{
+			return;
+		}
+
+		const FString Directory = FPaths::ProfilingDir() / TEXT("NinjaRecordings");
+		const FString DateString = FDateTime::Now().ToString();
+
+		for (TObjectIterator<UNinjaCharacterMovementComponent> It; It; ++It)
+		{
+			if (It->GetWorld() != World || !It->IsRecordingMovement())
+			{
+				continue;
+			}
+
+			TSharedPtr<FNinjaMovementRecording> Recording = It->StopMovementRecording();
+
+			const FString FileName = Directory / FString::Printf(TEXT("%s-%s-%s.nmr"),
+				*GetNameSafe(It->GetOwner()), (World->GetNetMode() == NM_Client) ? TEXT("Client") : TEXT("Server"),
+				*DateString);
+
+			if (Recording.IsValid() && Recording->SaveToFile(FileName))
+			{
+				UE_LOG(LogNinjaMovementRecording, Log, TEXT("Saved %d moves and %d corrections to %s"),
+					Recording->Moves.Num(), Recording->Corrections.Num(), *FileName);
+			}
+			else
+			{
+				UE_LOG(LogNinjaMovementRecording, Warning, TEXT("Movement recording couldn't be saved to %s"), *FileName);
+			}
+		}
+	}
+
+	/**
+	 * Handles the Ninja.Replay console command.
+	 * @param Args - arguments of the command
+	 * @param World - world where the command runs
+	 */
+	static void ExecReplayCommand(const TArray<FString>& Args, UWorld* World)
+	{
+		if (World == nullptr)
+		{
+			return;
+		}
+
+		const FString Params = FString::Join(Args, TEXT(" "));
+
+		FString FileName;
+		float Tolerance = 1.0f;
+		FParse::Value(*Params, TEXT("File="), FileName);
+		FParse::Value(*Params, TEXT("Tolerance="), Tolerance);
+
+		FNinjaMovementRecording Recording;
+		if (!Recording.LoadFromFile(FileName))
+		{
+			UE_LOG(LogNinjaMovementRecording, Warning, TEXT("Movement recording couldn't be loaded from %s"), *FileName);
+		}
+		else
+		{
+			ANinjaCharacter* Character = Recording.SpawnReplayCharacter(World);
+			if (Character == nullptr)
+			{
+				UE_LOG(LogNinjaMovementRecording, Warning, TEXT("Replay character couldn't be spawned for %s"), *FileName);
+			}
+			else
+			{
+				FNinjaMovementReplayReport Report;
+				Character->GetNinjaCharacterMovement()->ReplayMovementRecording(Recording, Tolerance, Report);
+				Character->Destroy();
+
+				UE_LOG(LogNinjaMovementRecording, Log, TEXT("Replayed %s: %s, %d recorded corrections"),
+					*FileName, *Report.ToString(), Recording.Corrections.Num());
+			}
+		}
+
+		if (FParse::Param(*Params, TEXT("Quit")))
+		{
+			FPlatformMisc::RequestExit(false);
+		}
+	}
+
+	FAutoConsoleCommandWithWorldAndArgs CmdRecordStart(TEXT("Ninja.Record.Start"),
+		TEXT("Starts recording moves of every locally simulated Ninja character movement component."),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&ExecStartCommand));
+
+	FAutoConsoleCommandWithWorldAndArgs CmdRecordStop(TEXT("Ninja.Record.Stop"),
+		TEXT("Stops recording moves and saves recordings to the profiling directory."),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&ExecStopCommand));
+
+	FAutoConsoleCommandWithWorldAndArgs CmdReplay(TEXT("Ninja.Replay"),
+		TEXT("Re-simulates a movement recording and compares results. Arguments: File=<path> Tolerance=1.0 Quit"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&ExecReplayCommand));
+#endif // !UE_BUILD_SHIPPING
+}
+
+FNinjaRecordedGravityState::FNinjaRecordedGravityState()
+	: MoveIndex(0)
+	, Mode(ENinjaGravityDirectionMode::Fixed)
+	, VectorA(FVector::ZeroVector)
+	, VectorB(FVector::ZeroVector)
+	, Scale(1.0f)
+	, ActorName(NAME_None)
+{
+}
+
+void FNinjaRecordedGravityState::Set(const FNinjaGravityState& GravityState)
+{
+	Mode = GravityState.Mode;
+	VectorA = GravityState.VectorA;
+	VectorB = GravityState.VectorB;
+	Scale = GravityState.Scale;
+	ActorName = (GravityState.Actor != nullptr) ? GravityState.Actor->GetFName() : NAME_None;
+	FieldPath = FSoftObjectPath(GravityState.Field);
+}
+
+bool FNinjaRecordedGravityState::Resolve(UWorld* World, FNinjaGravityState& OutGravityState) const
+{
+	OutGravityState.Mode = Mode;
+	OutGravityState.VectorA = VectorA;
+	OutGravityState.VectorB = VectorB;
+	OutGravityState.Scale = Scale;
+	OutGravityState.Actor = nullptr;
+	OutGravityState.Field = nullptr;
+
+	bool bResolved = true;
+
+	if (ActorName != NAME_None)
+	{
+		for (TActorIterator<AActor> It(World); It; ++It)
+		{
+			if (It->GetFName() == ActorName)
+			{
+				OutGravityState.Actor = *It;
+				break;
+			}
+		}
+
+		bResolved = OutGravityState.Actor != nullptr;
+	}
+
+	if (FieldPath.IsValid())
+	{
+		OutGravityState.Field = Cast<UNinjaGravityField>(FieldPath.TryLoad());
+		bResolved &= OutGravityState.Field != nullptr;
+	}
+
+	return bResolved;
+}
+
+FArchive& operator<<(FArchive& Ar, FNinjaRecordedGravityState& GravityState)
+{
+	Ar << GravityState.MoveIndex;
+	Ar << GravityState.Mode;
+	Ar << GravityState.VectorA;
+	Ar << GravityState.VectorB;
+	Ar << GravityState.Scale;
+	Ar << GravityState.ActorName;
+	Ar << GravityState.FieldPath;
+
+	return Ar;
+}
+
+FNinjaRecordedMove::FNinjaRecordedMove()
+	: TimeStamp(0.0f)
+	, DeltaTime(0.0f)
+	, CompressedFlags(0)
+	, Acceleration(FVector::ZeroVector)
+	, GravityDirection(FVector::ZeroVector)
+	, EndLocation(FVector::ZeroVector)
+	, EndRotation(FRotator::ZeroRotator)
+	, EndVelocity(FVector::ZeroVector)
+	, EndMovementMode(0)
+	, bFloorBlockingHit(false)
+	, bFloorWalkable(false)
+	, FloorDist(0.0f)
+	, FloorNormal(FVector::ZeroVector)
+{
+}
+
+FArchive& operator<<(FArchive& Ar, FNinjaRecordedMove& Move)
+{
+	// Full precision is kept; moves must be re-simulated exactly
+	Ar << Move.TimeStamp;
+	Ar << Move.DeltaTime;
+	Ar << Move.CompressedFlags;
+	Ar << Move.Acceleration;
+	Ar << Move.GravityDirection;
+	Ar << Move.EndLocation;
+	Ar << Move.EndRotation;
+	Ar << Move.EndVelocity;
+	Ar << Move.EndMovementMode;
+
+	uint8 FloorFlags = (Move.bFloorBlockingHit ? 1 : 0) | (Move.bFloorWalkable ? 2 : 0);
+	Ar << FloorFlags;
+	Move.bFloorBlockingHit = (FloorFlags & 1) != 0;
+	Move.bFloorWalkable = (FloorFlags & 2) != 0;
+
+	if (Move.bFloorBlockingHit)
+	{
+		Ar << Move.FloorDist;
+		Ar << Move.FloorNormal;
+	}
+
+	return Ar;
+}
+
+FNinjaRecordedCorrection::FNinjaRecordedCorrection()
+	: TimeStamp(0.0f)
+	, MoveIndex(INDEX_NONE)
+	, ClientLocation(FVector::ZeroVector)
+	, ServerLocation(FVector::ZeroVector)
+{
+}
+
+FArchive& operator<<(FArchive& Ar, FNinjaRecordedCorrection& Correction)
+{
+	Ar << Correction.TimeStamp;
+	Ar << Correction.MoveIndex;
+	Ar << Correction.ClientLocation;
+	Ar << Correction.ServerLocation;
+
+	return Ar;
+}
+
+FNinjaMovementReplayReport::FNinjaMovementReplayReport()
+	: NumMoves(0)
+	, NumDivergedMoves(0)
+	, FirstDivergedMove(INDEX_NONE)
+	, NumFloorMismatches(0)
+	, NumUnresolvedGravityStates(0)
+	, MaxLocationError(0.0f)
+	, MaxVelocityError(0.0f)
+	, SimulationTime(0.0)
+{
+}
+
+FString FNinjaMovementReplayReport::ToString() const
+{
+	return FString::Printf(TEXT("%d moves in %.3f ms (%.4f ms/move), %d diverged (first %d), %d floor mismatches, ")
+		TEXT("max location error %.3f, max velocity error %.3f, %d unresolved gravity states"),
+		NumMoves, SimulationTime, (NumMoves > 0) ? SimulationTime / NumMoves : 0.0, NumDivergedMoves,
+		FirstDivergedMove, NumFloorMismatches, MaxLocationError, MaxVelocityError, NumUnresolvedGravityStates);
+}
+
+FNinjaMovementRecording::FNinjaMovementRecording()
+	: NetMode(NM_Standalone)
+	, StartLocation(FVector::ZeroVector)
+	, StartRotation(FRotator::ZeroRotator)
+	, StartVelocity(FVector::ZeroVector)
+	, StartMovementMode(0)
+{
+}
+
+void FNinjaMovementRecording::Serialize(FArchive& Ar)
+{
+	Ar << CharacterClass;
+	Ar << NetMode;
+	Ar << StartLocation;
+	Ar << StartRotation;
+	Ar << StartVelocity;
+	Ar << StartMovementMode;
+	Ar << Moves;
+	Ar << GravityStates;
+	Ar << Corrections;
+}
+
+bool FNinjaMovementRecording::SaveToFile(const FString& FileName)
+{
+	TArray<uint8> UncompressedData;
+	FMemoryWriter Writer(UncompressedData);
+	Serialize(Writer);
+
+	int32 CompressedSize = FCompression::CompressMemoryBound(NAME_Zlib, UncompressedData.Num());
+	TArray<uint8> FileData;
+	FileData.SetNumUninitialized(sizeof(uint32) + sizeof(int32) * 2 + CompressedSize);
+
+	if (!FCompression::CompressMemory(NAME_Zlib, FileData.GetData() + sizeof(uint32) + sizeof(int32) * 2,
+		CompressedSize, UncompressedData.GetData(), UncompressedData.Num()))
+	{
+		return false;
+	}
+
+	FileData.SetNum(sizeof(uint32) + sizeof(int32) * 2 + CompressedSize);
+
+	// Header stores the uncompressed size, required to decompress
+	uint32 Magic = NinjaMovementRecording::FileMagic;
+	int32 Version = NinjaMovementRecording::FileVersion;
+	int32 UncompressedSize = UncompressedData.Num();
+	FMemoryWriter HeaderWriter(FileData);
+	HeaderWriter << Magic;
+	HeaderWriter << Version;
+	HeaderWriter << UncompressedSize;
+
+	return FFileHelper::SaveArrayToFile(FileData, *FileName);
+}
+
+bool FNinjaMovementRecording::LoadFromFile(const FString& FileName)
+{
+	TArray<uint8> FileData;
+	if (!FFileHelper::LoadFileToArray(FileData, *FileName) ||
+		FileData.Num() < (int32)(sizeof(uint32) + sizeof(int32) * 2))
+	{
+		return false;
+	}
+
+	uint32 Magic = 0;
+	int32 Version = 0;
+	int32 UncompressedSize = 0;
+	FMemoryReader HeaderReader(FileData);
+	HeaderReader << Magic;
+	HeaderReader << Version;
+	HeaderReader << UncompressedSize;
+
+	if (Magic != NinjaMovementRecording::FileMagic || Version != NinjaMovementRecording::FileVersion ||
+		UncompressedSize < 0)
+	{
+		return false;
+	}
+
+	TArray<uint8> UncompressedData;
+	UncompressedData.SetNumUninitialized(UncompressedSize);
+	const int32 HeaderSize = (int32)HeaderReader.Tell();
+
+	if (!FCompression::UncompressMemory(NAME_Zlib, UncompressedData.GetData(), UncompressedSize,
+		FileData.GetData() + HeaderSize, FileData.Num() - HeaderSize))
+	{
+		return false;
+	}
+
+	FMemoryReader Reader(UncompressedData);
+	Serialize(Reader);
+
+	return !Reader.IsError();
+}
+
+ANinjaCharacter* FNinjaMovementRecording::SpawnReplayCharacter(UWorld* World) const
+{
+	UClass* Class = CharacterClass.TryLoadClass<ANinjaCharacter>();
+	if (World == nullptr || Class == nullptr || World->GetNetMode() == NM_Client)
+	{
+		return nullptr;
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	SpawnParams.ObjectFlags |= RF_Transient;
+
+	ANinjaCharacter* Character = World->SpawnActor<ANinjaCharacter>(Class, StartLocation, StartRotation, SpawnParams);
+	if (Character == nullptr || Character->GetNinjaCharacterMovement() == nullptr)
+	{
+		return nullptr;
+	}
+
+	// Moves are only simulated by the replay
+	Character->SetActorTickEnabled(false);
+	Character->GetNinjaCharacterMovement()->SetComponentTickEnabled(false);
+
+	return Character;
+}
@@ -0,0 +1,262 @@
+// "Ninja Character" plugin, by Javier 'Xaklse' Osset; Copyright 2020
+
+
+#include "NinjaMovementTickManager.h"
+
+#include "NinjaCharacterMovementComponent.h"
+#include "NinjaCharacterStats.h"
+
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/PhysicsVolume.h"
+
+
+FNinjaMovementTickFunction::FNinjaMovementTickFunction()
+	: Manager(nullptr)
+{
+	TickGroup = TG_PrePhysics;
+	bCanEverTick = true;
+	bStartWithTickEnabled = true;
+}
+
+void FNinjaMovementTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread,
+	const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Manager != nullptr && TickType != LEVELTICK_ViewportsOnly)
+	{
+		Manager->TickComponents(DeltaTime, TickType);
+	}
+}
+
+FString FNinjaMovementTickFunction::DiagnosticMessage()
+{
+	return TEXT("FNinjaMovementTickFunction");
+}
+
+FName FNinjaMovementTickFunction::DiagnosticContext(bool bDetailed)
+{
+	return FName(TEXT("NinjaMovementTickManager"));
+}
+
+UNinjaMovementTickManager::UNinjaMovementTickManager()
+	: Super()
+{
+	bTickingComponents = false;
+}
+
+void UNinjaMovementTickManager::Deinitialize()
+{
+	for (FNinjaMovementTickEntry& Entry : Entries)
+	{
+		RemoveTickDependencies(Entry);
+	}
+
+	if (TickFunction.IsTickFunctionRegistered())
+	{
+		TickFunction.UnRegisterTickFunction();
+	}
+
+	Entries.Empty();
+
+	Super::Deinitialize();
+}
+
+void UNinjaMovementTickManager::RegisterComponent(UNinjaCharacterMovementComponent* Component)
+{
+	if (Component == nullptr || Entries.ContainsByPredicate([Component](const FNinjaMovementTickEntry& Entry)
+		{
+			return Entry.Component.Get() == Component;
+		}))
+	{
+		return;
+	}
+
+	if (!TickFunction.IsTickFunctionRegistered())
+	{
+		UWorld* World = GetWorld();
+		if (World == nullptr || World->PersistentLevel == nullptr)
+		{
+			return;
+		}
+
+		TickFunction.Manager = this;
+		TickFunction.RegisterTickFunction(World->PersistentLevel);
+	}
+
+	Component->SetComponentTickEnabled(false);
+
+	FNinjaMovementTickEntry& Entry = Entries.AddDefaulted_GetRef();
+	Entry.Component = Component;
+	Entry.PhysicsVolume = Component->GetPhysicsVolume();
+	Entry.GravityDirectionMode = Component->GetGravityDirectionMode();
+
+	AddTickDependencies(Entry);
+}
+
+void UNinjaMovementTickManager::UnregisterComponent(UNinjaCharacterMovementComponent* Component, bool bRestoreTick)
+{
+	if (Component == nullptr)
+	{
+		return;
+	}
+
+	for (int32 Index = 0; Index < Entries.Num(); ++Index)
+	{
+		if (Entries[Index].Component.Get() == Component)
+		{
+			RemoveTickDependencies(Entries[Index]);
+
+			if (bTickingComponents)
+			{
+				// Removed after all components are ticked
+				Entries[Index].Component.Reset();
+			}
+			else
+			{
+				Entries.RemoveAtSwap(Index, 1, false);
+			}
+
+			if (bRestoreTick)
+			{
+				Component->SetComponentTickEnabled(true);
+			}
+
+			break;
+		}
+	}
+}
+
+void UNinjaMovementTickManager::TickComponents(float DeltaTime, ELevelTick TickType)
+{
+	SCOPE_CYCLE_COUNTER(STAT_NinjaMovementTickManager);
+
+	// Discard entries of components destroyed without unregistering
+	for (int32 Index = Entries.Num() - 1; Index >= 0; --Index)
+	{
+		if (!Entries[Index].Component.IsValid())
+		{
+			RemoveTickDependencies(Entries[Index]);
+			Entries.RemoveAtSwap(Index, 1, false);
+		}
+	}
+
+	for (FNinjaMovementTickEntry& Entry : Entries)
+	{
+		// Physics volumes and gravity modes change as characters move around
+		Entry.PhysicsVolume = Entry.Component->GetPhysicsVolume();
+		Entry.GravityDirectionMode = Entry.Component->GetGravityDirectionMode();
+
+		// Controller changes on possession
+		const ACharacter* Character = Entry.Component->GetCharacterOwner();
+		if (Character != nullptr && Character->GetController() != Entry.Controller.Get())
+		{
+			RemoveTickDependencies(Entry);
+			AddTickDependencies(Entry);
+		}
+	}
+
+	Entries.Sort([](const FNinjaMovementTickEntry& A, const FNinjaMovementTickEntry& B)
+	{
+		if (A.PhysicsVolume != B.PhysicsVolume)
+		{
+			return (UPTRINT)A.PhysicsVolume < (UPTRINT)B.PhysicsVolume;
+		}
+
+		return A.GravityDirectionMode < B.GravityDirectionMode;
+	});
+
+	bTickingComponents = true;
+
+	const APhysicsVolume* GroupVolume = nullptr;
+	float GroupVolumeGravityZ = 0.0f;
+
+	// Components registered while ticking are appended and also ticked
+	for (int32 Index = 0; Index < Entries.Num(); ++Index)
+	{
+		UNinjaCharacterMovementComponent* Component = Entries[Index].Component.Get();
+		if (Component == nullptr || !Component->IsRegistered() || Component->GetOwner() == nullptr)
+		{
+			continue;
+		}
+
+		if (!Component->ShouldUseMovementTickManager())
+		{
+			UnregisterComponent(Component, true);
+			continue;
+		}
+
+		// Volume gravity is evaluated once per group
+		if (Index == 0 || Entries[Index].PhysicsVolume != GroupVolume)
+		{
+			GroupVolume = Entries[Index].PhysicsVolume;
+			GroupVolumeGravityZ = (GroupVolume != nullptr) ? GroupVolume->GetGravityZ() : GetWorld()->GetGravityZ();
+		}
+
+		// Per-tick state of the next component is fetched while this one ticks
+		const UNinjaCharacterMovementComponent* NextComponent = Entries.IsValidIndex(Index + 1) ?
+			Entries[Index + 1].Component.Get() : nullptr;
+		if (NextComponent != nullptr)
+		{
+			const FNinjaMovementHotState* NextHotState = &NextComponent->GetHotState();
+			FPlatformMisc::Prefetch(NextHotState);
+			FPlatformMisc::Prefetch(NextHotState, PLATFORM_CACHE_LINE_SIZE);
+		}
+
+		Component->SetGroupVolumeGravityZ(GroupVolumeGravityZ);
+		Component->TickComponent(DeltaTime * Component->GetOwner()->CustomTimeDilation, TickType,
+			&Component->PrimaryComponentTick);
+	}
+
+	bTickingComponents = false;
+
+	Entries.RemoveAllSwap([](const FNinjaMovementTickEntry& Entry)
+	{
+		return !Entry.Component.IsValid();
+	});
+}
+
+void UNinjaMovementTickManager::AddTickDependencies(FNinjaMovementTickEntry& Entry)
+{
+	const ACharacter* Character = Entry.Component.IsValid() ? Entry.Component->GetCharacterOwner() : nullptr;
+	if (Character == nullptr)
+	{
+		return;
+	}
+
+	// Input of the controller is consumed by movement, see AController::AddPawnTickDependency
+	AController* Controller = Character->GetController();
+	if (Controller != nullptr && Controller->PrimaryActorTick.bCanEverTick)
+	{
+		TickFunction.AddPrerequisite(Controller, Controller->PrimaryActorTick);
+	}
+
+	Entry.Controller = Controller;
+
+	// Animation uses the result of movement, see ACharacter::PostInitializeComponents
+	USkeletalMeshComponent* Mesh = Character->GetMesh();
+	if (Mesh != nullptr && Mesh->PrimaryComponentTick.bCanEverTick)
+	{
+		Mesh->PrimaryComponentTick.AddPrerequisite(this, TickFunction);
+		Entry.Mesh = Mesh;
+	}
+}
+
+void UNinjaMovementTickManager::RemoveTickDependencies(FNinjaMovementTickEntry& Entry)
+{
+	AController* Controller = Entry.Controller.Get();
+	if (Controller != nullptr)
+	{
+		TickFunction.RemovePrerequisite(Controller, Controller->PrimaryActorTick);
+	}
+
+	USkeletalMeshComponent* Mesh = Entry.Mesh.Get();
+	if (Mesh != nullptr)
+	{
+		Mesh->PrimaryComponentTick.RemovePrerequisite(this, TickFunction);
+	}
+
+	Entry.Controller.Reset();
+	Entry.Mesh.Reset();
+}
@@ -5,6 +5,9 @@
 
 #include "NinjaCharacter.h"
 #include "NinjaCharacterMovementComponent.h"
+#include "NinjaCharacterStats.h"
+#include "NinjaGravityField.h"
+#include "NinjaGravityRegistrySubsystem.h"
 
 #include "Components/BrushComponent.h"
 #include "Components/PrimitiveComponent.h"
@@ -12,6 +15,9 @@
 #include "Components/SkeletalMeshComponent.h"
 #include "Components/SplineComponent.h"
 
+#include "Async/ParallelFor.h"
+#include "Net/UnrealNetwork.h"
+
 #if WITH_EDITORONLY_DATA
 #include "Components/TextRenderComponent.h"
 #endif
@@ -27,6 +33,28 @@ FName ANinjaPhysicsVolume::TextRenderComponentName(TEXT("TextRenderComponent"));
 
 namespace NinjaPhysicsVolumeCVars
 {
+	static int32 ParallelGravityForces = 1;
+	FAutoConsoleVariableRef CVarParallelGravityForces(
+		TEXT("npv.ParallelGravityForces"),
+		ParallelGravityForces,
+		TEXT("Whether volumes with 'Parallel Gravity Forces' enabled compute gravity forces with worker threads.\n")
+		TEXT("0: Disable, 1: Enable"),
+		ECVF_Default);
+
+	static int32 ParallelGravityMinBodies = 64;
+	FAutoConsoleVariableRef CVarParallelGravityMinBodies(
+		TEXT("npv.ParallelGravityMinBodies"),
+		ParallelGravityMinBodies,
+		TEXT("Minimum number of physics bodies in a volume to compute gravity forces with worker threads."),
+		ECVF_Default);
+
+	static int32 ParallelGravityBatchSize = 64;
+	FAutoConsoleVariableRef CVarParallelGravityBatchSize(
+		TEXT("npv.ParallelGravityBatchSize"),
+		ParallelGravityBatchSize,
+		TEXT("Number of physics bodies evaluated by each parallel gravity task."),
+		ECVF_Default);
+
 #if !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
 	static int32 ShowGravity = 0;
 	FAutoConsoleVariableRef CVarShowGravity(
@@ -38,6 +66,175 @@ namespace NinjaPhysicsVolumeCVars
 #endif // !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
 }
 
+namespace NinjaGravityBatch
+{
+	/** Number of points evaluated at once by SIMD kernels. */
+	static const int32 NumLanes = 4;
+
+	/** Group of points (or vectors) stored as structure of arrays. */
+	struct FVectors4
+	{
+		VectorRegister X;
+		VectorRegister Y;
+		VectorRegister Z;
+	};
+
+	/**
+	 * Loads up to four points into SIMD registers; unused lanes repeat the last point.
+	 * @param Points - source points
+	 * @param Count - number of valid points, between 1 and NumLanes
+	 * @return points in structure of arrays layout
+	 */
+	static FORCEINLINE FVectors4 Load(const FVector* Points, int32 Count)
+	{
+		MS_ALIGN(16) float X[NumLanes] GCC_ALIGN(16);
+		MS_ALIGN(16) float Y[NumLanes] GCC_ALIGN(16);
+		MS_ALIGN(16) float Z[NumLanes] GCC_ALIGN(16);
+
+		for (int32 Lane = 0; Lane < NumLanes; ++Lane)
+		{
+			const FVector& Point = Points[FMath::Min(Lane, Count - 1)];
+			X[Lane] = Point.X;
+			Y[Lane] = Point.Y;
+			Z[Lane] = Point.Z;
+		}
+
+		return { VectorLoadAligned(X), VectorLoadAligned(Y), VectorLoadAligned(Z) };
+	}
+
+	/**
+	 * Stores up to four vectors from SIMD registers.
+	 * @param Vectors - vectors in structure of arrays layout
+	 * @param OutVectors - destination vectors
+	 * @param Count - number of valid vectors, between 1 and NumLanes
+	 */
+	static FORCEINLINE void Store(const FVectors4& Vectors, FVector* OutVectors, int32 Count)
+	{
+		MS_ALIGN(16) float X[NumLanes] GCC_ALIGN(16);
+		MS_ALIGN(16) float Y[NumLanes] GCC_ALIGN(16);
+		MS_ALIGN(16) float Z[NumLanes] GCC_ALIGN(16);
+
+		VectorStoreAligned(Vectors.X, X);
+		VectorStoreAligned(Vectors.Y, Y);
+		VectorStoreAligned(Vectors.Z, Z);
+
+		for (int32 Lane = 0; Lane < Count; ++Lane)
+		{
+			OutVectors[Lane] = FVector(X[Lane], Y[Lane], Z[Lane]);
+		}
+	}
+
+	/**
+	 * Broadcasts a vector to all lanes.
+	 * @param Vector - vector to broadcast
+	 * @return vector in structure of arrays layout
+	 */
+	static FORCEINLINE FVectors4 Splat(const FVector& Vector)
+	{
+		return { VectorSetFloat1(Vector.X), VectorSetFloat1(Vector.Y), VectorSetFloat1(Vector.Z) };
+	}
+
+	/**
+	 * Computes dot product of two groups of vectors.
+	 */
+	static FORCEINLINE VectorRegister Dot(const FVectors4& A, const FVectors4& B)
+	{
+		return VectorMultiplyAdd(A.X, B.X, VectorMultiplyAdd(A.Y, B.Y, VectorMultiply(A.Z, B.Z)));
+	}
+
+	/**
+	 * Converts gravity directions (not normalized) to gravity vectors; same as
+	 * GetSafeNormal multiplied by given magnitude.
+	 * @param Dirs - directions of gravity
+	 * @param Magnitude - signed magnitude of gravity
+	 * @return gravity vectors
+	 */
+	static FORCEINLINE FVectors4 ToGravity(const FVectors4& Dirs, const VectorRegister& Magnitude)
+	{
+		const VectorRegister SizeSquared = Dot(Dirs, Dirs);
+		const VectorRegister Mask = VectorCompareGT(SizeSquared, VectorSetFloat1(SMALL_NUMBER));
+		const VectorRegister Scale = VectorSelect(Mask,
+			VectorMultiply(VectorReciprocalSqrtAccurate(SizeSquared), Magnitude), VectorZero());
+
+		return { VectorMultiply(Dirs.X, Scale), VectorMultiply(Dirs.Y, Scale), VectorMultiply(Dirs.Z, Scale) };
+	}
+}
+
+namespace NinjaTrackedList
+{
+	/**
+	 * Adds an item to a tracked list.
+	 * @param List - tracked list
+	 * @param Indices - index of every item in the list
+	 * @param Item - item to add
+	 * @return true if the item wasn't tracked yet
+	 */
+	template<typename T>
+	static bool Add(TArray<T*>& List, TMap<const T*, int32>& Indices, T* Item)
+	{
+		const int32* Index = Indices.Find(Item);
+		if (Index != nullptr && List.IsValidIndex(*Index) && List[*Index] == Item)
+		{
+			return false;
+		}
+
+		Indices.Add(Item, List.Add(Item));
+
+		return true;
+	}
+
+	/**
+	 * Removes an item from a tracked list; order of the list isn't kept.
+	 * @param List - tracked list
+	 * @param Indices - index of every item in the list
+	 * @param Item - item to remove
+	 * @return true if the item was tracked
+	 */
+	template<typename T>
+	static bool Remove(TArray<T*>& List, TMap<const T*, int32>& Indices, T* Item)
+	{
+		int32 Index;
+		if (!Indices.RemoveAndCopyValue(Item, Index) || !List.IsValidIndex(Index) || List[Index] != Item)
+		{
+			return false;
+		}
+
+		List.RemoveAtSwap(Index, 1, false);
+
+		// Update index of the item that took the free position
+		if (List.IsValidIndex(Index) && List[Index] != nullptr)
+		{
+			Indices.Add(List[Index], Index);
+		}
+
+		return true;
+	}
+
+	/**
+	 * Removes all invalid items from a tracked list.
+	 * @param List - tracked list
+	 * @param Indices - index of every item in the list
+	 */
+	template<typename T>
+	static void Compact(TArray<T*>& List, TMap<const T*, int32>& Indices)
+	{
+		const int32 NumRemoved = List.RemoveAllSwap([](T* Item)
+		{
+			return Item == nullptr || Item->IsPendingKill();
+		}, false);
+
+		if (NumRemoved > 0)
+		{
+			// Rebuild the indices, stale entries are discarded too
+			Indices.Reset();
+			for (int32 Index = 0; Index < List.Num(); ++Index)
+			{
+				Indices.Add(List[Index], Index);
+			}
+		}
+	}
+}
+
 
 ANinjaPhysicsVolume::ANinjaPhysicsVolume(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
@@ -59,58 +256,294 @@ ANinjaPhysicsVolume::ANinjaPhysicsVolume(const FObjectInitializer& ObjectInitial
 	PrimaryActorTick.bCanEverTick = true;
 	PrimaryActorTick.bStartWithTickEnabled = false;
 
+	BakedGravityField = nullptr;
+	BakedGravityFieldActor = nullptr;
+	BakedGravityFieldCellSize = 100.0f;
+	bParallelGravityForces = false;
+	bPhysicsRateGravityForces = false;
+	bPublishGravitySnapshot = false;
+	bReplicateGravity = false;
+	bUseGravitySources = false;
+	LastTrackedListsCompactionFrame = 0;
 	GravityActor = nullptr;
+	GravityDirectionFunc = FNinjaGravityEvaluator::Find(ENinjaGravityDirectionMode::Fixed);
 	GravityDirectionMode = ENinjaGravityDirectionMode::Fixed;
+	GravityField = nullptr;
 	GravityScale = 1.0f;
+	GravitySpline = nullptr;
 	GravityVectorA = FVector(0.0f, 0.0f, -1.0f);
 	GravityVectorB = FVector::ZeroVector;
 	NinjaFallVelocity = FVector::ZeroVector;
+
+	PhysicsRateGravityDelegate.BindUObject(this, &ANinjaPhysicsVolume::ApplyPhysicsRateGravity);
+}
+
+void ANinjaPhysicsVolume::PostLoad()
+{
+	Super::PostLoad();
+
+	if (bReplicateGravity)
+	{
+		// Replication must be configured before network roles are established
+		bAlwaysRelevant = true;
+		bReplicates = true;
+		NetDormancy = DORM_DormantAll;
+	}
+}
+
+void ANinjaPhysicsVolume::PostInitializeComponents()
+{
+	Super::PostInitializeComponents();
+
+	// Mode could have been changed by subclasses or loaded from disk
+	GravityDirectionFunc = FNinjaGravityEvaluator::Find(GravityDirectionMode);
+
+	UpdateGravitySpline();
+
+	// Server and client start from the same loaded gravity settings
+	GravityState = MakeGravityState();
+}
+
+void ANinjaPhysicsVolume::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (bUseGravitySources)
+	{
+		SetFieldGravityDirection();
+	}
+	else if (BakedGravityField != nullptr && BakedGravityField->IsValidField())
+	{
+		SetBakedGravityDirection(BakedGravityField);
+	}
+
+	if (bPublishGravitySnapshot)
+	{
+		PublishGravitySnapshot();
+		SetActorTickEnabled(true);
+	}
+
+	UNinjaGravityRegistrySubsystem* GravityRegistry = GetWorld()->GetSubsystem<UNinjaGravityRegistrySubsystem>();
+	if (GravityRegistry != nullptr)
+	{
+		GravityRegistry->RegisterVolume(this);
+	}
+}
+
+void ANinjaPhysicsVolume::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	UNinjaGravityRegistrySubsystem* GravityRegistry = GetWorld()->GetSubsystem<UNinjaGravityRegistrySubsystem>();
+	if (GravityRegistry != nullptr)
+	{
+		GravityRegistry->UnregisterVolume(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 void ANinjaPhysicsVolume::Tick(float DeltaTime)
 {
+	SCOPE_CYCLE_COUNTER(STAT_NinjaPhysicsVolumeTick);
+
 	Super::Tick(DeltaTime);
 
-	for (AActor* TrackedActor : TrackedActors)
+	// Discard destroyed Actors once per frame
+	CompactTrackedLists();
+
+	// Worker threads only read cached data of the gravity Actor
+	RefreshGravityActorProxy();
+
+	if (bPublishGravitySnapshot || bPhysicsRateGravityForces)
 	{
-		if (TrackedActor != nullptr && !TrackedActor->IsPendingKill())
+		PublishGravitySnapshot();
+	}
+
+	if (TrackedActors.Num() == 0)
+	{
+		if (!bPublishGravitySnapshot)
+		{
+			SetActorTickEnabled(false);
+		}
+
+		return;
+	}
+
+	if (ShouldApplyGravityAtPhysicsRate())
+	{
+		// Physics simulation computes and applies gravity forces of every body by itself
+		for (AActor* TrackedActor : TrackedActors)
 		{
 			UPrimitiveComponent* Primitive = Cast<UPrimitiveComponent>(TrackedActor->GetRootComponent());
-			if (Primitive->IsGravityEnabled())
+			if (Primitive != nullptr && Primitive->IsGravityEnabled())
 			{
-				// Add force combination of reverse engine's gravity and custom gravity
-				const FVector GravityForce = FVector(0.0f, 0.0f, GetGravityZ() * -1.0f) +
-					GetGravity(Primitive->GetComponentLocation());
-
-				USkeletalMeshComponent* SkeletalMesh = Cast<USkeletalMeshComponent>(Primitive);
-				if (SkeletalMesh != nullptr)
-				{
-					SkeletalMesh->AddForceToAllBodiesBelow(GravityForce, NAME_None, true, true);
-				}
-				else
-				{
-					Primitive->AddForce(GravityForce, NAME_None, true);
-				}
+				AddPhysicsRateGravity(Primitive);
 			}
 		}
+
+		return;
+	}
+
+	// Gather physics bodies affected by gravity
+	TArray<UPrimitiveComponent*, TInlineAllocator<64>> Primitives;
+	TArray<FVector, TInlineAllocator<64>> Locations;
+	Primitives.Reserve(TrackedActors.Num());
+	Locations.Reserve(TrackedActors.Num());
+
+	for (AActor* TrackedActor : TrackedActors)
+	{
+		UPrimitiveComponent* Primitive = Cast<UPrimitiveComponent>(TrackedActor->GetRootComponent());
+		if (Primitive != nullptr && Primitive->IsGravityEnabled())
+		{
+			Primitives.Add(Primitive);
+			Locations.Add(Primitive->GetComponentLocation());
+		}
+	}
+
+	if (Primitives.Num() == 0)
+	{
+		return;
+	}
+
+	TArray<FVector, TInlineAllocator<64>> Gravities;
+	Gravities.SetNumUninitialized(Locations.Num());
+
+	if (ShouldComputeGravityInParallel(Locations.Num()))
+	{
+		// Make sure cached spline data is up to date before worker threads read it
+		if (GravitySpline != nullptr && !GravitySplineTree.IsBuiltFor(GravitySpline))
+		{
+			GravitySplineTree.Build(GravitySpline);
+		}
+
+		// Compute gravity forces from location snapshot with worker threads
+		const int32 BatchSize = FMath::Max(1, NinjaPhysicsVolumeCVars::ParallelGravityBatchSize);
+		const int32 NumBatches = FMath::DivideAndRoundUp(Locations.Num(), BatchSize);
+
+		ParallelFor(NumBatches, [this, &Locations, &Gravities, BatchSize](int32 BatchIndex)
+		{
+			const int32 Start = BatchIndex * BatchSize;
+			const int32 Count = FMath::Min(BatchSize, Locations.Num() - Start);
+
+			GetGravityBatch(TArrayView<const FVector>(Locations.GetData() + Start, Count),
+				TArrayView<FVector>(Gravities.GetData() + Start, Count));
+		});
+	}
+	else
+	{
+		GetGravityBatch(Locations, Gravities);
+	}
+
+	// Apply all gravity forces on game thread
+	const FVector ReverseEngineGravity = FVector(0.0f, 0.0f, GetGravityZ() * -1.0f);
+
+	for (int32 Index = 0; Index < Primitives.Num(); ++Index)
+	{
+		// Add force combination of reverse engine's gravity and custom gravity
+		const FVector GravityForce = ReverseEngineGravity + Gravities[Index];
+
+		USkeletalMeshComponent* SkeletalMesh = Cast<USkeletalMeshComponent>(Primitives[Index]);
+		if (SkeletalMesh != nullptr)
+		{
+			SkeletalMesh->AddForceToAllBodiesBelow(GravityForce, NAME_None, true, true);
+		}
+		else
+		{
+			Primitives[Index]->AddForce(GravityForce, NAME_None, true);
+		}
 	}
 }
 
-void ANinjaPhysicsVolume::ActorEnteredVolume(AActor* Other)
+bool ANinjaPhysicsVolume::ShouldComputeGravityInParallel(int32 NumBodies) const
 {
-	Super::ActorEnteredVolume(Other);
+	if (!bParallelGravityForces || NinjaPhysicsVolumeCVars::ParallelGravityForces == 0 ||
+		NumBodies < NinjaPhysicsVolumeCVars::ParallelGravityMinBodies || !FApp::ShouldUseThreadingForPerformance())
+	{
+		return false;
+	}
+
+#if !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
+	if (NinjaPhysicsVolumeCVars::ShowGravity > 0)
+	{
+		// Debug drawing isn't thread-safe
+		return false;
+	}
+#endif // !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
+
+	switch (GravityDirectionMode)
+	{
+		case ENinjaGravityDirectionMode::SplineTangent:
+		case ENinjaGravityDirectionMode::Spline:
+		case ENinjaGravityDirectionMode::SplinePlane:
+		{
+			// Spline must be resolved beforehand
+			return GetGravitySpline() != nullptr;
+		}
+
+		case ENinjaGravityDirectionMode::Collision:
+		case ENinjaGravityDirectionMode::Field:
+		{
+			// Collision queries and gravity registry stay on game thread
+			return false;
+		}
+	}
 
-	// Remove all empty positions of the TrackedActors list
-	TrackedActors.RemoveAll([](AActor* Actor)
+	return true;
+}
+
+bool ANinjaPhysicsVolume::ShouldApplyGravityAtPhysicsRate() const
+{
+	// Collision queries and gravity registry stay on game thread, like parallel gravity forces
+	return bPhysicsRateGravityForces && GravityDirectionMode != ENinjaGravityDirectionMode::Collision &&
+		GravityDirectionMode != ENinjaGravityDirectionMode::Field;
+}
+
+void ANinjaPhysicsVolume::AddPhysicsRateGravity(UPrimitiveComponent* Primitive)
+{
+	USkeletalMeshComponent* SkeletalMesh = Cast<USkeletalMeshComponent>(Primitive);
+	if (SkeletalMesh != nullptr)
+	{
+		// Every simulated body of a ragdoll is evaluated at its own location
+		for (FBodyInstance* Body : SkeletalMesh->Bodies)
+		{
+			if (Body != nullptr && Body->bEnableGravity && Body->IsInstanceSimulatingPhysics())
+			{
+				Body->AddCustomPhysics(PhysicsRateGravityDelegate);
+			}
+		}
+	}
+	else
 	{
-		return Actor == nullptr;
-	});
+		FBodyInstance* Body = Primitive->GetBodyInstance();
+		if (Body != nullptr && Body->IsInstanceSimulatingPhysics())
+		{
+			Body->AddCustomPhysics(PhysicsRateGravityDelegate);
+		}
+	}
+}
 
-	// Remove all empty positions of the TrackedNinjas list
-	TrackedNinjas.RemoveAll([](ANinjaCharacter* Ninja)
+void ANinjaPhysicsVolume::ApplyPhysicsRateGravity(float DeltaTime, FBodyInstance* BodyInstance)
+{
+	// Gravity settings are only read from the immutable published snapshot
+	const FNinjaGravitySnapshotPtr Snapshot = GravitySnapshotBuffer.Read();
+	if (!Snapshot.IsValid() || BodyInstance == nullptr)
 	{
-		return Ninja == nullptr;
-	});
+		return;
+	}
+
+	const FVector Location = BodyInstance->GetUnrealWorldTransform_AssumesLocked().GetLocation();
+
+	// Add force combination of reverse engine's gravity and custom gravity
+	BodyInstance->AddForce(FVector(0.0f, 0.0f, Snapshot->EngineGravityZ * -1.0f) + Snapshot->GetGravity(Location), false, true);
+}
+
+void ANinjaPhysicsVolume::ActorEnteredVolume(AActor* Other)
+{
+	SCOPE_CYCLE_COUNTER(STAT_NinjaPhysicsVolumeActorEntered);
+
+	Super::ActorEnteredVolume(Other);
+
+	CompactTrackedLists();
+	RefreshGravityActorProxy();
 
 	if (Other != nullptr && !Other->IsPendingKill())
 	{
@@ -226,6 +659,22 @@ void ANinjaPhysicsVolume::ActorEnteredVolume(AActor* Other)
 
 					break;
 				}
+
+				case ENinjaGravityDirectionMode::Baked:
+				{
+					if (GravityField != nullptr)
+					{
+						NinjaCharMoveComp->SetBakedGravityDirection(GravityField);
+					}
+
+					break;
+				}
+
+				case ENinjaGravityDirectionMode::Field:
+				{
+					NinjaCharMoveComp->SetFieldGravityDirection();
+					break;
+				}
 			}
 
 			// Launch walking Ninjas if configured
@@ -234,7 +683,7 @@ void ANinjaPhysicsVolume::ActorEnteredVolume(AActor* Other)
 				NinjaCharMoveComp->Launch(NinjaFallVelocity);
 			}
 
-			TrackedNinjas.Add(Ninja);
+			NinjaTrackedList::Add(TrackedNinjas, TrackedNinjaIndices, Ninja);
 		}
 		else
 		{
@@ -242,7 +691,7 @@ void ANinjaPhysicsVolume::ActorEnteredVolume(AActor* Other)
 			UPrimitiveComponent* Primitive = Cast<UPrimitiveComponent>(Other->GetRootComponent());
 			if (Primitive != nullptr && Primitive->IsAnySimulatingPhysics())
 			{
-				TrackedActors.Add(Other);
+				NinjaTrackedList::Add(TrackedActors, TrackedActorIndices, Other);
 			}
 		}
 	}
@@ -252,6 +701,8 @@ void ANinjaPhysicsVolume::ActorEnteredVolume(AActor* Other)
 
 void ANinjaPhysicsVolume::ActorLeavingVolume(AActor* Other)
 {
+	SCOPE_CYCLE_COUNTER(STAT_NinjaPhysicsVolumeActorLeaving);
+
 	Super::ActorLeavingVolume(Other);
 
 	// Remove the received Actor from the TrackedActors list
@@ -260,27 +711,28 @@ void ANinjaPhysicsVolume::ActorLeavingVolume(AActor* Other)
 		ANinjaCharacter* Ninja = Cast<ANinjaCharacter>(Other);
 		if (Ninja != nullptr)
 		{
-			TrackedNinjas.Remove(Ninja);
+			NinjaTrackedList::Remove(TrackedNinjas, TrackedNinjaIndices, Ninja);
 		}
 		else
 		{
-			TrackedActors.Remove(Other);
+			NinjaTrackedList::Remove(TrackedActors, TrackedActorIndices, Other);
 		}
 	}
 
-	// Remove all empty positions of the TrackedActors list
-	TrackedActors.RemoveAll([](AActor* Actor)
-	{
-		return Actor == nullptr;
-	});
+	SetActorTickEnabled(TrackedActors.Num() > 0);
+}
 
-	// Remove all empty positions of the TrackedNinjas list
-	TrackedNinjas.RemoveAll([](ANinjaCharacter* Ninja)
+void ANinjaPhysicsVolume::CompactTrackedLists()
+{
+	if (LastTrackedListsCompactionFrame == GFrameCounter)
 	{
-		return Ninja == nullptr;
-	});
+		return;
+	}
 
-	SetActorTickEnabled(TrackedActors.Num() > 0);
+	LastTrackedListsCompactionFrame = GFrameCounter;
+
+	NinjaTrackedList::Compact(TrackedActors, TrackedActorIndices);
+	NinjaTrackedList::Compact(TrackedNinjas, TrackedNinjaIndices);
 }
 
 FVector ANinjaPhysicsVolume::GetGravity(const FVector& Point) const
@@ -290,6 +742,27 @@ FVector ANinjaPhysicsVolume::GetGravity(const FVector& Point) const
 		return FVector::ZeroVector;
 	}
 
+	FScopeCycleCounter GravityCycleCounter(NinjaCharacterStats::GetGravityStatId(GravityDirectionMode));
+	NINJA_COUNT_GRAVITY_EVALUATIONS(1);
+
+	bool bUseEvaluator = (GravityDirectionFunc != nullptr);
+
+#if !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
+	if (NinjaPhysicsVolumeCVars::ShowGravity > 0)
+	{
+		// Debug drawing is only done by the switch below
+		bUseEvaluator = false;
+	}
+#endif // !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
+
+	if (bUseEvaluator)
+	{
+		FVector VectorA, VectorB;
+		ResolveGravityVectors(VectorA, VectorB);
+
+		return GravityDirectionFunc(VectorA, VectorB, Point) * (FMath::Abs(GetGravityZ()) * GravityScale);
+	}
+
 	FVector Gravity = FVector::ZeroVector;
 
 	switch (GravityDirectionMode)
@@ -302,21 +775,12 @@ FVector ANinjaPhysicsVolume::GetGravity(const FVector& Point) const
 
 		case ENinjaGravityDirectionMode::SplineTangent:
 		{
-			USplineComponent* Spline = nullptr;
-			if (GravityActor != nullptr && !GravityActor->IsPendingKill())
-			{
-				Spline = Cast<USplineComponent>(
-					GravityActor->GetComponentByClass(USplineComponent::StaticClass()));
-			}
-			else
-			{
-				Spline = Cast<USplineComponent>(GetComponentByClass(USplineComponent::StaticClass()));
-			}
+			const USplineComponent* Spline = GetGravitySpline();
 
 			if (Spline != nullptr)
 			{
-				const FVector GravityDir = Spline->FindDirectionClosestToWorldLocation(
-					Point, ESplineCoordinateSpace::Type::World);
+				const FVector GravityDir = Spline->GetDirectionAtSplineInputKey(
+					FindGravitySplineInputKey(Spline, Point), ESplineCoordinateSpace::Type::World);
 				if (!GravityDir.IsZero())
 				{
 					Gravity = GravityDir * (FMath::Abs(GetGravityZ()) * GravityScale);
@@ -336,12 +800,8 @@ FVector ANinjaPhysicsVolume::GetGravity(const FVector& Point) const
 
 		case ENinjaGravityDirectionMode::Point:
 		{
-			FVector GravityPoint = GravityVectorA;
-
-			if (GravityActor != nullptr && !GravityActor->IsPendingKill())
-			{
-				GravityPoint = GravityActor->GetActorLocation();
-			}
+			FVector GravityPoint, UnusedVector;
+			ResolveGravityVectors(GravityPoint, UnusedVector);
 
 			const FVector GravityDir = GravityPoint - Point;
 			if (!GravityDir.IsZero())
@@ -404,21 +864,12 @@ FVector ANinjaPhysicsVolume::GetGravity(const FVector& Point) const
 
 		case ENinjaGravityDirectionMode::Spline:
 		{
-			USplineComponent* Spline = nullptr;
-			if (GravityActor != nullptr && !GravityActor->IsPendingKill())
-			{
-				Spline = Cast<USplineComponent>(
-					GravityActor->GetComponentByClass(USplineComponent::StaticClass()));
-			}
-			else
-			{
-				Spline = Cast<USplineComponent>(GetComponentByClass(USplineComponent::StaticClass()));
-			}
+			const USplineComponent* Spline = GetGravitySpline();
 
 			if (Spline != nullptr)
 			{
-				const FVector GravityPoint = Spline->FindLocationClosestToWorldLocation(
-					Point, ESplineCoordinateSpace::Type::World);
+				const FVector GravityPoint = Spline->GetLocationAtSplineInputKey(
+					FindGravitySplineInputKey(Spline, Point), ESplineCoordinateSpace::Type::World);
 				const FVector GravityDir = GravityPoint - Point;
 				if (!GravityDir.IsZero())
 				{
@@ -458,20 +909,11 @@ FVector ANinjaPhysicsVolume::GetGravity(const FVector& Point) const
 
 		case ENinjaGravityDirectionMode::SplinePlane:
 		{
-			USplineComponent* Spline = nullptr;
-			if (GravityActor != nullptr && !GravityActor->IsPendingKill())
-			{
-				Spline = Cast<USplineComponent>(
-					GravityActor->GetComponentByClass(USplineComponent::StaticClass()));
-			}
-			else
-			{
-				Spline = Cast<USplineComponent>(GetComponentByClass(USplineComponent::StaticClass()));
-			}
+			const USplineComponent* Spline = GetGravitySpline();
 
 			if (Spline != nullptr)
 			{
-				const float InputKey = Spline->FindInputKeyClosestToWorldLocation(Point);
+				const float InputKey = FindGravitySplineInputKey(Spline, Point);
 				const FVector ClosestLocation = Spline->GetLocationAtSplineInputKey(
 					InputKey, ESplineCoordinateSpace::Type::World);
 				const FVector ClosestUpVector = Spline->GetUpVectorAtSplineInputKey(
@@ -498,13 +940,8 @@ FVector ANinjaPhysicsVolume::GetGravity(const FVector& Point) const
 
 		case ENinjaGravityDirectionMode::Box:
 		{
-			FVector BoxOrigin = GravityVectorA;
-			FVector BoxExtent = GravityVectorB;
-
-			if (GravityActor != nullptr && !GravityActor->IsPendingKill())
-			{
-				GravityActor->GetActorBounds(true, BoxOrigin, BoxExtent);
-			}
+			FVector BoxOrigin, BoxExtent;
+			ResolveGravityVectors(BoxOrigin, BoxExtent);
 
 			const FVector GravityDir = FBox(BoxOrigin - BoxExtent,
 				BoxOrigin + BoxExtent).GetClosestPointTo(Point) - Point;
@@ -545,9 +982,44 @@ FVector ANinjaPhysicsVolume::GetGravity(const FVector& Point) const
 #endif // !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
 				}
 			}
+			else if (GravityActorProxy.HasCache())
+			{
+				// Collision geometry is streamed out, approximate it with its last bounds
+				FVector BoxOrigin, BoxExtent;
+				GravityActorProxy.GetCachedBounds(BoxOrigin, BoxExtent);
 
-			break;
-		}
+				const FVector GravityDir = FBox(BoxOrigin - BoxExtent,
+					BoxOrigin + BoxExtent).GetClosestPointTo(Point) - Point;
+				if (!GravityDir.IsZero())
+				{
+					Gravity = GravityDir.GetSafeNormal() * (FMath::Abs(GetGravityZ()) * GravityScale);
+				}
+			}
+
+			break;
+		}
+
+		case ENinjaGravityDirectionMode::Baked:
+		{
+			if (GravityField != nullptr)
+			{
+				Gravity = GravityField->SampleGravity(Point) * (FMath::Abs(GetGravityZ()) * GravityScale);
+			}
+
+			break;
+		}
+
+		case ENinjaGravityDirectionMode::Field:
+		{
+			const UNinjaGravityRegistrySubsystem* GravityRegistry = GetWorld()->GetSubsystem<UNinjaGravityRegistrySubsystem>();
+			if (GravityRegistry != nullptr)
+			{
+				// Blended sources also provide relative strength of gravity
+				Gravity = GravityRegistry->GetFieldGravity(Point) * (FMath::Abs(GetGravityZ()) * GravityScale);
+			}
+
+			break;
+		}
 	}
 
 #if !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
@@ -568,174 +1040,584 @@ FVector ANinjaPhysicsVolume::GetGravityDirection(const FVector& Point) const
 		return FVector::ZeroVector;
 	}
 
+	FScopeCycleCounter GravityCycleCounter(NinjaCharacterStats::GetGravityStatId(GravityDirectionMode));
+	NINJA_COUNT_GRAVITY_EVALUATIONS(1);
+
+	if (GravityDirectionFunc != nullptr)
+	{
+		FVector VectorA, VectorB;
+		ResolveGravityVectors(VectorA, VectorB);
+
+		return GravityDirectionFunc(VectorA, VectorB, Point) * ((GravityScale > 0.0f) ? 1.0f : -1.0f);
+	}
+
 	FVector GravityDir = FVector::ZeroVector;
 
 	switch (GravityDirectionMode)
 	{
-		case ENinjaGravityDirectionMode::Fixed:
+		case ENinjaGravityDirectionMode::SplineTangent:
 		{
-			GravityDir = GravityVectorA * ((GravityScale > 0.0f) ? 1.0f : -1.0f);
+			const USplineComponent* Spline = GetGravitySpline();
+
+			if (Spline != nullptr)
+			{
+				GravityDir = Spline->GetDirectionAtSplineInputKey(
+					FindGravitySplineInputKey(Spline, Point), ESplineCoordinateSpace::Type::World) *
+					((GravityScale > 0.0f) ? 1.0f : -1.0f);
+			}
+
 			break;
 		}
 
-		case ENinjaGravityDirectionMode::SplineTangent:
+		case ENinjaGravityDirectionMode::Spline:
 		{
-			USplineComponent* Spline = nullptr;
-			if (GravityActor != nullptr && !GravityActor->IsPendingKill())
-			{
-				Spline = Cast<USplineComponent>(
-					GravityActor->GetComponentByClass(USplineComponent::StaticClass()));
-			}
-			else
+			const USplineComponent* Spline = GetGravitySpline();
+
+			if (Spline != nullptr)
 			{
-				Spline = Cast<USplineComponent>(GetComponentByClass(USplineComponent::StaticClass()));
+				const FVector GravityPoint = Spline->GetLocationAtSplineInputKey(
+					FindGravitySplineInputKey(Spline, Point), ESplineCoordinateSpace::Type::World);
+				GravityDir = GravityPoint - Point;
+				if (!GravityDir.IsZero())
+				{
+					GravityDir = GravityDir.GetSafeNormal() *
+						((GravityScale > 0.0f) ? 1.0f : -1.0f);
+				}
 			}
 
+			break;
+		}
+
+		case ENinjaGravityDirectionMode::SplinePlane:
+		{
+			const USplineComponent* Spline = GetGravitySpline();
+
 			if (Spline != nullptr)
 			{
-				GravityDir = Spline->FindDirectionClosestToWorldLocation(
-					Point, ESplineCoordinateSpace::Type::World) *
-					((GravityScale > 0.0f) ? 1.0f : -1.0f);
+				const float InputKey = FindGravitySplineInputKey(Spline, Point);
+				const FVector ClosestLocation = Spline->GetLocationAtSplineInputKey(
+					InputKey, ESplineCoordinateSpace::Type::World);
+				const FVector ClosestUpVector = Spline->GetUpVectorAtSplineInputKey(
+					InputKey, ESplineCoordinateSpace::Type::World);
+
+				GravityDir = FVector::PointPlaneProject(Point,
+					ClosestLocation, ClosestUpVector) - Point;
+				if (!GravityDir.IsZero())
+				{
+					GravityDir = GravityDir.GetSafeNormal() *
+						((GravityScale > 0.0f) ? 1.0f : -1.0f);
+				}
 			}
 
 			break;
 		}
 
-		case ENinjaGravityDirectionMode::Point:
+		case ENinjaGravityDirectionMode::Collision:
 		{
-			FVector GravityPoint = GravityVectorA;
-
 			if (GravityActor != nullptr && !GravityActor->IsPendingKill())
 			{
-				GravityPoint = GravityActor->GetActorLocation();
+				FVector ClosestPoint;
+				if (Cast<UPrimitiveComponent>(GravityActor->GetRootComponent())->GetClosestPointOnCollision(
+					Point, ClosestPoint) > 0.0f)
+				{
+					GravityDir = ClosestPoint - Point;
+					if (!GravityDir.IsZero())
+					{
+						GravityDir = GravityDir.GetSafeNormal() *
+							((GravityScale > 0.0f) ? 1.0f : -1.0f);
+					}
+				}
 			}
+			else if (GravityActorProxy.HasCache())
+			{
+				// Collision geometry is streamed out, approximate it with its last bounds
+				FVector BoxOrigin, BoxExtent;
+				GravityActorProxy.GetCachedBounds(BoxOrigin, BoxExtent);
 
-			GravityDir = GravityPoint - Point;
-			if (!GravityDir.IsZero())
+				GravityDir = FBox(BoxOrigin - BoxExtent, BoxOrigin + BoxExtent).GetClosestPointTo(Point) - Point;
+				if (!GravityDir.IsZero())
+				{
+					GravityDir = GravityDir.GetSafeNormal() *
+						((GravityScale > 0.0f) ? 1.0f : -1.0f);
+				}
+			}
+
+			break;
+		}
+
+		case ENinjaGravityDirectionMode::Baked:
+		{
+			if (GravityField != nullptr)
 			{
-				GravityDir = GravityDir.GetSafeNormal() *
+				GravityDir = GravityField->SampleGravity(Point).GetSafeNormal() *
 					((GravityScale > 0.0f) ? 1.0f : -1.0f);
 			}
 
 			break;
 		}
 
-		case ENinjaGravityDirectionMode::Line:
+		case ENinjaGravityDirectionMode::Field:
 		{
-			GravityDir = FMath::ClosestPointOnInfiniteLine(
-				GravityVectorA, GravityVectorB, Point) - Point;
-			if (!GravityDir.IsZero())
+			const UNinjaGravityRegistrySubsystem* GravityRegistry = GetWorld()->GetSubsystem<UNinjaGravityRegistrySubsystem>();
+			if (GravityRegistry != nullptr)
 			{
-				GravityDir = GravityDir.GetSafeNormal() *
+				GravityDir = GravityRegistry->GetFieldGravity(Point).GetSafeNormal() *
 					((GravityScale > 0.0f) ? 1.0f : -1.0f);
 			}
 
 			break;
 		}
+	}
+
+	return GravityDir;
+}
+
+void ANinjaPhysicsVolume::SetGravityDirectionMode(ENinjaGravityDirectionMode NewGravityDirectionMode)
+{
+	GravityDirectionMode = NewGravityDirectionMode;
+	GravityDirectionFunc = FNinjaGravityEvaluator::Find(GravityDirectionMode);
+}
+
+void ANinjaPhysicsVolume::ResolveGravityVectors(FVector& OutVectorA, FVector& OutVectorB) const
+{
+	OutVectorA = GravityVectorA;
+	OutVectorB = GravityVectorB;
+
+	if (GravityActor != nullptr && !GravityActor->IsPendingKill())
+	{
+		if (GravityDirectionMode == ENinjaGravityDirectionMode::Point)
+		{
+			OutVectorA = GravityActor->GetActorLocation();
+		}
+		else if (GravityDirectionMode == ENinjaGravityDirectionMode::Box)
+		{
+			GravityActor->GetActorBounds(true, OutVectorA, OutVectorB);
+		}
+	}
+	else if (GravityActorProxy.HasCache())
+	{
+		// Actor is streamed out, use its cached data
+		if (GravityDirectionMode == ENinjaGravityDirectionMode::Point)
+		{
+			OutVectorA = GravityActorProxy.GetCachedLocation();
+		}
+		else if (GravityDirectionMode == ENinjaGravityDirectionMode::Box)
+		{
+			GravityActorProxy.GetCachedBounds(OutVectorA, OutVectorB);
+		}
+	}
+}
+
+void ANinjaPhysicsVolume::RefreshGravityActorProxy()
+{
+	AActor* SourceActor = GravityActorProxy.Get();
+	if (SourceActor == nullptr)
+	{
+		return;
+	}
+
+	if (SourceActor != GravityActor)
+	{
+		// Level of the Actor was streamed back in
+		GravityActor = SourceActor;
+		UpdateGravitySpline();
+	}
+
+	GravityActorProxy.Refresh(GravityDirectionMode);
+}
+
+float ANinjaPhysicsVolume::GetGravityMagnitude(const FVector& Point) const
+{
+	return FMath::Abs(GetGravityZ() * GravityScale);
+}
+
+void ANinjaPhysicsVolume::GetGravityBatch(TArrayView<const FVector> Points, TArrayView<FVector> OutGravities) const
+{
+	check(Points.Num() == OutGravities.Num());
+
+	const int32 NumPoints = Points.Num();
+	if (NumPoints == 0)
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_NinjaGravityBatch);
+
+	if (GravityScale == 0.0f)
+	{
+		for (FVector& Gravity : OutGravities)
+		{
+			Gravity = FVector::ZeroVector;
+		}
+
+		return;
+	}
 
+	bool bUseKernel = false;
+
+	switch (GravityDirectionMode)
+	{
+		case ENinjaGravityDirectionMode::Fixed:
+		case ENinjaGravityDirectionMode::Point:
+		case ENinjaGravityDirectionMode::Line:
 		case ENinjaGravityDirectionMode::Segment:
+		case ENinjaGravityDirectionMode::Plane:
+		case ENinjaGravityDirectionMode::Box:
 		{
-			GravityDir = FMath::ClosestPointOnLine(GravityVectorA,
-				GravityVectorB, Point) - Point;
-			if (!GravityDir.IsZero())
+			bUseKernel = true;
+			break;
+		}
+	}
+
+#if !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
+	if (NinjaPhysicsVolumeCVars::ShowGravity > 0)
+	{
+		// Debug drawing is only done by the scalar path
+		bUseKernel = false;
+	}
+#endif // !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
+
+	if (!bUseKernel)
+	{
+		for (int32 Index = 0; Index < NumPoints; ++Index)
+		{
+			OutGravities[Index] = GetGravity(Points[Index]);
+		}
+
+		return;
+	}
+
+	NINJA_COUNT_GRAVITY_EVALUATIONS(NumPoints);
+
+	const float Magnitude = FMath::Abs(GetGravityZ()) * GravityScale;
+
+	if (GravityDirectionMode == ENinjaGravityDirectionMode::Fixed)
+	{
+		// Same gravity everywhere
+		const FVector Gravity = GravityVectorA * Magnitude;
+		for (FVector& OutGravity : OutGravities)
+		{
+			OutGravity = Gravity;
+		}
+
+		return;
+	}
+
+	using namespace NinjaGravityBatch;
+
+	// Resolve mode data once for the whole batch
+	FVector VectorA, VectorB;
+	ResolveGravityVectors(VectorA, VectorB);
+
+	const VectorRegister MagnitudeReg = VectorSetFloat1(Magnitude);
+	const FVectors4 A = Splat(VectorA);
+
+	// Line and segment share the projection factor
+	const FVector LineDir = VectorB - VectorA;
+	const float LineSizeSquared = LineDir.SizeSquared();
+	const FVectors4 LineDirReg = Splat(LineDir);
+	const VectorRegister InvLineSizeSquared = VectorSetFloat1(
+		(LineSizeSquared < SMALL_NUMBER) ? 0.0f : 1.0f / LineSizeSquared);
+
+	// Box is stored as min and max corners
+	const FVectors4 BoxMin = Splat(VectorA - VectorB);
+	const FVectors4 BoxMax = Splat(VectorA + VectorB);
+
+	const FVectors4 PlaneNormal = Splat(VectorB);
+
+	for (int32 Index = 0; Index < NumPoints; Index += NumLanes)
+	{
+		const int32 Count = FMath::Min(NumLanes, NumPoints - Index);
+		const FVectors4 P = Load(Points.GetData() + Index, Count);
+
+		FVectors4 Dirs;
+
+		switch (GravityDirectionMode)
+		{
+			case ENinjaGravityDirectionMode::Point:
 			{
-				GravityDir = GravityDir.GetSafeNormal() *
-					((GravityScale > 0.0f) ? 1.0f : -1.0f);
+				Dirs = { VectorSubtract(A.X, P.X), VectorSubtract(A.Y, P.Y), VectorSubtract(A.Z, P.Z) };
+				break;
+			}
+
+			case ENinjaGravityDirectionMode::Line:
+			case ENinjaGravityDirectionMode::Segment:
+			{
+				const FVectors4 AP = { VectorSubtract(P.X, A.X), VectorSubtract(P.Y, A.Y), VectorSubtract(P.Z, A.Z) };
+				VectorRegister T = VectorMultiply(Dot(AP, LineDirReg), InvLineSizeSquared);
+				if (GravityDirectionMode == ENinjaGravityDirectionMode::Segment)
+				{
+					T = VectorMin(VectorMax(T, VectorZero()), VectorOne());
+				}
+
+				// Closest point is A + T * LineDir, direction is closest point minus P
+				Dirs = { VectorSubtract(VectorMultiply(LineDirReg.X, T), AP.X),
+					VectorSubtract(VectorMultiply(LineDirReg.Y, T), AP.Y),
+					VectorSubtract(VectorMultiply(LineDirReg.Z, T), AP.Z) };
+				break;
 			}
 
+			case ENinjaGravityDirectionMode::Plane:
+			{
+				const FVectors4 AP = { VectorSubtract(P.X, A.X), VectorSubtract(P.Y, A.Y), VectorSubtract(P.Z, A.Z) };
+				const VectorRegister Distance = VectorNegate(Dot(AP, PlaneNormal));
+				Dirs = { VectorMultiply(PlaneNormal.X, Distance), VectorMultiply(PlaneNormal.Y, Distance),
+					VectorMultiply(PlaneNormal.Z, Distance) };
+				break;
+			}
+
+			default:
+			{
+				// Closest point is the point clamped to the box
+				Dirs = { VectorSubtract(VectorMin(VectorMax(P.X, BoxMin.X), BoxMax.X), P.X),
+					VectorSubtract(VectorMin(VectorMax(P.Y, BoxMin.Y), BoxMax.Y), P.Y),
+					VectorSubtract(VectorMin(VectorMax(P.Z, BoxMin.Z), BoxMax.Z), P.Z) };
+				break;
+			}
+		}
+
+		Store(ToGravity(Dirs, MagnitudeReg), OutGravities.GetData() + Index, Count);
+	}
+}
+
+void ANinjaPhysicsVolume::UpdateGravitySpline()
+{
+	AActor* SplineOwner = (GravityActor != nullptr && !GravityActor->IsPendingKill()) ? GravityActor : this;
+	GravitySpline = Cast<USplineComponent>(SplineOwner->GetComponentByClass(USplineComponent::StaticClass()));
+
+	if (GravitySpline != nullptr && !GravitySplineTree.IsBuiltFor(GravitySpline))
+	{
+		GravitySplineTree.Build(GravitySpline);
+	}
+}
+
+const USplineComponent* ANinjaPhysicsVolume::GetGravitySpline() const
+{
+	const AActor* SplineOwner = (GravityActor != nullptr && !GravityActor->IsPendingKill()) ? GravityActor : this;
+	if (GravitySpline == nullptr || GravitySpline->IsPendingKill() || GravitySpline->GetOwner() != SplineOwner)
+	{
+		ANinjaPhysicsVolume* MutableThis = const_cast<ANinjaPhysicsVolume*>(this);
+		MutableThis->UpdateGravitySpline();
+	}
+
+	return GravitySpline;
+}
+
+float ANinjaPhysicsVolume::FindGravitySplineInputKey(const USplineComponent* Spline, const FVector& Point) const
+{
+	if (!GravitySplineTree.IsBuiltFor(Spline))
+	{
+		// Spline changed, rebuild its acceleration structure
+		ANinjaPhysicsVolume* MutableThis = const_cast<ANinjaPhysicsVolume*>(this);
+		MutableThis->GravitySplineTree.Build(Spline);
+	}
+
+	return GravitySplineTree.FindInputKeyClosestToWorldLocation(Spline, Point);
+}
+
+void ANinjaPhysicsVolume::PublishGravitySnapshot()
+{
+	FNinjaGravitySnapshot* NewSnapshot = GravitySnapshotBuffer.BeginWrite();
+	if (NewSnapshot == nullptr)
+	{
+		// Every other slot is being read, readers keep the previous snapshot
+		return;
+	}
+
+	const FNinjaGravitySnapshotPtr PreviousSnapshot = GravitySnapshotBuffer.Read();
+	FNinjaGravitySnapshot& Snapshot = *NewSnapshot;
+
+	Snapshot.Mode = GravityDirectionMode;
+	Snapshot.DirectionFunc = GravityDirectionFunc;
+	Snapshot.Scale = GravityScale;
+	Snapshot.Magnitude = FMath::Abs(GetGravityZ());
+	Snapshot.EngineGravityZ = GetGravityZ();
+	Snapshot.Direction = GetGravityDirection(GetActorLocation());
+	Snapshot.Transform = GetActorTransform();
+	Snapshot.Frame = GFrameCounter;
+
+	// Actor driven modes store the current state of the Actor
+	ResolveGravityVectors(Snapshot.VectorA, Snapshot.VectorB);
+
+	const bool bSplineMode = (GravityDirectionMode == ENinjaGravityDirectionMode::SplineTangent ||
+		GravityDirectionMode == ENinjaGravityDirectionMode::Spline ||
+		GravityDirectionMode == ENinjaGravityDirectionMode::SplinePlane);
+	Snapshot.Spline = FNinjaGravitySplineSamples::Sample(bSplineMode ? GetGravitySpline() : nullptr,
+		PreviousSnapshot.IsValid() ? PreviousSnapshot->Spline : nullptr);
+
+	if (GravityDirectionMode == ENinjaGravityDirectionMode::Baked && GravityField != nullptr)
+	{
+		Snapshot.FieldBounds = GravityField->GetBounds();
+		Snapshot.FieldDimensions = GravityField->GetDimensions();
+		Snapshot.FieldSamples = GravityField->GetSharedSamples();
+	}
+	else
+	{
+		Snapshot.FieldSamples.Reset();
+	}
+
+	GravitySnapshotBuffer.Publish();
+}
+
+void ANinjaPhysicsVolume::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(ANinjaPhysicsVolume, GravityState);
+}
+
+FNinjaGravityState ANinjaPhysicsVolume::MakeGravityState() const
+{
+	FNinjaGravityState NewGravityState;
+	NewGravityState.Mode = GravityDirectionMode;
+	NewGravityState.VectorA = FVector::ZeroVector;
+	NewGravityState.Scale = GetGravityScale();
+
+	switch (GravityDirectionMode)
+	{
+		case ENinjaGravityDirectionMode::Fixed:
+		{
+			NewGravityState.VectorA = GravityVectorA;
 			break;
 		}
 
+		case ENinjaGravityDirectionMode::SplineTangent:
 		case ENinjaGravityDirectionMode::Spline:
+		case ENinjaGravityDirectionMode::SplinePlane:
+		case ENinjaGravityDirectionMode::Collision:
+		{
+			NewGravityState.Actor = GravityActor;
+			break;
+		}
+
+		case ENinjaGravityDirectionMode::Point:
 		{
-			USplineComponent* Spline = nullptr;
 			if (GravityActor != nullptr && !GravityActor->IsPendingKill())
 			{
-				Spline = Cast<USplineComponent>(
-					GravityActor->GetComponentByClass(USplineComponent::StaticClass()));
+				NewGravityState.Actor = GravityActor;
 			}
 			else
 			{
-				Spline = Cast<USplineComponent>(GetComponentByClass(USplineComponent::StaticClass()));
+				NewGravityState.VectorA = GravityVectorA;
 			}
 
-			if (Spline != nullptr)
+			break;
+		}
+
+		case ENinjaGravityDirectionMode::Box:
+		{
+			if (GravityActor != nullptr && !GravityActor->IsPendingKill())
 			{
-				const FVector GravityPoint = Spline->FindLocationClosestToWorldLocation(
-					Point, ESplineCoordinateSpace::Type::World);
-				GravityDir = GravityPoint - Point;
-				if (!GravityDir.IsZero())
-				{
-					GravityDir = GravityDir.GetSafeNormal() *
-						((GravityScale > 0.0f) ? 1.0f : -1.0f);
-				}
+				NewGravityState.Actor = GravityActor;
+			}
+			else
+			{
+				NewGravityState.VectorA = GravityVectorA;
+				NewGravityState.VectorB = GravityVectorB;
 			}
 
 			break;
 		}
 
+		case ENinjaGravityDirectionMode::Line:
+		case ENinjaGravityDirectionMode::Segment:
 		case ENinjaGravityDirectionMode::Plane:
 		{
-			GravityDir = FVector::PointPlaneProject(Point, GravityVectorA,
-				GravityVectorB) - Point;
-			if (!GravityDir.IsZero())
-			{
-				GravityDir = GravityDir.GetSafeNormal() *
-					((GravityScale > 0.0f) ? 1.0f : -1.0f);
-			}
+			NewGravityState.VectorA = GravityVectorA;
+			NewGravityState.VectorB = GravityVectorB;
+			break;
+		}
+
+		case ENinjaGravityDirectionMode::Baked:
+		{
+			NewGravityState.Field = GravityField;
+			break;
+		}
+	}
 
+	return NewGravityState;
+}
+
+void ANinjaPhysicsVolume::OnRep_GravityState()
+{
+	ApplyGravityState(GravityState);
+}
+
+void ANinjaPhysicsVolume::ApplyGravityState(const FNinjaGravityState& NewGravityState)
+{
+	if (GravityScale != NewGravityState.Scale)
+	{
+		SetGravityScale(NewGravityState.Scale);
+	}
+
+	// Setters change gravity settings of tracked Ninjas too
+	switch (NewGravityState.Mode)
+	{
+		case ENinjaGravityDirectionMode::Fixed:
+		{
+			SetFixedGravityDirection(NewGravityState.VectorA);
 			break;
 		}
 
-		case ENinjaGravityDirectionMode::SplinePlane:
+		case ENinjaGravityDirectionMode::SplineTangent:
 		{
-			USplineComponent* Spline = nullptr;
-			if (GravityActor != nullptr && !GravityActor->IsPendingKill())
+			SetSplineTangentGravityDirection(NewGravityState.Actor);
+			break;
+		}
+
+		case ENinjaGravityDirectionMode::Point:
+		{
+			if (NewGravityState.Actor != nullptr)
 			{
-				Spline = Cast<USplineComponent>(
-					GravityActor->GetComponentByClass(USplineComponent::StaticClass()));
+				SetPointGravityDirectionFromActor(NewGravityState.Actor);
 			}
 			else
 			{
-				Spline = Cast<USplineComponent>(GetComponentByClass(USplineComponent::StaticClass()));
+				SetPointGravityDirection(NewGravityState.VectorA);
 			}
 
-			if (Spline != nullptr)
-			{
-				const float InputKey = Spline->FindInputKeyClosestToWorldLocation(Point);
-				const FVector ClosestLocation = Spline->GetLocationAtSplineInputKey(
-					InputKey, ESplineCoordinateSpace::Type::World);
-				const FVector ClosestUpVector = Spline->GetUpVectorAtSplineInputKey(
-					InputKey, ESplineCoordinateSpace::Type::World);
+			break;
+		}
 
-				GravityDir = FVector::PointPlaneProject(Point,
-					ClosestLocation, ClosestUpVector) - Point;
-				if (!GravityDir.IsZero())
-				{
-					GravityDir = GravityDir.GetSafeNormal() *
-						((GravityScale > 0.0f) ? 1.0f : -1.0f);
-				}
-			}
+		case ENinjaGravityDirectionMode::Line:
+		{
+			SetLineGravityDirection(NewGravityState.VectorA, NewGravityState.VectorB);
+			break;
+		}
 
+		case ENinjaGravityDirectionMode::Segment:
+		{
+			SetSegmentGravityDirection(NewGravityState.VectorA, NewGravityState.VectorB);
 			break;
 		}
 
-		case ENinjaGravityDirectionMode::Box:
+		case ENinjaGravityDirectionMode::Spline:
 		{
-			FVector BoxOrigin = GravityVectorA;
-			FVector BoxExtent = GravityVectorB;
+			SetSplineGravityDirection(NewGravityState.Actor);
+			break;
+		}
 
-			if (GravityActor != nullptr && !GravityActor->IsPendingKill())
+		case ENinjaGravityDirectionMode::Plane:
+		{
+			SetPlaneGravityDirection(NewGravityState.VectorA, NewGravityState.VectorB);
+			break;
+		}
+
+		case ENinjaGravityDirectionMode::SplinePlane:
+		{
+			SetSplinePlaneGravityDirection(NewGravityState.Actor);
+			break;
+		}
+
+		case ENinjaGravityDirectionMode::Box:
+		{
+			if (NewGravityState.Actor != nullptr)
 			{
-				GravityActor->GetActorBounds(true, BoxOrigin, BoxExtent);
+				SetBoxGravityDirectionFromActor(NewGravityState.Actor);
 			}
-
-			GravityDir = FBox(BoxOrigin - BoxExtent,
-				BoxOrigin + BoxExtent).GetClosestPointTo(Point) - Point;
-			if (!GravityDir.IsZero())
+			else
 			{
-				GravityDir = GravityDir.GetSafeNormal() *
-					((GravityScale > 0.0f) ? 1.0f : -1.0f);
+				SetBoxGravityDirection(NewGravityState.VectorA, NewGravityState.VectorB);
 			}
 
 			break;
@@ -743,31 +1625,43 @@ FVector ANinjaPhysicsVolume::GetGravityDirection(const FVector& Point) const
 
 		case ENinjaGravityDirectionMode::Collision:
 		{
-			if (GravityActor != nullptr && !GravityActor->IsPendingKill())
+			SetCollisionGravityDirection(NewGravityState.Actor);
+			break;
+		}
+
+		case ENinjaGravityDirectionMode::Baked:
+		{
+			if (NewGravityState.Field != nullptr)
 			{
-				FVector ClosestPoint;
-				if (Cast<UPrimitiveComponent>(GravityActor->GetRootComponent())->GetClosestPointOnCollision(
-					Point, ClosestPoint) > 0.0f)
-				{
-					GravityDir = ClosestPoint - Point;
-					if (!GravityDir.IsZero())
-					{
-						GravityDir = GravityDir.GetSafeNormal() *
-							((GravityScale > 0.0f) ? 1.0f : -1.0f);
-					}
-				}
+				SetBakedGravityDirection(NewGravityState.Field);
 			}
 
 			break;
 		}
-	}
 
-	return GravityDir;
+		case ENinjaGravityDirectionMode::Field:
+		{
+			SetFieldGravityDirection();
+			break;
+		}
+	}
 }
 
-float ANinjaPhysicsVolume::GetGravityMagnitude(const FVector& Point) const
+void ANinjaPhysicsVolume::ReplicateGravityToClients()
 {
-	return FMath::Abs(GetGravityZ() * GravityScale);
+	if (!bReplicateGravity || !HasAuthority() || GetNetMode() == ENetMode::NM_Standalone)
+	{
+		return;
+	}
+
+	const FNinjaGravityState NewGravityState = MakeGravityState();
+	if (NewGravityState != GravityState)
+	{
+		// One update reaches every client, then the volume goes dormant again
+		GravityState = NewGravityState;
+		FlushNetDormancy();
+		NINJA_COUNT_GRAVITY_RPCS(1);
+	}
 }
 
 void ANinjaPhysicsVolume::K2_SetFixedGravityDirection(const FVector& NewGravityDirection)
@@ -784,7 +1678,7 @@ void ANinjaPhysicsVolume::SetFixedGravityDirection(const FVector& NewFixedGravit
 		return;
 	}
 
-	GravityDirectionMode = ENinjaGravityDirectionMode::Fixed;
+	SetGravityDirectionMode(ENinjaGravityDirectionMode::Fixed);
 	GravityVectorA = NewFixedGravityDirection;
 
 	// Change gravity settings of Ninjas
@@ -795,6 +1689,8 @@ void ANinjaPhysicsVolume::SetFixedGravityDirection(const FVector& NewFixedGravit
 			Ninja->GetNinjaCharacterMovement()->SetFixedGravityDirection(NewFixedGravityDirection);
 		}
 	}
+
+	ReplicateGravityToClients();
 }
 
 void ANinjaPhysicsVolume::SetSplineTangentGravityDirection(AActor* NewGravityActor)
@@ -806,12 +1702,19 @@ void ANinjaPhysicsVolume::SetSplineTangentGravityDirection(AActor* NewGravityAct
 		return;
 	}
 
-	const USplineComponent* Spline = Cast<USplineComponent>(
+	USplineComponent* Spline = Cast<USplineComponent>(
 		NewGravityActor->GetComponentByClass(USplineComponent::StaticClass()));
 	if (Spline != nullptr)
 	{
-		GravityDirectionMode = ENinjaGravityDirectionMode::SplineTangent;
+		SetGravityDirectionMode(ENinjaGravityDirectionMode::SplineTangent);
 		GravityActor = NewGravityActor;
+		GravityActorProxy.Set(NewGravityActor, GravityDirectionMode);
+		GravitySpline = Spline;
+
+		if (!GravitySplineTree.IsBuiltFor(Spline))
+		{
+			GravitySplineTree.Build(Spline);
+		}
 
 		// Change gravity settings of Ninjas
 		for (ANinjaCharacter* Ninja : TrackedNinjas)
@@ -821,6 +1724,8 @@ void ANinjaPhysicsVolume::SetSplineTangentGravityDirection(AActor* NewGravityAct
 				Ninja->GetNinjaCharacterMovement()->SetSplineTangentGravityDirection(NewGravityActor);
 			}
 		}
+
+		ReplicateGravityToClients();
 	}
 }
 
@@ -832,9 +1737,10 @@ void ANinjaPhysicsVolume::SetPointGravityDirection(const FVector& NewGravityPoin
 		return;
 	}
 
-	GravityDirectionMode = ENinjaGravityDirectionMode::Point;
+	SetGravityDirectionMode(ENinjaGravityDirectionMode::Point);
 	GravityVectorA = NewGravityPoint;
 	GravityActor = nullptr;
+	GravityActorProxy.Reset();
 
 	// Change gravity settings of Ninjas
 	for (ANinjaCharacter* Ninja : TrackedNinjas)
@@ -844,6 +1750,8 @@ void ANinjaPhysicsVolume::SetPointGravityDirection(const FVector& NewGravityPoin
 			Ninja->GetNinjaCharacterMovement()->SetPointGravityDirection(NewGravityPoint);
 		}
 	}
+
+	ReplicateGravityToClients();
 }
 
 void ANinjaPhysicsVolume::SetPointGravityDirectionFromActor(AActor* NewGravityActor)
@@ -854,8 +1762,9 @@ void ANinjaPhysicsVolume::SetPointGravityDirectionFromActor(AActor* NewGravityAc
 		return;
 	}
 
-	GravityDirectionMode = ENinjaGravityDirectionMode::Point;
+	SetGravityDirectionMode(ENinjaGravityDirectionMode::Point);
 	GravityActor = NewGravityActor;
+	GravityActorProxy.Set(NewGravityActor, GravityDirectionMode);
 
 	// Change gravity settings of Ninjas
 	for (ANinjaCharacter* Ninja : TrackedNinjas)
@@ -865,6 +1774,8 @@ void ANinjaPhysicsVolume::SetPointGravityDirectionFromActor(AActor* NewGravityAc
 			Ninja->GetNinjaCharacterMovement()->SetPointGravityDirectionFromActor(NewGravityActor);
 		}
 	}
+
+	ReplicateGravityToClients();
 }
 
 void ANinjaPhysicsVolume::SetLineGravityDirection(const FVector& NewGravityLineStart, const FVector& NewGravityLineEnd)
@@ -876,7 +1787,7 @@ void ANinjaPhysicsVolume::SetLineGravityDirection(const FVector& NewGravityLineS
 		return;
 	}
 
-	GravityDirectionMode = ENinjaGravityDirectionMode::Line;
+	SetGravityDirectionMode(ENinjaGravityDirectionMode::Line);
 	GravityVectorA = NewGravityLineStart;
 	GravityVectorB = NewGravityLineEnd;
 
@@ -889,6 +1800,8 @@ void ANinjaPhysicsVolume::SetLineGravityDirection(const FVector& NewGravityLineS
 				NewGravityLineStart, NewGravityLineEnd);
 		}
 	}
+
+	ReplicateGravityToClients();
 }
 
 void ANinjaPhysicsVolume::SetSegmentGravityDirection(const FVector& NewGravitySegmentStart, const FVector& NewGravitySegmentEnd)
@@ -900,7 +1813,7 @@ void ANinjaPhysicsVolume::SetSegmentGravityDirection(const FVector& NewGravitySe
 		return;
 	}
 
-	GravityDirectionMode = ENinjaGravityDirectionMode::Segment;
+	SetGravityDirectionMode(ENinjaGravityDirectionMode::Segment);
 	GravityVectorA = NewGravitySegmentStart;
 	GravityVectorB = NewGravitySegmentEnd;
 
@@ -913,6 +1826,8 @@ void ANinjaPhysicsVolume::SetSegmentGravityDirection(const FVector& NewGravitySe
 				NewGravitySegmentStart, NewGravitySegmentEnd);
 		}
 	}
+
+	ReplicateGravityToClients();
 }
 
 void ANinjaPhysicsVolume::SetSplineGravityDirection(AActor* NewGravityActor)
@@ -924,12 +1839,19 @@ void ANinjaPhysicsVolume::SetSplineGravityDirection(AActor* NewGravityActor)
 		return;
 	}
 
-	const USplineComponent* Spline = Cast<USplineComponent>(
+	USplineComponent* Spline = Cast<USplineComponent>(
 		NewGravityActor->GetComponentByClass(USplineComponent::StaticClass()));
 	if (Spline != nullptr)
 	{
-		GravityDirectionMode = ENinjaGravityDirectionMode::Spline;
+		SetGravityDirectionMode(ENinjaGravityDirectionMode::Spline);
 		GravityActor = NewGravityActor;
+		GravityActorProxy.Set(NewGravityActor, GravityDirectionMode);
+		GravitySpline = Spline;
+
+		if (!GravitySplineTree.IsBuiltFor(Spline))
+		{
+			GravitySplineTree.Build(Spline);
+		}
 
 		// Change gravity settings of Ninjas
 		for (ANinjaCharacter* Ninja : TrackedNinjas)
@@ -939,6 +1861,8 @@ void ANinjaPhysicsVolume::SetSplineGravityDirection(AActor* NewGravityActor)
 				Ninja->GetNinjaCharacterMovement()->SetSplineGravityDirection(NewGravityActor);
 			}
 		}
+
+		ReplicateGravityToClients();
 	}
 }
 
@@ -956,7 +1880,7 @@ void ANinjaPhysicsVolume::SetPlaneGravityDirection(const FVector& NewGravityPlan
 		return;
 	}
 
-	GravityDirectionMode = ENinjaGravityDirectionMode::Plane;
+	SetGravityDirectionMode(ENinjaGravityDirectionMode::Plane);
 	GravityVectorA = NewGravityPlaneBase;
 	GravityVectorB = NewGravityPlaneNormal;
 
@@ -969,6 +1893,8 @@ void ANinjaPhysicsVolume::SetPlaneGravityDirection(const FVector& NewGravityPlan
 				NewGravityPlaneBase, NewGravityPlaneNormal);
 		}
 	}
+
+	ReplicateGravityToClients();
 }
 
 void ANinjaPhysicsVolume::SetSplinePlaneGravityDirection(AActor* NewGravityActor)
@@ -980,12 +1906,19 @@ void ANinjaPhysicsVolume::SetSplinePlaneGravityDirection(AActor* NewGravityActor
 		return;
 	}
 
-	const USplineComponent* Spline = Cast<USplineComponent>(
+	USplineComponent* Spline = Cast<USplineComponent>(
 		NewGravityActor->GetComponentByClass(USplineComponent::StaticClass()));
 	if (Spline != nullptr)
 	{
-		GravityDirectionMode = ENinjaGravityDirectionMode::SplinePlane;
+		SetGravityDirectionMode(ENinjaGravityDirectionMode::SplinePlane);
 		GravityActor = NewGravityActor;
+		GravityActorProxy.Set(NewGravityActor, GravityDirectionMode);
+		GravitySpline = Spline;
+
+		if (!GravitySplineTree.IsBuiltFor(Spline))
+		{
+			GravitySplineTree.Build(Spline);
+		}
 
 		// Change gravity settings of Ninjas
 		for (ANinjaCharacter* Ninja : TrackedNinjas)
@@ -995,6 +1928,8 @@ void ANinjaPhysicsVolume::SetSplinePlaneGravityDirection(AActor* NewGravityActor
 				Ninja->GetNinjaCharacterMovement()->SetSplinePlaneGravityDirection(NewGravityActor);
 			}
 		}
+
+		ReplicateGravityToClients();
 	}
 }
 
@@ -1006,10 +1941,11 @@ void ANinjaPhysicsVolume::SetBoxGravityDirection(const FVector& NewGravityBoxOri
 		return;
 	}
 
-	GravityDirectionMode = ENinjaGravityDirectionMode::Box;
+	SetGravityDirectionMode(ENinjaGravityDirectionMode::Box);
 	GravityVectorA = NewGravityBoxOrigin;
 	GravityVectorB = NewGravityBoxExtent;
 	GravityActor = nullptr;
+	GravityActorProxy.Reset();
 
 	// Change gravity settings of Ninjas
 	for (ANinjaCharacter* Ninja : TrackedNinjas)
@@ -1020,6 +1956,8 @@ void ANinjaPhysicsVolume::SetBoxGravityDirection(const FVector& NewGravityBoxOri
 				NewGravityBoxOrigin, NewGravityBoxExtent);
 		}
 	}
+
+	ReplicateGravityToClients();
 }
 
 void ANinjaPhysicsVolume::SetBoxGravityDirectionFromActor(AActor* NewGravityActor)
@@ -1030,8 +1968,9 @@ void ANinjaPhysicsVolume::SetBoxGravityDirectionFromActor(AActor* NewGravityActo
 		return;
 	}
 
-	GravityDirectionMode = ENinjaGravityDirectionMode::Box;
+	SetGravityDirectionMode(ENinjaGravityDirectionMode::Box);
 	GravityActor = NewGravityActor;
+	GravityActorProxy.Set(NewGravityActor, GravityDirectionMode);
 
 	// Change gravity settings of Ninjas
 	for (ANinjaCharacter* Ninja : TrackedNinjas)
@@ -1041,6 +1980,8 @@ void ANinjaPhysicsVolume::SetBoxGravityDirectionFromActor(AActor* NewGravityActo
 			Ninja->GetNinjaCharacterMovement()->SetBoxGravityDirectionFromActor(NewGravityActor);
 		}
 	}
+
+	ReplicateGravityToClients();
 }
 
 void ANinjaPhysicsVolume::SetCollisionGravityDirection(AActor* NewGravityActor)
@@ -1055,8 +1996,9 @@ void ANinjaPhysicsVolume::SetCollisionGravityDirection(AActor* NewGravityActor)
 	const UPrimitiveComponent* Primitive = Cast<UPrimitiveComponent>(NewGravityActor->GetRootComponent());
 	if (Primitive != nullptr)
 	{
-		GravityDirectionMode = ENinjaGravityDirectionMode::Collision;
+		SetGravityDirectionMode(ENinjaGravityDirectionMode::Collision);
 		GravityActor = NewGravityActor;
+		GravityActorProxy.Set(NewGravityActor, GravityDirectionMode);
 
 		// Change gravity settings of Ninjas
 		for (ANinjaCharacter* Ninja : TrackedNinjas)
@@ -1066,9 +2008,103 @@ void ANinjaPhysicsVolume::SetCollisionGravityDirection(AActor* NewGravityActor)
 				Ninja->GetNinjaCharacterMovement()->SetCollisionGravityDirection(NewGravityActor);
 			}
 		}
+
+		ReplicateGravityToClients();
 	}
 }
 
+void ANinjaPhysicsVolume::SetBakedGravityDirection(UNinjaGravityField* NewGravityField)
+{
+	if (NewGravityField == nullptr || !NewGravityField->IsValidField() ||
+		(GravityDirectionMode == ENinjaGravityDirectionMode::Baked &&
+		GravityField == NewGravityField))
+	{
+		return;
+	}
+
+	SetGravityDirectionMode(ENinjaGravityDirectionMode::Baked);
+	GravityField = NewGravityField;
+
+	// Change gravity settings of Ninjas
+	for (ANinjaCharacter* Ninja : TrackedNinjas)
+	{
+		if (Ninja != nullptr && !Ninja->IsPendingKill())
+		{
+			Ninja->GetNinjaCharacterMovement()->SetBakedGravityDirection(NewGravityField);
+		}
+	}
+
+	ReplicateGravityToClients();
+}
+
+void ANinjaPhysicsVolume::SetFieldGravityDirection()
+{
+	if (GravityDirectionMode == ENinjaGravityDirectionMode::Field)
+	{
+		return;
+	}
+
+	SetGravityDirectionMode(ENinjaGravityDirectionMode::Field);
+
+	// Change gravity settings of Ninjas
+	for (ANinjaCharacter* Ninja : TrackedNinjas)
+	{
+		if (Ninja != nullptr && !Ninja->IsPendingKill())
+		{
+			Ninja->GetNinjaCharacterMovement()->SetFieldGravityDirection();
+		}
+	}
+
+	ReplicateGravityToClients();
+}
+
+bool ANinjaPhysicsVolume::BakeGravityField(UNinjaGravityField* TargetGravityField, float CellSize)
+{
+	if (TargetGravityField == nullptr || GetBrushComponent() == nullptr ||
+		(GravityDirectionMode == ENinjaGravityDirectionMode::Baked &&
+		GravityField == TargetGravityField))
+	{
+		// A baked gravity field can't sample itself
+		return false;
+	}
+
+	// Sample unscaled gravity and skip debug drawing
+	TGuardValue<float> GravityScaleGuard(GravityScale, 1.0f);
+#if !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
+	TGuardValue<int32> ShowGravityGuard(NinjaPhysicsVolumeCVars::ShowGravity, 0);
+#endif // !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
+
+	return TargetGravityField->Bake(GetBrushComponent()->Bounds.GetBox(), CellSize,
+		FMath::Abs(GetGravityZ()), [this](const FVector& Point) { return GetGravity(Point); });
+}
+
+#if WITH_EDITOR
+void ANinjaPhysicsVolume::BakeGravityFieldInEditor()
+{
+	if (BakedGravityField == nullptr)
+	{
+		return;
+	}
+
+	if (BakedGravityFieldActor != nullptr && !BakedGravityFieldActor->IsPendingKill() &&
+		Cast<UPrimitiveComponent>(BakedGravityFieldActor->GetRootComponent()) != nullptr)
+	{
+		// Sample collision geometry of the given Actor; the evaluator of the current mode must not run
+		TGuardValue<ENinjaGravityDirectionMode> GravityDirectionModeGuard(GravityDirectionMode,
+			ENinjaGravityDirectionMode::Collision);
+		TGuardValue<FNinjaGravityDirectionFunc> GravityDirectionFuncGuard(GravityDirectionFunc,
+			FNinjaGravityEvaluator::Find(ENinjaGravityDirectionMode::Collision));
+		TGuardValue<AActor*> GravityActorGuard(GravityActor, BakedGravityFieldActor);
+
+		BakeGravityField(BakedGravityField, BakedGravityFieldCellSize);
+	}
+	else
+	{
+		BakeGravityField(BakedGravityField, BakedGravityFieldCellSize);
+	}
+}
+#endif // WITH_EDITOR
+
 float ANinjaPhysicsVolume::GetGravityScale() const
 {
 	return GravityScale;
@@ -1086,4 +2122,6 @@ void ANinjaPhysicsVolume::SetGravityScale(float NewGravityScale)
 			Ninja->GetNinjaCharacterMovement()->GravityScale = NewGravityScale;
 		}
 	}
+
+	ReplicateGravityToClients();
 }
@@ -19,7 +19,7 @@ ANinjaPhysicsVolumeSpline::ANinjaPhysicsVolumeSpline(const FObjectInitializer& O
 	SplineComponent->SetupAttachment(GetBrushComponent());
 
 	GravityActor = nullptr;
-	GravityDirectionMode = ENinjaGravityDirectionMode::Spline;
+	SetGravityDirectionMode(ENinjaGravityDirectionMode::Spline);
 	GravityVectorA = FVector::ZeroVector;
 	GravityVectorB = FVector::ZeroVector;
 }
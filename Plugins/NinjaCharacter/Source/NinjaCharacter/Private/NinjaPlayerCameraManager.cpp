@@ -4,14 +4,37 @@
 #include "NinjaPlayerCameraManager.h"
 
 #include "NinjaCharacter.h"
+#include "NinjaCharacterStats.h"
+#include "NinjaMath.h"
 
 #include "Camera/CameraModifier.h"
 #include "Engine/Engine.h"
 #include "IXRTrackingSystem.h"
 
 
-DECLARE_CYCLE_STAT(TEXT("Camera ProcessViewRotation"), STAT_Camera_ProcessViewRotation, STATGROUP_Game);
+DECLARE_CYCLE_STAT(TEXT("Ninja Camera ProcessViewRotation"), STAT_Camera_ProcessViewRotation, STATGROUP_NinjaCharacter);
 
+namespace NinjaPlayerCameraManager
+{
+	/**
+	 * View rotations closer than this are the same; AController::SetControlRotation
+	 * ignores changes smaller than 1e-3, this is larger to absorb them.
+	 */
+	static constexpr float ViewRotationTolerance = 1e-2f;
+}
+
+
+ANinjaPlayerCameraManager::ANinjaPlayerCameraManager(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	bGravityAwareView = false;
+	ViewAxisSpringStiffness = 12.0f;
+
+	ViewBasis = FQuat::Identity;
+	ViewBasisRotation = FRotator::ZeroRotator;
+	ViewBasisAxisZ = FVector::UpVector;
+	ViewAxisSpringSpeed = 0.0f;
+}
 
 void ANinjaPlayerCameraManager::ProcessViewRotation(float DeltaTime, FRotator& OutViewRotation, FRotator& OutDeltaRot)
 {
@@ -36,6 +59,17 @@ void ANinjaPlayerCameraManager::ProcessViewRotation(float DeltaTime, FRotator& O
 	const FVector ViewPlaneZ = (Pawn == nullptr) ? FVector::ZeroVector :
 		((Ninja != nullptr) ? Ninja->GetActorAxisZ() : Pawn->GetActorQuat().GetAxisZ());
 
+	const bool bIsHeadTrackingAllowed = IsHeadTrackingAllowed();
+
+	if (bGravityAwareView && Ninja != nullptr && !bIsHeadTrackingAllowed)
+	{
+		ProcessGravityAwareViewRotation(Ninja, DeltaTime, OutViewRotation, OutDeltaRot);
+		return;
+	}
+
+	// Cached view basis is only kept while used
+	ViewBasisCharacter.Reset();
+
 	if (!OutDeltaRot.IsZero())
 	{
 		// Obtain current view orthonormal axes
@@ -68,9 +102,6 @@ void ANinjaPlayerCameraManager::ProcessViewRotation(float DeltaTime, FRotator& O
 		OutDeltaRot = FRotator::ZeroRotator;
 	}
 
-	const bool bIsHeadTrackingAllowed =
-		GEngine->XRSystem.IsValid() &&
-		(GetWorld() != nullptr ? GEngine->XRSystem->IsHeadTrackingAllowedForWorld(*GetWorld()) : GEngine->XRSystem->IsHeadTrackingAllowed());
 	if (bIsHeadTrackingAllowed)
 	{
 		// With HMD devices, we can't limit the view orientation, because it's bound to the player's head
@@ -123,3 +154,141 @@ void ANinjaPlayerCameraManager::ProcessViewRotation(float DeltaTime, FRotator& O
 		}
 	}
 }
+
+bool ANinjaPlayerCameraManager::IsGravityAwareViewOf(const ANinjaCharacter* Character) const
+{
+	// Head tracked views don't use the cached view basis
+	return bGravityAwareView && Character != nullptr && GetViewTargetPawn() == Character && !IsHeadTrackingAllowed();
+}
+
+bool ANinjaPlayerCameraManager::IsHeadTrackingAllowed() const
+{
+	return GEngine->XRSystem.IsValid() &&
+		(GetWorld() != nullptr ? GEngine->XRSystem->IsHeadTrackingAllowedForWorld(*GetWorld()) : GEngine->XRSystem->IsHeadTrackingAllowed());
+}
+
+void ANinjaPlayerCameraManager::ProcessGravityAwareViewRotation(const ANinjaCharacter* Ninja, float DeltaTime,
+	FRotator& OutViewRotation, FRotator& OutDeltaRot)
+{
+	if (ViewBasisCharacter.Get() != Ninja)
+	{
+		// Build cached view basis from current view and capsule
+		ViewBasisCharacter = Ninja;
+		ViewBasis = OutViewRotation.Quaternion();
+		ViewBasisAxisZ = Ninja->GetActorAxisZ();
+		ViewAxisSpringSpeed = 0.0f;
+	}
+	else if (!OutViewRotation.Equals(ViewBasisRotation, NinjaPlayerCameraManager::ViewRotationTolerance))
+	{
+		// View rotation was changed by someone else, i.e. a camera modifier or a teleport
+		ViewBasis = OutViewRotation.Quaternion();
+	}
+
+	// Follow 'up' axis of the capsule
+	UpdateViewAxisSpring(Ninja->GetActorAxisZ(), DeltaTime);
+
+	if (!OutDeltaRot.IsZero())
+	{
+		// Obtain current view axes from cached basis
+		const FVector ViewRotationX = FNinjaMath::GetAxisX(ViewBasis);
+		const FVector ViewRotationY = FNinjaMath::GetAxisY(ViewBasis);
+
+		// Add delta rotation; yaw rotation happens around cached 'up' axis to avoid weird orbits
+		if (OutDeltaRot.Pitch != 0.0f)
+		{
+			ViewBasis = FQuat(ViewRotationY, FMath::DegreesToRadians(-OutDeltaRot.Pitch)) * ViewBasis;
+		}
+		if (OutDeltaRot.Yaw != 0.0f)
+		{
+			ViewBasis = FQuat(ViewBasisAxisZ, FMath::DegreesToRadians(OutDeltaRot.Yaw)) * ViewBasis;
+		}
+		if (OutDeltaRot.Roll != 0.0f)
+		{
+			ViewBasis = FQuat(ViewRotationX, FMath::DegreesToRadians(OutDeltaRot.Roll)) * ViewBasis;
+		}
+
+		// Consume delta rotation
+		OutDeltaRot = FRotator::ZeroRotator;
+	}
+
+	// Keep cached basis orthonormal
+	ViewBasis.Normalize();
+
+	// Limit the player's view pitch only
+	const FVector ViewRotationX = FNinjaMath::GetAxisX(ViewBasis);
+	const FVector ViewRotationY = FNinjaMath::GetAxisY(ViewBasis);
+	const FVector ViewRotationZ = FNinjaMath::GetAxisZ(ViewBasis);
+
+	// Obtain angle (with sign) between current view Z vector and cached 'up' axis
+	float PitchAngle = FMath::RadiansToDegrees(FMath::Acos(FMath::Clamp(ViewRotationZ | ViewBasisAxisZ, -1.0f, 1.0f)));
+	if ((ViewRotationX | ViewBasisAxisZ) < 0.0f)
+	{
+		PitchAngle *= -1.0f;
+	}
+
+	if (PitchAngle > ViewPitchMax || PitchAngle < ViewPitchMin)
+	{
+		// Make quaternion from zero pitch and rotate with maximum or minimum pitch
+		ViewBasis = FQuat(ViewRotationY, FMath::DegreesToRadians((PitchAngle > ViewPitchMax) ? -ViewPitchMax : -ViewPitchMin)) *
+			FQuat(FRotationMatrix::MakeFromZY(ViewBasisAxisZ, ViewRotationY));
+		ViewBasis.Normalize();
+	}
+
+	ViewBasisRotation = ViewBasis.Rotator();
+	OutViewRotation = ViewBasisRotation;
+}
+
+void ANinjaPlayerCameraManager::UpdateViewAxisSpring(const FVector& TargetAxisZ, float DeltaTime)
+{
+	const float Cosine = FMath::Clamp(ViewBasisAxisZ | TargetAxisZ, -1.0f, 1.0f);
+	if (Cosine >= 1.0f - KINDA_SMALL_NUMBER)
+	{
+		// Already aligned
+		ViewBasisAxisZ = TargetAxisZ;
+		ViewAxisSpringSpeed = 0.0f;
+		return;
+	}
+
+	FVector RotationAxis;
+	if (!FNinjaMath::Opposite(ViewBasisAxisZ, TargetAxisZ))
+	{
+		RotationAxis = (ViewBasisAxisZ ^ TargetAxisZ).GetSafeNormal();
+	}
+	else
+	{
+		// Flip view by preserving forward axis
+		RotationAxis = FVector::VectorPlaneProject(FNinjaMath::GetAxisX(ViewBasis), ViewBasisAxisZ).GetSafeNormal();
+		if (RotationAxis.IsZero())
+		{
+			RotationAxis = FNinjaMath::GetAxisY(ViewBasis);
+		}
+	}
+
+	const float Angle = FMath::Acos(Cosine);
+	float AngleStep = Angle;
+
+	if (ViewAxisSpringStiffness > 0.0f)
+	{
+		if (DeltaTime <= 0.0f)
+		{
+			return;
+		}
+
+		// Critically damped spring, stable with any frame time
+		const float Decay = FMath::Exp(-ViewAxisSpringStiffness * DeltaTime);
+		const float Impulse = (ViewAxisSpringStiffness * Angle - ViewAxisSpringSpeed) * DeltaTime;
+		const float NewAngle = (Angle + Impulse) * Decay;
+
+		ViewAxisSpringSpeed = (ViewAxisSpringSpeed + ViewAxisSpringStiffness * Impulse) * Decay;
+		AngleStep = FMath::Clamp(Angle - NewAngle, 0.0f, Angle);
+	}
+	else
+	{
+		ViewAxisSpringSpeed = 0.0f;
+	}
+
+	// Rotate cached basis and 'up' axis together
+	const FQuat StepRotation(RotationAxis, AngleStep);
+	ViewBasis = StepRotation * ViewBasis;
+	ViewBasisAxisZ = (AngleStep < Angle) ? StepRotation.RotateVector(ViewBasisAxisZ).GetSafeNormal() : TargetAxisZ;
+}
@@ -0,0 +1,340 @@
+// "Ninja Character" plugin, by Javier 'Xaklse' Osset; Copyright 2020
+
+
+#include "NinjaProjectileManager.h"
+
+#include "NinjaCharacterStats.h"
+#include "NinjaGravityRegistrySubsystem.h"
+#include "NinjaPhysicsVolume.h"
+
+#include "Engine/World.h"
+#include "GameFramework/ProjectileMovementComponent.h"
+
+
+FNinjaPooledProjectileParams::FNinjaPooledProjectileParams()
+	: Radius(0.0f)
+	, GravityScale(1.0f)
+	, LifeSpan(5.0f)
+	, TraceChannel(ECC_WorldDynamic)
+	, ImpactActorClass(nullptr)
+	, Owner(nullptr)
+{
+}
+
+FNinjaProjectileTickFunction::FNinjaProjectileTickFunction()
+	: Manager(nullptr)
+{
+	TickGroup = TG_PrePhysics;
+	bCanEverTick = true;
+	bStartWithTickEnabled = true;
+}
+
+void FNinjaProjectileTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread,
+	const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Manager != nullptr && TickType != LEVELTICK_ViewportsOnly)
+	{
+		Manager->TickProjectiles(DeltaTime);
+	}
+}
+
+FString FNinjaProjectileTickFunction::DiagnosticMessage()
+{
+	return TEXT("FNinjaProjectileTickFunction");
+}
+
+FName FNinjaProjectileTickFunction::DiagnosticContext(bool bDetailed)
+{
+	return FName(TEXT("NinjaProjectileManager"));
+}
+
+UNinjaProjectileManager::UNinjaProjectileManager()
+	: Super()
+{
+	NextProjectileId = 0;
+}
+
+void UNinjaProjectileManager::Deinitialize()
+{
+	if (TickFunction.IsTickFunctionRegistered())
+	{
+		TickFunction.UnRegisterTickFunction();
+	}
+
+	Ids.Empty();
+	IdIndices.Empty();
+	Locations.Empty();
+	PreviousLocations.Empty();
+	Velocities.Empty();
+	LifeSpans.Empty();
+	Radii.Empty();
+	GravityScales.Empty();
+	TraceChannels.Empty();
+	ImpactActorClasses.Empty();
+	Owners.Empty();
+	SweepHandles.Empty();
+	PendingImpacts.Empty();
+
+	Super::Deinitialize();
+}
+
+int32 UNinjaProjectileManager::FireProjectile(const FVector& Location, const FVector& Velocity,
+	const FNinjaPooledProjectileParams& Params)
+{
+	if (!TickFunction.IsTickFunctionRegistered())
+	{
+		UWorld* World = GetWorld();
+		if (World == nullptr || World->PersistentLevel == nullptr)
+		{
+			return INDEX_NONE;
+		}
+
+		TickFunction.Manager = this;
+		TickFunction.RegisterTickFunction(World->PersistentLevel);
+	}
+
+	const int32 ProjectileId = NextProjectileId;
+	NextProjectileId = (NextProjectileId < MAX_int32) ? NextProjectileId + 1 : 0;
+
+	IdIndices.Add(ProjectileId, Ids.Add(ProjectileId));
+	Locations.Add(Location);
+	PreviousLocations.Add(Location);
+	Velocities.Add(Velocity);
+	LifeSpans.Add(Params.LifeSpan);
+	Radii.Add(FMath::Max(0.0f, Params.Radius));
+	GravityScales.Add(Params.GravityScale);
+	TraceChannels.Add(Params.TraceChannel);
+	ImpactActorClasses.Add(Params.ImpactActorClass);
+	Owners.Add(Params.Owner);
+	SweepHandles.AddDefaulted();
+
+	return ProjectileId;
+}
+
+void UNinjaProjectileManager::DiscardProjectile(int32 ProjectileId)
+{
+	const int32* Index = IdIndices.Find(ProjectileId);
+	if (Index != nullptr)
+	{
+		RemoveProjectile(*Index);
+	}
+}
+
+void UNinjaProjectileManager::TickProjectiles(float DeltaTime)
+{
+	if (Ids.Num() == 0 || DeltaTime <= 0.0f)
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_NinjaProjectileManager);
+
+	// Previous movement is tested before moving again
+	ProcessSweepResults();
+
+	IntegrateProjectiles(DeltaTime);
+
+	RequestSweeps();
+}
+
+void UNinjaProjectileManager::ProcessSweepResults()
+{
+	UWorld* World = GetWorld();
+
+	// Iterate backwards; removed projectiles are replaced by already processed ones
+	for (int32 Index = Ids.Num() - 1; Index >= 0; --Index)
+	{
+		if (!SweepHandles[Index].IsValid())
+		{
+			continue;
+		}
+
+		FTraceDatum TraceDatum;
+		const bool bHasData = World->QueryTraceData(SweepHandles[Index], TraceDatum);
+		SweepHandles[Index] = FTraceHandle();
+
+		if (bHasData && TraceDatum.OutHits.Num() > 0 && TraceDatum.OutHits[0].bBlockingHit)
+		{
+			HandleImpact(Index, TraceDatum.OutHits[0]);
+		}
+	}
+
+	DispatchImpacts();
+}
+
+void UNinjaProjectileManager::IntegrateProjectiles(float DeltaTime)
+{
+	const int32 NumProjectiles = Ids.Num();
+	const UNinjaGravityRegistrySubsystem* GravityRegistry = GetWorld()->GetSubsystem<UNinjaGravityRegistrySubsystem>();
+
+	// Find the physics volume of every projectile without overlap events
+	BatchVolumes.SetNumUninitialized(NumProjectiles, false);
+	BatchOrder.SetNumUninitialized(NumProjectiles, false);
+	BatchGravities.SetNumUninitialized(NumProjectiles, false);
+
+	for (int32 Index = 0; Index < NumProjectiles; ++Index)
+	{
+		BatchVolumes[Index] = (GravityRegistry != nullptr) ? GravityRegistry->FindGravityVolume(Locations[Index]) : nullptr;
+		BatchOrder[Index] = Index;
+	}
+
+	BatchOrder.Sort([this](int32 A, int32 B)
+	{
+		return (UPTRINT)BatchVolumes[A] < (UPTRINT)BatchVolumes[B];
+	});
+
+	// Gather locations in sorted order so every batch is a contiguous slice
+	BatchPoints.SetNumUninitialized(NumProjectiles, false);
+	for (int32 Order = 0; Order < NumProjectiles; ++Order)
+	{
+		BatchPoints[Order] = Locations[BatchOrder[Order]];
+	}
+
+	// Evaluate gravity once per batch of projectiles that share a volume
+	const float WorldGravityZ = GetWorld()->GetGravityZ();
+	int32 BatchStart = 0;
+
+	while (BatchStart < NumProjectiles)
+	{
+		const ANinjaPhysicsVolume* BatchVolume = BatchVolumes[BatchOrder[BatchStart]];
+		int32 BatchEnd = BatchStart + 1;
+		while (BatchEnd < NumProjectiles && BatchVolumes[BatchOrder[BatchEnd]] == BatchVolume)
+		{
+			++BatchEnd;
+		}
+
+		const int32 BatchCount = BatchEnd - BatchStart;
+
+		if (BatchVolume == nullptr)
+		{
+			for (int32 Order = BatchStart; Order < BatchEnd; ++Order)
+			{
+				BatchGravities[Order] = FVector(0.0f, 0.0f, WorldGravityZ);
+			}
+		}
+		else
+		{
+			BatchVolume->GetGravityBatch(TArrayView<const FVector>(BatchPoints).Slice(BatchStart, BatchCount),
+				TArrayView<FVector>(BatchGravities).Slice(BatchStart, BatchCount));
+		}
+
+		BatchStart = BatchEnd;
+	}
+
+	// Constant acceleration during the step
+	const float HalfDeltaTimeSquared = 0.5f * DeltaTime * DeltaTime;
+
+	for (int32 Order = 0; Order < NumProjectiles; ++Order)
+	{
+		const int32 Index = BatchOrder[Order];
+		const FVector Acceleration = BatchGravities[Order] * GravityScales[Index];
+
+		PreviousLocations[Index] = Locations[Index];
+		Locations[Index] += Velocities[Index] * DeltaTime + Acceleration * HalfDeltaTimeSquared;
+		Velocities[Index] += Acceleration * DeltaTime;
+		LifeSpans[Index] -= DeltaTime;
+	}
+
+	for (int32 Index = NumProjectiles - 1; Index >= 0; --Index)
+	{
+		if (LifeSpans[Index] <= 0.0f)
+		{
+			RemoveProjectile(Index);
+		}
+	}
+}
+
+void UNinjaProjectileManager::RequestSweeps()
+{
+	UWorld* World = GetWorld();
+
+	for (int32 Index = 0; Index < Ids.Num(); ++Index)
+	{
+		FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(NinjaPooledProjectile), false, Owners[Index].Get());
+
+		// Every sweep of this frame runs together with other asynchronous traces
+		if (Radii[Index] > 0.0f)
+		{
+			SweepHandles[Index] = World->AsyncSweepByChannel(EAsyncTraceType::Single, PreviousLocations[Index],
+				Locations[Index], FQuat::Identity, TraceChannels[Index], FCollisionShape::MakeSphere(Radii[Index]),
+				QueryParams);
+		}
+		else
+		{
+			SweepHandles[Index] = World->AsyncLineTraceByChannel(EAsyncTraceType::Single, PreviousLocations[Index],
+				Locations[Index], TraceChannels[Index], QueryParams);
+		}
+	}
+}
+
+void UNinjaProjectileManager::HandleImpact(int32 Index, const FHitResult& Hit)
+{
+	FNinjaPendingProjectileImpact& Impact = PendingImpacts.AddDefaulted_GetRef();
+	Impact.ProjectileId = Ids[Index];
+	Impact.Hit = Hit;
+	Impact.Velocity = Velocities[Index];
+	Impact.ImpactActorClass = ImpactActorClasses[Index];
+	Impact.Owner = Owners[Index];
+
+	RemoveProjectile(Index);
+}
+
+void UNinjaProjectileManager::DispatchImpacts()
+{
+	UWorld* World = GetWorld();
+
+	for (const FNinjaPendingProjectileImpact& Impact : PendingImpacts)
+	{
+		AActor* ImpactActor = nullptr;
+
+		if (Impact.ImpactActorClass != nullptr)
+		{
+			AActor* ProjectileOwner = Impact.Owner.Get();
+
+			FActorSpawnParameters SpawnParams;
+			SpawnParams.Owner = ProjectileOwner;
+			SpawnParams.Instigator = (ProjectileOwner != nullptr) ? ProjectileOwner->GetInstigator() : nullptr;
+			SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+			ImpactActor = World->SpawnActor<AActor>(Impact.ImpactActorClass, Impact.Hit.Location,
+				Impact.Velocity.Rotation(), SpawnParams);
+
+			if (ImpactActor != nullptr)
+			{
+				// Full projectile continues from here and handles the hit by itself
+				UProjectileMovementComponent* ProjectileMovement = ImpactActor->FindComponentByClass<UProjectileMovementComponent>();
+				if (ProjectileMovement != nullptr)
+				{
+					ProjectileMovement->Velocity = Impact.Velocity;
+					ProjectileMovement->UpdateComponentVelocity();
+				}
+			}
+		}
+
+		OnProjectileImpact.Broadcast(Impact.ProjectileId, Impact.Hit, ImpactActor);
+	}
+
+	PendingImpacts.Reset();
+}
+
+void UNinjaProjectileManager::RemoveProjectile(int32 Index)
+{
+	// Last projectile takes the place of the removed one
+	IdIndices.Remove(Ids[Index]);
+	if (Index != Ids.Num() - 1)
+	{
+		IdIndices.Add(Ids.Last(), Index);
+	}
+
+	Ids.RemoveAtSwap(Index, 1, false);
+	Locations.RemoveAtSwap(Index, 1, false);
+	PreviousLocations.RemoveAtSwap(Index, 1, false);
+	Velocities.RemoveAtSwap(Index, 1, false);
+	LifeSpans.RemoveAtSwap(Index, 1, false);
+	Radii.RemoveAtSwap(Index, 1, false);
+	GravityScales.RemoveAtSwap(Index, 1, false);
+	TraceChannels.RemoveAtSwap(Index, 1, false);
+	ImpactActorClasses.RemoveAtSwap(Index, 1, false);
+	Owners.RemoveAtSwap(Index, 1, false);
+	SweepHandles.RemoveAtSwap(Index, 1, false);
+}
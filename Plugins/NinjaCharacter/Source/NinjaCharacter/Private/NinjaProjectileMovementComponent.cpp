@@ -3,9 +3,12 @@
 
 #include "NinjaProjectileMovementComponent.h"
 
+#include "NinjaGravityRegistrySubsystem.h"
 #include "NinjaMath.h"
 #include "NinjaPhysicsVolume.h"
 
+#include "Engine/World.h"
+
 
 UNinjaProjectileMovementComponent::UNinjaProjectileMovementComponent(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
@@ -13,9 +16,21 @@ UNinjaProjectileMovementComponent::UNinjaProjectileMovementComponent(const FObje
 	bComponentShouldUpdatePhysicsVolume = true;
 
 	bFollowGravityDirection = false;
+	bUseGravityRegistry = false;
 	OldGravityDirection = FVector::ZeroVector;
 }
 
+void UNinjaProjectileMovementComponent::OnRegister()
+{
+	if (bUseGravityRegistry)
+	{
+		// Physics volume isn't tracked through overlaps
+		bComponentShouldUpdatePhysicsVolume = false;
+	}
+
+	Super::OnRegister();
+}
+
 bool UNinjaProjectileMovementComponent::ShouldUseSubStepping() const
 {
 	return bForceSubStepping || (ShouldApplyGravity() && !GetGravity().IsZero()) ||
@@ -28,7 +43,7 @@ FVector UNinjaProjectileMovementComponent::ComputeVelocity(FVector InitialVeloci
 	{
 		FVector GravityDir;
 
-		const ANinjaPhysicsVolume* NinjaPhysicsVolume = Cast<ANinjaPhysicsVolume>(GetPhysicsVolume());
+		const ANinjaPhysicsVolume* NinjaPhysicsVolume = GetNinjaPhysicsVolume();
 		if (NinjaPhysicsVolume != nullptr)
 		{
 			GravityDir = NinjaPhysicsVolume->GetGravityDirection(
@@ -91,7 +106,7 @@ float UNinjaProjectileMovementComponent::GetGravityZ() const
 	{
 		return 0.0f;
 	}
-	const ANinjaPhysicsVolume* NinjaPhysicsVolume = Cast<ANinjaPhysicsVolume>(GetPhysicsVolume());
+	const ANinjaPhysicsVolume* NinjaPhysicsVolume = GetNinjaPhysicsVolume();
 	if (NinjaPhysicsVolume != nullptr)
 	{
 		return (NinjaPhysicsVolume->GetGravity(UpdatedComponent->GetComponentLocation()) *
@@ -108,7 +123,7 @@ FVector UNinjaProjectileMovementComponent::GetGravity() const
 		return FVector::ZeroVector;
 	}
 
-	const ANinjaPhysicsVolume* NinjaPhysicsVolume = Cast<ANinjaPhysicsVolume>(GetPhysicsVolume());
+	const ANinjaPhysicsVolume* NinjaPhysicsVolume = GetNinjaPhysicsVolume();
 	if (NinjaPhysicsVolume != nullptr)
 	{
 		return NinjaPhysicsVolume->GetGravity(UpdatedComponent->GetComponentLocation()) *
@@ -117,3 +132,19 @@ FVector UNinjaProjectileMovementComponent::GetGravity() const
 
 	return FVector(0.0f, 0.0f, UMovementComponent::GetGravityZ() * ProjectileGravityScale);
 }
+
+const ANinjaPhysicsVolume* UNinjaProjectileMovementComponent::GetNinjaPhysicsVolume() const
+{
+	if (bUseGravityRegistry && UpdatedComponent != nullptr)
+	{
+		const UWorld* World = GetWorld();
+		const UNinjaGravityRegistrySubsystem* GravityRegistry = (World != nullptr) ?
+			World->GetSubsystem<UNinjaGravityRegistrySubsystem>() : nullptr;
+		if (GravityRegistry != nullptr)
+		{
+			return GravityRegistry->FindGravityVolume(UpdatedComponent->GetComponentLocation());
+		}
+	}
+
+	return Cast<ANinjaPhysicsVolume>(GetPhysicsVolume());
+}
@@ -0,0 +1,200 @@
+// "Ninja Character" plugin, by Javier 'Xaklse' Osset; Copyright 2020
+
+
+#include "NinjaSplineSegmentTree.h"
+
+#include "Components/SplineComponent.h"
+
+
+/** Below this number of segments, testing every segment is already cheap. */
+static const int32 NINJA_SPLINE_TREE_MIN_SEGMENTS = 8;
+/** Maximum number of segments stored by a leaf node. */
+static const int32 NINJA_SPLINE_TREE_LEAF_SEGMENTS = 4;
+
+
+/**
+ * Computes the local space bounds of a spline segment.
+ * @param Curve - position curve of the spline
+ * @param SegmentIndex - index of the first point of the segment
+ * @return bounds that contain the whole segment
+ */
+static FBox ComputeSegmentBounds(const FInterpCurveVector& Curve, int32 SegmentIndex)
+{
+	const int32 LastPoint = Curve.Points.Num() - 1;
+	const bool bLoopSegment = Curve.bIsLooped && SegmentIndex == LastPoint;
+
+	const FInterpCurvePoint<FVector>& Point0 = Curve.Points[SegmentIndex];
+	const FInterpCurvePoint<FVector>& Point1 = Curve.Points[bLoopSegment ? 0 : SegmentIndex + 1];
+
+	FBox Bounds(ForceInit);
+	Bounds += Point0.OutVal;
+	Bounds += Point1.OutVal;
+
+	if (Point0.IsCurveKey())
+	{
+		// A cubic segment is contained by the convex hull of its Bezier control points
+		const float Diff = (bLoopSegment ? Point0.InVal + Curve.LoopKeyOffset : Point1.InVal) - Point0.InVal;
+		Bounds += Point0.OutVal + Point0.LeaveTangent * (Diff / 3.0f);
+		Bounds += Point1.OutVal - Point1.ArriveTangent * (Diff / 3.0f);
+	}
+
+	return Bounds;
+}
+
+
+FNinjaSplineSegmentTree::FNinjaSplineSegmentTree()
+	: SplineVersion(0)
+	, NumSplinePoints(0)
+{
+}
+
+bool FNinjaSplineSegmentTree::IsBuiltFor(const USplineComponent* Spline) const
+{
+	return (Spline != nullptr && SplineComponent.Get() == Spline &&
+		SplineVersion == Spline->SplineCurves.Version &&
+		NumSplinePoints == Spline->SplineCurves.Position.Points.Num());
+}
+
+void FNinjaSplineSegmentTree::Build(const USplineComponent* Spline)
+{
+	Reset();
+
+	if (Spline == nullptr)
+	{
+		return;
+	}
+
+	const FInterpCurveVector& Curve = Spline->SplineCurves.Position;
+
+	SplineComponent = Spline;
+	SplineVersion = Spline->SplineCurves.Version;
+	NumSplinePoints = Curve.Points.Num();
+
+	const int32 NumSegments = Curve.bIsLooped ? NumSplinePoints : NumSplinePoints - 1;
+	if (NumSegments < NINJA_SPLINE_TREE_MIN_SEGMENTS)
+	{
+		// Tree is considered built but empty
+		return;
+	}
+
+	TArray<FBox> SegmentBounds;
+	SegmentBounds.Reserve(NumSegments);
+	Segments.Reserve(NumSegments);
+
+	for (int32 SegmentIndex = 0; SegmentIndex < NumSegments; ++SegmentIndex)
+	{
+		SegmentBounds.Add(ComputeSegmentBounds(Curve, SegmentIndex));
+		Segments.Add(SegmentIndex);
+	}
+
+	Nodes.Reserve((NumSegments / NINJA_SPLINE_TREE_LEAF_SEGMENTS + 1) * 2);
+	Nodes.AddDefaulted();
+	BuildNode(0, 0, NumSegments, SegmentBounds);
+}
+
+void FNinjaSplineSegmentTree::BuildNode(int32 NodeIndex, int32 Start, int32 Count, const TArray<FBox>& SegmentBounds)
+{
+	FBox Bounds(ForceInit);
+	FBox CenterBounds(ForceInit);
+	for (int32 Index = Start; Index < Start + Count; ++Index)
+	{
+		Bounds += SegmentBounds[Segments[Index]];
+		CenterBounds += SegmentBounds[Segments[Index]].GetCenter();
+	}
+
+	Nodes[NodeIndex].Bounds = Bounds;
+
+	if (Count <= NINJA_SPLINE_TREE_LEAF_SEGMENTS)
+	{
+		Nodes[NodeIndex].FirstIndex = Start;
+		Nodes[NodeIndex].NumSegments = Count;
+		return;
+	}
+
+	// Split along the longest axis of segment centers
+	const FVector CenterExtent = CenterBounds.GetExtent();
+	const int32 Axis = (CenterExtent.X >= CenterExtent.Y && CenterExtent.X >= CenterExtent.Z) ? 0 :
+		((CenterExtent.Y >= CenterExtent.Z) ? 1 : 2);
+
+	TArrayView<int32>(Segments.GetData() + Start, Count).Sort([&SegmentBounds, Axis](int32 A, int32 B)
+	{
+		return SegmentBounds[A].GetCenter()[Axis] < SegmentBounds[B].GetCenter()[Axis];
+	});
+
+	const int32 FirstChild = Nodes.AddDefaulted(2);
+	Nodes[NodeIndex].FirstIndex = FirstChild;
+	Nodes[NodeIndex].NumSegments = 0;
+
+	const int32 HalfCount = Count / 2;
+	BuildNode(FirstChild, Start, HalfCount, SegmentBounds);
+	BuildNode(FirstChild + 1, Start + HalfCount, Count - HalfCount, SegmentBounds);
+}
+
+void FNinjaSplineSegmentTree::Reset()
+{
+	Nodes.Reset();
+	Segments.Reset();
+	SplineComponent.Reset();
+	SplineVersion = 0;
+	NumSplinePoints = 0;
+}
+
+float FNinjaSplineSegmentTree::FindInputKeyClosestToWorldLocation(const USplineComponent* Spline, const FVector& WorldLocation) const
+{
+	if (Nodes.Num() == 0 || !IsBuiltFor(Spline))
+	{
+		return Spline->FindInputKeyClosestToWorldLocation(WorldLocation);
+	}
+
+	const FInterpCurveVector& Curve = Spline->SplineCurves.Position;
+	const FVector LocalLocation = Spline->GetComponentTransform().InverseTransformPosition(WorldLocation);
+
+	float BestDistanceSq = BIG_NUMBER;
+	float BestInputKey = Curve.Points[0].InVal;
+
+	TArray<int32, TInlineAllocator<64>> NodeStack;
+	NodeStack.Add(0);
+
+	while (NodeStack.Num() > 0)
+	{
+		const FNode& Node = Nodes[NodeStack.Pop(false)];
+
+		// Skip nodes that can't contain a closer segment
+		if (Node.Bounds.ComputeSquaredDistanceToPoint(LocalLocation) >= BestDistanceSq)
+		{
+			continue;
+		}
+
+		if (Node.NumSegments > 0)
+		{
+			for (int32 Index = Node.FirstIndex; Index < Node.FirstIndex + Node.NumSegments; ++Index)
+			{
+				float DistanceSq;
+				const float InputKey = Curve.InaccurateFindNearestOnSegment(LocalLocation, Segments[Index], DistanceSq);
+				if (DistanceSq < BestDistanceSq)
+				{
+					BestDistanceSq = DistanceSq;
+					BestInputKey = InputKey;
+				}
+			}
+		}
+		else
+		{
+			// Push farthest child first so closest child is visited first
+			const float DistanceSqA = Nodes[Node.FirstIndex].Bounds.ComputeSquaredDistanceToPoint(LocalLocation);
+			const float DistanceSqB = Nodes[Node.FirstIndex + 1].Bounds.ComputeSquaredDistanceToPoint(LocalLocation);
+			if (DistanceSqA <= DistanceSqB)
+			{
+				NodeStack.Add(Node.FirstIndex + 1);
+				NodeStack.Add(Node.FirstIndex);
+			}
+			else
+			{
+				NodeStack.Add(Node.FirstIndex);
+				NodeStack.Add(Node.FirstIndex + 1);
+			}
+		}
+	}
+
+	return BestInputKey;
+}
@@ -0,0 +1,685 @@
+// "Ninja Character" plugin, by Javier 'Xaklse' Osset; Copyright 2020
+
+
+#include "NinjaSurfaceNavigationSubsystem.h"
+
+#include "NinjaCharacterMovementComponent.h"
+#include "NinjaCharacterStats.h"
+#include "NinjaPhysicsVolume.h"
+
+#include "AIController.h"
+#include "Algo/Reverse.h"
+#include "Async/Async.h"
+#include "Components/BrushComponent.h"
+#include "Components/CapsuleComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Character.h"
+#include "NavigationData.h"
+
+
+namespace NinjaSurfaceNavigationCVars
+{
+	static int32 MaxTilesPerFrame = 2;
+	FAutoConsoleVariableRef CVarMaxTilesPerFrame(
+		TEXT("nsn.MaxTilesPerFrame"),
+		MaxTilesPerFrame,
+		TEXT("Maximum number of surface graph tiles rebuilt per frame."),
+		ECVF_Default);
+
+	static int32 MaxSearchNodes = 16384;
+	FAutoConsoleVariableRef CVarMaxSearchNodes(
+		TEXT("nsn.MaxSearchNodes"),
+		MaxSearchNodes,
+		TEXT("Maximum number of surface graph nodes visited by a path query before giving up."),
+		ECVF_Default);
+}
+
+namespace NinjaSurfaceNavigation
+{
+	/** Amount of cells searched around start and goal locations of path queries. */
+	static constexpr int32 NearestNodeSearchCells = 2;
+}
+
+const FIntVector FNinjaSurfaceGraph::NeighborOffsets[FNinjaSurfaceGraph::NumNeighbors] =
+{
+	FIntVector(-1, -1, -1), FIntVector(0, -1, -1), FIntVector(1, -1, -1),
+	FIntVector(-1, 0, -1), FIntVector(0, 0, -1), FIntVector(1, 0, -1),
+	FIntVector(-1, 1, -1), FIntVector(0, 1, -1), FIntVector(1, 1, -1),
+	FIntVector(-1, -1, 0), FIntVector(0, -1, 0), FIntVector(1, -1, 0),
+	FIntVector(-1, 0, 0), FIntVector(1, 0, 0),
+	FIntVector(-1, 1, 0), FIntVector(0, 1, 0), FIntVector(1, 1, 0),
+	FIntVector(-1, -1, 1), FIntVector(0, -1, 1), FIntVector(1, -1, 1),
+	FIntVector(-1, 0, 1), FIntVector(0, 0, 1), FIntVector(1, 0, 1),
+	FIntVector(-1, 1, 1), FIntVector(0, 1, 1), FIntVector(1, 1, 1)
+};
+
+int32 FNinjaSurfaceGraph::FindNearestNode(const FVector& Point, int32 SearchCells) const
+{
+	const FIntVector Coords = GetCellCoordsAt(Point);
+
+	int32 NearestCell = INDEX_NONE;
+	float NearestDistSquared = BIG_NUMBER;
+
+	for (int32 Z = -SearchCells; Z <= SearchCells; ++Z)
+	{
+		for (int32 Y = -SearchCells; Y <= SearchCells; ++Y)
+		{
+			for (int32 X = -SearchCells; X <= SearchCells; ++X)
+			{
+				const int32 CellIndex = GetCellIndex(Coords + FIntVector(X, Y, Z));
+				const FNinjaSurfaceNode* Node = FindNode(CellIndex);
+				if (Node != nullptr)
+				{
+					const float DistSquared = FVector::DistSquared(Node->Location, Point);
+					if (DistSquared < NearestDistSquared)
+					{
+						NearestCell = CellIndex;
+						NearestDistSquared = DistSquared;
+					}
+				}
+			}
+		}
+	}
+
+	return NearestCell;
+}
+
+bool FNinjaSurfaceGraph::FindPath(int32 StartCell, int32 GoalCell, int32 MaxSearchNodes,
+	TArray<FVector>& OutPathPoints) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_NinjaSurfaceNavigationFindPath);
+
+	OutPathPoints.Reset();
+
+	const FNinjaSurfaceNode* StartNode = FindNode(StartCell);
+	const FNinjaSurfaceNode* GoalNode = FindNode(GoalCell);
+	if (StartNode == nullptr || GoalNode == nullptr)
+	{
+		return false;
+	}
+
+	/** Search state of a visited node. */
+	struct FSearchNode
+	{
+		float Cost;
+		int32 ParentCell;
+		bool bClosed;
+	};
+
+	/** Entry of the open list. */
+	struct FOpenNode
+	{
+		float Score;
+		int32 Cell;
+	};
+
+	TMap<int32, FSearchNode> Visited;
+	TArray<FOpenNode> OpenList;
+
+	const auto OpenPredicate = [](const FOpenNode& A, const FOpenNode& B)
+	{
+		return A.Score < B.Score;
+	};
+
+	Visited.Add(StartCell, {0.0f, INDEX_NONE, false});
+	OpenList.HeapPush({FVector::Dist(StartNode->Location, GoalNode->Location), StartCell}, OpenPredicate);
+
+	bool bFound = false;
+
+	while (OpenList.Num() > 0 && Visited.Num() < MaxSearchNodes)
+	{
+		FOpenNode Current;
+		OpenList.HeapPop(Current, OpenPredicate, false);
+
+		FSearchNode& CurrentSearch = Visited.FindChecked(Current.Cell);
+		if (CurrentSearch.bClosed)
+		{
+			// Stale entry of the open list
+			continue;
+		}
+
+		CurrentSearch.bClosed = true;
+		const float CurrentCost = CurrentSearch.Cost;
+
+		if (Current.Cell == GoalCell)
+		{
+			bFound = true;
+			break;
+		}
+
+		const FNinjaSurfaceNode& CurrentNode = *FindNode(Current.Cell);
+		const FIntVector CurrentCoords = GetCellCoords(Current.Cell);
+
+		for (int32 Neighbor = 0; Neighbor < NumNeighbors; ++Neighbor)
+		{
+			if ((CurrentNode.NeighborMask & (1u << Neighbor)) == 0)
+			{
+				continue;
+			}
+
+			const int32 NeighborCell = GetCellIndex(CurrentCoords + NeighborOffsets[Neighbor]);
+			const FNinjaSurfaceNode* NeighborNode = FindNode(NeighborCell);
+			if (NeighborNode == nullptr)
+			{
+				continue;
+			}
+
+			const float NeighborCost = CurrentCost + FVector::Dist(CurrentNode.Location, NeighborNode->Location);
+
+			FSearchNode* NeighborSearch = Visited.Find(NeighborCell);
+			if (NeighborSearch != nullptr && (NeighborSearch->bClosed || NeighborSearch->Cost <= NeighborCost))
+			{
+				continue;
+			}
+
+			Visited.Add(NeighborCell, {NeighborCost, Current.Cell, false});
+			OpenList.HeapPush({NeighborCost + FVector::Dist(NeighborNode->Location, GoalNode->Location),
+				NeighborCell}, OpenPredicate);
+		}
+	}
+
+	if (!bFound)
+	{
+		return false;
+	}
+
+	for (int32 Cell = GoalCell; Cell != INDEX_NONE; Cell = Visited.FindChecked(Cell).ParentCell)
+	{
+		OutPathPoints.Add(FindNode(Cell)->Location);
+	}
+
+	Algo::Reverse(OutPathPoints);
+
+	return true;
+}
+
+FNinjaSurfaceNavigationTickFunction::FNinjaSurfaceNavigationTickFunction()
+	: Subsystem(nullptr)
+{
+	TickGroup = TG_PostPhysics;
+	bCanEverTick = true;
+	bStartWithTickEnabled = true;
+}
+
+void FNinjaSurfaceNavigationTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType,
+	ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Subsystem != nullptr && TickType != LEVELTICK_ViewportsOnly)
+	{
+		Subsystem->TickSurfaceNavigation(DeltaTime);
+	}
+}
+
+FString FNinjaSurfaceNavigationTickFunction::DiagnosticMessage()
+{
+	return TEXT("FNinjaSurfaceNavigationTickFunction");
+}
+
+FName FNinjaSurfaceNavigationTickFunction::DiagnosticContext(bool bDetailed)
+{
+	return FName(TEXT("NinjaSurfaceNavigationSubsystem"));
+}
+
+UNinjaSurfaceNavigationSubsystem::UNinjaSurfaceNavigationSubsystem()
+	: Super()
+{
+}
+
+void UNinjaSurfaceNavigationSubsystem::Deinitialize()
+{
+	if (TickFunction.IsTickFunctionRegistered())
+	{
+		TickFunction.UnRegisterTickFunction();
+	}
+
+	// Running path queries keep their own reference to graphs
+	Entries.Empty();
+
+	Super::Deinitialize();
+}
+
+void UNinjaSurfaceNavigationSubsystem::BuildSurfaceGraph(ANinjaPhysicsVolume* Volume,
+	const UNinjaCharacterMovementComponent* AgentMovement, float CellSize)
+{
+	if (Volume == nullptr || AgentMovement == nullptr || AgentMovement->UpdatedPrimitive == nullptr ||
+		CellSize <= KINDA_SMALL_NUMBER)
+	{
+		return;
+	}
+
+	if (!TickFunction.IsTickFunctionRegistered())
+	{
+		UWorld* World = GetWorld();
+		if (World == nullptr || World->PersistentLevel == nullptr)
+		{
+			return;
+		}
+
+		TickFunction.Subsystem = this;
+		TickFunction.RegisterTickFunction(World->PersistentLevel);
+	}
+
+	RemoveSurfaceGraph(Volume);
+
+	const FBox Bounds = Volume->GetBrushComponent()->Bounds.GetBox();
+
+	TSharedRef<FNinjaSurfaceGraph, ESPMode::ThreadSafe> Graph = MakeShared<FNinjaSurfaceGraph, ESPMode::ThreadSafe>();
+	Graph->Origin = Bounds.Min;
+	Graph->CellSize = CellSize;
+	Graph->Dimensions = FIntVector(
+		FMath::Max(1, FMath::CeilToInt(Bounds.GetSize().X / CellSize)),
+		FMath::Max(1, FMath::CeilToInt(Bounds.GetSize().Y / CellSize)),
+		FMath::Max(1, FMath::CeilToInt(Bounds.GetSize().Z / CellSize)));
+	Graph->NumTiles = FIntVector(
+		FMath::DivideAndRoundUp(Graph->Dimensions.X, FNinjaSurfaceGraph::TileCells),
+		FMath::DivideAndRoundUp(Graph->Dimensions.Y, FNinjaSurfaceGraph::TileCells),
+		FMath::DivideAndRoundUp(Graph->Dimensions.Z, FNinjaSurfaceGraph::TileCells));
+	Graph->Tiles.SetNum(Graph->NumTiles.X * Graph->NumTiles.Y * Graph->NumTiles.Z);
+
+	FNinjaSurfaceGraphEntry Entry;
+	Entry.Volume = Volume;
+	Entry.AgentMovement = AgentMovement;
+	Entry.AgentRadius = 34.0f;
+	Entry.AgentHalfHeight = 88.0f;
+	Entry.MaxStepHeight = AgentMovement->MaxStepHeight;
+	Entry.TraceChannel = AgentMovement->UpdatedPrimitive->GetCollisionObjectType();
+	Entry.Graph = Graph;
+
+	const ACharacter* CharacterOwner = AgentMovement->GetCharacterOwner();
+	if (CharacterOwner != nullptr)
+	{
+		CharacterOwner->GetCapsuleComponent()->GetScaledCapsuleSize(Entry.AgentRadius, Entry.AgentHalfHeight);
+	}
+
+	const float WalkableFloorZ = FMath::Clamp(AgentMovement->GetWalkableFloorZ(), KINDA_SMALL_NUMBER, 1.0f);
+	Entry.WalkableSlopeTangent = FMath::Sqrt(1.0f - FMath::Square(WalkableFloorZ)) / WalkableFloorZ;
+
+	const int32 NumTiles = Graph->Tiles.Num();
+	Entry.DirtyTiles.Reserve(NumTiles);
+	for (int32 TileIndex = 0; TileIndex < NumTiles; ++TileIndex)
+	{
+		Entry.DirtyTiles.Add(TileIndex);
+	}
+
+	Entries.Add(MoveTemp(Entry));
+}
+
+void UNinjaSurfaceNavigationSubsystem::RemoveSurfaceGraph(const ANinjaPhysicsVolume* Volume)
+{
+	Entries.RemoveAllSwap([Volume](const FNinjaSurfaceGraphEntry& Entry)
+	{
+		return Entry.Volume.Get() == Volume;
+	});
+}
+
+void UNinjaSurfaceNavigationSubsystem::InvalidateArea(const FBox& Area)
+{
+	for (FNinjaSurfaceGraphEntry& Entry : Entries)
+	{
+		MarkTilesDirty(Entry, Area);
+	}
+}
+
+bool UNinjaSurfaceNavigationSubsystem::IsSurfaceGraphReady(const ANinjaPhysicsVolume* Volume) const
+{
+	const FNinjaSurfaceGraphEntry* Entry = Entries.FindByPredicate([Volume](const FNinjaSurfaceGraphEntry& Entry)
+	{
+		return Entry.Volume.Get() == Volume;
+	});
+
+	return Entry != nullptr && Entry->DirtyTiles.Num() == 0;
+}
+
+bool UNinjaSurfaceNavigationSubsystem::FindPathAsync(const FVector& Start, const FVector& Goal,
+	FNinjaSurfacePathDelegate OnPathFound)
+{
+	const FNinjaSurfaceGraphEntry* Entry = FindGraphEntry(Start);
+	if (Entry == nullptr)
+	{
+		return false;
+	}
+
+	TSharedPtr<const FNinjaSurfaceGraph, ESPMode::ThreadSafe> Graph = Entry->Graph;
+	const int32 MaxSearchNodes = NinjaSurfaceNavigationCVars::MaxSearchNodes;
+
+	// Graph is immutable once published, rebuilds of tiles publish a new one
+	Async(EAsyncExecution::ThreadPool, [Graph, Start, Goal, MaxSearchNodes, OnPathFound]()
+	{
+		TArray<FVector> PathPoints;
+
+		const int32 StartCell = Graph->FindNearestNode(Start, NinjaSurfaceNavigation::NearestNodeSearchCells);
+		const int32 GoalCell = Graph->FindNearestNode(Goal, NinjaSurfaceNavigation::NearestNodeSearchCells);
+
+		const bool bSuccess = StartCell != INDEX_NONE && GoalCell != INDEX_NONE &&
+			Graph->FindPath(StartCell, GoalCell, MaxSearchNodes, PathPoints);
+
+		if (bSuccess)
+		{
+			PathPoints.Insert(Start, 0);
+			PathPoints.Add(Goal);
+		}
+
+		AsyncTask(ENamedThreads::GameThread, [OnPathFound, bSuccess, PathPoints = MoveTemp(PathPoints)]()
+		{
+			OnPathFound.ExecuteIfBound(bSuccess, PathPoints);
+		});
+	});
+
+	return true;
+}
+
+bool UNinjaSurfaceNavigationSubsystem::RequestSurfaceMove(AAIController* Controller, const FVector& Goal,
+	float AcceptanceRadius)
+{
+	const APawn* Pawn = (Controller != nullptr) ? Controller->GetPawn() : nullptr;
+	if (Pawn == nullptr)
+	{
+		return false;
+	}
+
+	// Start at the feet of the pawn, along its own 'down' axis
+	FVector Start = Pawn->GetNavAgentLocation();
+	const ACharacter* Character = Cast<ACharacter>(Pawn);
+	if (Character != nullptr)
+	{
+		const UNinjaCharacterMovementComponent* NinjaMovement =
+			Cast<UNinjaCharacterMovementComponent>(Character->GetCharacterMovement());
+		if (NinjaMovement != nullptr)
+		{
+			Start = Character->GetActorLocation() - NinjaMovement->GetComponentAxisZ() *
+				Character->GetCapsuleComponent()->GetScaledCapsuleHalfHeight();
+		}
+	}
+
+	TWeakObjectPtr<AAIController> WeakController = Controller;
+
+	return FindPathAsync(Start, Goal, FNinjaSurfacePathDelegate::CreateLambda(
+		[WeakController, Goal, AcceptanceRadius](bool bSuccess, const TArray<FVector>& PathPoints)
+	{
+		AAIController* Controller = WeakController.Get();
+		if (!bSuccess || Controller == nullptr)
+		{
+			return;
+		}
+
+		// Path following component moves along the path with RequestDirectMove (or RequestPathMove)
+		FAIMoveRequest MoveRequest(Goal);
+		MoveRequest.SetAcceptanceRadius(AcceptanceRadius);
+
+		FNavPathSharedPtr Path = MakeShareable(new FNavigationPath(PathPoints, nullptr));
+		Controller->RequestMove(MoveRequest, Path);
+	}));
+}
+
+void UNinjaSurfaceNavigationSubsystem::TickSurfaceNavigation(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_NinjaSurfaceNavigationRebuild);
+
+	int32 TileBudget = NinjaSurfaceNavigationCVars::MaxTilesPerFrame;
+
+	for (int32 EntryIndex = Entries.Num() - 1; EntryIndex >= 0; --EntryIndex)
+	{
+		FNinjaSurfaceGraphEntry& Entry = Entries[EntryIndex];
+		if (!Entry.Volume.IsValid())
+		{
+			Entries.RemoveAtSwap(EntryIndex, 1, false);
+			continue;
+		}
+
+		if (Entry.DirtyTiles.Num() == 0 || TileBudget <= 0 || !Entry.AgentMovement.IsValid())
+		{
+			continue;
+		}
+
+		// Copy the table of tiles of the published graph; path queries still running keep the old one
+		TSharedRef<FNinjaSurfaceGraph, ESPMode::ThreadSafe> NewGraph =
+			MakeShared<FNinjaSurfaceGraph, ESPMode::ThreadSafe>(*Entry.Graph);
+		FNinjaWritableTiles WritableTiles;
+
+		const int32 NumTiles = FMath::Min(TileBudget, Entry.DirtyTiles.Num());
+		TileBudget -= NumTiles;
+
+		for (int32 Index = 0; Index < NumTiles; ++Index)
+		{
+			SampleTile(Entry, *NewGraph, Entry.DirtyTiles[Index], WritableTiles);
+		}
+
+		// Connections are made after sampling, neighbor tiles could have been rebuilt too
+		for (int32 Index = 0; Index < NumTiles; ++Index)
+		{
+			ConnectTile(Entry, *NewGraph, Entry.DirtyTiles[Index], WritableTiles);
+		}
+
+		Entry.DirtyTiles.RemoveAt(0, NumTiles, false);
+		Entry.Graph = NewGraph;
+	}
+}
+
+const UNinjaSurfaceNavigationSubsystem::FNinjaSurfaceGraphEntry* UNinjaSurfaceNavigationSubsystem::FindGraphEntry(
+	const FVector& Point) const
+{
+	const FNinjaSurfaceGraphEntry* FoundEntry = nullptr;
+	int32 FoundPriority = 0;
+
+	for (const FNinjaSurfaceGraphEntry& Entry : Entries)
+	{
+		const ANinjaPhysicsVolume* Volume = Entry.Volume.Get();
+		if (Volume != nullptr && (FoundEntry == nullptr || Volume->Priority > FoundPriority) &&
+			Volume->EncompassesPoint(Point))
+		{
+			FoundEntry = &Entry;
+			FoundPriority = Volume->Priority;
+		}
+	}
+
+	return FoundEntry;
+}
+
+void UNinjaSurfaceNavigationSubsystem::MarkTilesDirty(FNinjaSurfaceGraphEntry& Entry, const FBox& Area) const
+{
+	const FNinjaSurfaceGraph& Graph = *Entry.Graph;
+	const float TileSize = Graph.CellSize * FNinjaSurfaceGraph::TileCells;
+
+	// Traces of cells reach beyond their bounds, area is expanded by a cell
+	const FVector LocalMin = (Area.Min - Graph.Origin - FVector(Graph.CellSize)) / TileSize;
+	const FVector LocalMax = (Area.Max - Graph.Origin + FVector(Graph.CellSize)) / TileSize;
+
+	const FIntVector MinTile(
+		FMath::Max(0, FMath::FloorToInt(LocalMin.X)),
+		FMath::Max(0, FMath::FloorToInt(LocalMin.Y)),
+		FMath::Max(0, FMath::FloorToInt(LocalMin.Z)));
+	const FIntVector MaxTile(
+		FMath::Min(Graph.NumTiles.X - 1, FMath::FloorToInt(LocalMax.X)),
+		FMath::Min(Graph.NumTiles.Y - 1, FMath::FloorToInt(LocalMax.Y)),
+		FMath::Min(Graph.NumTiles.Z - 1, FMath::FloorToInt(LocalMax.Z)));
+
+	for (int32 Z = MinTile.Z; Z <= MaxTile.Z; ++Z)
+	{
+		for (int32 Y = MinTile.Y; Y <= MaxTile.Y; ++Y)
+		{
+			for (int32 X = MinTile.X; X <= MaxTile.X; ++X)
+			{
+				Entry.DirtyTiles.AddUnique(X + (Y + Z * Graph.NumTiles.Y) * Graph.NumTiles.X);
+			}
+		}
+	}
+}
+
+void UNinjaSurfaceNavigationSubsystem::SampleTile(const FNinjaSurfaceGraphEntry& Entry, FNinjaSurfaceGraph& Graph,
+	int32 TileIndex, FNinjaWritableTiles& WritableTiles) const
+{
+	const ANinjaPhysicsVolume* Volume = Entry.Volume.Get();
+	const UNinjaCharacterMovementComponent* AgentMovement = Entry.AgentMovement.Get();
+	UWorld* World = GetWorld();
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(NinjaSurfaceNavigation), false);
+	FCollisionResponseParams ResponseParams;
+	AgentMovement->InitCollisionParams(QueryParams, ResponseParams);
+
+	const FCollisionShape AgentShape = FCollisionShape::MakeCapsule(Entry.AgentRadius, Entry.AgentHalfHeight);
+	const float HalfDiagonal = Graph.CellSize * 0.8660254f;
+
+	// Every cell of the tile is sampled again, a new tile replaces the shared one
+	TSharedPtr<FNinjaSurfaceTile, ESPMode::ThreadSafe> Tile = MakeShared<FNinjaSurfaceTile, ESPMode::ThreadSafe>();
+	WritableTiles.Add(TileIndex, Tile);
+	Graph.Tiles[TileIndex] = Tile;
+
+	FIntVector MinCell, MaxCell;
+	GetTileCells(Entry, TileIndex, 0, MinCell, MaxCell);
+
+	for (int32 Z = MinCell.Z; Z <= MaxCell.Z; ++Z)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+		{
+			for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+			{
+				const FIntVector Coords(X, Y, Z);
+				const int32 CellIndex = Graph.GetCellIndex(Coords);
+
+				const FVector CellCenter = Graph.Origin + (FVector(Coords) + FVector(0.5f)) * Graph.CellSize;
+				if (!Volume->EncompassesPoint(CellCenter))
+				{
+					continue;
+				}
+
+				const FVector GravityDir = Volume->GetGravityDirection(CellCenter);
+				if (GravityDir.IsZero())
+				{
+					continue;
+				}
+
+				// Find the surface that faces local 'up' inside this cell
+				FHitResult Hit;
+				if (!World->LineTraceSingleByChannel(Hit, CellCenter - GravityDir * HalfDiagonal,
+					CellCenter + GravityDir * HalfDiagonal, Entry.TraceChannel, QueryParams, ResponseParams) ||
+					Graph.GetCellCoordsAt(Hit.ImpactPoint) != Coords)
+				{
+					continue;
+				}
+
+				const FVector Up = GravityDir * -1.0f;
+				if (!AgentMovement->IsWalkableEx(Hit, Up))
+				{
+					continue;
+				}
+
+				// Agent capsule must fit standing on the surface
+				const FVector AgentLocation = Hit.ImpactPoint + Up * (Entry.AgentHalfHeight + MAX_FLOOR_DIST);
+				if (World->OverlapBlockingTestByChannel(AgentLocation, FRotationMatrix::MakeFromZ(Up).ToQuat(),
+					Entry.TraceChannel, AgentShape, QueryParams, ResponseParams))
+				{
+					continue;
+				}
+
+				Tile->Nodes.Add(CellIndex, {Hit.ImpactPoint, Up, 0});
+			}
+		}
+	}
+}
+
+void UNinjaSurfaceNavigationSubsystem::ConnectTile(const FNinjaSurfaceGraphEntry& Entry, FNinjaSurfaceGraph& Graph,
+	int32 TileIndex, FNinjaWritableTiles& WritableTiles) const
+{
+	const UNinjaCharacterMovementComponent* AgentMovement = Entry.AgentMovement.Get();
+	UWorld* World = GetWorld();
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(NinjaSurfaceNavigation), false);
+	FCollisionResponseParams ResponseParams;
+	AgentMovement->InitCollisionParams(QueryParams, ResponseParams);
+
+	FIntVector MinCell, MaxCell;
+	GetTileCells(Entry, TileIndex, 1, MinCell, MaxCell);
+
+	for (int32 Z = MinCell.Z; Z <= MaxCell.Z; ++Z)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+		{
+			for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+			{
+				const FIntVector Coords(X, Y, Z);
+				const int32 CellIndex = Graph.GetCellIndex(Coords);
+				const FNinjaSurfaceNode* Node = Graph.FindNode(CellIndex);
+				if (Node == nullptr)
+				{
+					continue;
+				}
+
+				uint32 NeighborMask = 0;
+
+				for (int32 Neighbor = 0; Neighbor < FNinjaSurfaceGraph::NumNeighbors; ++Neighbor)
+				{
+					const int32 NeighborCell = Graph.GetCellIndex(Coords + FNinjaSurfaceGraph::NeighborOffsets[Neighbor]);
+					const FNinjaSurfaceNode* NeighborNode = Graph.FindNode(NeighborCell);
+					if (NeighborNode == nullptr)
+					{
+						continue;
+					}
+
+					// Height difference must be a step or a walkable slope
+					const FVector Delta = NeighborNode->Location - Node->Location;
+					const FVector Up = (Node->Up + NeighborNode->Up).GetSafeNormal();
+					const float Climb = FMath::Abs(Delta | Up);
+					if (Climb > Entry.MaxStepHeight + FVector::VectorPlaneProject(Delta, Up).Size() *
+						Entry.WalkableSlopeTangent)
+					{
+						continue;
+					}
+
+					if (World->LineTraceTestByChannel(Node->Location + Node->Up * Entry.AgentRadius,
+						NeighborNode->Location + NeighborNode->Up * Entry.AgentRadius, Entry.TraceChannel,
+						QueryParams, ResponseParams))
+					{
+						continue;
+					}
+
+					NeighborMask |= (1u << Neighbor);
+				}
+
+				// Border cells belong to neighbor tiles that are only copied if their connections changed
+				if (Node->NeighborMask != NeighborMask)
+				{
+					FNinjaSurfaceTile& Tile = GetWritableTile(Graph, Graph.GetTileIndex(Coords), WritableTiles);
+					Tile.Nodes.FindChecked(CellIndex).NeighborMask = NeighborMask;
+				}
+			}
+		}
+	}
+}
+
+FNinjaSurfaceTile& UNinjaSurfaceNavigationSubsystem::GetWritableTile(FNinjaSurfaceGraph& Graph, int32 TileIndex,
+	FNinjaWritableTiles& WritableTiles) const
+{
+	TSharedPtr<FNinjaSurfaceTile, ESPMode::ThreadSafe>* WritableTile = WritableTiles.Find(TileIndex);
+	if (WritableTile != nullptr)
+	{
+		return **WritableTile;
+	}
+
+	// Copy on write, the shared tile could be read by path queries of older graphs
+	const FNinjaSurfaceTilePtr& SharedTile = Graph.Tiles[TileIndex];
+	TSharedPtr<FNinjaSurfaceTile, ESPMode::ThreadSafe> Tile = SharedTile.IsValid() ?
+		MakeShared<FNinjaSurfaceTile, ESPMode::ThreadSafe>(*SharedTile) : MakeShared<FNinjaSurfaceTile, ESPMode::ThreadSafe>();
+
+	WritableTiles.Add(TileIndex, Tile);
+	Graph.Tiles[TileIndex] = Tile;
+
+	return *Tile;
+}
+
+void UNinjaSurfaceNavigationSubsystem::GetTileCells(const FNinjaSurfaceGraphEntry& Entry, int32 TileIndex,
+	int32 Border, FIntVector& OutMin, FIntVector& OutMax) const
+{
+	const FIntVector& Dimensions = Entry.Graph->Dimensions;
+	const FIntVector& NumTiles = Entry.Graph->NumTiles;
+	const FIntVector Tile(TileIndex % NumTiles.X, (TileIndex / NumTiles.X) % NumTiles.Y,
+		TileIndex / (NumTiles.X * NumTiles.Y));
+
+	OutMin = FIntVector(
+		FMath::Max(0, Tile.X * FNinjaSurfaceGraph::TileCells - Border),
+		FMath::Max(0, Tile.Y * FNinjaSurfaceGraph::TileCells - Border),
+		FMath::Max(0, Tile.Z * FNinjaSurfaceGraph::TileCells - Border));
+	OutMax = FIntVector(
+		FMath::Min(Dimensions.X - 1, (Tile.X + 1) * FNinjaSurfaceGraph::TileCells - 1 + Border),
+		FMath::Min(Dimensions.Y - 1, (Tile.Y + 1) * FNinjaSurfaceGraph::TileCells - 1 + Border),
+		FMath::Min(Dimensions.Z - 1, (Tile.Z + 1) * FNinjaSurfaceGraph::TileCells - 1 + Border));
+}
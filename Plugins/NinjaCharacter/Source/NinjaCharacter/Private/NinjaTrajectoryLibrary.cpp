@@ -0,0 +1,201 @@
+// "Ninja Character" plugin, by Javier 'Xaklse' Osset; Copyright 2020
+
+
+#include "NinjaTrajectoryLibrary.h"
+
+#include "NinjaGravityRegistrySubsystem.h"
+#include "NinjaPhysicsVolume.h"
+
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+
+
+FNinjaTrajectoryParams::FNinjaTrajectoryParams()
+	: StartLocation(FVector::ZeroVector)
+	, LaunchVelocity(FVector::ZeroVector)
+	, MaxSimTime(2.0f)
+	, GravityScale(1.0f)
+	, MinStepTime(0.01f)
+	, MaxStepTime(0.1f)
+	, GravityTolerance(0.05f)
+	, MaxSweeps(0)
+	, SweepRadius(0.0f)
+	, TraceChannel(ECC_WorldDynamic)
+	, IgnoredActor(nullptr)
+{
+}
+
+FNinjaTrajectoryResult::FNinjaTrajectoryResult()
+	: EndLocation(FVector::ZeroVector)
+	, EndVelocity(FVector::ZeroVector)
+	, EndTime(0.0f)
+	, NumPoints(0)
+	, NumSweeps(0)
+	, bBlockingHit(false)
+{
+}
+
+namespace NinjaTrajectory
+{
+	/**
+	 * Obtains the gravity that influences a given point in space.
+	 * @param World - world of the prediction
+	 * @param GravityRegistry - optional registry of physics volumes
+	 * @param Point - given point in space affected by gravity
+	 * @param OutGravity - receives current gravity
+	 * @param OutVolume - receives physics volume that contains the point, nullptr if none
+	 * @return true if gravity is constant inside the physics volume that contains the point
+	 */
+	static bool GetGravity(const UWorld* World, const UNinjaGravityRegistrySubsystem* GravityRegistry,
+		const FVector& Point, FVector& OutGravity, const ANinjaPhysicsVolume*& OutVolume)
+	{
+		const ANinjaPhysicsVolume* Volume = (GravityRegistry != nullptr) ?
+			GravityRegistry->FindGravityVolume(Point) : nullptr;
+		OutVolume = Volume;
+
+		if (Volume == nullptr)
+		{
+			OutGravity = FVector(0.0f, 0.0f, World->GetGravityZ());
+			return true;
+		}
+
+		OutGravity = Volume->GetGravity(Point);
+		return Volume->GetGravityDirectionMode() == ENinjaGravityDirectionMode::Fixed;
+	}
+}
+
+bool UNinjaTrajectoryLibrary::PredictNinjaTrajectory(const UObject* WorldContextObject,
+	const FNinjaTrajectoryParams& Params, TArrayView<FVector> OutPoints, FNinjaTrajectoryResult& OutResult)
+{
+	OutResult = FNinjaTrajectoryResult();
+	OutResult.EndLocation = Params.StartLocation;
+	OutResult.EndVelocity = Params.LaunchVelocity;
+
+	UWorld* World = GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::LogAndReturnNull);
+	if (World == nullptr || Params.MaxSimTime <= 0.0f || OutPoints.Num() == 0)
+	{
+		return false;
+	}
+
+	const UNinjaGravityRegistrySubsystem* GravityRegistry = World->GetSubsystem<UNinjaGravityRegistrySubsystem>();
+
+	const float MinStepTime = FMath::Max(KINDA_SMALL_NUMBER, Params.MinStepTime);
+	const float MaxStepTime = FMath::Max(MinStepTime, Params.MaxStepTime);
+	const float ToleranceSquared = FMath::Square(FMath::Max(KINDA_SMALL_NUMBER, Params.GravityTolerance));
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(NinjaPredictTrajectory), false, Params.IgnoredActor);
+	const FCollisionShape SweepShape = (Params.SweepRadius > 0.0f) ?
+		FCollisionShape::MakeSphere(Params.SweepRadius) : FCollisionShape();
+
+	FVector Location = Params.StartLocation;
+	FVector Velocity = Params.LaunchVelocity;
+	float Time = 0.0f;
+
+	while (Time < Params.MaxSimTime && OutResult.NumPoints < OutPoints.Num())
+	{
+		FVector StartGravity;
+		const ANinjaPhysicsVolume* StartVolume;
+		const bool bConstantGravity = NinjaTrajectory::GetGravity(World, GravityRegistry, Location, StartGravity,
+			StartVolume);
+		StartGravity *= Params.GravityScale;
+
+		float StepTime = FMath::Min(MaxStepTime, Params.MaxSimTime - Time);
+		FVector NewLocation, NewVelocity;
+
+		if (bConstantGravity)
+		{
+			// Constant acceleration has an exact solution while the step stays in the same gravity region;
+			// halve the step while it ends in another one, so it stops close to the boundary
+			while (true)
+			{
+				NewLocation = Location + Velocity * StepTime + StartGravity * (0.5f * StepTime * StepTime);
+
+				const ANinjaPhysicsVolume* EndVolume = (GravityRegistry != nullptr) ?
+					GravityRegistry->FindGravityVolume(NewLocation) : nullptr;
+				if (StepTime > MinStepTime && EndVolume != StartVolume)
+				{
+					StepTime = FMath::Max(MinStepTime, StepTime * 0.5f);
+					continue;
+				}
+
+				NewVelocity = Velocity + StartGravity * StepTime;
+				break;
+			}
+		}
+		else
+		{
+			// Compare gravity at both ends of the step and shorten it while they differ too much
+			const float MaxGravityChangeSquared = StartGravity.SizeSquared() * ToleranceSquared;
+
+			while (true)
+			{
+				NewLocation = Location + Velocity * StepTime + StartGravity * (0.5f * StepTime * StepTime);
+
+				FVector EndGravity;
+				const ANinjaPhysicsVolume* EndVolume;
+				NinjaTrajectory::GetGravity(World, GravityRegistry, NewLocation, EndGravity, EndVolume);
+				EndGravity *= Params.GravityScale;
+
+				if (StepTime > MinStepTime && (EndGravity - StartGravity).SizeSquared() > MaxGravityChangeSquared)
+				{
+					StepTime = FMath::Max(MinStepTime, StepTime * 0.5f);
+					continue;
+				}
+
+				const FVector AverageGravity = (StartGravity + EndGravity) * 0.5f;
+				NewLocation = Location + Velocity * StepTime + AverageGravity * (0.5f * StepTime * StepTime);
+				NewVelocity = Velocity + AverageGravity * StepTime;
+				break;
+			}
+		}
+
+		if (OutResult.NumSweeps < Params.MaxSweeps)
+		{
+			OutResult.NumSweeps++;
+
+			FHitResult Hit;
+			const bool bHit = (Params.SweepRadius > 0.0f) ?
+				World->SweepSingleByChannel(Hit, Location, NewLocation, FQuat::Identity, Params.TraceChannel,
+				SweepShape, QueryParams) :
+				World->LineTraceSingleByChannel(Hit, Location, NewLocation, Params.TraceChannel, QueryParams);
+
+			if (bHit && Hit.bBlockingHit)
+			{
+				// Velocity is interpolated linearly along the step
+				OutResult.HitResult = Hit;
+				OutResult.bBlockingHit = true;
+				OutResult.EndLocation = Hit.Location;
+				OutResult.EndVelocity = FMath::Lerp(Velocity, NewVelocity, Hit.Time);
+				OutResult.EndTime = Time + StepTime * Hit.Time;
+				OutPoints[OutResult.NumPoints++] = Hit.Location;
+
+				return true;
+			}
+		}
+
+		Location = NewLocation;
+		Velocity = NewVelocity;
+		Time += StepTime;
+
+		OutPoints[OutResult.NumPoints++] = Location;
+	}
+
+	OutResult.EndLocation = Location;
+	OutResult.EndVelocity = Velocity;
+	OutResult.EndTime = Time;
+
+	return false;
+}
+
+bool UNinjaTrajectoryLibrary::K2_PredictNinjaTrajectory(const UObject* WorldContextObject,
+	const FNinjaTrajectoryParams& Params, int32 MaxPoints, TArray<FVector>& OutPathPositions,
+	FNinjaTrajectoryResult& OutResult)
+{
+	OutPathPositions.SetNumUninitialized(FMath::Max(0, MaxPoints));
+
+	const bool bHit = PredictNinjaTrajectory(WorldContextObject, Params, OutPathPositions, OutResult);
+
+	OutPathPositions.SetNum(OutResult.NumPoints);
+
+	return bHit;
+}
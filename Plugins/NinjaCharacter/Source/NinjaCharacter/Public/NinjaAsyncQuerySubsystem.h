@@ -0,0 +1,112 @@
+// "Ninja Character" plugin, by Javier 'Xaklse' Osset; Copyright 2020
+
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "WorldCollision.h"
+#include "NinjaAsyncQuerySubsystem.generated.h"
+
+
+/** Speculative scene queries that can be requested one frame in advance. */
+enum class ENinjaAsyncQuery : uint8
+{
+	/** Floor probe along the predicted capsule 'down' axis. */
+	Floor,
+	/** Penetration check done when the capsule rotates around its center. */
+	Rotation
+};
+
+/**
+ * Collects speculative sweeps requested by movement components, runs them as
+ * asynchronous scene queries and hands their results back on the next frame.
+ */
+UCLASS()
+class NINJACHARACTER_API UNinjaAsyncQuerySubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UNinjaAsyncQuerySubsystem();
+
+	/** Implement this for deinitialization of instances of the system. */
+	virtual void Deinitialize() override;
+
+	/**
+	 * Requests an asynchronous sweep; its result is available on next frame.
+	 * @note A previous request of the same query and requester is discarded
+	 * @param Requester - object that owns the request
+	 * @param Query - kind of speculative query
+	 * @param Start - start location of the shape
+	 * @param End - end location of the shape
+	 * @param Rotation - rotation of the shape
+	 * @param TraceChannel - the 'channel' that this trace is in
+	 * @param CollisionShape - shape to sweep
+	 * @param Params - additional parameters used for the trace
+	 * @param ResponseParam - response container to be used for this trace
+	 */
+	void RequestSweep(const UObject* Requester, ENinjaAsyncQuery Query, const FVector& Start, const FVector& End,
+		const FQuat& Rotation, ECollisionChannel TraceChannel, const FCollisionShape& CollisionShape,
+		const FCollisionQueryParams& Params, const FCollisionResponseParams& ResponseParam);
+
+	/**
+	 * Obtains the result of a previously requested sweep if it matches the
+	 * sweep that would be done now; the request is removed either way.
+	 * @note Result is adjusted to the new start location assuming a planar impacted surface
+	 * @param Requester - object that owns the request
+	 * @param Query - kind of speculative query
+	 * @param Start - start location of the shape now
+	 * @param End - end location of the shape now
+	 * @param Rotation - rotation of the shape now
+	 * @param CollisionShape - shape to sweep now
+	 * @param MaxDistance - maximum distance allowed between requested and current start locations
+	 * @param MaxAngleCosine - cosine of maximum angle allowed between requested and current directions
+	 * @param OutHit - receives the first blocking hit found
+	 * @param bOutBlockingHit - receives true if the sweep found a blocking hit
+	 * @return true if the result of the request was usable, false if a synchronous sweep is needed
+	 */
+	bool ConsumeSweep(const UObject* Requester, ENinjaAsyncQuery Query, const FVector& Start, const FVector& End,
+		const FQuat& Rotation, const FCollisionShape& CollisionShape, float MaxDistance, float MaxAngleCosine,
+		FHitResult& OutHit, bool& bOutBlockingHit);
+
+protected:
+	/** Data of a requested sweep. */
+	struct FNinjaAsyncSweep
+	{
+		/** Handle of the asynchronous trace. */
+		FTraceHandle Handle;
+
+		/** Start location of the shape. */
+		FVector Start;
+
+		/** End location of the shape. */
+		FVector End;
+
+		/** Z rotation axis of the shape. */
+		FVector AxisZ;
+
+		/** Swept shape. */
+		FCollisionShape Shape;
+
+		/** Frame when the sweep was requested. */
+		uint64 Frame;
+	};
+
+	/** Requested sweeps, keyed by requester and query. */
+	TMap<uint64, FNinjaAsyncSweep> Sweeps;
+
+	/** Last frame when stale requests were removed. */
+	uint64 LastPruneFrame;
+
+	/**
+	 * Builds the key of a request.
+	 * @param Requester - object that owns the request
+	 * @param Query - kind of speculative query
+	 * @return key of the request
+	 */
+	static uint64 MakeKey(const UObject* Requester, ENinjaAsyncQuery Query);
+
+	/** Removes requests whose results expired. */
+	void PruneSweeps();
+};
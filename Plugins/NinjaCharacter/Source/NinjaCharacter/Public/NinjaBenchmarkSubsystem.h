@@ -0,0 +1,247 @@
+// "Ninja Character" plugin, by Javier 'Xaklse' Osset; Copyright 2020
+
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineBaseTypes.h"
+#include "Math/RandomStream.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "NinjaTypes.h"
+#include "NinjaBenchmarkSubsystem.generated.h"
+
+
+class ANinjaCharacter;
+class ANinjaPhysicsVolume;
+class FJsonValue;
+class UNinjaBenchmarkSubsystem;
+
+/**
+ * Settings of a scripted benchmark run by a UNinjaBenchmarkSubsystem.
+ */
+USTRUCT(BlueprintType)
+struct NINJACHARACTER_API FNinjaBenchmarkSettings
+{
+	GENERATED_BODY()
+
+public:
+	FNinjaBenchmarkSettings();
+
+	/** Class of the AI driven characters spawned by the benchmark. */
+	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="NinjaBenchmark")
+	TSubclassOf<ANinjaCharacter> CharacterClass;
+
+	/** Amounts of characters measured for every gravity mode. */
+	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="NinjaBenchmark")
+	TArray<int32> CharacterCounts;
+
+	/** Gravity modes measured; modes that require Actors or assets are skipped. */
+	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="NinjaBenchmark")
+	TArray<ENinjaGravityDirectionMode> GravityModes;
+
+	/** Amount of pooled projectiles kept in flight while measuring. */
+	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="NinjaBenchmark",Meta=(ClampMin="0",UIMin="0"))
+	int32 NumProjectiles;
+
+	/** Amount of frames simulated before measuring a case. */
+	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="NinjaBenchmark",Meta=(ClampMin="0",UIMin="0"))
+	int32 WarmupFrames;
+
+	/** Amount of frames measured per case. */
+	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="NinjaBenchmark",Meta=(ClampMin="1",UIMin="1"))
+	int32 MeasuredFrames;
+
+	/** Seed of every random decision of the scripted scenario. */
+	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="NinjaBenchmark")
+	int32 RandomSeed;
+
+	/** Radius of the area around the benchmark center where characters are spawned and wander. */
+	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="NinjaBenchmark",Meta=(ClampMin="0",UIMin="0"))
+	float SpawnRadius;
+
+	/** If true, the application exits when the benchmark finishes. */
+	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="NinjaBenchmark")
+	bool bQuitWhenFinished;
+};
+
+/**
+ * Tick function that drives the scripted scenario of a UNinjaBenchmarkSubsystem.
+ */
+USTRUCT()
+struct FNinjaBenchmarkTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+public:
+	FNinjaBenchmarkTickFunction();
+
+	/** Benchmark subsystem that owns this tick function. */
+	UNinjaBenchmarkSubsystem* Subsystem;
+
+	/**
+	 * Abstract function to actually execute the tick.
+	 * @param DeltaTime - frame time to advance, in seconds
+	 * @param TickType - kind of tick for this frame
+	 * @param CurrentThread - thread we are executing on, useful to pass along as new tasks are created
+	 * @param MyCompletionGraphEvent - completion event for this task
+	 */
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread,
+		const FGraphEventRef& MyCompletionGraphEvent) override;
+
+	/** Abstract function to describe this tick. Used to print messages about illegal cycles in the dependency graph. */
+	virtual FString DiagnosticMessage() override;
+
+	/** Function used to describe this tick for active tick reporting. */
+	virtual FName DiagnosticContext(bool bDetailed) override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FNinjaBenchmarkTickFunction> : public TStructOpsTypeTraitsBase2<FNinjaBenchmarkTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
+/**
+ * Measures how Ninja movement scales: for every gravity mode and amount of
+ * characters, AI driven characters wander around with a fixed seed while
+ * pooled projectiles fly, and frame time, gravity evaluations, floor sweeps,
+ * gravity replication and sent network bytes are averaged and saved as JSON
+ * to the profiling directory. Run it in a map with floor (and optionally a
+ * Ninja physics volume that becomes the benchmark center) with the
+ * Ninja.Benchmark console command, i.e. with -ExecCmds from an automated job,
+ * and -benchmark -fps=60 for a deterministic frame time.
+ */
+UCLASS()
+class NINJACHARACTER_API UNinjaBenchmarkSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UNinjaBenchmarkSubsystem();
+
+	/** Implement this for deinitialization of instances of the system. */
+	virtual void Deinitialize() override;
+
+	/**
+	 * Starts a benchmark; a running benchmark is stopped first.
+	 * @param NewSettings - settings of the benchmark
+	 * @return true if the benchmark started
+	 */
+	bool StartBenchmark(const FNinjaBenchmarkSettings& NewSettings);
+
+	/**
+	 * Stops the running benchmark without saving results.
+	 */
+	void StopBenchmark();
+
+	/**
+	 * Checks if a benchmark is running.
+	 * @return true if a benchmark is running
+	 */
+	FORCEINLINE bool IsBenchmarkRunning() const
+	{
+		return CaseIndex != INDEX_NONE;
+	}
+
+	/**
+	 * Advances the scripted scenario of the running benchmark.
+	 * @param DeltaTime - frame time to advance, in seconds
+	 */
+	void TickBenchmark(float DeltaTime);
+
+protected:
+	/**
+	 * Prepares the world for the current case.
+	 * @return true if the case can be measured
+	 */
+	bool StartCase();
+
+	/**
+	 * Records results of the current case and cleans the world.
+	 */
+	void FinishCase();
+
+	/**
+	 * Applies the gravity mode of the current case to a character, or to the
+	 * benchmark physics volume.
+	 * @param Character - character that receives the gravity mode, nullptr for the physics volume
+	 * @param Mode - mode that determines direction of gravity
+	 */
+	void ApplyGravityMode(ANinjaCharacter* Character, ENinjaGravityDirectionMode Mode) const;
+
+	/**
+	 * Feeds scripted movement input to every character.
+	 */
+	void DriveCharacters();
+
+	/**
+	 * Fires pooled projectiles until the desired amount is in flight.
+	 */
+	void RefillProjectiles();
+
+	/**
+	 * Destroys every spawned character and its controller.
+	 */
+	void DestroyCharacters();
+
+	/**
+	 * Saves results of every measured case to a file.
+	 */
+	void SaveResults() const;
+
+	/**
+	 * Obtains the amount of bytes sent by the network driver of the world.
+	 * @return total amount of sent bytes, zero without network driver
+	 */
+	int64 GetNetOutBytes() const;
+
+protected:
+	/** Settings of the running benchmark. */
+	FNinjaBenchmarkSettings Settings;
+
+	/** Index of the current case, INDEX_NONE if no benchmark is running. */
+	int32 CaseIndex;
+
+	/** Frames simulated in the current case, including warmup. */
+	int32 CaseFrame;
+
+	/** Random stream of the scripted scenario. */
+	FRandomStream RandomStream;
+
+	/** Center of the area where characters wander. */
+	FVector Center;
+
+	/** Optional physics volume that receives the gravity mode of every case. */
+	TWeakObjectPtr<ANinjaPhysicsVolume> Volume;
+
+	/** Characters spawned for the current case. */
+	UPROPERTY(Transient)
+	TArray<ANinjaCharacter*> Characters;
+
+	/** Current destination of every character. */
+	TArray<FVector> Waypoints;
+
+	/** Time of the last tick, in seconds. */
+	double LastTickTime;
+
+	/** Accumulated frame time of the measured frames, in milliseconds. */
+	double FrameTimeSum;
+
+	/** Longest measured frame, in milliseconds. */
+	double FrameTimeMax;
+
+	/** Accumulated game thread time of the measured frames, in milliseconds. */
+	double GameThreadTimeSum;
+
+	/** Sent network bytes when measuring started. */
+	int64 StartNetOutBytes;
+
+	/** JSON objects with results of every measured case. */
+	TArray<TSharedPtr<FJsonValue>> Results;
+
+	/** Tick function that drives the scripted scenario. */
+	FNinjaBenchmarkTickFunction TickFunction;
+};
@@ -91,7 +91,10 @@ protected:
 	virtual void TransformUpdated(class USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport);
 
 public:
-	/** If true, the aim control rotation of the Controller is rotated whenever the capsule is aligned to something. */
+	/**
+	 * If true, the aim control rotation of the Controller is rotated whenever the capsule is aligned to something.
+	 * @note Ignored while viewed by a gravity-aware Ninja camera manager, which interpolates the view instead
+	 */
 	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="NinjaCharacter")
 	uint32 bCapsuleRotatesControlRotation:1;
 
@@ -225,6 +228,20 @@ public:
 	 */
 	FVector GetActorAxisZ() const;
 
+	/**
+	 * Return the location of the root component, interpolated between fixed
+	 * time steps of movement if they are enabled.
+	 * @return interpolated location of the root component
+	 */
+	FVector GetInterpolatedActorLocation() const;
+
+	/**
+	 * Return the rotation of the root component, interpolated between fixed
+	 * time steps of movement if they are enabled.
+	 * @return interpolated rotation of the root component
+	 */
+	FQuat GetInterpolatedActorQuat() const;
+
 public:
 	/**
 	 * Smoothly interpolates location and rotation of an attached component.
@@ -8,12 +8,60 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/CharacterMovementComponent.h"
+#include "NinjaAsyncQuerySubsystem.h"
 #include "NinjaCharacterMovementReplication.h"
+#include "NinjaGravityActorProxy.h"
+#include "NinjaGravityEvaluator.h"
+#include "NinjaGravitySnapshot.h"
+#include "NinjaGravityState.h"
 #include "NinjaMath.h"
+#include "NinjaMovementHotState.h"
+#include "NinjaMovementRecording.h"
+#include "NinjaSplineSegmentTree.h"
 #include "NinjaTypes.h"
 #include "NinjaCharacterMovementComponent.generated.h"
 
 
+/**
+ * Movement level of detail applied to simulated proxies that are far from
+ * every local view target.
+ */
+USTRUCT(BlueprintType)
+struct NINJACHARACTER_API FNinjaSimulatedMovementLOD
+{
+	GENERATED_BODY()
+
+public:
+	FNinjaSimulatedMovementLOD();
+
+	/** Minimum distance to closest local view target that activates this level of detail. */
+	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="NinjaCharacterMovement",Meta=(ClampMin="0",UIMin="0"))
+	float MinDistance;
+
+	/** Tick interval of the movement component, zero ticks every frame. */
+	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="NinjaCharacterMovement",Meta=(ClampMin="0",UIMin="0"))
+	float TickInterval;
+
+	/** If true, floor isn't searched while simulating movement; current floor is kept. */
+	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="NinjaCharacterMovement")
+	uint32 bSkipFloorChecks:1;
+
+	/** If true, last gravity evaluation is reused until gravity settings change. */
+	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="NinjaCharacterMovement")
+	uint32 bFreezeGravity:1;
+
+	/**
+	 * If true, movement isn't simulated; replicated movement is extrapolated
+	 * with replicated velocity, without collision.
+	 */
+	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="NinjaCharacterMovement")
+	uint32 bExtrapolateOnly:1;
+
+	/** Maximum time that replicated movement is extrapolated after a network update. */
+	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="NinjaCharacterMovement",Meta=(ClampMin="0",UIMin="0",EditCondition="bExtrapolateOnly"))
+	float MaxExtrapolationTime;
+};
+
 /**
  * A MovementComponent updates the position of the associated PrimitiveComponent
  * during its tick. This type handles the movement for Characters, and is able
@@ -36,6 +84,33 @@ public:
 	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
 #endif // WITH_EDITOR
 
+public:
+	/**
+	 * Returns properties that are replicated for the lifetime of the actor channel.
+	 * @param OutLifetimeProps - receives the replicated properties
+	 */
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+public:
+	/**
+	 * Initializes the component; values derived from loaded settings are computed again.
+	 */
+	virtual void InitializeComponent() override;
+
+protected:
+	/** Simulation state read or written every tick, kept together in a few cache lines. */
+	FNinjaMovementHotState HotState;
+
+public:
+	/**
+	 * Obtains the simulation state read or written every tick.
+	 * @return per-tick simulation state
+	 */
+	FORCEINLINE const FNinjaMovementHotState& GetHotState() const
+	{
+		return HotState;
+	}
+
 public:
 	/**
 	 * Perform jump. Called by Character when a jump has been detected because Character->bPressedJump was true. Checks CanJump().
@@ -101,6 +176,115 @@ public:
 	 */
 	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
 
+protected:
+	/** Called when the game starts. */
+	virtual void BeginPlay() override;
+
+	/** Called when the component is removed from play. */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+public:
+	/**
+	 * If true, AI controlled characters are ticked in batches by UNinjaMovementTickManager
+	 * instead of using their own tick function.
+	 * @note Components with a tick interval or that tick while paused keep their own tick function
+	 */
+	UPROPERTY(EditDefaultsOnly,BlueprintReadOnly,Category="NinjaCharacterMovement")
+	uint32 bUseMovementTickManager:1;
+
+	/**
+	 * Asks if this component can be ticked by UNinjaMovementTickManager.
+	 * @note Player controlled characters and network proxies always use their own tick function
+	 * @return true if the movement tick manager can tick this component
+	 */
+	virtual bool ShouldUseMovementTickManager() const;
+
+public:
+	/**
+	 * If true, movement of locally controlled and authoritative AI characters
+	 * is simulated with a constant time step of 1 / FixedTimeStepRate seconds;
+	 * frame time is accumulated and at most MaxFixedTimeSteps steps run every
+	 * frame, so simulation cost doesn't depend on frame rate.
+	 * @note Network proxies keep using network smoothing
+	 */
+	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="NinjaCharacterMovement")
+	uint32 bFixedTimeStep:1;
+
+	/** Amount of fixed time steps simulated per second. */
+	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="NinjaCharacterMovement",Meta=(ClampMin="1",UIMin="1",EditCondition="bFixedTimeStep"))
+	float FixedTimeStepRate;
+
+	/** Maximum amount of fixed time steps simulated in one frame; accumulated time beyond it is discarded. */
+	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="NinjaCharacterMovement",Meta=(ClampMin="1",UIMin="1",EditCondition="bFixedTimeStep"))
+	int32 MaxFixedTimeSteps;
+
+	/**
+	 * If true, Mesh is placed every frame between the results of the last two
+	 * fixed time steps.
+	 * @note Other components can be interpolated with ANinjaCharacter::SmoothComponentLocationAndRotation
+	 */
+	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="NinjaCharacterMovement",Meta=(EditCondition="bFixedTimeStep"))
+	uint32 bInterpolateFixedTimeStepMesh:1;
+
+	/**
+	 * Obtains the location of the updated component interpolated between the
+	 * last two fixed time steps.
+	 * @return interpolated location, current location if not simulating fixed time steps
+	 */
+	FVector GetInterpolatedComponentLocation() const;
+
+	/**
+	 * Obtains the rotation of the updated component interpolated between the
+	 * last two fixed time steps.
+	 * @return interpolated rotation, current rotation if not simulating fixed time steps
+	 */
+	FQuat GetInterpolatedComponentQuat() const;
+
+	/**
+	 * Stops interpolating from the results of previous fixed time steps, i.e.
+	 * after a teleport or a network correction.
+	 * @note Ignored while fixed time steps are being simulated
+	 */
+	void ResetFixedTimeStepInterpolation();
+
+protected:
+	/**
+	 * Updates acceleration and performs movement; the movement is split into
+	 * fixed time steps if bFixedTimeStep is true.
+	 * @param InputVector - input acceleration of this frame
+	 * @param DeltaSeconds - time elapsed since last frame
+	 */
+	virtual void ControlledCharacterMove(const FVector& InputVector, float DeltaSeconds) override;
+
+	/**
+	 * Places Mesh at the interpolated transform of the updated component.
+	 */
+	virtual void InterpolateFixedTimeStepMesh();
+
+	/** Simulation time accumulated and not consumed by fixed time steps yet. */
+	float FixedTimeStepAccumulator;
+
+	/** Location of the updated component when the last fixed time step started. */
+	FVector FixedTimeStepPreviousLocation;
+
+	/** Rotation of the updated component when the last fixed time step started. */
+	FQuat FixedTimeStepPreviousRotation;
+
+	/** Location of the updated component when the last fixed time step ended. */
+	FVector FixedTimeStepCurrentLocation;
+
+	/** Rotation of the updated component when the last fixed time step ended. */
+	FQuat FixedTimeStepCurrentRotation;
+
+	/** Input acceleration of frames that didn't simulate any fixed time step. */
+	FVector FixedTimeStepPendingInput;
+
+	/** If true, fixed time steps are being simulated and their results can be interpolated. */
+	bool bFixedTimeStepInterpolation;
+
+	/** If true, the current frame is simulating fixed time steps. */
+	bool bSimulatingFixedTimeSteps;
+
 public:
 	/**
 	 * Constrain components of root motion velocity that may not be appropriate given the current movement mode (e.g. when falling Z may be ignored).
@@ -115,6 +299,52 @@ protected:
 	/** Simulate movement on a non-owning client. Called by SimulatedTick(). */
 	virtual void SimulateMovement(float DeltaSeconds) override;
 
+public:
+	/**
+	 * Levels of detail of simulated movement, sorted by increasing MinDistance.
+	 * @note Console variable 'p.SimulatedMovementLOD' can disable them globally
+	 */
+	UPROPERTY(EditDefaultsOnly,BlueprintReadOnly,Category="NinjaCharacterMovement|LOD")
+	TArray<FNinjaSimulatedMovementLOD> SimulatedMovementLODs;
+
+	/** Distance to local view targets is multiplied by this amount if the Character wasn't recently rendered. */
+	UPROPERTY(EditDefaultsOnly,BlueprintReadOnly,Category="NinjaCharacterMovement|LOD",Meta=(ClampMin="1",UIMin="1"))
+	float NotRenderedLODDistanceScale;
+
+	/**
+	 * Obtains the active level of detail of simulated movement.
+	 * @return active level of detail, nullptr if movement is fully simulated
+	 */
+	const FNinjaSimulatedMovementLOD* GetSimulatedMovementLOD() const;
+
+protected:
+	/** Index of active level of detail of simulated movement, INDEX_NONE if movement is fully simulated. */
+	int32 SimulatedMovementLODIndex;
+
+	/** Tick interval of the movement component when movement is fully simulated. */
+	float SimulatedMovementLODBaseTickInterval;
+
+	/** Time that replicated movement has been extrapolated since last network update. */
+	float SimulatedMovementExtrapolationTime;
+
+	/**
+	 * Selects the level of detail of simulated movement from distance to
+	 * closest local view target.
+	 */
+	virtual void UpdateSimulatedMovementLOD();
+
+	/**
+	 * Leaves the current level of detail of simulated movement, if any, and
+	 * restores the tick interval it replaced; i.e. when the role changes.
+	 */
+	void ResetSimulatedMovementLOD();
+
+	/**
+	 * Extrapolates replicated movement of a simulated proxy, without collision.
+	 * @param DeltaSeconds - time elapsed since last frame
+	 */
+	virtual void ExtrapolateSimulatedMovement(float DeltaSeconds);
+
 public:
 	/** Update or defer updating of position based on Base movement. */
 	virtual void MaybeUpdateBasedMovement(float DeltaSeconds) override;
@@ -449,6 +679,15 @@ public:
 	/** Return true if the hit result should be considered a walkable surface for the character. */
 	virtual bool IsWalkable(const FHitResult& Hit) const override;
 
+	/**
+	 * Return true if the hit result should be considered a walkable surface
+	 * for the character standing along a given 'up' direction.
+	 * @param Hit - hit result to check
+	 * @param UpDirection - normalized 'up' direction of the character
+	 * @return true if the surface is walkable
+	 */
+	virtual bool IsWalkableEx(const FHitResult& Hit, const FVector& UpDirection) const;
+
 public:
 	/**
 	 * Return true if the 2D distance to the impact point is inside the edge tolerance (CapsuleRadius minus a small rejection threshold).
@@ -477,6 +716,58 @@ public:
 	 */
 	virtual void ComputeFloorDist(const FVector& CapsuleLocation, float LineDistance, float SweepDistance, FFindFloorResult& OutFloorResult, float SweepRadius, const FHitResult* DownwardSweepResult = nullptr) const override;
 
+	/**
+	 * Maximum distance the capsule can move away from the location of the last floor sweep to reuse its result.
+	 * @note Console variable 'p.FloorCache' can disable the floor cache globally
+	 */
+	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="NinjaCharacterMovement|Floor",Meta=(ClampMin="0",UIMin="0"))
+	float FloorCacheDistanceTolerance;
+
+	/** Maximum angle (in degrees) the capsule can rotate away from the orientation of the last floor sweep to reuse its result. */
+	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="NinjaCharacterMovement|Floor",Meta=(ClampMin="0",UIMin="0",ClampMax="45",UIMax="45"))
+	float FloorCacheAngleTolerance;
+
+	/** Discards the result of the last floor sweep, next floor query performs a full sweep. */
+	UFUNCTION(BlueprintCallable,Category="Pawn|Components|NinjaCharacterMovement")
+	virtual void InvalidateFloorCache();
+
+protected:
+	/** If true, the result of the last floor sweep can be reused. */
+	mutable bool bFloorCacheValid;
+
+	/** Result of the last walkable floor sweep. */
+	mutable FFindFloorResult FloorCacheResult;
+
+	/** Location of the capsule used for the last floor sweep. */
+	mutable FVector FloorCacheLocation;
+
+	/** Z rotation axis of the capsule used for the last floor sweep. */
+	mutable FVector FloorCacheAxisZ;
+
+	/** Radius used for the last floor sweep. */
+	mutable float FloorCacheSweepRadius;
+
+	/** Transform of the floor component when the last floor sweep was done. */
+	mutable FTransform FloorCacheBaseTransform;
+
+	/**
+	 * Tries to obtain the result of a floor query from the last floor sweep.
+	 * @param CapsuleLocation - location of the capsule used for the query
+	 * @param SweepDistance - max distance of the floor query
+	 * @param SweepRadius - the radius of the floor query
+	 * @param OutFloorResult - result of the floor query if the cached sweep was reused
+	 * @return true if the cached sweep result was reused
+	 */
+	bool ReuseFloorCache(const FVector& CapsuleLocation, float SweepDistance, float SweepRadius, FFindFloorResult& OutFloorResult) const;
+
+	/**
+	 * Stores the result of a walkable floor sweep so it can be reused.
+	 * @param CapsuleLocation - location of the capsule used for the sweep
+	 * @param SweepRadius - the radius used for the sweep
+	 * @param FloorResult - result of the floor sweep
+	 */
+	void StoreFloorCache(const FVector& CapsuleLocation, float SweepRadius, const FFindFloorResult& FloorResult) const;
+
 public:
 	/**
 	 * Sweep against the world and return the first blocking hit.
@@ -493,6 +784,38 @@ public:
 	virtual bool FloorSweepTest(struct FHitResult& OutHit, const FVector& Start, const FVector& End, ECollisionChannel TraceChannel,
 		const FCollisionShape& CollisionShape, const FCollisionQueryParams& Params, const FCollisionResponseParams& ResponseParam) const override;
 
+	/**
+	 * If true, speculative floor and rotation sweeps of next tick are requested as asynchronous scene queries.
+	 * @note Synchronous sweeps are done if results are stale or don't match; console variable 'p.AsyncSceneQueries' can disable them globally
+	 */
+	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="NinjaCharacterMovement|Floor")
+	uint32 bUseAsyncSceneQueries:1;
+
+	/** Maximum distance between predicted and actual start locations of an asynchronous sweep to use its result. */
+	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="NinjaCharacterMovement|Floor",Meta=(ClampMin="0",UIMin="0",EditCondition="bUseAsyncSceneQueries"))
+	float AsyncQueryDistanceTolerance;
+
+protected:
+	/**
+	 * Asks if speculative sweeps can be requested as asynchronous scene queries.
+	 * @return true if asynchronous scene queries can be used
+	 */
+	bool CanUseAsyncSceneQueries() const;
+
+	/**
+	 * Same as FloorSweepTest, but reuses the result of an asynchronous sweep requested on previous tick if possible.
+	 * @param Query - kind of speculative query
+	 * @see FloorSweepTest
+	 */
+	bool AsyncFloorSweepTest(ENinjaAsyncQuery Query, struct FHitResult& OutHit, const FVector& Start, const FVector& End, ECollisionChannel TraceChannel,
+		const FCollisionShape& CollisionShape, const FCollisionQueryParams& Params, const FCollisionResponseParams& ResponseParam) const;
+
+	/**
+	 * Requests asynchronous sweeps that are predicted to be done on next tick.
+	 * @param DeltaTime - time elapsed since last frame
+	 */
+	virtual void RequestAsyncSceneQueries(float DeltaTime);
+
 public:
 	/** Verify that the supplied hit result is a valid landing spot when falling. */
 	virtual bool IsValidLandingSpot(const FVector& CapsuleLocation, const FHitResult& Hit) const override;
@@ -589,6 +912,73 @@ protected:
 	 */
 	virtual void ServerMoveHandleClientError(float ClientTimeStamp, float DeltaTime, const FVector& Accel, const FVector& RelativeClientLocation, UPrimitiveComponent* ClientMovementBase, FName ClientBaseBoneName, uint8 ClientMovementMode) override;
 
+	/**
+	 * Asks if gravity direction or capsule orientation of the client move being processed differ too much from the
+	 * server ones.
+	 * @return true if a client adjustment should be sent
+	 */
+	virtual bool ServerCheckClientGravityError() const;
+
+public:
+	/**
+	 * Process a move at the given time stamp, given the compressed flags representing various events that occurred (ie jump).
+	 * @note Gravity direction sent by the client is used if it is within NetworkGravityAngleTolerance of server gravity
+	 */
+	virtual void MoveAutonomous(float ClientTimeStamp, float DeltaTime, uint8 CompressedFlags, const FVector& NewAccel) override;
+
+	/**
+	 * Maximum angle (in degrees) between gravity directions (or capsule orientations) of client and server
+	 * for a client move to be accepted as is.
+	 */
+	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="NinjaCharacterMovement",Meta=(ClampMin="0",UIMin="0",ClampMax="90",UIMax="90"))
+	float NetworkGravityAngleTolerance;
+
+protected:
+	/** If true, gravity direction of the client move being processed overrides server gravity direction. */
+	uint32 bUseNetworkGravityDirection:1;
+
+	/** Gravity direction (not influenced by GravityScale) of the client move being processed. */
+	FVector NetworkGravityDirection;
+
+public:
+	/**
+	 * Forces the gravity direction used while a client move is processed by the server or replayed by the client.
+	 * @param NewGravityDirection - gravity direction (influenced by GravityScale) that the move was made with
+	 */
+	void SetNetworkGravityDirection(const FVector& NewGravityDirection);
+
+	/**
+	 * Stops forcing the gravity direction of a client move.
+	 */
+	void ClearNetworkGravityDirection();
+
+	/**
+	 * Asks if a gravity direction sent with a client move is close enough to current gravity direction.
+	 * @param MoveGravityDirection - gravity direction (influenced by GravityScale) that the move was made with
+	 * @return true if the move can be simulated with its own gravity direction
+	 */
+	bool IsNetworkGravityDirectionAcceptable(const FVector& MoveGravityDirection) const;
+
+	/**
+	 * Obtains the mode that determines direction of gravity.
+	 * @return current gravity mode
+	 */
+	FORCEINLINE ENinjaGravityDirectionMode GetGravityDirectionMode() const
+	{
+		return GravityDirectionMode;
+	}
+
+protected:
+	/**
+	 * If bUpdatePosition is true, then replay any unacked moves. Returns whether any moves were actually replayed.
+	 * @note Gravity direction of every replayed move is restored through FSavedMove_Ninja::PrepMoveFor
+	 */
+	virtual bool ClientUpdatePositionAfterServerUpdate() override;
+
+public:
+	/** Get prediction data for a client game. Should not be used if not running as a client. Allocates the data on demand and can be overridden to allocate a custom override if desired. Result must be a FNetworkPredictionData_Client_Character. */
+	virtual class FNetworkPredictionData_Client* GetPredictionData_Client() const override;
+
 public:
 	/* Replicate position correction to client, associated with a timestamped servermove. Client will replay subsequent moves after applying adjustment. */
 	virtual void ClientAdjustPosition_Implementation(float TimeStamp, FVector NewLocation, FVector NewVelocity, UPrimitiveComponent* NewBase, FName NewBaseBoneName, bool bHasBase, bool bBaseRelativePosition, uint8 ServerMovementMode) override;
@@ -605,6 +995,83 @@ protected:
 	/** Event notification when client receives a correction from the server. Base implementation logs relevant data and draws debug info if "p.NetShowCorrections" is not equal to 0. */
 	virtual void OnClientCorrectionReceived(class FNetworkPredictionData_Client_Character& ClientData, float TimeStamp, FVector NewLocation, FVector NewVelocity, UPrimitiveComponent* NewBase, FName NewBaseBoneName, bool bHasBase, bool bBaseRelativePosition, uint8 ServerMovementMode) override;
 
+public:
+	/**
+	 * Starts recording moves, gravity changes, floor results and corrections.
+	 * The server records moves received from the client, an autonomous client
+	 * records its own saved moves.
+	 */
+	void StartMovementRecording();
+
+	/**
+	 * Stops recording moves.
+	 * @return finished recording, invalid if not recording
+	 */
+	TSharedPtr<FNinjaMovementRecording> StopMovementRecording();
+
+	/**
+	 * Asks if moves are being recorded.
+	 * @return true if recording
+	 */
+	FORCEINLINE bool IsRecordingMovement() const
+	{
+		return MovementRecording.IsValid();
+	}
+
+	/**
+	 * Re-simulates every move of a recording, compares results with the
+	 * recorded ones and measures simulation time. A move that diverges is
+	 * reported and the character is snapped to its recorded result, so every
+	 * divergence is reported on its own.
+	 * @note Other Actors don't move while the recording is replayed
+	 * @param Recording - recording to replay, the character should be spawned at its start
+	 * @param Tolerance - maximum distance between replayed and recorded locations and velocities
+	 * @param OutReport - receives results of the comparison
+	 */
+	virtual void ReplayMovementRecording(const FNinjaMovementRecording& Recording, float Tolerance,
+		FNinjaMovementReplayReport& OutReport);
+
+	/**
+	 * Records a saved move made by an autonomous client.
+	 * @param SavedMove - saved move to record
+	 */
+	void RecordSavedMove(const FSavedMove_Ninja& SavedMove) const;
+
+	/**
+	 * Discards a recorded saved move that was combined into a newer move.
+	 * @param SavedMove - saved move that was combined
+	 */
+	void DiscardRecordedSavedMove(const FSavedMove_Ninja& SavedMove) const;
+
+	/**
+	 * Records current gravity settings if they changed since the last
+	 * recorded move; called when a move starts.
+	 */
+	void RecordGravityState() const;
+
+protected:
+	/**
+	 * Records a finished move.
+	 * @param TimeStamp - time stamp of the move
+	 * @param DeltaTime - time simulated by the move
+	 * @param CompressedFlags - compressed flags of the move
+	 * @param NewAccel - acceleration of the move
+	 * @param MoveGravityDirection - gravity direction sent with the move, zero if none
+	 */
+	void RecordMove(float TimeStamp, float DeltaTime, uint8 CompressedFlags, const FVector& NewAccel,
+		const FVector& MoveGravityDirection) const;
+
+	/**
+	 * Records a correction sent by the server or received by the client.
+	 * @param TimeStamp - time stamp of the corrected move
+	 * @param ClientLocation - location of the client
+	 * @param ServerLocation - location of the server
+	 */
+	void RecordCorrection(float TimeStamp, const FVector& ClientLocation, const FVector& ServerLocation) const;
+
+	/** Recording of moves in progress, invalid if not recording. */
+	TSharedPtr<FNinjaMovementRecording> MovementRecording;
+
 protected:
 	/** Called when the collision capsule touches another primitive component. */
 	virtual void CapsuleTouched(UPrimitiveComponent* OverlappedComp, AActor* Other, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult) override;
@@ -628,6 +1095,9 @@ private:
 	/** Server response RPC data container. */
 	FNinjaCharacterMoveResponseDataContainer NinjaMoveResponseDataContainer;
 
+	/** Client move RPC data container. */
+	FNinjaCharacterNetworkMoveDataContainer NinjaNetworkMoveDataContainer;
+
 public:
 	/** If true, when the Character bumps into an unwalkable blocking object, triggers unwalkable hit events. */
 	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="NinjaCharacterMovement")
@@ -678,10 +1148,36 @@ protected:
 	UPROPERTY(VisibleInstanceOnly,BlueprintReadOnly,Category="NinjaCharacterMovement")
 	AActor* GravityActor;
 
-protected:
-	/** If true, gravity direction changed and needs to be replicated. */
-	uint32 bDirtyGravityDirection:1;
+	/** Optional baked gravity field that determines direction of gravity. */
+	UPROPERTY(VisibleInstanceOnly,BlueprintReadOnly,Category="NinjaCharacterMovement")
+	class UNinjaGravityField* GravityField;
+
+	/** Streaming friendly reference to GravityActor, with its cached gravity data. */
+	FNinjaGravityActorProxy GravityActorProxy;
+
+	/**
+	 * Obtains the Actor that determines direction of gravity and refreshes its
+	 * cached gravity data.
+	 * @note GravityActor is bound again when its level streams back in
+	 * @return Actor that determines direction of gravity, nullptr if none or streamed out
+	 */
+	AActor* ResolveGravityActor();
+
+	/** Cached spline of GravityActor used by spline gravity modes. */
+	UPROPERTY(Transient)
+	class USplineComponent* GravitySpline;
+
+	/** Acceleration structure for closest input key queries of GravitySpline. */
+	FNinjaSplineSegmentTree GravitySplineTree;
+
+	/**
+	 * Obtains the spline of GravityActor used by spline gravity modes.
+	 * @note Resolves the spline again (and rebuilds its acceleration structure) if needed
+	 * @return spline of GravityActor, can be nullptr
+	 */
+	const class USplineComponent* ResolveGravitySpline();
 
+protected:
 	/** If true, gravity data isn't replicated from server to clients. */
 	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="NinjaCharacterMovement")
 	uint32 bDisableGravityReplication:1;
@@ -692,6 +1188,53 @@ protected:
 	 */
 	virtual bool ShouldReplicateGravity() const;
 
+	/** Gravity settings replicated from server to clients. */
+	UPROPERTY(ReplicatedUsing=OnRep_GravityState)
+	FNinjaGravityState GravityState;
+
+	/**
+	 * Maximum angle (in degrees) that a replicated gravity direction can
+	 * differ from the current one before gravity is replicated again.
+	 */
+	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="NinjaCharacterMovement",Meta=(ClampMin="0",UIMin="0",ClampMax="90",UIMax="90"))
+	float GravityReplicationAngleThreshold;
+
+	/**
+	 * Maximum distance that a replicated gravity location can differ from
+	 * the current one before gravity is replicated again.
+	 */
+	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="NinjaCharacterMovement",Meta=(ClampMin="0",UIMin="0"))
+	float GravityReplicationDistanceThreshold;
+
+	/**
+	 * Time (in seconds) after which a gravity change smaller than the
+	 * replication thresholds is replicated anyway, so clients converge.
+	 */
+	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="NinjaCharacterMovement",Meta=(ClampMin="0",UIMin="0"))
+	float GravityReplicationSettleTime;
+
+	/** World time of last change of replicated gravity settings. */
+	float LastGravityReplicationTime;
+
+	/**
+	 * Gathers current gravity settings into a replicable gravity state.
+	 * @return current gravity state
+	 */
+	FNinjaGravityState MakeGravityState() const;
+
+	/**
+	 * Called on clients after GravityState has been replicated.
+	 * @note A gravity state that follows the physics volume takes its settings
+	 */
+	UFUNCTION()
+	virtual void OnRep_GravityState();
+
+	/**
+	 * Replaces current gravity settings with a replicated gravity state.
+	 * @param NewGravityState - gravity state received from server
+	 */
+	virtual void ApplyGravityState(const FNinjaGravityState& NewGravityState);
+
 public:
 	/**
 	 * Obtains the current gravity.
@@ -716,6 +1259,73 @@ public:
 	UFUNCTION(BlueprintPure,Category="Pawn|Components|NinjaCharacterMovement")
 	virtual float GetGravityMagnitude() const;
 
+protected:
+	/**
+	 * Evaluates gravity at current location of UpdatedComponent and stores the
+	 * result in the gravity cache.
+	 * @note Only place where gravity evaluation modifies GravityVectorA and GravityVectorB
+	 */
+	virtual void UpdateGravityCache();
+
+	/**
+	 * Asks if cached gravity data belongs to current frame and current location
+	 * of UpdatedComponent.
+	 * @return true if cached gravity data can be reused
+	 */
+	bool IsGravityCacheValid() const;
+
+	/**
+	 * Evaluates gravity again only if cached gravity data is outdated.
+	 */
+	void RefreshGravityCache() const;
+
+public:
+	/**
+	 * Discards cached gravity data; next gravity query evaluates gravity again.
+	 */
+	void InvalidateGravityCache();
+
+protected:
+	/**
+	 * Obtains gravity Z of current physics volume, not influenced by GravityScale.
+	 * @return gravity Z of current physics volume
+	 */
+	float GetVolumeGravityZ() const;
+
+public:
+	/**
+	 * Provides gravity Z of current physics volume for this frame; evaluated
+	 * once for a group of movement components that share the physics volume.
+	 * @param NewVolumeGravityZ - gravity Z of current physics volume
+	 */
+	void SetGroupVolumeGravityZ(float NewVolumeGravityZ);
+
+public:
+	/**
+	 * If true, a gravity snapshot that can be read from any thread is published every frame.
+	 * @see FNinjaGravitySnapshot::Read
+	 */
+	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="NinjaCharacterMovement")
+	uint32 bPublishGravitySnapshot:1;
+
+	/**
+	 * Obtains the buffer of published gravity snapshots.
+	 * @return buffer of gravity snapshots
+	 */
+	FORCEINLINE const FNinjaGravitySnapshotBuffer& GetGravitySnapshotBuffer() const
+	{
+		return GravitySnapshotBuffer;
+	}
+
+protected:
+	/** Buffer of published gravity snapshots. */
+	FNinjaGravitySnapshotBuffer GravitySnapshotBuffer;
+
+	/**
+	 * Copies current gravity settings to a new gravity snapshot and publishes it.
+	 */
+	virtual void PublishGravitySnapshot();
+
 public:
 	/**
 	 * Sets a new fixed gravity direction.
@@ -732,14 +1342,6 @@ public:
 	 */
 	virtual void SetFixedGravityDirection(const FVector& NewFixedGravityDirection);
 
-protected:
-	/**
-	 * Replicates a new fixed gravity direction to clients.
-	 * @param NewFixedGravityDirection - new fixed gravity direction, assumes it is normalized
-	 */
-	UFUNCTION(NetMulticast,Reliable)
-	virtual void MulticastSetFixedGravityDirection(const FVector& NewFixedGravityDirection);
-
 public:
 	/**
 	 * Sets a new gravity direction determined by closest spline tangent.
@@ -749,14 +1351,6 @@ public:
 	UFUNCTION(BlueprintCallable,Category="Pawn|Components|NinjaCharacterMovement")
 	virtual void SetSplineTangentGravityDirection(AActor* NewGravityActor);
 
-protected:
-	/**
-	 * Replicates a new spline gravity direction to clients.
-	 * @param NewGravityActor - Actor that provides a spline
-	 */
-	UFUNCTION(NetMulticast,Reliable)
-	virtual void MulticastSetSplineTangentGravityDirection(AActor* NewGravityActor);
-
 public:
 	/**
 	 * Sets a new point which gravity direction points to.
@@ -774,21 +1368,6 @@ public:
 	UFUNCTION(BlueprintCallable,Category="Pawn|Components|NinjaCharacterMovement")
 	virtual void SetPointGravityDirectionFromActor(AActor* NewGravityActor);
 
-protected:
-	/**
-	 * Replicates a new gravity point to clients.
-	 * @param NewGravityPoint - new point which gravity direction points to
-	 */
-	UFUNCTION(NetMulticast,Reliable)
-	virtual void MulticastSetPointGravityDirection(const FVector& NewGravityPoint);
-
-	/**
-	 * Replicates a new gravity point to clients.
-	 * @param NewGravityActor - Actor that provides its location as gravity point
-	 */
-	UFUNCTION(NetMulticast,Reliable)
-	virtual void MulticastSetPointGravityDirectionFromActor(AActor* NewGravityActor);
-
 public:
 	/**
 	 * Sets a new infinite line which gravity direction points to.
@@ -799,15 +1378,6 @@ public:
 	UFUNCTION(BlueprintCallable,Category="Pawn|Components|NinjaCharacterMovement")
 	virtual void SetLineGravityDirection(const FVector& NewGravityLineStart, const FVector& NewGravityLineEnd);
 
-protected:
-	/**
-	 * Replicates a new infinite line for gravity to clients.
-	 * @param NewGravityLineStart - a point that belongs to the infinite line
-	 * @param NewGravityLineEnd - another point that belongs to the infinite line
-	 */
-	UFUNCTION(NetMulticast,Reliable)
-	virtual void MulticastSetLineGravityDirection(const FVector& NewGravityLineStart, const FVector& NewGravityLineEnd);
-
 public:
 	/**
 	 * Sets a new segment line which gravity direction points to.
@@ -818,15 +1388,6 @@ public:
 	UFUNCTION(BlueprintCallable,Category="Pawn|Components|NinjaCharacterMovement")
 	virtual void SetSegmentGravityDirection(const FVector& NewGravitySegmentStart, const FVector& NewGravitySegmentEnd);
 
-protected:
-	/**
-	 * Replicates a new segment line for gravity to clients.
-	 * @param NewGravitySegmentStart - start point of the segment line
-	 * @param NewGravitySegmentEnd - end point of the segment line
-	 */
-	UFUNCTION(NetMulticast,Reliable)
-	virtual void MulticastSetSegmentGravityDirection(const FVector& NewGravitySegmentStart, const FVector& NewGravitySegmentEnd);
-
 public:
 	/**
 	 * Sets a new spline which gravity direction points to.
@@ -836,14 +1397,6 @@ public:
 	UFUNCTION(BlueprintCallable,Category="Pawn|Components|NinjaCharacterMovement")
 	virtual void SetSplineGravityDirection(AActor* NewGravityActor);
 
-protected:
-	/**
-	 * Replicates a new spline for gravity to clients.
-	 * @param NewGravityActor - Actor that provides a spline
-	 */
-	UFUNCTION(NetMulticast,Reliable)
-	virtual void MulticastSetSplineGravityDirection(AActor* NewGravityActor);
-
 public:
 	/**
 	 * Sets a new infinite plane which gravity direction points to.
@@ -862,15 +1415,6 @@ public:
 	 */
 	virtual void SetPlaneGravityDirection(const FVector& NewGravityPlaneBase, const FVector& NewGravityPlaneNormal);
 
-protected:
-	/**
-	 * Replicates a new infinite plane for gravity to clients.
-	 * @param NewGravityPlaneBase - a point that belongs to the plane
-	 * @param NewGravityPlaneNormal - normal of the plane, assumes it is normalized
-	 */
-	UFUNCTION(NetMulticast,Reliable)
-	virtual void MulticastSetPlaneGravityDirection(const FVector& NewGravityPlaneBase, const FVector& NewGravityPlaneNormal);
-
 public:
 	/**
 	 * Sets a new infinite plane determined by closest spline point and spline
@@ -881,15 +1425,6 @@ public:
 	UFUNCTION(BlueprintCallable,Category="Pawn|Components|NinjaCharacterMovement")
 	virtual void SetSplinePlaneGravityDirection(AActor* NewGravityActor);
 
-protected:
-	/**
-	 * Replicates a new infinite plane determined by closest spline point for
-	 * gravity to clients.
-	 * @param NewGravityActor - Actor that provides a spline
-	 */
-	UFUNCTION(NetMulticast,Reliable)
-	virtual void MulticastSetSplinePlaneGravityDirection(AActor* NewGravityActor);
-
 public:
 	/**
 	 * Sets a new axis-aligned box which gravity direction points to.
@@ -908,22 +1443,6 @@ public:
 	UFUNCTION(BlueprintCallable,Category="Pawn|Components|NinjaCharacterMovement")
 	virtual void SetBoxGravityDirectionFromActor(AActor* NewGravityActor);
 
-protected:
-	/**
-	 * Replicates a new axis-aligned box for gravity to clients.
-	 * @param NewGravityBoxOrigin - origin of the box
-	 * @param NewGravityBoxExtent - extents of the box
-	 */
-	UFUNCTION(NetMulticast,Reliable)
-	virtual void MulticastSetBoxGravityDirection(const FVector& NewGravityBoxOrigin, const FVector& NewGravityBoxExtent);
-
-	/**
-	 * Replicates a new axis-aligned box for gravity to clients.
-	 * @param NewGravityActor - Actor that provides its collision bounding box as gravity target
-	 */
-	UFUNCTION(NetMulticast,Reliable)
-	virtual void MulticastSetBoxGravityDirectionFromActor(AActor* NewGravityActor);
-
 public:
 	/**
 	 * Sets a new collision geometry which gravity direction points to.
@@ -933,13 +1452,23 @@ public:
 	UFUNCTION(BlueprintCallable,Category="Pawn|Components|NinjaCharacterMovement")
 	virtual void SetCollisionGravityDirection(AActor* NewGravityActor);
 
-protected:
+public:
 	/**
-	 * Replicates a new collision geometry for gravity to clients.
-	 * @param NewGravityActor - Actor that owns the PrimitiveComponent that has collision geometry
+	 * Sets a new baked gravity field which gravity direction is sampled from.
+	 * @note It can be influenced by GravityScale
+	 * @param NewGravityField - baked gravity field that provides gravity
 	 */
-	UFUNCTION(NetMulticast,Reliable)
-	virtual void MulticastSetCollisionGravityDirection(AActor* NewGravityActor);
+	UFUNCTION(BlueprintCallable,Category="Pawn|Components|NinjaCharacterMovement")
+	virtual void SetBakedGravityDirection(class UNinjaGravityField* NewGravityField);
+
+public:
+	/**
+	 * Sets gravity direction to be blended from gravity source components.
+	 * @note It can be influenced by GravityScale
+	 * @see UNinjaGravitySourceComponent
+	 */
+	UFUNCTION(BlueprintCallable,Category="Pawn|Components|NinjaCharacterMovement")
+	virtual void SetFieldGravityDirection();
 
 protected:
 	/**
@@ -956,21 +1485,6 @@ protected:
 	 */
 	virtual void OnGravityDirectionChanged(ENinjaGravityDirectionMode OldGravityDirectionMode, ENinjaGravityDirectionMode CurrentGravityDirectionMode);
 
-protected:
-	/**
-	 * Stores last known value of GravityScale.
-	 * @see GravityScale
-	 */
-	float OldGravityScale;
-
-protected:
-	/**
-	 * Replicates gravity scale factor to clients.
-	 * @param NewGravityScale - new gravity scale factor
-	 */
-	UFUNCTION(NetMulticast,Reliable)
-	virtual void MulticastSetGravityScale(float NewGravityScale);
-
 public:
 	/**
 	 * If true and a floor is found, rotate gravity direction and align it to floor base.
@@ -1114,6 +1628,43 @@ public:
 	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="NinjaCharacterMovement")
 	uint32 bRotateVelocityOnGround:1;
 
+	/**
+	 * If true, rotation updates done every tick are gated by a drift budget:
+	 * the updated component keeps its rotation until the angle between its
+	 * current and desired local Z rotation axes exceeds IncrementalRotationBudget,
+	 * then follows the desired axis every tick until the drift of a tick falls
+	 * below IncrementalRotationRelease.
+	 * @note Rotating around the center while walking reuses the current floor instead of sweeping
+	 */
+	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="NinjaCharacterMovement")
+	uint32 bIncrementalRotation:1;
+
+	/** Accumulated angle in degrees between current and desired local Z rotation axes that triggers a rotation. */
+	UPROPERTY(EditAnywhere,BlueprintReadOnly,Category="NinjaCharacterMovement",Meta=(ClampMin="0",ClampMax="45",UIMin="0",UIMax="45",EditCondition="bIncrementalRotation"))
+	float IncrementalRotationBudget;
+
+	/** Angle in degrees of a tick below which rotation stops following the desired axis. */
+	UPROPERTY(EditAnywhere,BlueprintReadOnly,Category="NinjaCharacterMovement",Meta=(ClampMin="0",ClampMax="45",UIMin="0",UIMax="45",EditCondition="bIncrementalRotation"))
+	float IncrementalRotationRelease;
+
+	/**
+	 * Sets new values for IncrementalRotationBudget and IncrementalRotationRelease.
+	 * @note The new values are clamped; release never exceeds budget
+	 * @param NewBudget - new value for IncrementalRotationBudget
+	 * @param NewRelease - new value for IncrementalRotationRelease
+	 */
+	UFUNCTION(BlueprintCallable,Category="NinjaCharacterMovement")
+	virtual void SetIncrementalRotationAngles(float NewBudget, float NewRelease);
+
+	/**
+	 * Checks if a rotation update done every tick should happen now.
+	 * @note Always true if bIncrementalRotation is false
+	 * @param DesiredAxisZ - desired local Z rotation axis wanted for the updated component
+	 * @return true if the updated component should rotate
+	 */
+	virtual bool ShouldUpdateComponentRotation(const FVector& DesiredAxisZ);
+
+public:
 	/**
 	 * Return the desired local Z rotation axis wanted for the updated component.
 	 * @return desired Z rotation axis
@@ -1153,30 +1704,24 @@ protected:
 	 */
 	virtual void SetThresholdParallelAngle(float NewThresholdParallelAngle);
 
-	/** Threshold that determines if two unit vectors are perpendicular. */
-	UPROPERTY(VisibleAnywhere,BlueprintReadOnly,Category="NinjaCharacterMovement")
-	float ThresholdOrthogonalCosine;
-
-	/** Threshold that determines if two unit vectors are parallel. */
-	UPROPERTY(VisibleAnywhere,BlueprintReadOnly,Category="NinjaCharacterMovement")
-	float ThresholdParallelCosine;
-
 public:
 	/**
 	 * Return the current threshold that determines if two unit vectors are orthogonal.
 	 * @return cosine threshold for orthogonal unit vectors
 	 */
+	UFUNCTION(BlueprintPure,Category="Pawn|Components|NinjaCharacterMovement")
 	FORCEINLINE float GetThresholdOrthogonalCosine() const
 	{
-		return ThresholdOrthogonalCosine;
+		return HotState.ThresholdOrthogonalCosine;
 	}
 
 	/**
 	 * Return the current threshold that determines if two unit vectors are parallel.
 	 * @return cosine threshold for parallel unit vectors
 	 */
+	UFUNCTION(BlueprintPure,Category="Pawn|Components|NinjaCharacterMovement")
 	FORCEINLINE float GetThresholdParallelCosine() const
 	{
-		return ThresholdParallelCosine;
+		return HotState.ThresholdParallelCosine;
 	}
 };
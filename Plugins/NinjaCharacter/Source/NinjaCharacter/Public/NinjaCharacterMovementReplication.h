@@ -4,7 +4,9 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "GameFramework/CharacterMovementComponent.h"
 #include "GameFramework/CharacterMovementReplication.h"
+#include "NinjaTypes.h"
 
 
 /**
@@ -24,3 +26,111 @@ public:
 		bHasRotation = true;
 	}
 };
+
+/**
+ * Data of a client move sent to the server; it also carries the gravity
+ * direction and capsule orientation the client used.
+ */
+struct NINJACHARACTER_API FNinjaCharacterNetworkMoveData : public FCharacterNetworkMoveData
+{
+public:
+	typedef FCharacterNetworkMoveData Super;
+
+	FNinjaCharacterNetworkMoveData();
+
+	/** Direction of gravity (influenced by GravityScale) when the move started. */
+	FVector_NetQuantizeNormal GravityDirection;
+
+	/** Z rotation axis of the updated component when the move ended. */
+	FVector_NetQuantizeNormal ComponentAxisZ;
+
+	/**
+	 * Given a FSavedMove_Character from UCharacterMovementComponent, fill in data in this struct with relevant movement data.
+	 */
+	virtual void ClientFillNetworkMoveData(const FSavedMove_Character& ClientMove, ENetworkMoveType MoveType) override;
+
+	/**
+	 * Serialize the data in this struct to or from the given FArchive. This packs or unpacks the data in to a variable-sized data stream that is sent from the
+	 * client to the server.
+	 */
+	virtual bool Serialize(UCharacterMovementComponent& CharacterMovement, FArchive& Ar, UPackageMap* PackageMap, ENetworkMoveType MoveType) override;
+};
+
+/**
+ * Structure used internally to handle serialization of FNinjaCharacterNetworkMoveData
+ * over the network.
+ */
+struct NINJACHARACTER_API FNinjaCharacterNetworkMoveDataContainer : public FCharacterNetworkMoveDataContainer
+{
+public:
+	FNinjaCharacterNetworkMoveDataContainer();
+
+private:
+	/** Storage of new, pending and old moves. */
+	FNinjaCharacterNetworkMoveData NinjaMoveData[3];
+};
+
+/**
+ * FSavedMove_Character that stores gravity and capsule orientation of
+ * Ninja moves.
+ */
+class NINJACHARACTER_API FSavedMove_Ninja : public FSavedMove_Character
+{
+public:
+	typedef FSavedMove_Character Super;
+
+	FSavedMove_Ninja();
+
+	/** Direction of gravity (influenced by GravityScale) when the move started. */
+	FVector SavedGravityDirection;
+
+	/** Z rotation axis of the updated component when the move started. */
+	FVector StartComponentAxisZ;
+
+	/** Z rotation axis of the updated component when the move ended. */
+	FVector SavedComponentAxisZ;
+
+	/** Mode that determined direction of gravity when the move started. */
+	ENinjaGravityDirectionMode SavedGravityDirectionMode;
+
+	/** Clear saved move properties, so it can be re-used. */
+	virtual void Clear() override;
+
+	/** Called to set up this saved move (when initially created) to make a predictive correction. */
+	virtual void SetMoveFor(ACharacter* C, float InDeltaTime, FVector const& NewAccel, class FNetworkPredictionData_Client_Character& ClientData) override;
+
+	/**
+	 * Returns true if this move can be combined with NewMove for replication without changing any behavior.
+	 * @note Gravity modes must match, and gravity directions and capsule orientations must be parallel
+	 */
+	virtual bool CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const override;
+
+	/**
+	 * Combine this move with an older move and update relevant state.
+	 * @note Recorded OldMove is discarded, this move records the combined move
+	 */
+	virtual void CombineWith(const FSavedMove_Character* OldMove, ACharacter* InCharacter, APlayerController* PC, const FVector& OldStartLocation) override;
+
+	/**
+	 * Called before ClientUpdatePosition uses this SavedMove to make a predictive correction.
+	 * @note Restores gravity direction of this move if it is still acceptable
+	 */
+	virtual void PrepMoveFor(ACharacter* C) override;
+
+	/** Set the properties describing the final position, etc. of the moved pawn. */
+	virtual void PostUpdate(ACharacter* C, EPostUpdateMode PostUpdateMode) override;
+};
+
+/**
+ * Client prediction data that allocates FSavedMove_Ninja moves.
+ */
+class NINJACHARACTER_API FNetworkPredictionData_Client_Ninja : public FNetworkPredictionData_Client_Character
+{
+public:
+	typedef FNetworkPredictionData_Client_Character Super;
+
+	FNetworkPredictionData_Client_Ninja(const UCharacterMovementComponent& ClientMovement);
+
+	/** Allocate a new saved move. Subclasses should override this if they want to use a custom move class. */
+	virtual FSavedMovePtr AllocateNewMove() override;
+};
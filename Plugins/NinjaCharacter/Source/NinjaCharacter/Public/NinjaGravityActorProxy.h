@@ -0,0 +1,131 @@
+// "Ninja Character" plugin, by Javier 'Xaklse' Osset; Copyright 2020
+
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/SoftObjectPtr.h"
+#include "UObject/WeakObjectPtrTemplates.h"
+#include "NinjaGravitySnapshot.h"
+#include "NinjaTypes.h"
+
+
+class AActor;
+class USplineComponent;
+
+/**
+ * Streaming friendly reference to an Actor that determines direction of
+ * gravity. The Actor is referenced softly, thus it isn't kept loaded and it
+ * is found again when its level streams back in, and the data needed to
+ * evaluate gravity (location, bounds and sampled spline) is cached, thus
+ * gravity keeps working while the Actor is streamed out.
+ * @note Game thread only
+ */
+struct NINJACHARACTER_API FNinjaGravityActorProxy
+{
+public:
+	FNinjaGravityActorProxy();
+
+	/**
+	 * References a new Actor and caches its gravity data.
+	 * @param NewActor - Actor that determines direction of gravity, nullptr resets the reference
+	 * @param Mode - gravity mode that uses the Actor
+	 */
+	void Set(AActor* NewActor, ENinjaGravityDirectionMode Mode);
+
+	/**
+	 * Discards the referenced Actor and its cached gravity data.
+	 */
+	void Reset();
+
+	/**
+	 * Asks if an Actor is referenced, even if it's streamed out.
+	 * @return true if an Actor is referenced
+	 */
+	FORCEINLINE bool IsSet() const
+	{
+		return !SoftActor.IsNull();
+	}
+
+	/**
+	 * Obtains the referenced Actor if it's loaded.
+	 * @note The Actor is found again after its level streams back in
+	 * @return referenced Actor, nullptr if it isn't loaded
+	 */
+	AActor* Get() const;
+
+	/**
+	 * Updates cached location or bounds from the referenced Actor, if it's loaded.
+	 * @param Mode - gravity mode that uses the Actor
+	 */
+	void Refresh(ENinjaGravityDirectionMode Mode);
+
+	/**
+	 * Updates the cached spline samples at most once per frame; they are reused if the spline didn't change.
+	 * @param Spline - spline of the referenced Actor, nullptr keeps cached samples
+	 */
+	void RefreshSpline(const USplineComponent* Spline);
+
+	/**
+	 * Asks if gravity data was cached from the referenced Actor.
+	 * @return true if cached gravity data can be used
+	 */
+	FORCEINLINE bool HasCache() const
+	{
+		return bHasCache;
+	}
+
+	/**
+	 * Obtains the cached location of the referenced Actor.
+	 * @return cached location
+	 */
+	FORCEINLINE const FVector& GetCachedLocation() const
+	{
+		return CachedLocation;
+	}
+
+	/**
+	 * Obtains the cached bounds of the referenced Actor.
+	 * @param OutOrigin - receives center of the bounding box
+	 * @param OutExtent - receives half extent of the bounding box
+	 */
+	FORCEINLINE void GetCachedBounds(FVector& OutOrigin, FVector& OutExtent) const
+	{
+		OutOrigin = CachedBoundsOrigin;
+		OutExtent = CachedBoundsExtent;
+	}
+
+	/**
+	 * Obtains the cached samples of the spline of the referenced Actor.
+	 * @return cached spline samples, nullptr if there aren't any
+	 */
+	FORCEINLINE const FNinjaGravitySplineSamples* GetCachedSpline() const
+	{
+		return CachedSpline.Get();
+	}
+
+private:
+	/** Soft reference to the Actor, survives its level streaming out. */
+	TSoftObjectPtr<AActor> SoftActor;
+
+	/** Last resolved Actor, avoids searching it again. */
+	mutable TWeakObjectPtr<AActor> ResolvedActor;
+
+	/** Cached location of the Actor. */
+	FVector CachedLocation;
+
+	/** Cached center of the bounding box of the Actor. */
+	FVector CachedBoundsOrigin;
+
+	/** Cached half extent of the bounding box of the Actor. */
+	FVector CachedBoundsExtent;
+
+	/** Cached samples of the spline of the Actor. */
+	TSharedPtr<const FNinjaGravitySplineSamples, ESPMode::ThreadSafe> CachedSpline;
+
+	/** Frame counter value of last update of cached spline samples. */
+	uint64 CachedSplineFrame;
+
+	/** If true, gravity data was cached from the Actor. */
+	bool bHasCache;
+};
@@ -0,0 +1,100 @@
+// "Ninja Character" plugin, by Javier 'Xaklse' Osset; Copyright 2020
+
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NinjaTypes.h"
+
+
+/**
+ * Gravity evaluator policies of direction modes that only depend on the two
+ * vectors stored by their owner. Every policy provides the same interface:
+ *   static FVector GetDirection(const FVector& VectorA, const FVector& VectorB, const FVector& Point);
+ * which returns the normalized direction of gravity at Point, or zero.
+ */
+
+/** Gravity direction is fixed; VectorA is the normalized direction. */
+struct FNinjaFixedGravityPolicy
+{
+	static FORCEINLINE FVector GetDirection(const FVector& VectorA, const FVector& VectorB, const FVector& Point)
+	{
+		return VectorA;
+	}
+};
+
+/** Gravity direction points to VectorA. */
+struct FNinjaPointGravityPolicy
+{
+	static FORCEINLINE FVector GetDirection(const FVector& VectorA, const FVector& VectorB, const FVector& Point)
+	{
+		return (VectorA - Point).GetSafeNormal();
+	}
+};
+
+/** Gravity direction points to the infinite line that passes through VectorA and VectorB. */
+struct FNinjaLineGravityPolicy
+{
+	static FORCEINLINE FVector GetDirection(const FVector& VectorA, const FVector& VectorB, const FVector& Point)
+	{
+		return (FMath::ClosestPointOnInfiniteLine(VectorA, VectorB, Point) - Point).GetSafeNormal();
+	}
+};
+
+/** Gravity direction points to the line bounded by VectorA and VectorB. */
+struct FNinjaSegmentGravityPolicy
+{
+	static FORCEINLINE FVector GetDirection(const FVector& VectorA, const FVector& VectorB, const FVector& Point)
+	{
+		return (FMath::ClosestPointOnLine(VectorA, VectorB, Point) - Point).GetSafeNormal();
+	}
+};
+
+/** Gravity direction points to the infinite plane with base VectorA and normal VectorB. */
+struct FNinjaPlaneGravityPolicy
+{
+	static FORCEINLINE FVector GetDirection(const FVector& VectorA, const FVector& VectorB, const FVector& Point)
+	{
+		return (FVector::PointPlaneProject(Point, VectorA, VectorB) - Point).GetSafeNormal();
+	}
+};
+
+/** Gravity direction points to the axis-aligned box with origin VectorA and extent VectorB. */
+struct FNinjaBoxGravityPolicy
+{
+	static FORCEINLINE FVector GetDirection(const FVector& VectorA, const FVector& VectorB, const FVector& Point)
+	{
+		return (FBox(VectorA - VectorB, VectorA + VectorB).GetClosestPointTo(Point) - Point).GetSafeNormal();
+	}
+};
+
+/** Signature of a bound gravity evaluator; see gravity evaluator policies. */
+typedef FVector (*FNinjaGravityDirectionFunc)(const FVector& VectorA, const FVector& VectorB, const FVector& Point);
+
+/**
+ * Binds gravity evaluator policies to direction modes, so owners look up the
+ * evaluator once when the mode changes instead of branching on every query.
+ */
+struct NINJACHARACTER_API FNinjaGravityEvaluator
+{
+	/**
+	 * Evaluates a gravity evaluator policy; the policy is inlined here.
+	 * @param VectorA - information that determines direction of gravity
+	 * @param VectorB - additional information that determines direction of gravity
+	 * @param Point - given point in space affected by gravity
+	 * @return normalized direction of gravity, could be zero
+	 */
+	template<typename PolicyType>
+	static FVector Evaluate(const FVector& VectorA, const FVector& VectorB, const FVector& Point)
+	{
+		return PolicyType::GetDirection(VectorA, VectorB, Point);
+	}
+
+	/**
+	 * Obtains the evaluator of a direction mode.
+	 * @note Modes that need splines, collision, baked fields or gravity sources don't have an evaluator
+	 * @param Mode - mode that determines direction of gravity
+	 * @return bound evaluator, nullptr if the mode must be evaluated by its owner
+	 */
+	static FNinjaGravityDirectionFunc Find(ENinjaGravityDirectionMode Mode);
+};
@@ -0,0 +1,122 @@
+// "Ninja Character" plugin, by Javier 'Xaklse' Osset; Copyright 2020
+
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "Templates/Function.h"
+#include "NinjaGravityField.generated.h"
+
+
+/**
+ * Precomputed gravity sampled over a regular 3D grid in world space. Every
+ * sample stores a quantized direction and a quantized relative strength;
+ * gravity is trilinearly interpolated between samples at runtime.
+ */
+UCLASS(BlueprintType)
+class NINJACHARACTER_API UNinjaGravityField : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	UNinjaGravityField(const FObjectInitializer& ObjectInitializer);
+
+protected:
+	/** World space bounds covered by the grid. */
+	UPROPERTY(VisibleAnywhere,BlueprintReadOnly,Category="NinjaGravityField")
+	FBox Bounds;
+
+	/** Number of samples along every axis of the grid. */
+	UPROPERTY(VisibleAnywhere,BlueprintReadOnly,Category="NinjaGravityField")
+	FIntVector Dimensions;
+
+	/** Packed samples; X, Y and Z of direction as int8 and strength as uint8. */
+	UPROPERTY()
+	TArray<uint32> Samples;
+
+public:
+	/**
+	 * Asks if the grid contains samples that can be used.
+	 * @return true if the grid can be sampled
+	 */
+	UFUNCTION(BlueprintPure,Category="NinjaGravityField")
+	bool IsValidField() const;
+
+	/**
+	 * Obtains the world space bounds covered by the grid.
+	 * @return bounds of the grid
+	 */
+	FORCEINLINE const FBox& GetBounds() const
+	{
+		return Bounds;
+	}
+
+	/**
+	 * Obtains the number of samples along every axis of the grid.
+	 * @return dimensions of the grid
+	 */
+	FORCEINLINE const FIntVector& GetDimensions() const
+	{
+		return Dimensions;
+	}
+
+	/**
+	 * Obtains the interpolated gravity that influences a given point in space.
+	 * @note Points outside bounds are clamped to the closest border of the grid
+	 * @param Point - given point in space affected by gravity
+	 * @return gravity direction scaled by relative strength [0..1], zero if the grid isn't valid
+	 */
+	UFUNCTION(BlueprintPure,Category="NinjaGravityField")
+	FVector SampleGravity(const FVector& Point) const;
+
+	/**
+	 * Obtains the interpolated gravity of a grid that influences a given point in space.
+	 * @note Only reads given data, thus it can be called from any thread
+	 * @param GridBounds - world space bounds covered by the grid
+	 * @param GridDimensions - number of samples along every axis of the grid
+	 * @param GridSamples - packed samples of the grid
+	 * @param Point - given point in space affected by gravity
+	 * @return gravity direction scaled by relative strength [0..1], zero if the grid isn't valid
+	 */
+	static FVector SampleGravity(const FBox& GridBounds, const FIntVector& GridDimensions,
+		const TArray<uint32>& GridSamples, const FVector& Point);
+
+	/**
+	 * Obtains an immutable copy of packed samples that can be shared with other threads.
+	 * @return shared copy of packed samples
+	 */
+	TSharedPtr<const TArray<uint32>, ESPMode::ThreadSafe> GetSharedSamples() const;
+
+	/**
+	 * Fills the grid sampling a gravity function.
+	 * @param NewBounds - world space bounds covered by the grid
+	 * @param CellSize - desired distance between samples, it is adjusted to fit bounds
+	 * @param MaxGravityMagnitude - magnitude of gravity that corresponds to full strength
+	 * @param GravityFunction - returns gravity vector that influences a given point in space
+	 * @return true if the grid was filled
+	 */
+	bool Bake(const FBox& NewBounds, float CellSize, float MaxGravityMagnitude,
+		TFunctionRef<FVector(const FVector&)> GravityFunction);
+
+protected:
+	/**
+	 * Quantizes gravity direction and relative strength into a sample.
+	 * @param Gravity - gravity direction scaled by relative strength [0..1]
+	 * @return packed sample
+	 */
+	static uint32 PackSample(const FVector& Gravity);
+
+	/**
+	 * Obtains gravity direction and relative strength from a sample.
+	 * @param Sample - packed sample
+	 * @return gravity direction scaled by relative strength [0..1]
+	 */
+	static FVector UnpackSample(uint32 Sample);
+
+	/** Immutable copy of packed samples shared with other threads; created on demand. */
+	mutable TSharedPtr<const TArray<uint32>, ESPMode::ThreadSafe> SharedSamples;
+
+	/** Maximum number of samples along every axis of the grid. */
+	static const int32 MaxDimension;
+};
@@ -0,0 +1,245 @@
+// "Ninja Character" plugin, by Javier 'Xaklse' Osset; Copyright 2020
+
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "NinjaGravityRegistrySubsystem.generated.h"
+
+
+class ANinjaPhysicsVolume;
+class UNinjaGravitySourceComponent;
+
+/**
+ * Bounding volume hierarchy over a list of boxes, used to find the boxes
+ * that contain a point in space.
+ */
+struct NINJACHARACTER_API FNinjaBoundsTree
+{
+public:
+	/**
+	 * Builds the hierarchy; previous contents are discarded.
+	 * @param Bounds - boxes to store, referenced by index
+	 */
+	void Build(const TArray<FBox>& Bounds);
+
+	/** Discards contents of the hierarchy. */
+	void Reset();
+
+	/**
+	 * Finds the boxes that might contain a point in space.
+	 * @note Only nodes are tested, given boxes have to be tested by the caller
+	 * @param Point - point in space
+	 * @param OutIndices - receives indices of boxes of leaf nodes that contain the point
+	 */
+	template<typename AllocatorType>
+	void FindLeafIndices(const FVector& Point, TArray<int32, AllocatorType>& OutIndices) const
+	{
+		if (Nodes.Num() == 0)
+		{
+			return;
+		}
+
+		TArray<int32, TInlineAllocator<32>> NodeStack;
+		NodeStack.Add(0);
+
+		while (NodeStack.Num() > 0)
+		{
+			const FNode& Node = Nodes[NodeStack.Pop(false)];
+			if (!Node.Bounds.IsInsideOrOn(Point))
+			{
+				continue;
+			}
+
+			if (Node.NumBoxes == 0)
+			{
+				NodeStack.Add(Node.FirstIndex);
+				NodeStack.Add(Node.FirstIndex + 1);
+				continue;
+			}
+
+			for (int32 Index = Node.FirstIndex; Index < Node.FirstIndex + Node.NumBoxes; ++Index)
+			{
+				OutIndices.Add(Indices[Index]);
+			}
+		}
+	}
+
+private:
+	/** Node of the hierarchy. */
+	struct FNode
+	{
+		/** World space bounds that contain every box of the node. */
+		FBox Bounds;
+
+		/** First child node if interior node, first index of Indices if leaf node. */
+		int32 FirstIndex;
+
+		/** Number of boxes stored by a leaf node; zero for interior nodes. */
+		int32 NumBoxes;
+	};
+
+	/**
+	 * Builds a node of the hierarchy and its children recursively.
+	 * @param NodeIndex - index of the node to build
+	 * @param Start - first index of Indices contained by the node
+	 * @param Count - amount of boxes contained by the node
+	 * @param Bounds - stored boxes
+	 */
+	void BuildNode(int32 NodeIndex, int32 Start, int32 Count, const TArray<FBox>& Bounds);
+
+	/** Nodes of the hierarchy; first node is the root. */
+	TArray<FNode> Nodes;
+
+	/** Indices of boxes referenced by leaf nodes. */
+	TArray<int32> Indices;
+};
+
+/**
+ * Keeps a bounding volume hierarchy of every Ninja physics volume in play, so
+ * the volume that affects a point in space can be found without overlap events.
+ * It also keeps gravity source components, blended together by Field mode.
+ * @note If several volumes contain a point, the one with highest Priority wins
+ */
+UCLASS()
+class NINJACHARACTER_API UNinjaGravityRegistrySubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UNinjaGravityRegistrySubsystem();
+
+	/** Implement this for deinitialization of instances of the system. */
+	virtual void Deinitialize() override;
+
+	/**
+	 * Adds a physics volume to the registry.
+	 * @param Volume - physics volume to add
+	 */
+	void RegisterVolume(ANinjaPhysicsVolume* Volume);
+
+	/**
+	 * Removes a physics volume from the registry.
+	 * @param Volume - physics volume to remove
+	 */
+	void UnregisterVolume(ANinjaPhysicsVolume* Volume);
+
+	/**
+	 * Notifies that bounds or priority of a registered physics volume changed.
+	 * @note Movable volumes are checked automatically once per frame
+	 * @param Volume - physics volume that changed
+	 */
+	void UpdateVolume(ANinjaPhysicsVolume* Volume);
+
+	/**
+	 * Finds the physics volume with highest priority that contains a point.
+	 * @param Point - point in world space
+	 * @return physics volume that contains the point, nullptr if none
+	 */
+	ANinjaPhysicsVolume* FindGravityVolume(const FVector& Point) const;
+
+	/**
+	 * Obtains the gravity that influences a given point in space.
+	 * @param Point - given point in space affected by gravity
+	 * @return gravity of the physics volume that contains the point, world gravity if none
+	 */
+	FVector GetGravity(const FVector& Point) const;
+
+	/**
+	 * Obtains the amount of registered physics volumes.
+	 * @return amount of registered physics volumes
+	 */
+	FORCEINLINE int32 GetNumVolumes() const
+	{
+		return Volumes.Num();
+	}
+
+public:
+	/**
+	 * Adds a gravity source to the registry.
+	 * @param Source - gravity source to add
+	 */
+	void RegisterSource(UNinjaGravitySourceComponent* Source);
+
+	/**
+	 * Removes a gravity source from the registry.
+	 * @param Source - gravity source to remove
+	 */
+	void UnregisterSource(UNinjaGravitySourceComponent* Source);
+
+	/**
+	 * Notifies that shape or influence of a registered gravity source changed.
+	 * @note Movable sources are checked automatically once per frame
+	 * @param Source - gravity source that changed
+	 */
+	void UpdateSource(UNinjaGravitySourceComponent* Source);
+
+	/**
+	 * Blends every gravity source that influences a given point in space.
+	 * @note Sources fade out with their falloff; overlapping sources are averaged by weight
+	 * @param Point - given point in space affected by gravity
+	 * @return direction of gravity multiplied by relative strength, could be zero
+	 */
+	FVector GetFieldGravity(const FVector& Point) const;
+
+	/**
+	 * Obtains the amount of registered gravity sources.
+	 * @return amount of registered gravity sources
+	 */
+	FORCEINLINE int32 GetNumSources() const
+	{
+		return Sources.Num();
+	}
+
+protected:
+	/**
+	 * Rebuilds the hierarchy of volumes if registered volumes changed.
+	 */
+	void RefreshVolumeTree();
+
+	/**
+	 * Obtains the world space bounds of a physics volume.
+	 * @param Volume - physics volume to query
+	 * @return bounds of the brush of the volume
+	 */
+	static FBox GetVolumeBounds(const ANinjaPhysicsVolume* Volume);
+
+	/**
+	 * Rebuilds the hierarchy of sources if registered sources changed.
+	 */
+	void RefreshSourceTree();
+
+protected:
+	/** Registered physics volumes; volumes unregister themselves when removed from play. */
+	UPROPERTY(Transient)
+	TArray<ANinjaPhysicsVolume*> Volumes;
+
+	/** Bounds of registered volumes when the hierarchy was built. */
+	TArray<FBox> VolumeBounds;
+
+	/** Hierarchy of registered volumes. */
+	FNinjaBoundsTree VolumeTree;
+
+	/** If true, the hierarchy of volumes has to be rebuilt. */
+	bool bVolumeTreeDirty;
+
+	/** Frame counter value when movable volumes were last checked. */
+	uint64 LastVolumeRefreshFrame;
+
+	/** Registered gravity sources; sources unregister themselves when unregistered. */
+	UPROPERTY(Transient)
+	TArray<UNinjaGravitySourceComponent*> Sources;
+
+	/** Influence bounds of registered sources when the hierarchy was built. */
+	TArray<FBox> SourceBounds;
+
+	/** Hierarchy of registered sources. */
+	FNinjaBoundsTree SourceTree;
+
+	/** If true, the hierarchy of sources has to be rebuilt. */
+	bool bSourceTreeDirty;
+
+	/** Frame counter value when movable sources were last checked. */
+	uint64 LastSourceRefreshFrame;
+};
@@ -0,0 +1,270 @@
+// "Ninja Character" plugin, by Javier 'Xaklse' Osset; Copyright 2020
+
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/Atomic.h"
+#include "NinjaGravityEvaluator.h"
+#include "NinjaTypes.h"
+
+
+class ANinjaPhysicsVolume;
+class FNinjaGravitySnapshotPtr;
+class UNinjaCharacterMovementComponent;
+class USplineComponent;
+
+/**
+ * Points of a spline sampled in world space, so the spline can be queried
+ * without accessing the spline component.
+ */
+struct NINJACHARACTER_API FNinjaGravitySplineSamples
+{
+public:
+	FNinjaGravitySplineSamples();
+
+	/** Identifies the sampled spline component; never dereferenced. */
+	const void* SplineId;
+
+	/** Version of the spline curves when they were sampled. */
+	uint32 SplineVersion;
+
+	/** Transform of the spline component when it was sampled. */
+	FTransform SplineTransform;
+
+	/** World space locations of samples. */
+	TArray<FVector> Locations;
+
+	/** World space normalized directions of samples. */
+	TArray<FVector> Directions;
+
+	/** World space up vectors of samples. */
+	TArray<FVector> UpVectors;
+
+	/**
+	 * Samples a spline, or reuses previous samples if the spline didn't change.
+	 * @param Spline - spline to sample
+	 * @param PreviousSamples - samples that can be reused
+	 * @return samples of the spline, nullptr if there isn't a spline
+	 */
+	static TSharedPtr<const FNinjaGravitySplineSamples, ESPMode::ThreadSafe> Sample(const USplineComponent* Spline,
+		const TSharedPtr<const FNinjaGravitySplineSamples, ESPMode::ThreadSafe>& PreviousSamples);
+
+	/**
+	 * Finds the point of the sampled spline closest to a location.
+	 * @param Point - location in world space
+	 * @param OutLocation - receives closest location of the spline
+	 * @param OutDirection - receives direction of the spline at closest location
+	 * @param OutUpVector - receives up vector of the spline at closest location
+	 * @return true if the spline has samples
+	 */
+	bool FindClosest(const FVector& Point, FVector& OutLocation, FVector& OutDirection, FVector& OutUpVector) const;
+
+	/** Number of samples taken for every segment of a spline. */
+	static const int32 SamplesPerSegment;
+
+	/** Maximum number of samples taken for a spline. */
+	static const int32 MaxSamples;
+};
+
+/**
+ * Immutable copy of gravity settings, published by its owner once per frame
+ * on the game thread and readable from any thread.
+ */
+struct NINJACHARACTER_API FNinjaGravitySnapshot
+{
+public:
+	FNinjaGravitySnapshot();
+
+	/** Mode that determines direction of gravity. */
+	ENinjaGravityDirectionMode Mode;
+
+	/** Evaluator bound to Mode by the owner, nullptr if Mode has none. */
+	FNinjaGravityDirectionFunc DirectionFunc;
+
+	/** Stores information that determines direction of gravity. */
+	FVector VectorA;
+
+	/** Stores additional information that determines direction of gravity. */
+	FVector VectorB;
+
+	/** Gravity vector is multiplied by this amount. */
+	float Scale;
+
+	/** Absolute (positive) magnitude of gravity, not influenced by Scale. */
+	float Magnitude;
+
+	/** Engine gravity along Z axis that physics bodies already simulate by themselves. */
+	float EngineGravityZ;
+
+	/** Direction of gravity at location of the owner when published; could be zero. */
+	FVector Direction;
+
+	/** Transform of the owner when published. */
+	FTransform Transform;
+
+	/** Sampled spline for spline gravity modes. */
+	TSharedPtr<const FNinjaGravitySplineSamples, ESPMode::ThreadSafe> Spline;
+
+	/** World space bounds of the baked gravity field. */
+	FBox FieldBounds;
+
+	/** Number of samples along every axis of the baked gravity field. */
+	FIntVector FieldDimensions;
+
+	/** Packed samples of the baked gravity field. */
+	TSharedPtr<const TArray<uint32>, ESPMode::ThreadSafe> FieldSamples;
+
+	/** Frame counter value when published. */
+	uint64 Frame;
+
+public:
+	/**
+	 * Obtains the gravity that influences a given point in space.
+	 * @note Collision mode can't be evaluated outside the game thread, direction towards last closest point is used
+	 * @param Point - given point in space affected by gravity
+	 * @return gravity vector, could be zero
+	 */
+	FVector GetGravity(const FVector& Point) const;
+
+	/**
+	 * Obtains the normalized direction of gravity that influences a given point in space.
+	 * @param Point - given point in space affected by gravity
+	 * @return normalized direction of gravity, could be zero
+	 */
+	FVector GetGravityDirection(const FVector& Point) const;
+
+	/**
+	 * Obtains the latest gravity snapshot published by a movement component.
+	 * @note Never blocks; can be called from any thread while the component is alive
+	 * @param Component - movement component that publishes gravity snapshots
+	 * @return latest gravity snapshot, invalid if none was published
+	 */
+	static FNinjaGravitySnapshotPtr Read(const UNinjaCharacterMovementComponent* Component);
+
+	/**
+	 * Obtains the latest gravity snapshot published by a physics volume.
+	 * @note Never blocks; can be called from any thread while the volume is alive
+	 * @param Volume - physics volume that publishes gravity snapshots
+	 * @return latest gravity snapshot, invalid if none was published
+	 */
+	static FNinjaGravitySnapshotPtr Read(const ANinjaPhysicsVolume* Volume);
+
+private:
+	/**
+	 * Obtains normalized direction of gravity and relative strength, not influenced by Scale.
+	 * @param Point - given point in space affected by gravity
+	 * @param OutStrength - receives relative strength of gravity
+	 * @return normalized direction of gravity, could be zero
+	 */
+	FVector EvaluateDirection(const FVector& Point, float& OutStrength) const;
+};
+
+/**
+ * Reference to a published gravity snapshot; the slot of the snapshot isn't
+ * reused while the reference is held. Only movable, keep it short-lived.
+ */
+class NINJACHARACTER_API FNinjaGravitySnapshotPtr
+{
+public:
+	FNinjaGravitySnapshotPtr();
+	FNinjaGravitySnapshotPtr(FNinjaGravitySnapshotPtr&& Other);
+	FNinjaGravitySnapshotPtr& operator=(FNinjaGravitySnapshotPtr&& Other);
+	~FNinjaGravitySnapshotPtr();
+
+	FNinjaGravitySnapshotPtr(const FNinjaGravitySnapshotPtr&) = delete;
+	FNinjaGravitySnapshotPtr& operator=(const FNinjaGravitySnapshotPtr&) = delete;
+
+	/**
+	 * Checks if a snapshot is referenced.
+	 * @return true if a snapshot is referenced
+	 */
+	FORCEINLINE bool IsValid() const
+	{
+		return Snapshot != nullptr;
+	}
+
+	/**
+	 * Obtains the referenced snapshot.
+	 * @return referenced snapshot, nullptr if none
+	 */
+	FORCEINLINE const FNinjaGravitySnapshot* Get() const
+	{
+		return Snapshot;
+	}
+
+	FORCEINLINE const FNinjaGravitySnapshot* operator->() const
+	{
+		check(Snapshot != nullptr);
+		return Snapshot;
+	}
+
+	FORCEINLINE const FNinjaGravitySnapshot& operator*() const
+	{
+		check(Snapshot != nullptr);
+		return *Snapshot;
+	}
+
+	/** Releases the referenced snapshot. */
+	void Reset();
+
+private:
+	friend class FNinjaGravitySnapshotBuffer;
+
+	FNinjaGravitySnapshotPtr(const FNinjaGravitySnapshot* InSnapshot, TAtomic<int32>* InReaderCount);
+
+	/** Referenced snapshot. */
+	const FNinjaGravitySnapshot* Snapshot;
+
+	/** Amount of readers of the slot of the snapshot, decremented on release. */
+	TAtomic<int32>* ReaderCount;
+};
+
+/**
+ * Publication point of gravity snapshots, made of a few preallocated slots.
+ * The game thread fills a slot that isn't published nor read and then
+ * publishes its index; readers on any thread pin the published slot with a
+ * reader count and check that the index didn't change meanwhile. Readers
+ * never block and publishing doesn't allocate; published slots are never
+ * written.
+ */
+class NINJACHARACTER_API FNinjaGravitySnapshotBuffer
+{
+public:
+	FNinjaGravitySnapshotBuffer();
+
+	/**
+	 * Obtains a slot to write; game thread only.
+	 * @note Readers never see the slot while written
+	 * @return snapshot to fill before calling Publish(), nullptr if every other slot is being read
+	 */
+	FNinjaGravitySnapshot* BeginWrite();
+
+	/** Makes the written snapshot the published one; game thread only. */
+	void Publish();
+
+	/**
+	 * Obtains the latest published snapshot; any thread, never blocks.
+	 * @return latest published snapshot, invalid if none was published
+	 */
+	FNinjaGravitySnapshotPtr Read() const;
+
+	/** Discards published snapshots; game thread only. */
+	void Reset();
+
+private:
+	/** Number of preallocated snapshots: published one, written one and one kept by slow readers. */
+	static constexpr int32 NumSlots = 3;
+
+	/** Preallocated snapshots. */
+	FNinjaGravitySnapshot Slots[NumSlots];
+
+	/** Amount of readers that pin every slot. */
+	mutable TAtomic<int32> ReaderCounts[NumSlots];
+
+	/** Index of the published slot, INDEX_NONE if none was published. */
+	TAtomic<int32> PublishedIndex;
+
+	/** Index of the slot being written by the game thread, INDEX_NONE if none. */
+	int32 WriteIndex;
+};
@@ -0,0 +1,114 @@
+// "Ninja Character" plugin, by Javier 'Xaklse' Osset; Copyright 2020
+
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/SceneComponent.h"
+#include "NinjaSplineSegmentTree.h"
+#include "NinjaTypes.h"
+#include "NinjaGravitySourceComponent.generated.h"
+
+
+/**
+ * A GravitySourceComponent attracts towards its shape everything inside its
+ * influence radius. Physics volumes and characters in Field gravity mode blend
+ * all sources that influence them, weighted by their falloff.
+ */
+UCLASS(ClassGroup=Physics,Meta=(BlueprintSpawnableComponent))
+class NINJACHARACTER_API UNinjaGravitySourceComponent : public USceneComponent
+{
+	GENERATED_BODY()
+
+public:
+	UNinjaGravitySourceComponent(const FObjectInitializer& ObjectInitializer);
+
+	/**
+	 * Called when a component is registered, after Scene is set, but before
+	 * CreateRenderState_Concurrent or OnCreatePhysicsState are called.
+	 */
+	virtual void OnRegister() override;
+
+	/**
+	 * Called when a component is unregistered. Called after DestroyRenderState_Concurrent
+	 * and OnDestroyPhysicsState are called.
+	 */
+	virtual void OnUnregister() override;
+
+#if WITH_EDITOR
+	/**
+	 * Called when a property on this object has been modified externally.
+	 * @param PropertyChangedEvent - the property that was modified
+	 */
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif // WITH_EDITOR
+
+public:
+	/** Shape that gravity direction points to. */
+	UPROPERTY(EditAnywhere,BlueprintReadOnly,Category="NinjaGravitySource")
+	ENinjaGravitySourceShape Shape;
+
+	/** Length of the line shape, centered on this component along its X axis. */
+	UPROPERTY(EditAnywhere,BlueprintReadOnly,Category="NinjaGravitySource",Meta=(ClampMin="0",UIMin="0"))
+	float LineLength;
+
+	/** Half size of the box shape, oriented with this component. */
+	UPROPERTY(EditAnywhere,BlueprintReadOnly,Category="NinjaGravitySource")
+	FVector BoxExtent;
+
+	/**
+	 * Distance to the shape where influence of this source ends.
+	 * @note Spline shape uses the first spline of the owner (or the attach parent)
+	 */
+	UPROPERTY(EditAnywhere,BlueprintReadOnly,Category="NinjaGravitySource",Meta=(ClampMin="0",UIMin="0"))
+	float InfluenceRadius;
+
+	/** Influence fades out over this distance, ending at InfluenceRadius. */
+	UPROPERTY(EditAnywhere,BlueprintReadOnly,Category="NinjaGravitySource",Meta=(ClampMin="0",UIMin="0"))
+	float FalloffDistance;
+
+	/** Relative importance of this source when blended with other sources. */
+	UPROPERTY(EditAnywhere,BlueprintReadOnly,Category="NinjaGravitySource",Meta=(ClampMin="0",UIMin="0"))
+	float Weight;
+
+	/** Relative strength of gravity of this source. */
+	UPROPERTY(EditAnywhere,BlueprintReadOnly,Category="NinjaGravitySource")
+	float Strength;
+
+public:
+	/**
+	 * Obtains the world space bounds where this source has influence.
+	 * @return bounds of the shape expanded by InfluenceRadius
+	 */
+	FBox GetInfluenceBounds() const;
+
+	/**
+	 * Finds the point of the shape closest to a given point in space.
+	 * @param Point - given point in space
+	 * @param OutClosestPoint - receives closest point of the shape
+	 * @return false if the shape isn't valid
+	 */
+	bool GetClosestPoint(const FVector& Point, FVector& OutClosestPoint) const;
+
+	/**
+	 * Obtains the weight of this source at a given distance to its shape.
+	 * @param Distance - distance to the shape
+	 * @return weight of this source, zero if outside of influence
+	 */
+	float GetInfluenceWeight(float Distance) const;
+
+protected:
+	/** Resolves the spline used by Spline shape. */
+	void UpdateGravitySpline();
+
+	/** Notifies the gravity registry that this source changed. */
+	void NotifyRegistry();
+
+protected:
+	/** Cached spline used by Spline shape. */
+	UPROPERTY(Transient)
+	class USplineComponent* GravitySpline;
+
+	/** Acceleration structure for closest input key queries of GravitySpline. */
+	FNinjaSplineSegmentTree GravitySplineTree;
+};
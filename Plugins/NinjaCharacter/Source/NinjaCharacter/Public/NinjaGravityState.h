@@ -0,0 +1,100 @@
+// "Ninja Character" plugin, by Javier 'Xaklse' Osset; Copyright 2020
+
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NinjaTypes.h"
+#include "NinjaGravityState.generated.h"
+
+
+/**
+ * Gravity settings replicated from server to clients. Only the data required
+ * by the current gravity mode is serialized; locations are quantized to one
+ * decimal and directions are quantized as unit vectors. A gravity state that
+ * just follows a Ninja physics volume that replicates gravity is one bit.
+ */
+USTRUCT()
+struct NINJACHARACTER_API FNinjaGravityState
+{
+	GENERATED_BODY()
+
+public:
+	FNinjaGravityState();
+
+	/** Mode that determines direction of gravity. */
+	UPROPERTY()
+	ENinjaGravityDirectionMode Mode;
+
+	/** Stores information that determines direction of gravity. */
+	UPROPERTY()
+	FVector VectorA;
+
+	/** Stores additional information that determines direction of gravity. */
+	UPROPERTY()
+	FVector VectorB;
+
+	/** Optional Actor that determines direction of gravity. */
+	UPROPERTY()
+	AActor* Actor;
+
+	/** Optional baked gravity field that determines direction of gravity. */
+	UPROPERTY()
+	class UNinjaGravityField* Field;
+
+	/** Gravity vector is multiplied by this amount. */
+	UPROPERTY()
+	float Scale;
+
+	/**
+	 * If true, gravity settings are the ones replicated by the current Ninja
+	 * physics volume and every other member is ignored.
+	 */
+	UPROPERTY()
+	bool bFromVolume;
+
+public:
+	/**
+	 * Asks if a given gravity state is close enough to this one, thus it
+	 * doesn't need to be replicated.
+	 * @param Other - gravity state to compare with
+	 * @param MaxAngleCosine - cosine of maximum angle allowed between directions
+	 * @param MaxDistance - maximum distance allowed between locations
+	 * @return true if both gravity states are close enough
+	 */
+	bool IsNearlyEqual(const FNinjaGravityState& Other, float MaxAngleCosine, float MaxDistance) const;
+
+	/**
+	 * Asks if this gravity state uses an Actor instead of stored vectors.
+	 * @return true if Actor determines direction of gravity
+	 */
+	bool UsesActor() const;
+
+	/**
+	 * Serializes the gravity state for network replication.
+	 * @param Ar - archive to read from or write to
+	 * @param Map - package map used to serialize object references
+	 * @param bOutSuccess - receives false if serialization failed
+	 * @return true if the struct was serialized
+	 */
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+
+	/** Compares every member of two gravity states. */
+	bool operator==(const FNinjaGravityState& Other) const;
+
+	/** Compares every member of two gravity states. */
+	FORCEINLINE bool operator!=(const FNinjaGravityState& Other) const
+	{
+		return !(*this == Other);
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FNinjaGravityState> : public TStructOpsTypeTraitsBase2<FNinjaGravityState>
+{
+	enum
+	{
+		WithNetSerializer = true,
+		WithIdenticalViaEquality = true,
+	};
+};
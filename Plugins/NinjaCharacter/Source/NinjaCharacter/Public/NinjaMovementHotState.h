@@ -0,0 +1,68 @@
+// "Ninja Character" plugin, by Javier 'Xaklse' Osset; Copyright 2020
+
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NinjaGravityEvaluator.h"
+
+
+/**
+ * Simulation state of a Ninja character movement component that is read or
+ * written every tick, kept apart from configuration and debugging state and
+ * aligned to a cache line; it spans two cache lines.
+ * @note Members are sorted by size to avoid padding
+ */
+struct alignas(PLATFORM_CACHE_LINE_SIZE) NINJACHARACTER_API FNinjaMovementHotState
+{
+public:
+	FNinjaMovementHotState();
+
+	/** Frame counter value when cached gravity data was evaluated. */
+	uint64 GravityCacheFrame;
+
+	/** Frame counter value when GroupVolumeGravityZ was provided. */
+	uint64 GroupVolumeGravityFrame;
+
+	/** Frame counter value of last rotation allowed by the drift budget. */
+	uint64 IncrementalRotationFrame;
+
+	/** Evaluator bound to the gravity mode, nullptr if the mode has none. */
+	FNinjaGravityDirectionFunc GravityDirectionFunc;
+
+	/** Location of UpdatedComponent when cached gravity data was evaluated. */
+	FVector GravityCacheLocation;
+
+	/** Cached normalized direction of gravity, not influenced by GravityScale; could be zero. */
+	FVector GravityCacheDirection;
+
+	/** Cached absolute (positive) magnitude of gravity, not influenced by GravityScale. */
+	float GravityCacheMagnitude;
+
+	/** Gravity Z of current physics volume shared by a group of movement components. */
+	float GroupVolumeGravityZ;
+
+	/** Stores last known value of GravityScale. */
+	float OldGravityScale;
+
+	/** Threshold that determines if two unit vectors are perpendicular. */
+	float ThresholdOrthogonalCosine;
+
+	/** Threshold that determines if two unit vectors are parallel. */
+	float ThresholdParallelCosine;
+
+	/** Cosine of IncrementalRotationBudget. */
+	float IncrementalRotationBudgetCosine;
+
+	/** Cosine of IncrementalRotationRelease. */
+	float IncrementalRotationReleaseCosine;
+
+	/** If true, cached gravity data was evaluated and can be reused. */
+	bool bGravityCacheValid;
+
+	/** If true, gravity direction changed and needs to be replicated. */
+	bool bDirtyGravityDirection;
+
+	/** If true, drift exceeded the budget and rotation follows the desired axis every tick. */
+	bool bIncrementalRotationActive;
+};
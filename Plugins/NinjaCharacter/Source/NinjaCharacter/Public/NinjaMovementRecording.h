@@ -0,0 +1,234 @@
+// "Ninja Character" plugin, by Javier 'Xaklse' Osset; Copyright 2020
+
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/SoftObjectPath.h"
+#include "NinjaTypes.h"
+
+
+class ANinjaCharacter;
+class UWorld;
+struct FNinjaGravityState;
+
+/**
+ * Gravity settings of a recorded move; object references are stored by name
+ * so they can be resolved in the replay world.
+ */
+struct NINJACHARACTER_API FNinjaRecordedGravityState
+{
+	FNinjaRecordedGravityState();
+
+	/** Index of the first move simulated with this gravity state. */
+	int32 MoveIndex;
+
+	/** Mode that determines direction of gravity. */
+	ENinjaGravityDirectionMode Mode;
+
+	/** Stores information that determines direction of gravity. */
+	FVector VectorA;
+
+	/** Stores additional information that determines direction of gravity. */
+	FVector VectorB;
+
+	/** Gravity vector is multiplied by this amount. */
+	float Scale;
+
+	/** Name of the optional Actor that determines direction of gravity. */
+	FName ActorName;
+
+	/** Path of the optional baked gravity field that determines direction of gravity. */
+	FSoftObjectPath FieldPath;
+
+	/**
+	 * Fills this recorded gravity state from a gravity state.
+	 * @param GravityState - gravity state to record
+	 */
+	void Set(const FNinjaGravityState& GravityState);
+
+	/**
+	 * Resolves this recorded gravity state in a world.
+	 * @param World - world where Actors are searched
+	 * @param OutGravityState - receives the gravity state
+	 * @return false if a referenced object couldn't be found
+	 */
+	bool Resolve(UWorld* World, FNinjaGravityState& OutGravityState) const;
+
+	/** Serializes a recorded gravity state. */
+	friend FArchive& operator<<(FArchive& Ar, FNinjaRecordedGravityState& GravityState);
+};
+
+/**
+ * Input and result of a recorded move.
+ */
+struct NINJACHARACTER_API FNinjaRecordedMove
+{
+	FNinjaRecordedMove();
+
+	/** Time stamp of the move, sent by the client. */
+	float TimeStamp;
+
+	/** Time simulated by the move, in seconds. */
+	float DeltaTime;
+
+	/** Compressed flags of the move, i.e. jump and crouch. */
+	uint8 CompressedFlags;
+
+	/** Acceleration of the move. */
+	FVector Acceleration;
+
+	/** Gravity direction (influenced by GravityScale) sent with the move, zero if none. */
+	FVector GravityDirection;
+
+	/** Location of the updated component when the move ended. */
+	FVector EndLocation;
+
+	/** Rotation of the updated component when the move ended. */
+	FRotator EndRotation;
+
+	/** Velocity when the move ended. */
+	FVector EndVelocity;
+
+	/** Packed movement mode when the move ended. */
+	uint8 EndMovementMode;
+
+	/** If true, the floor found by the move was a blocking hit. */
+	bool bFloorBlockingHit;
+
+	/** If true, the floor found by the move was walkable. */
+	bool bFloorWalkable;
+
+	/** Distance to the floor found by the move. */
+	float FloorDist;
+
+	/** Normal of the floor found by the move. */
+	FVector FloorNormal;
+
+	/** Serializes a recorded move. */
+	friend FArchive& operator<<(FArchive& Ar, FNinjaRecordedMove& Move);
+};
+
+/**
+ * Correction sent by the server or received by the client while recording.
+ */
+struct NINJACHARACTER_API FNinjaRecordedCorrection
+{
+	FNinjaRecordedCorrection();
+
+	/** Time stamp of the corrected move. */
+	float TimeStamp;
+
+	/** Index of the last move recorded before the correction. */
+	int32 MoveIndex;
+
+	/** Location of the client when the correction happened. */
+	FVector ClientLocation;
+
+	/** Location of the server when the correction happened. */
+	FVector ServerLocation;
+
+	/** Serializes a recorded correction. */
+	friend FArchive& operator<<(FArchive& Ar, FNinjaRecordedCorrection& Correction);
+};
+
+/**
+ * Results of a replayed recording compared to the recorded moves.
+ */
+struct NINJACHARACTER_API FNinjaMovementReplayReport
+{
+	FNinjaMovementReplayReport();
+
+	/** Amount of replayed moves. */
+	int32 NumMoves;
+
+	/** Amount of moves that ended too far from the recorded location, velocity or rotation. */
+	int32 NumDivergedMoves;
+
+	/** Index of the first move that diverged, INDEX_NONE if none. */
+	int32 FirstDivergedMove;
+
+	/** Amount of moves that found a different floor. */
+	int32 NumFloorMismatches;
+
+	/** Amount of gravity states that couldn't be resolved in the replay world. */
+	int32 NumUnresolvedGravityStates;
+
+	/** Longest distance between a replayed and a recorded location. */
+	float MaxLocationError;
+
+	/** Longest difference between a replayed and a recorded velocity. */
+	float MaxVelocityError;
+
+	/** Time spent simulating every move, in milliseconds. */
+	double SimulationTime;
+
+	/**
+	 * Describes the report in a single line.
+	 * @return description of the report
+	 */
+	FString ToString() const;
+};
+
+/**
+ * Compact binary recording of the moves of a Ninja character movement
+ * component, including gravity changes and floor results, that can be
+ * re-simulated offline to reproduce and profile network corrections.
+ * @see UNinjaCharacterMovementComponent::StartMovementRecording
+ */
+struct NINJACHARACTER_API FNinjaMovementRecording
+{
+	FNinjaMovementRecording();
+
+	/** Path of the class of the recorded character. */
+	FSoftClassPath CharacterClass;
+
+	/** Net mode of the recording world. */
+	uint8 NetMode;
+
+	/** Location of the updated component when recording started. */
+	FVector StartLocation;
+
+	/** Rotation of the updated component when recording started. */
+	FRotator StartRotation;
+
+	/** Velocity when recording started. */
+	FVector StartVelocity;
+
+	/** Packed movement mode when recording started. */
+	uint8 StartMovementMode;
+
+	/** Recorded moves, in order. */
+	TArray<FNinjaRecordedMove> Moves;
+
+	/** Gravity states, in order; the first one is the gravity when recording started. */
+	TArray<FNinjaRecordedGravityState> GravityStates;
+
+	/** Recorded corrections, in order. */
+	TArray<FNinjaRecordedCorrection> Corrections;
+
+	/** Serializes the whole recording. */
+	void Serialize(FArchive& Ar);
+
+	/**
+	 * Saves the recording to a compressed file.
+	 * @param FileName - path of the file
+	 * @return true if the file was saved
+	 */
+	bool SaveToFile(const FString& FileName);
+
+	/**
+	 * Loads a recording from a compressed file.
+	 * @param FileName - path of the file
+	 * @return true if the file was loaded
+	 */
+	bool LoadFromFile(const FString& FileName);
+
+	/**
+	 * Spawns a character of the recorded class at the start of the recording,
+	 * ready to replay it; the character doesn't tick by itself.
+	 * @param World - authoritative world where the character is spawned
+	 * @return spawned character, nullptr if it couldn't be spawned
+	 */
+	ANinjaCharacter* SpawnReplayCharacter(UWorld* World) const;
+};
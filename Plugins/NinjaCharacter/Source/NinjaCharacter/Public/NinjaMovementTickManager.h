@@ -0,0 +1,150 @@
+// "Ninja Character" plugin, by Javier 'Xaklse' Osset; Copyright 2020
+
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineBaseTypes.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "NinjaTypes.h"
+#include "NinjaMovementTickManager.generated.h"
+
+
+class AController;
+class APhysicsVolume;
+class UNinjaCharacterMovementComponent;
+class UNinjaMovementTickManager;
+class USkeletalMeshComponent;
+
+/**
+ * Tick function that ticks every movement component registered in a
+ * UNinjaMovementTickManager.
+ */
+USTRUCT()
+struct FNinjaMovementTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+public:
+	FNinjaMovementTickFunction();
+
+	/** Movement tick manager that owns this tick function. */
+	UNinjaMovementTickManager* Manager;
+
+	/**
+	 * Abstract function to actually execute the tick.
+	 * @param DeltaTime - frame time to advance, in seconds
+	 * @param TickType - kind of tick for this frame
+	 * @param CurrentThread - thread we are executing on, useful to pass along as new tasks are created
+	 * @param MyCompletionGraphEvent - completion event for this task
+	 */
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread,
+		const FGraphEventRef& MyCompletionGraphEvent) override;
+
+	/** Abstract function to describe this tick. Used to print messages about illegal cycles in the dependency graph. */
+	virtual FString DiagnosticMessage() override;
+
+	/** Function used to describe this tick for active tick reporting. */
+	virtual FName DiagnosticContext(bool bDetailed) override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FNinjaMovementTickFunction> : public TStructOpsTypeTraitsBase2<FNinjaMovementTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
+/**
+ * Ticks AI controlled Ninja movement components in batches with a single
+ * tick function. Components are visited grouped by physics volume and gravity
+ * mode, so volume gravity is evaluated once per group; direction of gravity
+ * is still evaluated per component because it depends on its location.
+ * Controllers of the characters tick before the batch and meshes after it,
+ * like they do with the own tick function of every component.
+ */
+UCLASS()
+class NINJACHARACTER_API UNinjaMovementTickManager : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UNinjaMovementTickManager();
+
+	/** Implement this for deinitialization of instances of the system. */
+	virtual void Deinitialize() override;
+
+	/**
+	 * Starts ticking a movement component; its own tick function is disabled.
+	 * @param Component - movement component to tick
+	 */
+	void RegisterComponent(UNinjaCharacterMovementComponent* Component);
+
+	/**
+	 * Stops ticking a movement component.
+	 * @param Component - movement component to stop ticking
+	 * @param bRestoreTick - if true, own tick function of the component is enabled again
+	 */
+	void UnregisterComponent(UNinjaCharacterMovementComponent* Component, bool bRestoreTick);
+
+	/**
+	 * Ticks every registered movement component.
+	 * @note Doesn't tick while the game is paused
+	 * @param DeltaTime - frame time to advance, in seconds
+	 * @param TickType - kind of tick for this frame
+	 */
+	void TickComponents(float DeltaTime, ELevelTick TickType);
+
+	/**
+	 * Obtains the amount of registered movement components.
+	 * @return amount of registered movement components
+	 */
+	FORCEINLINE int32 GetNumComponents() const
+	{
+		return Entries.Num();
+	}
+
+protected:
+	/** Registered movement component and the group it belongs to. */
+	struct FNinjaMovementTickEntry
+	{
+		/** Registered movement component; entries of destroyed components are discarded. */
+		TWeakObjectPtr<UNinjaCharacterMovementComponent> Component;
+
+		/** Physics volume of the movement component, refreshed every tick before grouping. */
+		APhysicsVolume* PhysicsVolume;
+
+		/** Gravity mode of the movement component. */
+		ENinjaGravityDirectionMode GravityDirectionMode;
+
+		/** Controller whose tick is a prerequisite of the tick function. */
+		TWeakObjectPtr<AController> Controller;
+
+		/** Mesh whose tick has the tick function as prerequisite. */
+		TWeakObjectPtr<USkeletalMeshComponent> Mesh;
+	};
+
+	/**
+	 * Makes the tick function tick after the controller and before the mesh of
+	 * the character of an entry; changes apply from next frame.
+	 * @param Entry - entry of a registered movement component
+	 */
+	void AddTickDependencies(FNinjaMovementTickEntry& Entry);
+
+	/**
+	 * Removes tick dependencies added by AddTickDependencies().
+	 * @param Entry - entry of a movement component
+	 */
+	void RemoveTickDependencies(FNinjaMovementTickEntry& Entry);
+
+	/** Registered movement components; components unregister themselves when removed from play. */
+	TArray<FNinjaMovementTickEntry> Entries;
+
+	/** Tick function that ticks registered movement components. */
+	FNinjaMovementTickFunction TickFunction;
+
+	/** If true, registered movement components are being ticked. */
+	bool bTickingComponents;
+};
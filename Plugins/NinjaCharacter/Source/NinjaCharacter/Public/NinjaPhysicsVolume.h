@@ -5,6 +5,12 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/PhysicsVolume.h"
+#include "PhysicsEngine/BodyInstance.h"
+#include "NinjaGravityActorProxy.h"
+#include "NinjaGravityEvaluator.h"
+#include "NinjaGravitySnapshot.h"
+#include "NinjaGravityState.h"
+#include "NinjaSplineSegmentTree.h"
 #include "NinjaTypes.h"
 #include "NinjaPhysicsVolume.generated.h"
 
@@ -33,6 +39,28 @@ public:
 #endif // WITH_EDITORONLY_DATA
 
 public:
+	/**
+	 * Do any object-specific cleanup required immediately after loading an object.
+	 */
+	virtual void PostLoad() override;
+
+	/**
+	 * Allow actors to initialize themselves on the C++ side after all of their
+	 * components have been initialized.
+	 */
+	virtual void PostInitializeComponents() override;
+
+	/**
+	 * Called when the game starts or when spawned.
+	 */
+	virtual void BeginPlay() override;
+
+	/**
+	 * Overridable function called whenever this actor is being removed from a level.
+	 * @param EndPlayReason - why this actor is being removed
+	 */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	/**
 	 * Called every frame.
 	 * @param DeltaTime - game time elapsed during last frame modified by the time dilation
@@ -48,6 +76,77 @@ protected:
 	UPROPERTY(VisibleInstanceOnly,BlueprintReadOnly,Transient,Category="NinjaPhysicsVolume")
 	TArray<class ANinjaCharacter*> TrackedNinjas;
 
+	/** Index of every tracked Actor in TrackedActors list. */
+	TMap<const AActor*, int32> TrackedActorIndices;
+
+	/** Index of every tracked Ninja in TrackedNinjas list. */
+	TMap<const class ANinjaCharacter*, int32> TrackedNinjaIndices;
+
+	/** Frame counter value of last compaction of tracked lists. */
+	uint64 LastTrackedListsCompactionFrame;
+
+	/**
+	 * Removes invalid entries from TrackedActors and TrackedNinjas lists.
+	 * @note Does nothing if lists were already compacted during current frame
+	 */
+	void CompactTrackedLists();
+
+public:
+	/**
+	 * If true, gravity forces of tracked Actors are computed in parallel by
+	 * worker threads and then applied in one pass.
+	 * @note Console variable 'npv.ParallelGravityForces' can disable it globally
+	 */
+	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="NinjaPhysicsVolume")
+	uint32 bParallelGravityForces:1;
+
+protected:
+	/**
+	 * Asks if gravity forces of a given number of tracked Actors should be
+	 * computed in parallel.
+	 * @param NumBodies - number of physics bodies affected by gravity
+	 * @return true if gravity forces should be computed by worker threads
+	 */
+	virtual bool ShouldComputeGravityInParallel(int32 NumBodies) const;
+
+public:
+	/**
+	 * If true, gravity forces of every simulated body of tracked Actors are
+	 * computed and applied by the physics simulation, reading the published
+	 * gravity snapshot instead of the game thread. Forces are applied once per
+	 * substep only if physics substepping is enabled in project settings,
+	 * otherwise once per frame. Bodies are still visited on the game thread
+	 * every tick to register the physics callback.
+	 * @note Collision and Field modes (and gravity sources) keep computing forces on the game thread
+	 */
+	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="NinjaPhysicsVolume")
+	uint32 bPhysicsRateGravityForces:1;
+
+protected:
+	/** Delegate that applies gravity to a body during every physics (sub)step; bound once, shared by all bodies. */
+	FCalculateCustomPhysics PhysicsRateGravityDelegate;
+
+	/**
+	 * Asks if gravity forces of tracked Actors are applied by the physics simulation.
+	 * @return true if bPhysicsRateGravityForces is set and the gravity mode can be evaluated from a snapshot
+	 */
+	virtual bool ShouldApplyGravityAtPhysicsRate() const;
+
+	/**
+	 * Registers PhysicsRateGravityDelegate for the next physics step of every
+	 * simulated body of a tracked physics body.
+	 * @param Primitive - tracked physics body affected by gravity
+	 */
+	void AddPhysicsRateGravity(class UPrimitiveComponent* Primitive);
+
+	/**
+	 * Applies custom gravity to a body during a physics (sub)step.
+	 * @note Called by the physics simulation, possibly outside the game thread
+	 * @param DeltaTime - duration of the physics (sub)step
+	 * @param BodyInstance - body affected by gravity
+	 */
+	void ApplyPhysicsRateGravity(float DeltaTime, FBodyInstance* BodyInstance);
+
 public:
 	/**
 	 * Called when an Actor enters this volume.
@@ -89,11 +188,32 @@ public:
 	UFUNCTION(BlueprintPure,Category="NinjaPhysicsVolume")
 	virtual float GetGravityMagnitude(const FVector& Point) const;
 
+	/**
+	 * Obtains the gravity vectors that influence a batch of points in space.
+	 * @note Fixed, Point, Line, Segment, Plane and Box modes are evaluated four points at a time with SIMD
+	 * @note Other modes (and debug drawing) fall back to GetGravity for every point
+	 * @param Points - given points in space affected by gravity
+	 * @param OutGravities - receives current gravity of every point, must be as long as Points
+	 */
+	virtual void GetGravityBatch(TArrayView<const FVector> Points, TArrayView<FVector> OutGravities) const;
+
+	/**
+	 * Obtains the mode that determines direction of gravity.
+	 * @return current gravity mode
+	 */
+	FORCEINLINE ENinjaGravityDirectionMode GetGravityDirectionMode() const
+	{
+		return GravityDirectionMode;
+	}
+
 protected:
 	/** Mode that determines direction of gravity. */
 	UPROPERTY(VisibleInstanceOnly,BlueprintReadOnly,Category="NinjaPhysicsVolume")
 	ENinjaGravityDirectionMode GravityDirectionMode;
 
+	/** Evaluator bound to GravityDirectionMode, nullptr if the mode has none. */
+	FNinjaGravityDirectionFunc GravityDirectionFunc;
+
 	/** Stores information that determines direction of gravity. */
 	UPROPERTY(VisibleInstanceOnly,BlueprintReadOnly,Category="NinjaPhysicsVolume")
 	FVector GravityVectorA;
@@ -106,6 +226,135 @@ protected:
 	UPROPERTY(VisibleInstanceOnly,BlueprintReadOnly,Category="NinjaPhysicsVolume")
 	AActor* GravityActor;
 
+	/** Streaming friendly reference to GravityActor, with its cached gravity data. */
+	FNinjaGravityActorProxy GravityActorProxy;
+
+	/** Cached spline of GravityActor (or this volume) used by spline gravity modes. */
+	UPROPERTY(Transient)
+	class USplineComponent* GravitySpline;
+
+	/** Optional baked gravity field that determines direction of gravity. */
+	UPROPERTY(VisibleInstanceOnly,BlueprintReadOnly,Category="NinjaPhysicsVolume")
+	class UNinjaGravityField* GravityField;
+
+	/** Acceleration structure for closest input key queries of GravitySpline. */
+	FNinjaSplineSegmentTree GravitySplineTree;
+
+protected:
+	/**
+	 * Changes the mode that determines direction of gravity and binds its evaluator.
+	 * @param NewGravityDirectionMode - new mode
+	 */
+	void SetGravityDirectionMode(ENinjaGravityDirectionMode NewGravityDirectionMode);
+
+	/**
+	 * Obtains the vectors that determine direction of gravity; Actor driven
+	 * modes take them from GravityActor, or its cached data if it's streamed out.
+	 * @param OutVectorA - receives information that determines direction of gravity
+	 * @param OutVectorB - receives additional information that determines direction of gravity
+	 */
+	void ResolveGravityVectors(FVector& OutVectorA, FVector& OutVectorB) const;
+
+	/**
+	 * Binds GravityActor again if its level streamed back in and refreshes its
+	 * cached gravity data; game thread only.
+	 */
+	void RefreshGravityActorProxy();
+
+	/**
+	 * Resolves the spline used by spline gravity modes; it belongs to
+	 * GravityActor or to this volume.
+	 */
+	void UpdateGravitySpline();
+
+	/**
+	 * Obtains the spline used by spline gravity modes.
+	 * @note Resolves the spline again if the cached one is outdated
+	 * @return spline used by spline gravity modes, can be nullptr
+	 */
+	const class USplineComponent* GetGravitySpline() const;
+
+	/**
+	 * Finds the input key of the gravity spline closest to a given point.
+	 * @note The acceleration structure is rebuilt if the spline changed
+	 * @param Spline - gravity spline
+	 * @param Point - given point in space
+	 * @return closest input key of the spline
+	 */
+	float FindGravitySplineInputKey(const class USplineComponent* Spline, const FVector& Point) const;
+
+public:
+	/**
+	 * If true, a gravity snapshot that can be read from any thread is published every frame.
+	 * @see FNinjaGravitySnapshot::Read
+	 */
+	UPROPERTY(EditAnywhere,BlueprintReadOnly,Category="NinjaPhysicsVolume")
+	uint32 bPublishGravitySnapshot:1;
+
+	/**
+	 * Obtains the buffer of published gravity snapshots.
+	 * @return buffer of gravity snapshots
+	 */
+	FORCEINLINE const FNinjaGravitySnapshotBuffer& GetGravitySnapshotBuffer() const
+	{
+		return GravitySnapshotBuffer;
+	}
+
+protected:
+	/** Buffer of published gravity snapshots. */
+	FNinjaGravitySnapshotBuffer GravitySnapshotBuffer;
+
+	/**
+	 * Copies current gravity settings to a new gravity snapshot and publishes it.
+	 */
+	virtual void PublishGravitySnapshot();
+
+public:
+	/**
+	 * If true, gravity settings of this volume are replicated once per change
+	 * and clients apply them to the Ninjas they track; Ninjas that follow
+	 * these settings don't replicate their own, only diverging ones do.
+	 * @note The volume replicates and stays dormant until gravity changes
+	 */
+	UPROPERTY(EditAnywhere,BlueprintReadOnly,Category="NinjaPhysicsVolume")
+	uint32 bReplicateGravity:1;
+
+	/**
+	 * Returns the properties used for network replication.
+	 * @param OutLifetimeProps - receives the replicated properties
+	 */
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	/**
+	 * Gathers current gravity settings into a replicable gravity state.
+	 * @return current gravity state
+	 */
+	FNinjaGravityState MakeGravityState() const;
+
+protected:
+	/** Gravity settings replicated from server to clients. */
+	UPROPERTY(ReplicatedUsing=OnRep_GravityState)
+	FNinjaGravityState GravityState;
+
+	/**
+	 * Called on clients after GravityState has been replicated.
+	 */
+	UFUNCTION()
+	virtual void OnRep_GravityState();
+
+	/**
+	 * Replaces current gravity settings with a replicated gravity state; it
+	 * is applied to tracked Ninjas too.
+	 * @param NewGravityState - gravity state received from server
+	 */
+	virtual void ApplyGravityState(const FNinjaGravityState& NewGravityState);
+
+	/**
+	 * Updates GravityState with current gravity settings and sends it to
+	 * clients, if this volume replicates gravity.
+	 */
+	void ReplicateGravityToClients();
+
 public:
 	/**
 	 * Sets a new fixed gravity direction.
@@ -232,6 +481,70 @@ public:
 	UFUNCTION(BlueprintCallable,Category="NinjaPhysicsVolume")
 	virtual void SetCollisionGravityDirection(AActor* NewGravityActor);
 
+public:
+	/**
+	 * Sets a new baked gravity field which gravity direction is sampled from.
+	 * @note It can be influenced by GravityScale
+	 * @param NewGravityField - baked gravity field that provides gravity
+	 */
+	UFUNCTION(BlueprintCallable,Category="NinjaPhysicsVolume")
+	virtual void SetBakedGravityDirection(class UNinjaGravityField* NewGravityField);
+
+public:
+	/**
+	 * Sets gravity direction to be blended from gravity source components.
+	 * @note It can be influenced by GravityScale
+	 * @see UNinjaGravitySourceComponent
+	 */
+	UFUNCTION(BlueprintCallable,Category="NinjaPhysicsVolume")
+	virtual void SetFieldGravityDirection();
+
+	/**
+	 * If true, gravity source components are blended as gravity when the game
+	 * starts; it takes precedence over BakedGravityField.
+	 */
+	UPROPERTY(EditAnywhere,BlueprintReadOnly,Category="NinjaPhysicsVolume")
+	uint32 bUseGravitySources:1;
+
+public:
+	/**
+	 * Baked gravity field filled by the editor bake step; if valid, it is used
+	 * as gravity when the game starts.
+	 */
+	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="NinjaPhysicsVolume|GravityField")
+	class UNinjaGravityField* BakedGravityField;
+
+	/**
+	 * Optional Actor whose collision geometry is sampled by the editor bake
+	 * step; current gravity settings are sampled if none is provided.
+	 */
+	UPROPERTY(EditInstanceOnly,BlueprintReadWrite,Category="NinjaPhysicsVolume|GravityField")
+	AActor* BakedGravityFieldActor;
+
+	/** Desired distance between samples of the baked gravity field. */
+	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="NinjaPhysicsVolume|GravityField",Meta=(ClampMin="1",UIMin="1"))
+	float BakedGravityFieldCellSize;
+
+	/**
+	 * Samples current gravity over the bounds of this volume and stores it in
+	 * a given baked gravity field.
+	 * @note Sampling ignores GravityScale, it is applied when the baked gravity field is used
+	 * @param TargetGravityField - baked gravity field that receives the samples
+	 * @param CellSize - desired distance between samples
+	 * @return true if the baked gravity field was filled
+	 */
+	UFUNCTION(BlueprintCallable,Category="NinjaPhysicsVolume")
+	virtual bool BakeGravityField(class UNinjaGravityField* TargetGravityField, float CellSize);
+
+#if WITH_EDITOR
+	/**
+	 * Fills BakedGravityField sampling the collision geometry of
+	 * BakedGravityFieldActor (or current gravity settings).
+	 */
+	UFUNCTION(CallInEditor,Category="NinjaPhysicsVolume|GravityField")
+	void BakeGravityFieldInEditor();
+#endif // WITH_EDITOR
+
 protected:
 	/** Gravity vector is multiplied by this amount. */
 	UPROPERTY(EditAnywhere,BlueprintReadWrite,BlueprintSetter=SetGravityScale,Category="NinjaPhysicsVolume")
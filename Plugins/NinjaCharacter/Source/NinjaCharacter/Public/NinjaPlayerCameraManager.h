@@ -8,6 +8,8 @@
 #include "NinjaPlayerCameraManager.generated.h"
 
 
+class ANinjaCharacter;
+
 /**
  * Object that defines the master camera that the player actually uses to look
  * through. This type is able to handle arbitrary collision capsule orientation.
@@ -17,6 +19,9 @@ class NINJACHARACTER_API ANinjaPlayerCameraManager : public APlayerCameraManager
 {
 	GENERATED_BODY()
 
+public:
+	ANinjaPlayerCameraManager(const FObjectInitializer& ObjectInitializer);
+
 public:
 	/**
 	 * Called to adjust view rotation updates before they are applied.
@@ -26,4 +31,64 @@ public:
 	 * @param OutDeltaRot - how much the rotation changed this frame
 	 */
 	virtual void ProcessViewRotation(float DeltaTime, FRotator& OutViewRotation, FRotator& OutDeltaRot) override;
+
+public:
+	/**
+	 * If true, the view of a Ninja character keeps a cached basis relative to the
+	 * 'up' axis of the capsule and follows capsule axis changes with a spring;
+	 * bCapsuleRotatesControlRotation of the character is then ignored.
+	 */
+	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="NinjaCamera")
+	uint32 bGravityAwareView:1;
+
+	/** Stiffness of the critically damped spring that follows capsule axis changes; zero snaps instantly. */
+	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="NinjaCamera",Meta=(ClampMin="0",UIMin="0",EditCondition="bGravityAwareView"))
+	float ViewAxisSpringStiffness;
+
+public:
+	/**
+	 * Checks if the gravity-aware view handles capsule axis changes of a character.
+	 * @param Character - the character to check
+	 * @return true if the gravity-aware view rotates the view of the character
+	 */
+	bool IsGravityAwareViewOf(const ANinjaCharacter* Character) const;
+
+	/**
+	 * Checks if the view orientation is bound to the head of the player, i.e. with HMD devices.
+	 * @return true if head tracking is allowed
+	 */
+	bool IsHeadTrackingAllowed() const;
+
+protected:
+	/**
+	 * Adjusts view rotation updates of a Ninja character with the cached view basis.
+	 * @param Ninja - the view target character
+	 * @param DeltaTime - frame time in seconds
+	 * @param OutViewRotation - the view rotation to modify
+	 * @param OutDeltaRot - how much the rotation changed this frame
+	 */
+	void ProcessGravityAwareViewRotation(const ANinjaCharacter* Ninja, float DeltaTime, FRotator& OutViewRotation, FRotator& OutDeltaRot);
+
+	/**
+	 * Advances the spring that rotates the cached view basis towards the 'up' axis of the capsule.
+	 * @param TargetAxisZ - current 'up' axis of the capsule
+	 * @param DeltaTime - frame time in seconds
+	 */
+	void UpdateViewAxisSpring(const FVector& TargetAxisZ, float DeltaTime);
+
+protected:
+	/** Character whose view is described by the cached view basis. */
+	TWeakObjectPtr<const ANinjaCharacter> ViewBasisCharacter;
+
+	/** Cached orthonormal view basis, more precise than the view rotation. */
+	FQuat ViewBasis;
+
+	/** View rotation produced from the cached view basis; any other view rotation rebuilds the basis. */
+	FRotator ViewBasisRotation;
+
+	/** Cached 'up' axis of the view, follows the 'up' axis of the capsule. */
+	FVector ViewBasisAxisZ;
+
+	/** Angular speed of the spring that follows capsule axis changes, in radians per second. */
+	float ViewAxisSpringSpeed;
 };
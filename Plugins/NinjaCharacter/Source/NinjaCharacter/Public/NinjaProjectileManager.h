@@ -0,0 +1,289 @@
+// "Ninja Character" plugin, by Javier 'Xaklse' Osset; Copyright 2020
+
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineBaseTypes.h"
+#include "Engine/EngineTypes.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "WorldCollision.h"
+#include "NinjaProjectileManager.generated.h"
+
+
+class UNinjaProjectileManager;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FNinjaProjectileImpactSignature, int32, ProjectileId, const FHitResult&, Hit, AActor*, ImpactActor);
+
+/**
+ * Settings of a pooled projectile fired by a UNinjaProjectileManager.
+ */
+USTRUCT(BlueprintType)
+struct NINJACHARACTER_API FNinjaPooledProjectileParams
+{
+	GENERATED_BODY()
+
+public:
+	FNinjaPooledProjectileParams();
+
+	/** Radius of the sphere swept by the projectile; zero traces a line. */
+	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="NinjaProjectile",Meta=(ClampMin="0",UIMin="0"))
+	float Radius;
+
+	/** Gravity vector of the projectile is multiplied by this amount. */
+	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="NinjaProjectile")
+	float GravityScale;
+
+	/** Time in seconds before the projectile is discarded without impact. */
+	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="NinjaProjectile",Meta=(ClampMin="0",UIMin="0"))
+	float LifeSpan;
+
+	/** Collision channel used by sweeps of the projectile. */
+	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="NinjaProjectile")
+	TEnumAsByte<ECollisionChannel> TraceChannel;
+
+	/**
+	 * Optional Actor spawned on impact, placed at the impact location with the
+	 * velocity of the projectile; a projectile movement component of the
+	 * Actor continues the simulation and handles the hit itself.
+	 */
+	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="NinjaProjectile")
+	TSubclassOf<AActor> ImpactActorClass;
+
+	/** Optional Actor ignored by sweeps, also owner and instigator of the spawned Actor. */
+	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="NinjaProjectile")
+	AActor* Owner;
+};
+
+/**
+ * Tick function that simulates every projectile of a UNinjaProjectileManager.
+ */
+USTRUCT()
+struct FNinjaProjectileTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+public:
+	FNinjaProjectileTickFunction();
+
+	/** Projectile manager that owns this tick function. */
+	UNinjaProjectileManager* Manager;
+
+	/**
+	 * Abstract function to actually execute the tick.
+	 * @param DeltaTime - frame time to advance, in seconds
+	 * @param TickType - kind of tick for this frame
+	 * @param CurrentThread - thread we are executing on, useful to pass along as new tasks are created
+	 * @param MyCompletionGraphEvent - completion event for this task
+	 */
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread,
+		const FGraphEventRef& MyCompletionGraphEvent) override;
+
+	/** Abstract function to describe this tick. Used to print messages about illegal cycles in the dependency graph. */
+	virtual FString DiagnosticMessage() override;
+
+	/** Function used to describe this tick for active tick reporting. */
+	virtual FName DiagnosticContext(bool bDetailed) override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FNinjaProjectileTickFunction> : public TStructOpsTypeTraitsBase2<FNinjaProjectileTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
+/**
+ * Impact of a pooled projectile that was already removed, waiting to be dispatched.
+ */
+struct FNinjaPendingProjectileImpact
+{
+	/** Identifier of the removed projectile. */
+	int32 ProjectileId;
+
+	/** Impact information. */
+	FHitResult Hit;
+
+	/** Velocity of the projectile at the moment of impact. */
+	FVector Velocity;
+
+	/** Optional Actor class spawned on impact. */
+	TSubclassOf<AActor> ImpactActorClass;
+
+	/** Owner of the projectile. */
+	TWeakObjectPtr<AActor> Owner;
+};
+
+/**
+ * Simulates lightweight projectiles without Actors. Projectiles are stored as
+ * parallel arrays, gravity is evaluated in batches per physics volume and
+ * collision is tested with asynchronous sweeps; an Actor is only spawned on
+ * impact.
+ * @note Sweep results arrive one frame later, impacts are detected with one frame of delay
+ */
+UCLASS()
+class NINJACHARACTER_API UNinjaProjectileManager : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UNinjaProjectileManager();
+
+	/** Implement this for deinitialization of instances of the system. */
+	virtual void Deinitialize() override;
+
+	/**
+	 * Fires a new pooled projectile.
+	 * @param Location - initial location of the projectile
+	 * @param Velocity - initial velocity of the projectile
+	 * @param Params - settings of the projectile
+	 * @return identifier of the projectile, INDEX_NONE if it couldn't be fired
+	 */
+	UFUNCTION(BlueprintCallable,Category="NinjaProjectile")
+	int32 FireProjectile(const FVector& Location, const FVector& Velocity, const FNinjaPooledProjectileParams& Params);
+
+	/**
+	 * Discards a pooled projectile without impact.
+	 * @param ProjectileId - identifier of the projectile
+	 */
+	UFUNCTION(BlueprintCallable,Category="NinjaProjectile")
+	void DiscardProjectile(int32 ProjectileId);
+
+	/**
+	 * Advances simulation of every pooled projectile.
+	 * @param DeltaTime - frame time to advance, in seconds
+	 */
+	void TickProjectiles(float DeltaTime);
+
+	/**
+	 * Obtains the amount of pooled projectiles in flight.
+	 * @return amount of pooled projectiles
+	 */
+	FORCEINLINE int32 GetNumProjectiles() const
+	{
+		return Ids.Num();
+	}
+
+	/**
+	 * Obtains current locations of pooled projectiles, e.g. to render them.
+	 * @note Order changes when projectiles are removed
+	 * @return current locations of pooled projectiles
+	 */
+	FORCEINLINE TArrayView<const FVector> GetLocations() const
+	{
+		return Locations;
+	}
+
+	/**
+	 * Obtains current velocities of pooled projectiles.
+	 * @note Same order as GetLocations()
+	 * @return current velocities of pooled projectiles
+	 */
+	FORCEINLINE TArrayView<const FVector> GetVelocities() const
+	{
+		return Velocities;
+	}
+
+public:
+	/** Called when a pooled projectile impacts something. */
+	UPROPERTY(BlueprintAssignable,Category="NinjaProjectile")
+	FNinjaProjectileImpactSignature OnProjectileImpact;
+
+protected:
+	/**
+	 * Applies results of sweeps requested on previous frame.
+	 */
+	void ProcessSweepResults();
+
+	/**
+	 * Integrates velocities and locations of every pooled projectile.
+	 * @param DeltaTime - time to advance, in seconds
+	 */
+	void IntegrateProjectiles(float DeltaTime);
+
+	/**
+	 * Requests sweeps along the last movement of every pooled projectile.
+	 */
+	void RequestSweeps();
+
+	/**
+	 * Handles an impact of a pooled projectile; the projectile is removed and
+	 * the impact is queued for DispatchImpacts().
+	 * @param Index - index of the projectile
+	 * @param Hit - impact information
+	 */
+	void HandleImpact(int32 Index, const FHitResult& Hit);
+
+	/**
+	 * Spawns impact Actors and broadcasts OnProjectileImpact for queued impacts.
+	 * @note Called once projectile arrays aren't iterated anymore, so callbacks can fire or discard projectiles
+	 */
+	void DispatchImpacts();
+
+	/**
+	 * Removes a pooled projectile, swapping the last one into its place.
+	 * @param Index - index of the projectile
+	 */
+	void RemoveProjectile(int32 Index);
+
+protected:
+	/** Identifiers of pooled projectiles. */
+	TArray<int32> Ids;
+
+	/** Index of every pooled projectile by identifier. */
+	TMap<int32, int32> IdIndices;
+
+	/** Current locations of pooled projectiles. */
+	TArray<FVector> Locations;
+
+	/** Locations of pooled projectiles before last integration. */
+	TArray<FVector> PreviousLocations;
+
+	/** Current velocities of pooled projectiles. */
+	TArray<FVector> Velocities;
+
+	/** Remaining life spans of pooled projectiles. */
+	TArray<float> LifeSpans;
+
+	/** Sweep radii of pooled projectiles. */
+	TArray<float> Radii;
+
+	/** Gravity scales of pooled projectiles. */
+	TArray<float> GravityScales;
+
+	/** Collision channels of pooled projectiles. */
+	TArray<TEnumAsByte<ECollisionChannel>> TraceChannels;
+
+	/** Actors spawned on impact of pooled projectiles. */
+	UPROPERTY(Transient)
+	TArray<TSubclassOf<AActor>> ImpactActorClasses;
+
+	/** Owners of pooled projectiles. */
+	TArray<TWeakObjectPtr<AActor>> Owners;
+
+	/** Sweeps requested on previous frame for pooled projectiles. */
+	TArray<FTraceHandle> SweepHandles;
+
+	/** Scratch buffer with the physics volume of every projectile. */
+	TArray<const class ANinjaPhysicsVolume*> BatchVolumes;
+
+	/** Scratch buffer with projectile indices sorted by physics volume. */
+	TArray<int32> BatchOrder;
+
+	/** Scratch buffer with locations of projectiles sorted by physics volume. */
+	TArray<FVector> BatchPoints;
+
+	/** Scratch buffer that receives gravity of projectiles sorted by physics volume. */
+	TArray<FVector> BatchGravities;
+
+	/** Scratch buffer with impacts detected this frame. */
+	TArray<FNinjaPendingProjectileImpact> PendingImpacts;
+
+	/** Tick function that simulates pooled projectiles. */
+	FNinjaProjectileTickFunction TickFunction;
+
+	/** Identifier given to the next fired projectile. */
+	int32 NextProjectileId;
+};
@@ -20,6 +20,13 @@ class NINJACHARACTER_API UNinjaProjectileMovementComponent : public UProjectileM
 public:
 	UNinjaProjectileMovementComponent(const FObjectInitializer& ObjectInitializer);
 
+public:
+	/**
+	 * Called when a component is registered, after Scene is set, but before
+	 * CreateRenderState_Concurrent or OnCreatePhysicsState are called.
+	 */
+	virtual void OnRegister() override;
+
 public:
 	/**
 	 * Determine whether or not to use substepping in the projectile motion update.
@@ -34,10 +41,26 @@ public:
 	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="NinjaProjectileMovement")
 	uint32 bFollowGravityDirection:1;
 
+	/**
+	 * If true, the physics volume that affects this projectile is found through
+	 * the gravity registry instead of overlap events; overlap events can then be
+	 * disabled in the updated component.
+	 * @see UNinjaGravityRegistrySubsystem
+	 */
+	UPROPERTY(EditDefaultsOnly,BlueprintReadOnly,Category="NinjaProjectileMovement")
+	uint32 bUseGravityRegistry:1;
+
 protected:
 	/** Stores last calculated gravity direction if needed. */
 	FVector OldGravityDirection;
 
+protected:
+	/**
+	 * Obtains the Ninja physics volume that affects this projectile.
+	 * @return Ninja physics volume, nullptr if none
+	 */
+	const class ANinjaPhysicsVolume* GetNinjaPhysicsVolume() const;
+
 public:
 	/**
 	 * Given an initial velocity and a time step, compute a new velocity.
@@ -0,0 +1,88 @@
+// "Ninja Character" plugin, by Javier 'Xaklse' Osset; Copyright 2020
+
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/WeakObjectPtrTemplates.h"
+
+
+class USplineComponent;
+
+
+/**
+ * Bounding volume hierarchy of the segments of a spline, built in local space
+ * of the spline. Answers closest input key queries without visiting every
+ * segment of long splines.
+ */
+struct NINJACHARACTER_API FNinjaSplineSegmentTree
+{
+public:
+	FNinjaSplineSegmentTree();
+
+	/**
+	 * Asks if the tree was built for a given spline and its current state.
+	 * @param Spline - spline to check
+	 * @return true if the tree is up to date with the spline
+	 */
+	bool IsBuiltFor(const USplineComponent* Spline) const;
+
+	/**
+	 * Builds the tree from the segments of a given spline.
+	 * @param Spline - spline that provides the segments
+	 */
+	void Build(const USplineComponent* Spline);
+
+	/**
+	 * Discards all data of the tree.
+	 */
+	void Reset();
+
+	/**
+	 * Finds the input key of a spline closest to a location in world space.
+	 * @note Falls back to USplineComponent::FindInputKeyClosestToWorldLocation if the tree isn't up to date
+	 * @param Spline - spline to query
+	 * @param WorldLocation - location in world space
+	 * @return input key of the spline closest to the location
+	 */
+	float FindInputKeyClosestToWorldLocation(const USplineComponent* Spline, const FVector& WorldLocation) const;
+
+private:
+	/** Node of the bounding volume hierarchy. */
+	struct FNode
+	{
+		/** Local space bounds of all segments below this node. */
+		FBox Bounds;
+
+		/** Index of first child node (second one is next), or first entry of Segments if this is a leaf. */
+		int32 FirstIndex;
+
+		/** Number of segments if this is a leaf, zero otherwise. */
+		int32 NumSegments;
+	};
+
+	/**
+	 * Recursively builds a node of the tree.
+	 * @param NodeIndex - index of the node to build
+	 * @param Start - first entry of Segments covered by the node
+	 * @param Count - number of entries of Segments covered by the node
+	 * @param SegmentBounds - local space bounds of every segment
+	 */
+	void BuildNode(int32 NodeIndex, int32 Start, int32 Count, const TArray<FBox>& SegmentBounds);
+
+private:
+	/** Nodes of the hierarchy; first one is the root. */
+	TArray<FNode> Nodes;
+
+	/** Indices of spline segments, sorted so leaves reference contiguous ranges. */
+	TArray<int32> Segments;
+
+	/** Spline used to build the tree. */
+	TWeakObjectPtr<const USplineComponent> SplineComponent;
+
+	/** Version of the spline curves used to build the tree. */
+	uint32 SplineVersion;
+
+	/** Number of spline points used to build the tree. */
+	int32 NumSplinePoints;
+};
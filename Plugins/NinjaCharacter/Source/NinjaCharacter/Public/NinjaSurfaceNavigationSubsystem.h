@@ -0,0 +1,371 @@
+// "Ninja Character" plugin, by Javier 'Xaklse' Osset; Copyright 2020
+
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineBaseTypes.h"
+#include "Engine/EngineTypes.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "NinjaSurfaceNavigationSubsystem.generated.h"
+
+
+class AAIController;
+class ANinjaPhysicsVolume;
+class UNinjaCharacterMovementComponent;
+class UNinjaSurfaceNavigationSubsystem;
+
+/** Called on the game thread when an asynchronous surface path query finishes. */
+DECLARE_DELEGATE_TwoParams(FNinjaSurfacePathDelegate, bool /*bSuccess*/, const TArray<FVector>& /*PathPoints*/);
+
+/**
+ * Walkable surface sampled in a cell of a surface graph.
+ */
+struct FNinjaSurfaceNode
+{
+	/** Location of the surface. */
+	FVector Location;
+
+	/** Normalized 'up' direction of local gravity at the surface. */
+	FVector Up;
+
+	/** Bit N is set if the node is connected to the node of neighbor cell N. */
+	uint32 NeighborMask;
+};
+
+/**
+ * Nodes of the cells of a tile of a surface graph. Published tiles are
+ * immutable and shared by every graph that didn't rebuild them.
+ */
+struct FNinjaSurfaceTile
+{
+	/** Nodes of walkable cells, by cell index. */
+	TMap<int32, FNinjaSurfaceNode> Nodes;
+};
+
+typedef TSharedPtr<const FNinjaSurfaceTile, ESPMode::ThreadSafe> FNinjaSurfaceTilePtr;
+
+/**
+ * Graph of walkable surfaces over a uniform grid of cells, split in tiles;
+ * every cell holds one node at most. Published graphs are immutable and
+ * shared with worker threads that run path queries.
+ */
+struct NINJACHARACTER_API FNinjaSurfaceGraph
+{
+	/** Amount of neighbors of a cell, including diagonals. */
+	static constexpr int32 NumNeighbors = 26;
+
+	/** Amount of cells per axis of a tile. */
+	static constexpr int32 TileCells = 8;
+
+	/** Offsets of every neighbor cell. */
+	static const FIntVector NeighborOffsets[NumNeighbors];
+
+	/** Minimum corner of the grid. */
+	FVector Origin;
+
+	/** Size of a cell. */
+	float CellSize;
+
+	/** Amount of cells per axis. */
+	FIntVector Dimensions;
+
+	/** Amount of tiles per axis. */
+	FIntVector NumTiles;
+
+	/** Table of tiles, by tile index; nullptr if a tile wasn't built yet. */
+	TArray<FNinjaSurfaceTilePtr> Tiles;
+
+	/**
+	 * Obtains the coordinates of a cell.
+	 * @param CellIndex - index of the cell
+	 * @return coordinates of the cell
+	 */
+	FORCEINLINE FIntVector GetCellCoords(int32 CellIndex) const
+	{
+		return FIntVector(CellIndex % Dimensions.X, (CellIndex / Dimensions.X) % Dimensions.Y,
+			CellIndex / (Dimensions.X * Dimensions.Y));
+	}
+
+	/**
+	 * Obtains the index of a cell.
+	 * @param Coords - coordinates of the cell
+	 * @return index of the cell, INDEX_NONE if outside of the grid
+	 */
+	FORCEINLINE int32 GetCellIndex(const FIntVector& Coords) const
+	{
+		return (Coords.X < 0 || Coords.Y < 0 || Coords.Z < 0 || Coords.X >= Dimensions.X ||
+			Coords.Y >= Dimensions.Y || Coords.Z >= Dimensions.Z) ? INDEX_NONE :
+			Coords.X + (Coords.Y + Coords.Z * Dimensions.Y) * Dimensions.X;
+	}
+
+	/**
+	 * Obtains the index of the tile that contains a cell.
+	 * @param Coords - coordinates of the cell, inside of the grid
+	 * @return index of the tile
+	 */
+	FORCEINLINE int32 GetTileIndex(const FIntVector& Coords) const
+	{
+		return Coords.X / TileCells + (Coords.Y / TileCells + (Coords.Z / TileCells) * NumTiles.Y) * NumTiles.X;
+	}
+
+	/**
+	 * Finds the node of a cell.
+	 * @param CellIndex - index of the cell
+	 * @return node of the cell, nullptr if the cell isn't walkable
+	 */
+	FORCEINLINE const FNinjaSurfaceNode* FindNode(int32 CellIndex) const
+	{
+		if (CellIndex == INDEX_NONE)
+		{
+			return nullptr;
+		}
+
+		const FNinjaSurfaceTilePtr& Tile = Tiles[GetTileIndex(GetCellCoords(CellIndex))];
+		return Tile.IsValid() ? Tile->Nodes.Find(CellIndex) : nullptr;
+	}
+
+	/**
+	 * Obtains the coordinates of the cell that contains a point.
+	 * @param Point - point in world space
+	 * @return coordinates of the cell, could be outside of the grid
+	 */
+	FORCEINLINE FIntVector GetCellCoordsAt(const FVector& Point) const
+	{
+		const FVector LocalPoint = (Point - Origin) / CellSize;
+		return FIntVector(FMath::FloorToInt(LocalPoint.X), FMath::FloorToInt(LocalPoint.Y),
+			FMath::FloorToInt(LocalPoint.Z));
+	}
+
+	/**
+	 * Finds the node closest to a point, searching cells around it.
+	 * @param Point - point in world space
+	 * @param SearchCells - amount of cells searched in every direction
+	 * @return index of the cell of the closest node, INDEX_NONE if none
+	 */
+	int32 FindNearestNode(const FVector& Point, int32 SearchCells) const;
+
+	/**
+	 * Finds the shortest path between two nodes with A*.
+	 * @param StartCell - index of the cell of the start node
+	 * @param GoalCell - index of the cell of the goal node
+	 * @param MaxSearchNodes - maximum amount of nodes visited before giving up
+	 * @param OutPathPoints - receives locations of nodes of the path, from start to goal
+	 * @return true if a path was found
+	 */
+	bool FindPath(int32 StartCell, int32 GoalCell, int32 MaxSearchNodes, TArray<FVector>& OutPathPoints) const;
+};
+
+/**
+ * Tick function that rebuilds dirty areas of surface graphs of a
+ * UNinjaSurfaceNavigationSubsystem.
+ */
+USTRUCT()
+struct FNinjaSurfaceNavigationTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+public:
+	FNinjaSurfaceNavigationTickFunction();
+
+	/** Surface navigation subsystem that owns this tick function. */
+	UNinjaSurfaceNavigationSubsystem* Subsystem;
+
+	/**
+	 * Abstract function to actually execute the tick.
+	 * @param DeltaTime - frame time to advance, in seconds
+	 * @param TickType - kind of tick for this frame
+	 * @param CurrentThread - thread we are executing on, useful to pass along as new tasks are created
+	 * @param MyCompletionGraphEvent - completion event for this task
+	 */
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread,
+		const FGraphEventRef& MyCompletionGraphEvent) override;
+
+	/** Abstract function to describe this tick. Used to print messages about illegal cycles in the dependency graph. */
+	virtual FString DiagnosticMessage() override;
+
+	/** Function used to describe this tick for active tick reporting. */
+	virtual FName DiagnosticContext(bool bDetailed) override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FNinjaSurfaceNavigationTickFunction> : public TStructOpsTypeTraitsBase2<FNinjaSurfaceNavigationTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
+/**
+ * Builds and caches walkable surface graphs inside Ninja physics volumes for
+ * characters that walk on walls and planets, where the Z-up navigation mesh
+ * doesn't work. Surfaces are sampled along local gravity and classified with
+ * IsWalkableEx of an agent movement component; graphs are rebuilt tile by
+ * tile over several frames and paths are found on worker threads.
+ */
+UCLASS()
+class NINJACHARACTER_API UNinjaSurfaceNavigationSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UNinjaSurfaceNavigationSubsystem();
+
+	/** Implement this for deinitialization of instances of the system. */
+	virtual void Deinitialize() override;
+
+	/**
+	 * Starts building the surface graph of a physics volume; a previous graph
+	 * of the volume is replaced. The graph is built over several frames.
+	 * @param Volume - physics volume that bounds the graph
+	 * @param AgentMovement - movement component that classifies walkable surfaces and provides agent size
+	 * @param CellSize - size of a cell of the graph
+	 */
+	void BuildSurfaceGraph(ANinjaPhysicsVolume* Volume, const UNinjaCharacterMovementComponent* AgentMovement,
+		float CellSize = 100.0f);
+
+	/**
+	 * Discards the surface graph of a physics volume.
+	 * @param Volume - physics volume that bounds the graph
+	 */
+	void RemoveSurfaceGraph(const ANinjaPhysicsVolume* Volume);
+
+	/**
+	 * Marks an area as changed; tiles of surface graphs that overlap it are
+	 * rebuilt over the next frames.
+	 * @param Area - changed area in world space
+	 */
+	void InvalidateArea(const FBox& Area);
+
+	/**
+	 * Checks if the surface graph of a physics volume is completely built.
+	 * @param Volume - physics volume that bounds the graph
+	 * @return true if the graph exists and has no pending tiles
+	 */
+	bool IsSurfaceGraphReady(const ANinjaPhysicsVolume* Volume) const;
+
+	/**
+	 * Finds a path over walkable surfaces on a worker thread. The graph of the
+	 * physics volume that contains the start location is used.
+	 * @param Start - start location of the path
+	 * @param Goal - goal location of the path
+	 * @param OnPathFound - called on the game thread with the result
+	 * @return true if the query was started, false if there's no graph for the start location
+	 */
+	bool FindPathAsync(const FVector& Start, const FVector& Goal, FNinjaSurfacePathDelegate OnPathFound);
+
+	/**
+	 * Finds a path over walkable surfaces and hands it to the path following
+	 * component of an AI controller, which then feeds RequestDirectMove of
+	 * its Ninja movement component.
+	 * @param Controller - AI controller that moves
+	 * @param Goal - goal location of the move
+	 * @param AcceptanceRadius - distance to the goal that counts as reached
+	 * @return true if the path query was started
+	 */
+	bool RequestSurfaceMove(AAIController* Controller, const FVector& Goal, float AcceptanceRadius = 50.0f);
+
+	/**
+	 * Rebuilds a limited amount of dirty tiles of surface graphs.
+	 * @param DeltaTime - frame time to advance, in seconds
+	 */
+	void TickSurfaceNavigation(float DeltaTime);
+
+protected:
+	/** Surface graph of a physics volume and its build state. */
+	struct FNinjaSurfaceGraphEntry
+	{
+		/** Physics volume that bounds the graph. */
+		TWeakObjectPtr<ANinjaPhysicsVolume> Volume;
+
+		/** Movement component that classifies walkable surfaces. */
+		TWeakObjectPtr<const UNinjaCharacterMovementComponent> AgentMovement;
+
+		/** Radius of the agent capsule. */
+		float AgentRadius;
+
+		/** Half height of the agent capsule. */
+		float AgentHalfHeight;
+
+		/** Maximum height climbed between two nodes, besides walkable slopes. */
+		float MaxStepHeight;
+
+		/** Tangent of the steepest walkable slope. */
+		float WalkableSlopeTangent;
+
+		/** Collision channel of the agent. */
+		TEnumAsByte<ECollisionChannel> TraceChannel;
+
+		/** Tiles waiting to be rebuilt, in order. */
+		TArray<int32> DirtyTiles;
+
+		/** Last published graph; rebuilt tiles are published with a new table of tiles. */
+		TSharedPtr<const FNinjaSurfaceGraph, ESPMode::ThreadSafe> Graph;
+	};
+
+	/**
+	 * Finds the surface graph of the physics volume that contains a point.
+	 * @param Point - point in world space
+	 * @return surface graph entry, nullptr if none
+	 */
+	const FNinjaSurfaceGraphEntry* FindGraphEntry(const FVector& Point) const;
+
+	/**
+	 * Marks tiles of a surface graph that overlap an area as dirty.
+	 * @param Entry - surface graph entry
+	 * @param Area - changed area in world space
+	 */
+	void MarkTilesDirty(FNinjaSurfaceGraphEntry& Entry, const FBox& Area) const;
+
+	/** Tiles written during a rebuild, not shared with any published graph. */
+	typedef TMap<int32, TSharedPtr<FNinjaSurfaceTile, ESPMode::ThreadSafe>> FNinjaWritableTiles;
+
+	/**
+	 * Samples walkable surfaces of every cell of a tile into a new tile.
+	 * @param Entry - surface graph entry
+	 * @param Graph - graph that receives the new tile
+	 * @param TileIndex - index of the tile
+	 * @param WritableTiles - receives the new tile
+	 */
+	void SampleTile(const FNinjaSurfaceGraphEntry& Entry, FNinjaSurfaceGraph& Graph, int32 TileIndex,
+		FNinjaWritableTiles& WritableTiles) const;
+
+	/**
+	 * Connects nodes of every cell of a tile (and a border of one cell) to
+	 * their neighbors; shared tiles are copied before changing them.
+	 * @param Entry - surface graph entry
+	 * @param Graph - graph that receives the connections
+	 * @param TileIndex - index of the tile
+	 * @param WritableTiles - tiles already copied during this rebuild
+	 */
+	void ConnectTile(const FNinjaSurfaceGraphEntry& Entry, FNinjaSurfaceGraph& Graph, int32 TileIndex,
+		FNinjaWritableTiles& WritableTiles) const;
+
+	/**
+	 * Obtains a tile that can be written during a rebuild, copying the shared one if needed.
+	 * @param Graph - graph being rebuilt
+	 * @param TileIndex - index of the tile
+	 * @param WritableTiles - tiles already copied during this rebuild
+	 * @return writable tile
+	 */
+	FNinjaSurfaceTile& GetWritableTile(FNinjaSurfaceGraph& Graph, int32 TileIndex, FNinjaWritableTiles& WritableTiles) const;
+
+	/**
+	 * Obtains the cells that belong to a tile.
+	 * @param Entry - surface graph entry
+	 * @param TileIndex - index of the tile
+	 * @param Border - extra cells added around the tile
+	 * @param OutMin - receives coordinates of the first cell
+	 * @param OutMax - receives coordinates of the last cell
+	 */
+	void GetTileCells(const FNinjaSurfaceGraphEntry& Entry, int32 TileIndex, int32 Border, FIntVector& OutMin,
+		FIntVector& OutMax) const;
+
+protected:
+	/** Surface graphs by physics volume. */
+	TArray<FNinjaSurfaceGraphEntry> Entries;
+
+	/** Tick function that rebuilds dirty tiles. */
+	FNinjaSurfaceNavigationTickFunction TickFunction;
+};
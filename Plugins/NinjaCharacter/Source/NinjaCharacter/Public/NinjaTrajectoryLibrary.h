@@ -0,0 +1,153 @@
+// "Ninja Character" plugin, by Javier 'Xaklse' Osset; Copyright 2020
+
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineTypes.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "NinjaTrajectoryLibrary.generated.h"
+
+
+/**
+ * Settings of a trajectory prediction under Ninja gravity.
+ */
+USTRUCT(BlueprintType)
+struct NINJACHARACTER_API FNinjaTrajectoryParams
+{
+	GENERATED_BODY()
+
+public:
+	FNinjaTrajectoryParams();
+
+	/** Initial location of the trajectory. */
+	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="NinjaTrajectory")
+	FVector StartLocation;
+
+	/** Initial velocity of the trajectory. */
+	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="NinjaTrajectory")
+	FVector LaunchVelocity;
+
+	/** Maximum time in seconds to simulate. */
+	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="NinjaTrajectory",Meta=(ClampMin="0",UIMin="0"))
+	float MaxSimTime;
+
+	/** Gravity vector is multiplied by this amount. */
+	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="NinjaTrajectory")
+	float GravityScale;
+
+	/** Shortest allowed step in seconds, used where gravity changes quickly. */
+	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="NinjaTrajectory",Meta=(ClampMin="0.001",UIMin="0.001"))
+	float MinStepTime;
+
+	/** Longest allowed step in seconds, used under constant gravity unless the step leaves its physics volume. */
+	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="NinjaTrajectory",Meta=(ClampMin="0.001",UIMin="0.001"))
+	float MaxStepTime;
+
+	/**
+	 * Maximum relative change of gravity within a step (0 to 1) before the
+	 * step is halved; only used when gravity isn't constant.
+	 */
+	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="NinjaTrajectory",Meta=(ClampMin="0.001",UIMin="0.001"))
+	float GravityTolerance;
+
+	/**
+	 * Maximum amount of collision sweeps, one per step; zero disables
+	 * collision. When exhausted, the rest of the trajectory ignores collision.
+	 */
+	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="NinjaTrajectory",Meta=(ClampMin="0",UIMin="0"))
+	int32 MaxSweeps;
+
+	/** Radius of the swept sphere; zero traces a line. */
+	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="NinjaTrajectory",Meta=(ClampMin="0",UIMin="0"))
+	float SweepRadius;
+
+	/** Collision channel used by sweeps. */
+	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="NinjaTrajectory")
+	TEnumAsByte<ECollisionChannel> TraceChannel;
+
+	/** Optional Actor ignored by sweeps. */
+	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="NinjaTrajectory")
+	AActor* IgnoredActor;
+};
+
+/**
+ * Outcome of a trajectory prediction under Ninja gravity.
+ */
+USTRUCT(BlueprintType)
+struct NINJACHARACTER_API FNinjaTrajectoryResult
+{
+	GENERATED_BODY()
+
+public:
+	FNinjaTrajectoryResult();
+
+	/** Blocking hit found by sweeps, if any. */
+	UPROPERTY(BlueprintReadOnly,Category="NinjaTrajectory")
+	FHitResult HitResult;
+
+	/** Location at the end of the trajectory. */
+	UPROPERTY(BlueprintReadOnly,Category="NinjaTrajectory")
+	FVector EndLocation;
+
+	/** Velocity at the end of the trajectory. */
+	UPROPERTY(BlueprintReadOnly,Category="NinjaTrajectory")
+	FVector EndVelocity;
+
+	/** Simulated time in seconds. */
+	UPROPERTY(BlueprintReadOnly,Category="NinjaTrajectory")
+	float EndTime;
+
+	/** Amount of points written into the output buffer. */
+	UPROPERTY(BlueprintReadOnly,Category="NinjaTrajectory")
+	int32 NumPoints;
+
+	/** Amount of sweeps done. */
+	UPROPERTY(BlueprintReadOnly,Category="NinjaTrajectory")
+	int32 NumSweeps;
+
+	/** True if sweeps found a blocking hit. */
+	UPROPERTY(BlueprintReadOnly,Category="NinjaTrajectory")
+	uint32 bBlockingHit:1;
+};
+
+/**
+ * Native helpers that predict movement under Ninja gravity without spawning
+ * Actors nor ticking movement components.
+ */
+UCLASS()
+class NINJACHARACTER_API UNinjaTrajectoryLibrary : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * Predicts a ballistic trajectory under Ninja gravity. Physics volumes are
+	 * found through the gravity registry; constant gravity (Fixed mode or no
+	 * volume) is integrated in closed form with the longest step, halved while
+	 * the step ends in another physics volume; other modes evaluate gravity at
+	 * both ends of every step and halve it while gravity changes too much.
+	 * @note Only end points of steps are tested, a step that briefly crosses another volume isn't detected
+	 * @note Doesn't allocate memory; stops when the output buffer is full
+	 * @param WorldContextObject - object that provides the world
+	 * @param Params - settings of the prediction
+	 * @param OutPoints - caller-provided buffer that receives a point per step, start location excluded
+	 * @param OutResult - receives outcome of the prediction
+	 * @return true if sweeps found a blocking hit
+	 */
+	static bool PredictNinjaTrajectory(const UObject* WorldContextObject, const FNinjaTrajectoryParams& Params,
+		TArrayView<FVector> OutPoints, FNinjaTrajectoryResult& OutResult);
+
+	/**
+	 * Predicts a ballistic trajectory under Ninja gravity.
+	 * @param WorldContextObject - object that provides the world
+	 * @param Params - settings of the prediction
+	 * @param MaxPoints - maximum amount of points of the path
+	 * @param OutPathPositions - receives a point per step, start location excluded
+	 * @param OutResult - receives outcome of the prediction
+	 * @return true if sweeps found a blocking hit
+	 */
+	UFUNCTION(BlueprintCallable,Category="NinjaTrajectory",Meta=(WorldContext="WorldContextObject",DisplayName="Predict Ninja Trajectory",ScriptName="PredictNinjaTrajectory"))
+	static bool K2_PredictNinjaTrajectory(const UObject* WorldContextObject, const FNinjaTrajectoryParams& Params,
+		int32 MaxPoints, TArray<FVector>& OutPathPositions, FNinjaTrajectoryResult& OutResult);
+};
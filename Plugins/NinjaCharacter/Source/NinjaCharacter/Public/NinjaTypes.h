@@ -28,10 +28,10 @@ enum class ENinjaGravityDirectionMode : uint8
 	Box,
 	/** Gravity direction points to collision geometry of an Actor. */
 	Collision,
-	/** Mode not used (#1). */
-	Unused1,
-	/** Mode not used (#2). */
-	Unused2,
+	/** Gravity direction is sampled from a baked gravity field. */
+	Baked,
+	/** Gravity direction is blended from gravity source components. */
+	Field,
 	/** Mode not used (#3). */
 	Unused3,
 	/** Mode not used (#4). */
@@ -47,3 +47,17 @@ enum class ENinjaGravityDirectionMode : uint8
 	/** Mode not used (#9). */
 	Unused9,
 };
+
+/** Provides shapes of gravity sources. */
+UENUM(BlueprintType)
+enum class ENinjaGravitySourceShape : uint8
+{
+	/** Gravity direction points to location of the source. */
+	Point,
+	/** Gravity direction points to a line bounded by two points. */
+	Line,
+	/** Gravity direction points to a spline. */
+	Spline,
+	/** Gravity direction points to an oriented box. */
+	Box,
+};